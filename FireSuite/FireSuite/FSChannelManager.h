@@ -7,6 +7,14 @@
 
 #import <Foundation/Foundation.h>
 #import <Firebase/Firebase.h>
+#import "FSMetrics.h"
+#import "FSTracer.h"
+#import "FSRefCache.h"
+#import "FSRetrier.h"
+#import "FSShardRouter.h"
+#import "FSPromise.h"
+#import "FSOutbox.h"
+#import "FSEventHub.h"
 
 #define TimeStamp [NSString stringWithFormat:@"%f",[[NSDate new] timeIntervalSince1970] * 1000]
 
@@ -14,22 +22,113 @@ FOUNDATION_EXPORT NSString *const kAlertData;
 FOUNDATION_EXPORT NSString *const kAlertTimestamp;
 FOUNDATION_EXPORT NSString *const kAlertType;
 FOUNDATION_EXPORT NSString *const kAlertTypeNewMessage;
+FOUNDATION_EXPORT NSString *const kAlertTypeNewGroupMessage;
 
 /*!
  Used To Send And Receive Messages On User Channels
  */
+/*!
+ Alerts between users.  Safe to call from any thread -- observers are kept on a private serial queue and notified on callbackQueue.
+ */
 @interface FSChannelManager : NSObject
 
 + (FSChannelManager *) singleton;
 
-@property (strong, nonatomic) NSString * urlRefString;
-@property (strong, nonatomic) NSString * currentUserId;
+@property (strong) NSString * urlRefString;
+@property (strong) NSString * currentUserId;
 
+/*!
+ Where observer selectors and completions are delivered -- defaults to the main queue, like Firebase
+ */
+@property (strong) dispatch_queue_t callbackQueue;
+
+/*!
+ Receives counters and latencies -- defaults to [FSMetrics singleton]
+ */
+@property (strong) FSMetrics * metrics;
+
+/*!
+ Records a span for each step -- defaults to [FSTracer singleton]
+ */
+@property (strong) FSTracer * tracer;
+
+/*!
+ Shared Firebase refs -- defaults to [FSRefCache singleton]
+ */
+@property (strong) FSRefCache * refCache;
+
+/*!
+ Retries failed writes and transactions -- defaults to [FSRetrier singleton]
+ */
+@property (strong) FSRetrier * retrier;
+
+/*!
+ Routes Chats/ and Users/ paths across databases -- nil keeps everything under urlRefString
+ */
+@property (strong) FSShardRouter * shardRouter;
+
+/*!
+ Opens the alerts listener -- defaults to [FSEventHub singleton]
+ */
+@property (strong) FSEventHub * eventHub;
+
+/*!
+ Journals alerts so they survive failures and relaunches -- nil sends straight to Firebase.  Replays can repeat an alert that was already consumed; observers aren't told twice within a run.
+ */
+@property (strong) FSOutbox * outbox;
+
+- (void) sendAlertToUserId:(NSString *)userId
+             withAlertType:(NSString *)alertType
+                   andData:(id)data
+            withCompletion:(void (^)(NSError *))completion;
+
+/*!
+ Sends under @param key as the alert's child name -- sending the same key again overwrites rather than duplicates.  nil picks a new one.
+ */
 - (void) sendAlertToUserId:(NSString *)userId
              withAlertType:(NSString *)alertType
                    andData:(id)data
+                       key:(NSString *)key
             withCompletion:(void (^)(NSError *))completion;
 
+/*!
+ Fulfilled with NSNull once the server has the alert -- settled on callbackQueue
+ */
+- (FSPromise *) sendAlertToUserId:(NSString *)userId
+                    withAlertType:(NSString *)alertType
+                          andData:(id)data;
+
+#pragma mark FAN OUT
+
+/*!
+ Recipients per multi-location write -- defaults to 100
+ */
+@property NSUInteger fanOutChunkSize;
+
+/*!
+ One alert to every user in @param userIds -- each gets it under the same child name, in one multi-location write per shard and chunk.  Journaled as a single outbox entry when outbox is set.
+ */
+- (void) sendAlertToUserIds:(NSArray *)userIds
+              withAlertType:(NSString *)alertType
+                    andData:(id)data
+             withCompletion:(void (^)(NSError *))completion;
+
+/*!
+ Every recipient gets it under @param key -- nil picks a new one
+ */
+- (void) sendAlertToUserIds:(NSArray *)userIds
+              withAlertType:(NSString *)alertType
+                    andData:(id)data
+                        key:(NSString *)key
+             withCompletion:(void (^)(NSError *))completion;
+
+/*!
+ Fulfilled with NSNull once every recipient's alert has landed -- settled on callbackQueue
+ */
+- (FSPromise *) sendAlertToUserIds:(NSArray *)userIds
+                     withAlertType:(NSString *)alertType
+                           andData:(id)data;
+
 /*!
  Register alerts observers -- selector w/ one arg: -(void)receivedAlert:(NSDictionary *)alert;
  */
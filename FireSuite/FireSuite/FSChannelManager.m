@@ -9,14 +9,35 @@ NSString *const kAlertData = @"kAlertData";
 NSString *const kAlertTimestamp = @"kAlertTimestamp";
 NSString *const kAlertType = @"kAlertType";
 NSString *const kAlertTypeNewMessage = @"kAlertTypeNewMessage";
+NSString *const kAlertTypeNewGroupMessage = @"kAlertTypeNewGroupMessage";
 
 #import "FSChannelManager.h"
+#import "FSStateQueue.h"
+
+// Alerts Remembered For Dropping Replays
+static NSUInteger const kReceivedAlertKeysCapacity = 256;
+
+// Recipients Per Fan Out Write
+static NSUInteger const kDefaultFanOutChunkSize = 100;
 
 @interface FSChannelManager ()
 {
-    Firebase * alertsRef;
+    // Owns Everything Below -- Only Touched On This Queue
+    dispatch_queue_t stateQueue;
+    
+    // Users/{id}/alerts Through The Event Hub -- 0 When Not Monitoring
+    FSEventHubToken alertsToken;
     
     NSMutableArray * alertsObservers;
+    
+    // Recently Received Alert Keys -- Outbox Replays Are Removed Without Notifying Twice
+    NSMutableOrderedSet * receivedAlertKeys;
+    
+    // Exposed Through outbox
+    FSOutbox * _outbox;
+    
+    // Metrics -- Last Value Reported To Gauges, Listeners Are The Hub's
+    NSInteger reportedObserverCount;
 }
 @end
 
@@ -32,13 +53,87 @@ NSString *const kAlertTypeNewMessage = @"kAlertTypeNewMessage";
     return shared;
 }
 
+- (instancetype) init {
+    self = [super init];
+    if (self) {
+        stateQueue = FSStateQueueCreate("com.firesuite.channelManager");
+        _callbackQueue = dispatch_get_main_queue();
+        
+        // Default Tools
+        _metrics = [FSMetrics singleton];
+        _tracer = [FSTracer singleton];
+        _refCache = [FSRefCache singleton];
+        _retrier = [FSRetrier singleton];
+        _eventHub = [FSEventHub singleton];
+        
+        _fanOutChunkSize = kDefaultFanOutChunkSize;
+    }
+    return self;
+}
+
+#pragma mark STATE
+
+- (FSOutbox *) outbox {
+    __block FSOutbox * outbox;
+    FSStateQueueSync(stateQueue, ^{
+        outbox = _outbox;
+    });
+    return outbox;
+}
+
+- (void) setOutbox:(FSOutbox *)outbox {
+    FSStateQueueSync(stateQueue, ^{
+        _outbox = outbox;
+    });
+    
+    // Runs On The Outbox's Queue -- Never Waits On Ours
+    __weak FSChannelManager * weakSelf = self;
+    [outbox setSender:^(NSArray *entries, void (^done)(NSError *)) {
+        [weakSelf sendOutboxAlerts:entries completion:done];
+    } forKind:kOutboxKindAlert];
+    [outbox setSender:^(NSArray *entries, void (^done)(NSError *)) {
+        [weakSelf sendOutboxFanOuts:entries completion:done];
+    } forKind:kOutboxKindAlertFanOut];
+}
+
+// Hand A Result To The Developer
+- (void) deliver:(dispatch_block_t)block {
+    dispatch_async(self.callbackQueue ?: dispatch_get_main_queue(), block);
+}
+
+#pragma mark SHARDS
+
+- (NSString *) rootForUserId:(NSString *)userId {
+    FSShardRouter * shardRouter = self.shardRouter;
+    return shardRouter ? [shardRouter databaseURLForUserId:userId] : self.urlRefString;
+}
+
+// Report Changes In Observers Since Last Update
+- (void) updateMetricsGauges {
+    NSInteger observerCount = alertsObservers.count;
+    
+    [self.metrics adjustObserverCount:observerCount - reportedObserverCount];
+    
+    reportedObserverCount = observerCount;
+}
+
+#pragma mark SEND ALERT
+
+- (void) sendAlertToUserId:(NSString *)userId
+             withAlertType:(NSString *)alertType
+                   andData:(id)data
+            withCompletion:(void (^)(NSError *))completion
+{
+    [self sendAlertToUserId:userId withAlertType:alertType andData:data key:nil withCompletion:completion];
+}
+
 - (void) sendAlertToUserId:(NSString *)userId
              withAlertType:(NSString *)alertType
                    andData:(id)data
+                       key:(NSString *)key
             withCompletion:(void (^)(NSError *))completion
 {
-    NSString * alertsRefString = [NSString stringWithFormat:@"%@Users/%@/alerts/", _urlRefString, userId];
-    Firebase * sender = [[Firebase alloc]initWithUrl:alertsRefString];
+    Firebase * sender = [self.refCache refWithRoot:[self rootForUserId:userId] collection:@"Users" id:userId leaf:@"alerts"];
     
     NSMutableDictionary * alertt = [NSMutableDictionary new];
     alertt[kAlertType] = alertType;
@@ -46,49 +141,314 @@ NSString *const kAlertTypeNewMessage = @"kAlertTypeNewMessage";
     
     NSString * timeStamp = TimeStamp;
     alertt[kAlertTimestamp] = timeStamp;
-    [[sender childByAutoId] setValue:alertt andPriority:timeStamp withCompletionBlock:^(NSError *error, Firebase *ref) {
+    
+    Firebase * alertRef = key ? [sender childByAppendingPath:key] : [sender childByAutoId];
+    
+    // Journal First -- The Outbox Sends It, Retrying And Replaying As Needed
+    FSOutbox * outbox = self.outbox;
+    if (outbox) {
+        NSDictionary * entry = [FSOutbox entryWithKind:kOutboxKindAlert
+                                                  lane:[NSString stringWithFormat:@"Users/%@/alerts", userId]
+                                                   key:alertRef.name
+                                               payload:@{@"userId": userId, @"alert": alertt}];
+        NSError * error;
+        BOOL isQueued = [outbox enqueueEntry:entry completion:^(NSError *error) {
+            if (completion) [self deliver:^{
+                completion(error);
+            }];
+        } error:&error];
+        
+        if (!isQueued && completion) [self deliver:^{
+            completion(error);
+        }];
+        return;
+    }
+    
+    // Measure Until Server Acknowledges
+    FSMetrics * metrics = self.metrics;
+    FSTracer * tracer = self.tracer;
+    NSTimeInterval start = FSMetricsNow();
+    FSTraceSpan sendSpan = [tracer beginSpan:"channel.sendAlert" parent:FSTraceSpanNone];
+    [metrics recordBytes:FSMetricsEstimatedBytes(alertt) forOperation:kFSOperationSendAlert];
+    [metrics recordRoundTrips:1];
+    
+    [self.retrier setValue:alertt andPriority:timeStamp onRef:alertRef operation:kFSOperationSendAlert completion:^(NSError *error, Firebase *ref) {
         
-        if (completion) completion(error);
+        [metrics recordOperation:kFSOperationSendAlert latency:FSMetricsNow() - start error:error];
+        [tracer endSpan:sendSpan];
+        if (completion) [self deliver:^{
+            completion(error);
+        }];
         
     }];
 }
 
-#pragma mark INCOMING ALERTS MONITOR
+- (FSPromise *) sendAlertToUserId:(NSString *)userId
+                    withAlertType:(NSString *)alertType
+                          andData:(id)data
+{
+    FSPromise * promise = [FSPromise promise];
+    [self sendAlertToUserId:userId withAlertType:alertType andData:data withCompletion:^(NSError *error) {
+        promise.resolver([NSNull null], error);
+    }];
+    return promise;
+}
 
-- (void) startIncomingAlertsMonitor {
+#pragma mark OUTBOX
+
+// Outbox Sender -- A Batch Shares One Recipient, So One Multi-Location Write
+- (void) sendOutboxAlerts:(NSArray *)entries completion:(void (^)(NSError * error))completion {
     
-    // If ConnectionMonitor Isn't Already Monitoring, Start Monitoring
-    if (!alertsRef) {
-        
-        // Prep ConnectionRefString
-        NSString * refString = [NSString stringWithFormat:@"%@Users/%@/alerts/", _urlRefString, _currentUserId];
+    NSString * userId = entries[0][kOutboxEntryPayload][@"userId"];
+    Firebase * alertsRefForUser = [self.refCache refWithRoot:[self rootForUserId:userId] collection:@"Users" id:userId leaf:@"alerts"];
+    
+    // The Key Is The Alert's Child Name -- Replays Overwrite Rather Than Duplicate
+    NSMutableDictionary * values = [NSMutableDictionary dictionaryWithCapacity:entries.count];
+    for (NSDictionary * entry in entries) {
+        NSMutableDictionary * alert = [entry[kOutboxEntryPayload][@"alert"] mutableCopy];
+        alert[@".priority"] = alert[kAlertTimestamp];
+        values[entry[kOutboxEntryKey]] = alert;
+    }
+    
+    // Measure Until Server Acknowledges -- Each Alert Counts As A Send
+    FSMetrics * metrics = self.metrics;
+    FSTracer * tracer = self.tracer;
+    NSTimeInterval start = FSMetricsNow();
+    FSTraceSpan sendSpan = [tracer beginSpan:"channel.outbox.sendAlerts" parent:FSTraceSpanNone];
+    [metrics recordBytes:FSMetricsEstimatedBytes(values) forOperation:kFSOperationSendAlert];
+    [metrics recordRoundTrips:1];
+    
+    [self.retrier updateChildValues:values onRef:alertsRefForUser operation:kFSOperationSendAlert completion:^(NSError *error, Firebase *ref) {
+        NSTimeInterval latency = FSMetricsNow() - start;
+        for (NSUInteger i = 0; i < entries.count; i++) {
+            [metrics recordOperation:kFSOperationSendAlert latency:latency error:error];
+        }
+        [tracer endSpan:sendSpan];
+        completion(error);
+    }];
+}
+
+// Outbox Sender -- Every Fan Out In The Batch Goes Out Together
+- (void) sendOutboxFanOuts:(NSArray *)entries completion:(void (^)(NSError * error))completion {
+    
+    NSMutableArray * deliveries = [NSMutableArray new];
+    for (NSDictionary * entry in entries) {
+        NSMutableDictionary * alert = [entry[kOutboxEntryPayload][@"alert"] mutableCopy];
+        alert[@".priority"] = alert[kAlertTimestamp];
+        for (NSString * userId in entry[kOutboxEntryPayload][@"userIds"]) {
+            [deliveries addObject:@[userId, entry[kOutboxEntryKey], alert]];
+        }
+    }
+    [self writeFanOutDeliveries:deliveries completion:completion];
+}
+
+#pragma mark FAN OUT
+
+- (void) sendAlertToUserIds:(NSArray *)userIds
+              withAlertType:(NSString *)alertType
+                    andData:(id)data
+             withCompletion:(void (^)(NSError *))completion
+{
+    [self sendAlertToUserIds:userIds withAlertType:alertType andData:data key:nil withCompletion:completion];
+}
+
+- (void) sendAlertToUserIds:(NSArray *)userIds
+              withAlertType:(NSString *)alertType
+                    andData:(id)data
+                        key:(NSString *)key
+             withCompletion:(void (^)(NSError *))completion
+{
+    if (userIds.count == 0) {
+        if (completion) [self deliver:^{
+            completion(nil);
+        }];
+        return;
+    }
+    
+    NSMutableDictionary * alertt = [NSMutableDictionary new];
+    alertt[kAlertType] = alertType;
+    alertt[kAlertData] = data;
+    alertt[kAlertTimestamp] = TimeStamp;
+    
+    // One Key For Everyone -- Each Recipient's Alerts Are Their Own, And Replays Overwrite
+    if (!key) key = [[self.refCache refWithRoot:self.urlRefString collection:@"Users" id:nil leaf:nil] childByAutoId].name;
+    
+    // Journal First -- One Entry, However Many Recipients
+    FSOutbox * outbox = self.outbox;
+    if (outbox) {
+        NSDictionary * entry = [FSOutbox entryWithKind:kOutboxKindAlertFanOut
+                                                  lane:@"Users/fanOut"
+                                                   key:key
+                                               payload:@{@"userIds": userIds, @"alert": alertt}];
+        NSError * error;
+        BOOL isQueued = [outbox enqueueEntry:entry completion:^(NSError *error) {
+            if (completion) [self deliver:^{
+                completion(error);
+            }];
+        } error:&error];
         
-        // Load ConnectionMonitor
-        alertsRef = [[Firebase alloc] initWithUrl:refString];
+        if (!isQueued && completion) [self deliver:^{
+            completion(error);
+        }];
+        return;
+    }
+    
+    alertt[@".priority"] = alertt[kAlertTimestamp];
+    NSMutableArray * deliveries = [NSMutableArray arrayWithCapacity:userIds.count];
+    for (NSString * userId in userIds) {
+        [deliveries addObject:@[userId, key, alertt]];
+    }
+    [self writeFanOutDeliveries:deliveries completion:^(NSError *error) {
+        if (completion) [self deliver:^{
+            completion(error);
+        }];
+    }];
+}
+
+- (FSPromise *) sendAlertToUserIds:(NSArray *)userIds
+                     withAlertType:(NSString *)alertType
+                           andData:(id)data
+{
+    FSPromise * promise = [FSPromise promise];
+    [self sendAlertToUserIds:userIds withAlertType:alertType andData:data withCompletion:^(NSError *error) {
+        promise.resolver([NSNull null], error);
+    }];
+    return promise;
+}
+
+// @param deliveries -- [userId, key, alert] -- Grouped By Shard, Then Written fanOutChunkSize At A Time.  Completion Gets The First Error.
+- (void) writeFanOutDeliveries:(NSArray *)deliveries completion:(void (^)(NSError * error))completion {
+    
+    // Users/<userId>/alerts/<key> Under Each Recipient's Database
+    NSMutableDictionary * pathsByRoot = [NSMutableDictionary new];
+    for (NSArray * delivery in deliveries) {
+        NSString * root = [self rootForUserId:delivery[0]];
+        NSMutableArray * paths = pathsByRoot[root];
+        if (!paths) {
+            paths = [NSMutableArray new];
+            pathsByRoot[root] = paths;
+        }
+        [paths addObject:@[[NSString stringWithFormat:@"%@/alerts/%@", delivery[0], delivery[1]], delivery[2]]];
+    }
+    
+    NSUInteger chunkSize = MAX(self.fanOutChunkSize, 1);
+    NSMutableArray * chunks = [NSMutableArray new];
+    for (NSString * root in pathsByRoot) {
+        NSArray * paths = pathsByRoot[root];
+        for (NSUInteger i = 0; i < paths.count; i += chunkSize) {
+            NSMutableDictionary * values = [NSMutableDictionary dictionaryWithCapacity:chunkSize];
+            for (NSArray * path in [paths subarrayWithRange:NSMakeRange(i, MIN(chunkSize, paths.count - i))]) {
+                values[path[0]] = path[1];
+            }
+            [chunks addObject:@[root, values]];
+        }
+    }
+    
+    if (chunks.count == 0) {
+        completion(nil);
+        return;
+    }
+    
+    // Chunks Go Out Side By Side
+    FSMetrics * metrics = self.metrics;
+    FSTracer * tracer = self.tracer;
+    FSTraceSpan fanOutSpan = [tracer beginSpan:"channel.fanOutAlert" parent:FSTraceSpanNone];
+    
+    // Counted On stateQueue -- Retried Chunks Finish On Other Queues
+    __block NSUInteger remaining = chunks.count;
+    __block NSError * firstError;
+    for (NSArray * chunk in chunks) {
+        Firebase * usersRef = [self.refCache refWithRoot:chunk[0] collection:@"Users" id:nil leaf:nil];
+        NSTimeInterval start = FSMetricsNow();
+        [metrics recordBytes:FSMetricsEstimatedBytes(chunk[1]) forOperation:kFSOperationFanOutAlert];
+        [metrics recordRoundTrips:1];
         
-        // Begin Observing
-        [alertsRef observeEventType:FEventTypeChildAdded withBlock:^(FDataSnapshot *snapshot) {
-            
-            // Notify Observers Of Alert
-            if (snapshot.value != [NSNull new]) [self notifyAlertsObservers:snapshot.value];
-            
-            [snapshot.ref removeValue];
+        [self.retrier updateChildValues:chunk[1] onRef:usersRef operation:kFSOperationFanOutAlert completion:^(NSError *error, Firebase *ref) {
+            [metrics recordOperation:kFSOperationFanOutAlert latency:FSMetricsNow() - start error:error];
             
+            dispatch_async(stateQueue, ^{
+                if (error && !firstError) firstError = error;
+                if (--remaining > 0) return;
+                
+                [tracer endSpan:fanOutSpan];
+                completion(firstError);
+            });
         }];
     }
-    else {
-        NSLog(@"AlertsManager: Already Monitoring Alerts!");
+}
+
+#pragma mark INCOMING ALERTS MONITOR
+
+- (void) startIncomingAlertsMonitor {
+    FSStateQueueAsync(stateQueue, ^{
+        
+        // If ConnectionMonitor Isn't Already Monitoring, Start Monitoring
+        if (!alertsToken) {
+            
+            // Begin Observing
+            NSString * currentUserId = self.currentUserId;
+            alertsToken = [self.eventHub observeEventType:FEventTypeChildAdded atRoot:[self rootForUserId:currentUserId] collection:@"Users" id:currentUserId leaf:@"alerts" withBlock:^(FDataSnapshot *snapshot) {
+                dispatch_async(stateQueue, ^{
+                    [self receivedAlertSnapshot:snapshot];
+                });
+            }];
+        }
+        else {
+            NSLog(@"AlertsManager: Already Monitoring Alerts!");
+        }
+        
+    });
+}
+
+- (void) receivedAlertSnapshot:(FDataSnapshot *)snapshot {
+    
+    // Stopped While Queued -- Leave It For Next Time
+    if (!alertsToken) return;
+    
+    // A Replay Of One We Already Handled
+    if ([receivedAlertKeys containsObject:snapshot.name]) {
+        [snapshot.ref removeValue];
+        return;
     }
+    if (!receivedAlertKeys) receivedAlertKeys = [NSMutableOrderedSet new];
+    [receivedAlertKeys addObject:snapshot.name];
+    if (receivedAlertKeys.count > kReceivedAlertKeysCapacity) [receivedAlertKeys removeObjectAtIndex:0];
+    
+    // Delivery Ends Once The Alert Is Removed
+    FSTracer * tracer = self.tracer;
+    FSTraceSpan receiveSpan = [tracer beginSpan:"channel.receiveAlert" parent:FSTraceSpanNone];
+    
+    // Sender To Receiver Latency -- Alert Timestamp Is Milliseconds Since 1970
+    if ([snapshot.value isKindOfClass:[NSDictionary class]] && snapshot.value[kAlertTimestamp]) {
+        NSTimeInterval sentAt = [snapshot.value[kAlertTimestamp] doubleValue] / 1000;
+        [self.metrics recordOperation:kFSOperationReceiveAlert latency:[[NSDate new] timeIntervalSince1970] - sentAt error:nil];
+    }
+    
+    // Notify Observers Of Alert
+    if (snapshot.value != [NSNull new]) [self notifyAlertsObservers:snapshot.value parentSpan:receiveSpan];
+    
+    [self.metrics recordRoundTrips:1];
+    FSTraceSpan removeSpan = [tracer beginSpan:"channel.receiveAlert.remove" parent:receiveSpan];
+    [self.retrier removeValueOnRef:snapshot.ref operation:kFSOperationReceiveAlert completion:^(NSError *error, Firebase *ref) {
+        [tracer endSpan:removeSpan];
+        [tracer endSpan:receiveSpan];
+    }];
 }
 
-// Broadcast Connection Status
-- (void) notifyAlertsObservers:(NSDictionary *)alert {
+// Broadcast Connection Status -- Observers Are Copied, So They May Unregister While Being Notified
+- (void) notifyAlertsObservers:(NSDictionary *)alert parentSpan:(FSTraceSpan)parentSpan {
     
     // See If Any Observers Exist
-    if (alertsObservers) {
+    if (alertsObservers.count == 0) return;
+    
+    NSArray * observers = [alertsObservers copy];
+    FSTracer * tracer = self.tracer;
+    [self deliver:^{
+        
+        FSTraceSpan notifySpan = [tracer beginSpan:"channel.receiveAlert.notifyObservers" parent:parentSpan];
         
         // Notify All Observers
-        for (NSDictionary * observer in alertsObservers) {
+        for (NSDictionary * observer in observers) {
             
             // Parse Observer Object
             NSObject * ob = observer[@"observerObject"];
@@ -135,81 +495,102 @@ NSString *const kAlertTypeNewMessage = @"kAlertTypeNewMessage";
              */
             
         }
-    }
+        
+        [tracer endSpan:notifySpan];
+    }];
 }
 
 - (void) endAlertsMonitorWithCompletionBlock:(void (^)(void))completion {
-    [alertsRef removeAllObservers];
-    alertsRef = nil;
-    
-    [alertsObservers removeAllObjects];
-    alertsObservers = nil;
-    completion();
+    FSStateQueueAsync(stateQueue, ^{
+        [self.eventHub removeObserverWithToken:alertsToken];
+        alertsToken = 0;
+        
+        [alertsObservers removeAllObjects];
+        alertsObservers = nil;
+        [self updateMetricsGauges];
+        if (completion) [self deliver:completion];
+    });
 }
 
 #pragma mark CONNECTION STATUS OBSERVERS
 
 - (void) registerUserAlertsObserver:(NSObject *)observer withSelector:(SEL)selector {
-    
-    if (_currentUserId) {
-        // Start Incoming Alerts Monitor If Necessary
-        if (!alertsRef) [self startIncomingAlertsMonitor];
+    FSStateQueueAsync(stateQueue, ^{
         
-        // Create Connection Status Observers Pool If Necessary
-        if (!alertsObservers) alertsObservers = [NSMutableArray new];
-        
-        // Check Registration
-        if (![self isAlertObserverAlreadyRegistered:observer]) {
+        if (self.currentUserId) {
+            // Start Incoming Alerts Monitor If Necessary
+            if (!alertsToken) [self startIncomingAlertsMonitor];
+            
+            // Create Connection Status Observers Pool If Necessary
+            if (!alertsObservers) alertsObservers = [NSMutableArray new];
             
-            // Generate New Observer
-            NSMutableDictionary * newObserver = [NSMutableDictionary new];
-            newObserver[@"observerObject"] = observer;
-            newObserver[@"selector"] = [NSValue valueWithPointer:selector];
-            [alertsObservers addObject:newObserver];
+            // Check Registration
+            if (![self isAlertObserverAlreadyRegistered:observer]) {
+                
+                // Generate New Observer
+                NSMutableDictionary * newObserver = [NSMutableDictionary new];
+                newObserver[@"observerObject"] = observer;
+                newObserver[@"selector"] = [NSValue valueWithPointer:selector];
+                [alertsObservers addObject:newObserver];
+                [self updateMetricsGauges];
+            }
+            else {
+                // Observer Already Exists
+                NSLog(@"\n\n **** 3:AlertsManager: Attempt to add connectionStatusObserver that already exists **** \n\n");
+            }
         }
         else {
-            // Observer Already Exists
-            NSLog(@"\n\n **** 3:AlertsManager: Attempt to add connectionStatusObserver that already exists **** \n\n");
+            NSLog(@"DID NOT REGISTER USER ALERTS OBSERVER, MUST SET CURRENT USER ID [FireSuite setCurrentUserId:<userId>];");
         }
-    }
-    else {
-        NSLog(@"DID NOT REGISTER USER ALERTS OBSERVER, MUST SET CURRENT USER ID [FireSuite setCurrentUserId:<userId>];");
-    }
+        
+    });
 }
 
 - (void) removeAllAlertsObservers {
-    if (alertsObservers) {
-        [alertsObservers removeAllObjects];
-        alertsObservers = nil;
-    }
+    FSStateQueueAsync(stateQueue, ^{
+        if (alertsObservers) {
+            [alertsObservers removeAllObjects];
+            alertsObservers = nil;
+            [self updateMetricsGauges];
+        }
+    });
 }
 
 - (void) removeAlertStatusObserver:(NSObject *)observer {
-    if ([self isAlertObserverAlreadyRegistered:observer]) {
-        [alertsObservers removeObject:observer];
-    }
+    FSStateQueueAsync(stateQueue, ^{
+        if ([self isAlertObserverAlreadyRegistered:observer]) {
+            NSIndexSet * matches = [alertsObservers indexesOfObjectsPassingTest:^BOOL(NSDictionary * dict, NSUInteger idx, BOOL *stop) {
+                return dict[@"observerObject"] == observer;
+            }];
+            [alertsObservers removeObjectsAtIndexes:matches];
+            [self updateMetricsGauges];
+        }
+    });
 }
 
 - (void) removeAllAlertStatusObserversExcept:(NSObject *)observer {
-    if (alertsObservers) {
-        if ([self isAlertObserverAlreadyRegistered:observer]) {
-            NSMutableDictionary * observerToSave;
-            for (NSMutableDictionary * dict in alertsObservers) {
-                if (dict[@"observerObject"] == observer) {
-                    observerToSave = dict;
-                    break;
+    FSStateQueueAsync(stateQueue, ^{
+        if (alertsObservers) {
+            if ([self isAlertObserverAlreadyRegistered:observer]) {
+                NSMutableDictionary * observerToSave;
+                for (NSMutableDictionary * dict in alertsObservers) {
+                    if (dict[@"observerObject"] == observer) {
+                        observerToSave = dict;
+                        break;
+                    }
                 }
+                [alertsObservers removeAllObjects];
+                if (observerToSave) [alertsObservers addObject:observerToSave];
+                [self updateMetricsGauges];
+            }
+            else {
+                NSLog(@"\n\n **** AlertsManager: Attempt to RemoveAllConnectionStatusObserversExcept: - Observer Hasn't Been Created **** \n\n");
             }
-            [alertsObservers removeAllObjects];
-            if (observerToSave) [alertsObservers addObject:observerToSave];
         }
         else {
-            NSLog(@"\n\n **** AlertsManager: Attempt to RemoveAllConnectionStatusObserversExcept: - Observer Hasn't Been Created **** \n\n");
+            NSLog(@"\n\n **** AlertsManager: Attempt to RemoveAllConnectionStatusObserversExcept: - No Observers Exist **** \n\n");
         }
-    }
-    else {
-        NSLog(@"\n\n **** AlertsManager: Attempt to RemoveAllConnectionStatusObserversExcept: - No Observers Exist **** \n\n");
-    }
+    });
 }
 
 // Instance Level
@@ -7,28 +7,58 @@
 
 #import <Foundation/Foundation.h>
 #import <Firebase/Firebase.h>
+#import "FSMetrics.h"
+#import "FSTracer.h"
+#import "FSRefCache.h"
+#import "FSRetrier.h"
+#import "FSDecodePool.h"
+#import "FSShardRouter.h"
+#import "FSPromise.h"
+#import "FSOutbox.h"
+#import "FSChatSchema.h"
+#import "FSRateLimiter.h"
+#import "FSEventHub.h"
+
+@class FSChannelManager;
 
 #pragma mark CONSTANTS
 
 typedef enum {
     FSChatErrorAlreadyInUse = 101,
     FSChatErrorFailedToGetHeader = 202,
+    FSChatErrorSessionEnded = 303,
+    FSChatErrorArchiveUnreadable = 404,
+    FSChatErrorImportInvalidChat = 505,
 } FSChatErrorCode;
 
 // Response Keys
 FOUNDATION_EXPORT NSString *const kResponseMessages;
 FOUNDATION_EXPORT NSString *const kResponseHeader;
+FOUNDATION_EXPORT NSString *const kResponseHeaders;
+FOUNDATION_EXPORT NSString *const kResponseWatermark;
+FOUNDATION_EXPORT NSString *const kResponseResumed;
+FOUNDATION_EXPORT NSString *const kResponseEarlierCount;
 
 // Error Keys
 FOUNDATION_EXPORT NSString *const kFSChatManagerErrorDomain;
 FOUNDATION_EXPORT NSString *const kErrorFailedToGetHeader;
 FOUNDATION_EXPORT NSString *const kErrorAlreadyInUse;
+FOUNDATION_EXPORT NSString *const kErrorSessionEnded;
+FOUNDATION_EXPORT NSString *const kErrorArchiveUnreadable;
+FOUNDATION_EXPORT NSString *const kErrorImportInvalidChat;
 
 // Chat Keys
 FOUNDATION_EXPORT NSString *const kChatHeader;
 FOUNDATION_EXPORT NSString *const kChatMessages;
 FOUNDATION_EXPORT NSString *const kChatCreatedAt;
 FOUNDATION_EXPORT NSString *const kChatUsers;
+FOUNDATION_EXPORT NSString *const kChatArchive;
+
+// Outbox Watermarks -- Chats/<id>/outbox/<outboxId> Is The Highest Sequence Counted In The Header
+FOUNDATION_EXPORT NSString *const kChatOutbox;
+
+// User Keys -- Users/<id>/chatChanges/<chatId>, Priority Is The Server Time Of The Last Change
+FOUNDATION_EXPORT NSString *const kUserChatChanges;
 
 // Header Keys
 FOUNDATION_EXPORT NSString *const kHeaderLastMessage;
@@ -36,6 +66,23 @@ FOUNDATION_EXPORT NSString *const kHeaderTimeStamp;
 FOUNDATION_EXPORT NSString *const kHeaderCreatedAt;
 FOUNDATION_EXPORT NSString *const kHeaderUsers;
 FOUNDATION_EXPORT NSString *const kHeaderMessageCount;
+FOUNDATION_EXPORT NSString *const kHeaderArchivedCount;
+
+// Outbox Id -> Sequence Of Its Last Batch Counted, Until That Outbox's kChatOutbox Watermark Lands -- Covers A Replay Whose Watermark Never Did.  Never Handed To Callers.
+FOUNDATION_EXPORT NSString *const kHeaderOutboxSequences;
+
+// Header Preview Keys -- kHeaderLastMessage Holds kMessageContent (Cut To headerPreviewLength), kMessageSentBy, kMessageTimestamp And kMessageId
+FOUNDATION_EXPORT NSString *const kPreviewTruncated;
+
+// Archive Bucket Keys -- Chats/<id>/archive/<yyyyMMdd>_<first message id>
+FOUNDATION_EXPORT NSString *const kArchiveFirstTimestamp;
+FOUNDATION_EXPORT NSString *const kArchiveLastTimestamp;
+FOUNDATION_EXPORT NSString *const kArchiveMessageCount;
+FOUNDATION_EXPORT NSString *const kArchiveEncoding;
+FOUNDATION_EXPORT NSString *const kArchiveData;
+
+// Archive Encodings
+FOUNDATION_EXPORT NSString *const kArchiveEncodingDeflatedJSON;
 
 // Message Keys
 FOUNDATION_EXPORT NSString *const kMessageSentTo;
@@ -45,6 +92,21 @@ FOUNDATION_EXPORT NSString *const kMessageTimestamp;
 FOUNDATION_EXPORT NSString *const kMessageHasViewed;
 FOUNDATION_EXPORT NSString *const kMessageChatId;
 
+// Local Echo Keys -- Never Stored On A Live Message; kMessageId Also Names It In Alerts, Previews And Archives
+FOUNDATION_EXPORT NSString *const kMessageId;
+FOUNDATION_EXPORT NSString *const kMessageSendState;
+
+// Send States
+FOUNDATION_EXPORT NSString *const kMessageSendStatePending;
+FOUNDATION_EXPORT NSString *const kMessageSendStateSent;
+FOUNDATION_EXPORT NSString *const kMessageSendStateFailed;
+
+// Import Keys -- One Chat Handed To importChats:, Only kImportChatId Is Required
+FOUNDATION_EXPORT NSString *const kImportChatId;
+FOUNDATION_EXPORT NSString *const kImportUsers;
+FOUNDATION_EXPORT NSString *const kImportMessages;
+FOUNDATION_EXPORT NSString *const kImportCreatedAt;
+
 /*
  Firebase Priority Doesn't Calculate Decimals in priorities, Multiply By 1000 To Expose Milliseconds and have more accurate priorities!
  */
@@ -71,10 +133,20 @@ FOUNDATION_EXPORT NSString *const kMessageChatId;
  */
 @required - (void) newMessageReceived:(NSMutableDictionary *)newMessage;
 
+/*!
+ A locally echoed message moved to kMessageSendStateSent or kMessageSendStateFailed -- same object newMessageReceived: was given
+ */
+@optional - (void) messageSendStateDidChange:(NSMutableDictionary *)message;
+
+/*!
+ A background page of an adaptive load -- the messages just before the oldest delivered so far, oldest first, each carrying kMessageId
+ */
+@optional - (void) chatSessionDidLoadEarlierMessages:(NSArray *)messages;
+
 @end
 
 /*!
- Used To Monitor A P2P Chat Session
+ Used To Monitor A P2P Chat Session.  Safe to call from any thread -- state lives on a private serial queue, and delegate calls and completions arrive on callbackQueue.
  */
 @interface FSChatManager : NSObject
 
@@ -86,22 +158,152 @@ FOUNDATION_EXPORT NSString *const kMessageChatId;
 /*!
  Used to receive callbacks for incoming message stream -- must adhere to FSChatManagerDelegate Protocol
  */
-@property (strong, nonatomic) id<FSChatManagerDelegate>delegate;
+@property (strong) id<FSChatManagerDelegate>delegate;
+
+/*!
+ Where delegate calls and completions are delivered -- defaults to the main queue, like Firebase
+ */
+@property (strong) dispatch_queue_t callbackQueue;
 
 /*!
  Your Firebase URL -- Will be appended to yourfirebase.firebaseio.com/Chats/%@(chatId)/etc.
  */
-@property (strong, nonatomic) NSString * urlRefString;
+@property (strong) NSString * urlRefString;
 /*!
  Current User's Id
  */
-@property (strong, nonatomic) NSString * currentUserId;
+@property (strong) NSString * currentUserId;
 
 /*!
  Current ChatId
  */
 @property (strong, nonatomic) NSString * chatId;
 
+/*!
+ Receives counters and latencies -- defaults to [FSMetrics singleton]
+ */
+@property (strong) FSMetrics * metrics;
+
+/*!
+ Records a span for each step -- defaults to [FSTracer singleton]
+ */
+@property (strong) FSTracer * tracer;
+
+/*!
+ Shared Firebase refs -- defaults to [FSRefCache singleton]
+ */
+@property (strong) FSRefCache * refCache;
+
+/*!
+ Retries failed writes and transactions -- defaults to [FSRetrier singleton]
+ */
+@property (strong) FSRetrier * retrier;
+
+/*!
+ Builds message and header values off the state queue, keeping their order -- defaults to [FSDecodePool singleton], nil decodes inline
+ */
+@property (strong) FSDecodePool * decodePool;
+
+/*!
+ Routes Chats/ and Users/ paths across databases -- nil keeps everything under urlRefString
+ */
+@property (strong) FSShardRouter * shardRouter;
+
+/*!
+ Watches the connection for the live message monitor, alongside presence -- defaults to [FSEventHub singleton]
+ */
+@property (strong) FSEventHub * eventHub;
+
+/*!
+ Delivers new message alerts -- defaults to [FSChannelManager singleton]
+ */
+@property (strong) FSChannelManager * channelManager;
+
+/*!
+ Hand each sent message to newMessageReceived: right away, with kMessageId and kMessageSendState pending -- the server's copy is matched by kMessageId and not delivered again.  Defaults to YES.
+ */
+@property BOOL localEcho;
+
+/*!
+ Group sends alert every other member with kAlertTypeNewGroupMessage -- chat id, sender, timestamp and kMessageId -- while the group has no more than this many of them.  Bigger groups aren't alerted; members pull headers instead.  Defaults to 100, 0 turns group alerts off.
+ */
+@property NSUInteger fanOutThreshold;
+
+/*!
+ Characters of content kept in kHeaderLastMessage -- it also carries the sender, timestamp and kMessageId, the child name under kChatMessages, in place of the whole message.  kPreviewTruncated is YES when content was cut.  Defaults to 100.
+ */
+@property NSUInteger headerPreviewLength;
+
+/*!
+ Journals sends so they survive failures and relaunches, and replays them without duplicates -- nil sends straight to Firebase
+ */
+@property (strong) FSOutbox * outbox;
+
+/*!
+ Most messages compaction packs into one archive bucket -- buckets never span a UTC day either.  Defaults to 500.
+ */
+@property NSUInteger archiveBucketSize;
+
+/*!
+ How headers and messages this manager writes are stored -- see FSChatSchema.  Both versions are always read.  Defaults to FSChatSchemaVersion1; switch to FSChatSchemaVersion2 once every client reads it, then migrate what's already stored.
+ */
+@property FSChatSchemaVersion schemaVersion;
+
+/*!
+ Users read per migration page for the chats they list, and chats migrated at once.  Defaults to 50.
+ */
+@property NSUInteger migrationBatchSize;
+
+/*!
+ File keeping each chat's last delivered message, so a resumed session asks only for what came after it -- nil keeps them in memory, still used across reconnects
+ */
+@property (strong) NSString * cursorPath;
+
+/*!
+ Chats prefetchChatsWithHeaders: keeps warm -- those opened most since launch, then the most recently active.  Defaults to 5.
+ */
+@property NSUInteger prefetchChatCount;
+
+/*!
+ Newest messages prefetched per chat -- a load asking for more than this goes to the network unless that's all the chat has.  Defaults to 20.
+ */
+@property NSUInteger prefetchMessageCount;
+
+/*!
+ Most bytes of headers and messages kept warm, and so downloaded per prefetch.  Defaults to 256 KB.
+ */
+@property NSUInteger prefetchByteBudget;
+
+/*!
+ Paces sends per chat and for the whole context -- a send waits for its tokens before it's echoed or written, and fails if too many are waiting.  nil, or a limiter with no rate set, sends at once.
+ */
+@property (strong) FSRateLimiter * rateLimiter;
+
+/*!
+ YES folds a send made while another to the same chat is still waiting on rateLimiter into that one, its content on a new line -- every caller's completion gets the combined message.  Defaults to NO.
+ */
+@property BOOL coalescesLimitedSends;
+
+/*!
+ Most messages per import write -- whole chats are grouped up to this, and a bigger chat is split across several writes.  Defaults to 500.
+ */
+@property NSUInteger importBatchSize;
+
+/*!
+ Import chunks outstanding at once.  Defaults to 4.
+ */
+@property NSUInteger importMaxInFlight;
+
+/*!
+ Time to first render a load aims for.  The first window is sized to land within it from the measured round trip and throughput; the rest of the messages asked for follow in background pages through chatSessionDidLoadEarlierMessages:, and kResponseEarlierCount says how many.  0 loads them all up front.  Defaults to 0.
+ */
+@property NSTimeInterval initialLoadTargetLatency;
+
+/*!
+ Fewest messages the first window of an adaptive load asks for, however slow the link.  Defaults to 10.
+ */
+@property NSUInteger minimumInitialMessageCount;
+
 #pragma mark CREATE NEW CHAT
 
 /*!
@@ -128,6 +330,15 @@ withCompletionBlock:(void (^)(NSString * chatId, NSError * error))completion;
 - (void) getChatHeadersForUserId:(NSString *)userId
              WithCompletionBlock:(void (^)(NSArray * headers, NSError * error))completion;
 
+#pragma mark CHANGE FEED
+
+/*!
+ Headers of @param userId's chats changed since @param watermark, keyed by chat id, and the watermark to pass next time.  Creating a chat, adding a member and each send record a change for every member -- except sends to groups past fanOutThreshold, whose headers are still pulled.  nil does a full sync: every chat, plus a watermark to start from.  Changes at the watermark itself come back again, so nothing landing in the same millisecond is missed.
+ */
+- (void) getChatHeaderChangesForUserId:(NSString *)userId
+                        sinceWatermark:(NSNumber *)watermark
+                   withCompletionBlock:(void (^)(NSDictionary * headers, NSNumber * watermark, NSError * error))completion;
+
 #pragma mark CHAT SESSION
 
 /*!
@@ -135,16 +346,153 @@ withCompletionBlock:(void (^)(NSString * chatId, NSError * error))completion;
  */
 - (void) loadChatSessionWithChatId:(NSString *)chatId andNumberOfRecentMessages:(int)numberOfMessages;
 
+/*!
+ Like loadChatSessionWithChatId:andNumberOfRecentMessages:, but if @param chatId has a cursor the response has kResponseResumed YES and no messages -- every message after the last one delivered, on this launch or one saved to cursorPath, follows through newMessageReceived:.  Without a cursor it loads @param numberOfMessages as usual.
+ */
+- (void) resumeChatSessionWithChatId:(NSString *)chatId andNumberOfRecentMessages:(int)numberOfMessages;
+
 /*!
  Use this to end chat session before loading a new one!
  */
 - (void) endChatSessionWithCompletionBlock:(void (^)(NSError * error))completion;
 
+#pragma mark LINK ESTIMATES
+
+/*!
+ Seconds per round trip, smoothed over recent loads -- each header read is a sample.  0 until measured.
+ */
+- (NSTimeInterval) estimatedRoundTrip;
+
+/*!
+ Bytes per second once a query's round trip is taken out, smoothed over recent message loads and pages.  0 until measured.
+ */
+- (double) estimatedBytesPerSecond;
+
 #pragma mark SEND MESSAGE
 
 /*!
- Use to send a new message. -- Timestamp, SentBy, SentTo, ChatId
+ Use to send a new message. -- Timestamp, SentBy, SentTo, ChatId.  Paced by rateLimiter.
  */
 - (void) sendNewMessage:(NSString *)content;
 
+#pragma mark ARCHIVE
+
+/*!
+ Pack messages of @param chatId older than @param age seconds into compressed day buckets under kChatArchive, oldest first, removing them from kChatMessages in the same write.  Safe to repeat after a failure; run it from one client per chat at a time.  Completion gets how many messages were archived.
+ */
+- (void) compactChatWithId:(NSString *)chatId
+                 olderThan:(NSTimeInterval)age
+       withCompletionBlock:(void (^)(NSUInteger archivedCount, NSError * error))completion;
+
+#pragma mark HISTORY
+
+/*!
+ Up to @param count messages of @param chatId sent before @param timestamp -- nil for the newest -- oldest first, each carrying kMessageId.  Live messages are read first and archive buckets only if more are needed, so pass the first message's kMessageTimestamp to page further back.
+ */
+- (void) getMessagesForChatId:(NSString *)chatId
+              beforeTimestamp:(NSString *)timestamp
+                        count:(NSUInteger)count
+          withCompletionBlock:(void (^)(NSArray * messages, NSError * error))completion;
+
+#pragma mark MIGRATION
+
+/*!
+ Rewrite every chat's header and messages into @param version.  Chat ids come from the members' chat lists, migrationBatchSize users per read, database by database; each chat's messages are read a bounded window at a time.  Chats no member lists are left alone.  Chats already in @param version are read but not written, so an interrupted run is simply started again.  Headers change by transaction, keeping sends made meanwhile; don't compact a chat while it migrates.  Completion gets how many chats were rewritten.
+ */
+- (void) migrateChatsToSchemaVersion:(FSChatSchemaVersion)version
+                 withCompletionBlock:(void (^)(NSUInteger migratedCount, NSError * error))completion;
+
+#pragma mark IMPORT
+
+/*!
+ Bring existing conversations in from another system.  @param chats yields NSDictionaries -- kImportChatId, kImportUsers, kImportMessages (version 1 message dictionaries, kMessageTimestamp in milliseconds like TimeStamp) and optionally kImportCreatedAt -- and is read on the chat manager's queue, a chunk at a time.
+ 
+ Chats are grouped up to importBatchSize messages.  Each chunk goes out as multi-location writes of up to importBatchSize messages, one per database, then one chat list transaction per member and one change feed write per database.  importMaxInFlight chunks are outstanding at once.  Messages are keyed by timestamp and position, so they sort among later sends and a rerun writes the same keys.  Imported history counts as read.
+ 
+ After each chunk, the chats finished in stream order are counted to @param checkpointPath, and @param progress is told on callbackQueue.  A run given the same stream and path skips what the last one finished.  Chats past the checkpoint are written again, so import chats before anyone uses them.  Completion gets how many chats are in, including those skipped.
+ */
+- (void) importChats:(NSEnumerator *)chats
+      checkpointPath:(NSString *)checkpointPath
+   withProgressBlock:(void (^)(NSUInteger importedCount))progress
+  andCompletionBlock:(void (^)(NSUInteger importedCount, NSError * error))completion;
+
+#pragma mark PREFETCH
+
+/*!
+ Warm the newest prefetchMessageCount messages of the top prefetchChatCount chats in @param headers -- keyed by chat id, as getChatHeaderChangesForUserId: returns them -- within prefetchByteBudget.  A chat whose header timestamp hasn't moved isn't read again.  The next load of a prefetched chat answers without waiting on the network, stamps its header in the background and delivers anything newer through newMessageReceived:.  Completion gets how many chats are warm.
+ */
+- (void) prefetchChatsWithHeaders:(NSDictionary *)headers
+              withCompletionBlock:(void (^)(NSUInteger prefetchedCount, NSError * error))completion;
+
+#pragma mark PROMISES
+
+/*!
+ Same operations as above, as FSPromises -- settled on callbackQueue.  Cancelling one stops waiting on it; writes already sent still land.
+ */
+
+/*!
+ Fulfilled with the new chat id
+ */
+- (FSPromise *) createNewChatForUsers:(NSArray *)users withCustomId:(NSString *)customId;
+
+/*!
+ Fulfilled with @param chatId
+ */
+- (FSPromise *) addUserId:(NSString *)userId toChatId:(NSString *)chatId;
+
+/*!
+ Fulfilled with an array of headers -- empty if the user has no chats
+ */
+- (FSPromise *) chatHeadersForUserId:(NSString *)userId;
+
+/*!
+ Fulfilled with kResponseHeaders -- headers keyed by chat id -- and kResponseWatermark
+ */
+- (FSPromise *) chatHeaderChangesForUserId:(NSString *)userId sinceWatermark:(NSNumber *)watermark;
+
+/*!
+ Fulfilled with the load response also handed to the delegate.  Cancelling before it settles ends the session, removing its queries.
+ */
+- (FSPromise *) openChatSessionWithChatId:(NSString *)chatId andNumberOfRecentMessages:(int)numberOfMessages;
+
+/*!
+ Fulfilled with the response of resumeChatSessionWithChatId:andNumberOfRecentMessages:.  Cancels like openChatSessionWithChatId:andNumberOfRecentMessages:.
+ */
+- (FSPromise *) reopenChatSessionWithChatId:(NSString *)chatId andNumberOfRecentMessages:(int)numberOfMessages;
+
+/*!
+ Fulfilled with NSNull once the session has ended
+ */
+- (FSPromise *) endChatSession;
+
+/*!
+ Fulfilled with the message once the server has it -- failures still reach the delegate too
+ */
+- (FSPromise *) sendMessage:(NSString *)content;
+
+/*!
+ Fulfilled with how many messages were archived, as an NSNumber
+ */
+- (FSPromise *) compactChatWithId:(NSString *)chatId olderThan:(NSTimeInterval)age;
+
+/*!
+ Fulfilled with an array of messages -- empty once history runs out
+ */
+- (FSPromise *) messagesForChatId:(NSString *)chatId beforeTimestamp:(NSString *)timestamp count:(NSUInteger)count;
+
+/*!
+ Fulfilled with how many chats were rewritten, as an NSNumber
+ */
+- (FSPromise *) migrateChatsToSchemaVersion:(FSChatSchemaVersion)version;
+
+/*!
+ Fulfilled with how many chats are warm, as an NSNumber
+ */
+- (FSPromise *) prefetchChatsWithHeaders:(NSDictionary *)headers;
+
+/*!
+ Fulfilled with how many chats are in, as an NSNumber
+ */
+- (FSPromise *) importChats:(NSEnumerator *)chats checkpointPath:(NSString *)checkpointPath;
+
 @end
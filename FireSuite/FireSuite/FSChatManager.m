@@ -7,6 +7,9 @@
 
 #import "FSChatManager.h"
 #import "FSChannelManager.h"
+#import "FSStateQueue.h"
+#import <zlib.h>
+#import <time.h>
 
 
 #pragma mark KEYS
@@ -14,17 +17,31 @@
 // Extern Keys
 NSString *const kResponseMessages = @"kResponseMessages";
 NSString *const kResponseHeader = @"kResponseHeader";
+NSString *const kResponseHeaders = @"kResponseHeaders";
+NSString *const kResponseWatermark = @"kResponseWatermark";
+NSString *const kResponseResumed = @"kResponseResumed";
+NSString *const kResponseEarlierCount = @"kResponseEarlierCount";
 
 // Error Keys
 NSString *const kFSChatManagerErrorDomain = @"kFSChatManagerErrorDomain";
 NSString *const kErrorFailedToGetHeader = @"Failed To Get Chat Header";
 NSString *const kErrorAlreadyInUse = @"Chat Manager Is Already In Use";
+NSString *const kErrorSessionEnded = @"Chat Session Ended";
+NSString *const kErrorArchiveUnreadable = @"Archive Bucket Is Unreadable";
+NSString *const kErrorImportInvalidChat = @"Imported Chat Has No Id";
 
 // Chat Keys
 NSString *const kChatHeader= @"header";
 NSString *const kChatMessages = @"messages";
 NSString *const kChatCreatedAt = @"createdAt";
 NSString *const kChatUsers = @"users";
+NSString *const kChatArchive = @"archive";
+
+// Outbox Watermarks
+NSString *const kChatOutbox = @"outbox";
+
+// User Keys
+NSString *const kUserChatChanges = @"chatChanges";
 
 // Header Keys
 NSString *const kHeaderLastMessage = @"lastMessage";
@@ -32,6 +49,21 @@ NSString *const kHeaderTimeStamp = @"timestamp";
 NSString *const kHeaderCreatedAt = @"createdAt";
 NSString *const kHeaderUsers = @"users";
 NSString *const kHeaderMessageCount = @"messageCount";
+NSString *const kHeaderOutboxSequences = @"outboxSequences";
+NSString *const kHeaderArchivedCount = @"archivedCount";
+
+// Header Preview Keys
+NSString *const kPreviewTruncated = @"truncated";
+
+// Archive Bucket Keys
+NSString *const kArchiveFirstTimestamp = @"first";
+NSString *const kArchiveLastTimestamp = @"last";
+NSString *const kArchiveMessageCount = @"count";
+NSString *const kArchiveEncoding = @"encoding";
+NSString *const kArchiveData = @"data";
+
+// Archive Encodings
+NSString *const kArchiveEncodingDeflatedJSON = @"deflate+json";
 
 // Message Keys
 NSString *const kMessageSentTo = @"sentTo";
@@ -41,11 +73,133 @@ NSString *const kMessageTimestamp = @"timestamp";
 NSString *const kMessageHasViewed = @"hasViewed";
 NSString *const kMessageChatId = @"chatId";
 
+// Local Echo Keys
+NSString *const kMessageId = @"messageId";
+NSString *const kMessageSendState = @"sendState";
+
+// Send States
+NSString *const kMessageSendStatePending = @"pending";
+NSString *const kMessageSendStateSent = @"sent";
+NSString *const kMessageSendStateFailed = @"failed";
+
+// Import Keys
+NSString *const kImportChatId = @"chatId";
+NSString *const kImportUsers = @"users";
+NSString *const kImportMessages = @"messages";
+NSString *const kImportCreatedAt = @"createdAt";
+
+// Group Members Alerted Per Send -- Beyond This They Pull
+static NSUInteger const kDefaultFanOutThreshold = 100;
+
+// Characters Of Content A Header Keeps
+static NSUInteger const kDefaultHeaderPreviewLength = 100;
+
+// Messages Per Archive Bucket, And Per Compaction Read
+static NSUInteger const kDefaultArchiveBucketSize = 500;
+static NSUInteger const kCompactionBatchSize = 5000;
+
+// Archive Buckets Per History Read -- One, Doubling While A Page Needs More
+static NSUInteger const kHistoryMaxBucketsPerRead = 8;
+
+// Users Per Migration Read, And Chats Migrated At Once
+static NSUInteger const kDefaultMigrationBatchSize = 50;
+
+// Messages Per Migration Read -- No Chat Is Read Whole
+static NSUInteger const kMigrationMessageWindow = 500;
+
+// Cursor Keys -- The Last Message Delivered, Per Chat
+static NSString *const kCursorPriority = @"priority";
+static NSString *const kCursorName = @"name";
+
+// Deliveries Coalesced Per Cursor Save
+static NSTimeInterval const kCursorSaveDelay = 1.0;
+
+// Prefetch Defaults
+static NSUInteger const kDefaultPrefetchChatCount = 5;
+static NSUInteger const kDefaultPrefetchMessageCount = 20;
+static NSUInteger const kDefaultPrefetchByteBudget = 256 * 1024;
+
+// Limited Send Keys
+static NSString *const kLimitedSendContent = @"content";
+static NSString *const kLimitedSendCompletions = @"completions";
+
+// Outbox Entry Key -- Who A Journaled Message Still Owes An Alert: A User Id, Or Group Recipients
+static NSString *const kOutboxEntryAlertTo = @"alertTo";
+
+// Prefetched Chat Keys
+static NSString *const kPrefetchHeader = @"header";
+static NSString *const kPrefetchMessages = @"messages";
+static NSString *const kPrefetchComplete = @"complete";
+static NSString *const kPrefetchCursor = @"cursor";
+static NSString *const kPrefetchBytes = @"bytes";
+
+// Import Defaults
+static NSUInteger const kDefaultImportBatchSize = 500;
+static NSUInteger const kDefaultImportMaxInFlight = 4;
+
+// Adaptive Load Defaults
+static NSUInteger const kDefaultMinimumInitialMessageCount = 10;
+
+// Weight Of Each New Sample In The Link Estimates
+static double const kLinkEstimateWeight = 0.3;
+
+// Shortest Transfer A Sample Counts -- A Tiny Load Could Claim Any Throughput
+static NSTimeInterval const kLinkMinimumTransfer = 0.001;
+
+// Import Checkpoint Key -- Chats Finished In Stream Order
+static NSString *const kImportCheckpointImported = @"imported";
+
+// Firebase's Push Id Alphabet -- In Sort Order
+static NSString *const kImportKeyChars = @"-0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ_abcdefghijklmnopqrstuvwxyz";
+
+#pragma mark IMPORT RUN
+
+/*!
+ One importChats: call -- only touched on the chat manager's state queue
+ */
+@interface FSChatImport : NSObject
+
+@property (strong, nonatomic) NSEnumerator * chats;
+@property (strong, nonatomic) NSString * checkpointPath;
+@property (copy, nonatomic) void (^progress)(NSUInteger importedCount);
+@property (copy, nonatomic) void (^completion)(NSUInteger importedCount, NSError * error);
+@property (nonatomic) FSTraceSpan span;
+
+// Chats Taken From The Stream, And Those Finished Without A Gap Before Them -- Both Count The Checkpoint's
+@property (nonatomic) NSUInteger taken;
+@property (nonatomic) NSUInteger imported;
+
+// Finished Chunks Past A Gap -- Chat Count By Index Of Their First Chat
+@property (strong, nonatomic) NSMutableDictionary * finished;
+
+// Taken, But Too Big For The Chunk Being Built
+@property (strong, nonatomic) NSDictionary * pending;
+
+@property (nonatomic) NSUInteger inFlight;
+@property (nonatomic) BOOL isExhausted;
+@property (nonatomic) BOOL isFinished;
+@property (strong, nonatomic) NSError * error;
+
+@end
+
+@implementation FSChatImport
+@end
+
 
 
 @interface FSChatManager ()
 
 {
+    // Owns Everything Below -- Only Touched On This Queue
+    dispatch_queue_t stateQueue;
+    
+    // Bumped On Load And End -- Late Callbacks From An Old Session Are Dropped
+    NSUInteger session;
+    BOOL isLoadingSession;
+    
+    // Promise Waiting On The Current Load -- Called Once, Then Dropped
+    void (^loadCompletion)(NSDictionary * response, NSError * error);
+    
     // For Finding Observers
     FirebaseHandle queryHandle;
     FirebaseHandle messageMonitorHandle;
@@ -53,13 +207,59 @@ NSString *const kMessageChatId = @"chatId";
     // For Response
     int maxMessageCount;
     
-    // Headers
-    int headerCount;
+    // Metrics
+    NSTimeInterval loadStartTime;
+    BOOL isQueryingMessages;
+    BOOL isMonitoringMessages;
+    
+    // Tracing
+    FSTraceSpan loadSpan;
+    
+    // Current ChatId -- Exposed Through chatId
+    NSString * _chatId;
+    
+    // Exposed Through outbox
+    FSOutbox * _outbox;
+    
+    // Sent Messages Already Shown, By Child Name -- Until The Server's Copy Arrives
+    NSMutableDictionary * localEchoes;
+    
+    // Cursors By Chat Id -- Loaded From cursorsPath, Saved Back Shortly After Each Change
+    NSMutableDictionary * cursors;
+    NSString * cursorsPath;
+    BOOL isCursorSaveScheduled;
+    
+    // Resume From The Cursor Instead Of Loading Recent Messages
+    BOOL isResumingSession;
+    
+    // Where The Monitor Starts Without A Cursor -- The Header Timestamp Of An Empty Chat
+    NSString * monitorStartPriority;
+    
+    // Bumped Whenever The Monitor Is Replaced -- Deliveries Queued From The Old One Are Dropped
+    NSUInteger monitorGeneration;
+    
+    // Drops The Monitor Offline, Restarts It From The Cursor Once Back
+    FSEventHubToken connectedToken;
+    BOOL isMonitorPaused;
+    
+    // Sessions Loaded Per Chat Id, Since Launch
+    NSMutableDictionary * openCounts;
+    
+    // Warmed Chats By Chat Id -- Each Taken By The Next Load Of Its Chat
+    NSMutableDictionary * prefetchedChats;
+    
+    // Newest Send Still Waiting On The Rate Limiter -- Coalesced Sends Join It
+    NSMutableDictionary * limitedSend;
+    
+    // Outbox Watermarks By "<chatId>/<outboxId>" -- Our Outbox Is Their Only Writer, So Once Read They Stay Here
+    NSMutableDictionary * outboxWatermarks;
+    
+    // Link Estimates -- Smoothed Over Recent Loads, 0 Until Measured
+    NSTimeInterval linkRoundTrip;
+    double linkBytesPerSecond;
+    double linkBytesPerMessage;
 }
 
-// For Header Query
-@property (strong, nonatomic) NSMutableArray * receivedHeadersArray;
-
 // Initial Load Response
 @property (strong, nonatomic) NSMutableArray * receivedMessagesArray;
 @property (strong, nonatomic) NSDictionary * responseHeader;
@@ -74,6 +274,14 @@ NSString *const kMessageChatId = @"chatId";
 
 @end
 
+// What Callers See -- The Outbox Marker Is Bookkeeping
+static NSDictionary * FSHeaderForCallers(NSDictionary * header) {
+    if (!header[kHeaderOutboxSequences]) return header;
+    NSMutableDictionary * stripped = [header mutableCopy];
+    [stripped removeObjectForKey:kHeaderOutboxSequences];
+    return stripped;
+}
+
 @implementation FSChatManager
 
 #pragma mark SINGLETON
@@ -88,21 +296,135 @@ NSString *const kMessageChatId = @"chatId";
     return shared;
 }
 
+- (instancetype) init {
+    self = [super init];
+    if (self) {
+        stateQueue = FSStateQueueCreate("com.firesuite.chatManager");
+        _callbackQueue = dispatch_get_main_queue();
+        
+        // Default Tools
+        _metrics = [FSMetrics singleton];
+        _tracer = [FSTracer singleton];
+        _refCache = [FSRefCache singleton];
+        _retrier = [FSRetrier singleton];
+        _decodePool = [FSDecodePool singleton];
+        _channelManager = [FSChannelManager singleton];
+        _localEcho = YES;
+        _fanOutThreshold = kDefaultFanOutThreshold;
+        _archiveBucketSize = kDefaultArchiveBucketSize;
+        _headerPreviewLength = kDefaultHeaderPreviewLength;
+        _schemaVersion = FSChatSchemaVersion1;
+        _migrationBatchSize = kDefaultMigrationBatchSize;
+        _prefetchChatCount = kDefaultPrefetchChatCount;
+        _prefetchMessageCount = kDefaultPrefetchMessageCount;
+        _prefetchByteBudget = kDefaultPrefetchByteBudget;
+        _rateLimiter = [FSRateLimiter singleton];
+        _eventHub = [FSEventHub singleton];
+        _importBatchSize = kDefaultImportBatchSize;
+        _importMaxInFlight = kDefaultImportMaxInFlight;
+        _minimumInitialMessageCount = kDefaultMinimumInitialMessageCount;
+    }
+    return self;
+}
+
+#pragma mark STATE
+
+- (NSString *) chatId {
+    __block NSString * chatId;
+    FSStateQueueSync(stateQueue, ^{
+        chatId = _chatId;
+    });
+    return chatId;
+}
+
+- (void) setChatId:(NSString *)chatId {
+    FSStateQueueSync(stateQueue, ^{
+        _chatId = chatId;
+    });
+}
+
+- (NSTimeInterval) estimatedRoundTrip {
+    __block NSTimeInterval roundTrip;
+    FSStateQueueSync(stateQueue, ^{
+        roundTrip = linkRoundTrip;
+    });
+    return roundTrip;
+}
+
+- (double) estimatedBytesPerSecond {
+    __block double bytesPerSecond;
+    FSStateQueueSync(stateQueue, ^{
+        bytesPerSecond = linkBytesPerSecond;
+    });
+    return bytesPerSecond;
+}
+
+- (FSOutbox *) outbox {
+    __block FSOutbox * outbox;
+    FSStateQueueSync(stateQueue, ^{
+        outbox = _outbox;
+    });
+    return outbox;
+}
+
+- (void) setOutbox:(FSOutbox *)outbox {
+    FSStateQueueSync(stateQueue, ^{
+        _outbox = outbox;
+    });
+    
+    // Runs On The Outbox's Queue -- Never Waits On Ours
+    __weak FSChatManager * weakSelf = self;
+    __weak FSOutbox * weakOutbox = outbox;
+    [outbox setSender:^(NSArray *entries, void (^done)(NSError *)) {
+        [weakSelf sendOutboxMessages:entries fromOutboxId:weakOutbox.outboxId completion:done];
+    } forKind:kOutboxKindMessage];
+    
+    // Replays Included -- They Have No Completion To Tell
+    [outbox setDeadLetterHandler:^(NSArray *entries, NSError *error) {
+        [weakSelf outboxDidDropMessages:entries withError:error];
+    } forKind:kOutboxKindMessage];
+}
+
+// Hand A Result To The Developer
+- (void) deliver:(dispatch_block_t)block {
+    dispatch_async(self.callbackQueue ?: dispatch_get_main_queue(), block);
+}
+
+#pragma mark SHARDS
+
+- (NSString *) rootForChatId:(NSString *)chatId {
+    FSShardRouter * shardRouter = self.shardRouter;
+    return shardRouter ? [shardRouter databaseURLForChatId:chatId] : self.urlRefString;
+}
+
+- (NSString *) rootForUserId:(NSString *)userId {
+    FSShardRouter * shardRouter = self.shardRouter;
+    return shardRouter ? [shardRouter databaseURLForUserId:userId] : self.urlRefString;
+}
+
 #pragma mark CREATE NEW CHAT
 
 - (void) createNewChatForUsers:(NSArray *)users
                   withCustomId:(NSString *)customId
-            andCompletionBlock:(void (^)(NSString * newChatId, NSError * error))completion {
-    NSString * chatsString = [NSString stringWithFormat:@"%@Chats/", _urlRefString];
-    Firebase * chatsRef = [[Firebase alloc]initWithUrl:chatsString];
-    Firebase * newChatRef;
+            andCompletionBlock:(void (^)(NSString * newChatId, NSError * error))completionBlock {
     
-    if (customId) {
-        newChatRef = [chatsRef childByAppendingPath:customId];
-    }
-    else {
-        newChatRef = [chatsRef childByAutoId];
+    // Measure Until Chat Is Added To Every User
+    FSMetrics * metrics = self.metrics;
+    NSTimeInterval start = FSMetricsNow();
+    void (^completion)(NSString *, NSError *) = ^(NSString * newChatId, NSError * error) {
+        [metrics recordOperation:kFSOperationCreateChat latency:FSMetricsNow() - start error:error];
+        if (completionBlock) [self deliver:^{
+            completionBlock(newChatId, error);
+        }];
+    };
+    
+    // The Id Decides The Shard -- Auto Ids Are Generated Locally
+    NSString * newChatId = customId;
+    if (!newChatId) {
+        newChatId = [[self.refCache refWithRoot:self.urlRefString collection:@"Chats" id:nil leaf:nil] childByAutoId].name;
     }
+    Firebase * chatsRef = [self.refCache refWithRoot:[self rootForChatId:newChatId] collection:@"Chats" id:nil leaf:nil];
+    Firebase * newChatRef = [chatsRef childByAppendingPath:newChatId];
     
     /*
     NSMutableDictionary * newChat = [NSMutableDictionary new];
@@ -131,27 +453,41 @@ NSString *const kMessageChatId = @"chatId";
     
     // Set Header To Chat
     NSMutableDictionary * newChat = [NSMutableDictionary new];
-    newChat[kChatHeader] = headerDict;
+    newChat[kChatHeader] = FSChatSchemaEncodeHeader(headerDict, self.schemaVersion);
     
     // Unnecessary
     // newChat[kChatCreatedAt] = timeStamp;
     //
     
-    [newChatRef setValue:newChat andPriority:timeStamp withCompletionBlock:^(NSError *error, Firebase *ref) {
-        if (!error) {
-            if (users) {
-                [self addChatWithId:ref.name toUsers:users withCompletionBlock:completion];
+    [metrics recordBytes:FSMetricsEstimatedBytes(newChat) forOperation:kFSOperationCreateChat];
+    [metrics recordRoundTrips:1];
+    
+    [self.retrier setValue:newChat andPriority:timeStamp onRef:newChatRef operation:kFSOperationCreateChat completion:^(NSError *error, Firebase *ref) {
+        dispatch_async(stateQueue, ^{
+            if (!error) {
+                if (users) {
+                    [self addChatWithId:ref.name toUsers:users withCompletionBlock:^(NSString *newChat, NSError *error) {
+                        if (error) {
+                            completion(nil, error);
+                            return;
+                        }
+                        [self recordChangeOfChatId:newChat forUserIds:users completion:^(NSError *feedError) {
+                            completion(feedError ? nil : newChat, feedError);
+                        }];
+                    }];
+                }
+                else {
+                    completion(ref.name, nil);
+                }
             }
             else {
-                completion(ref.name, nil);
+                completion(nil, error);
             }
-        }
-        else {
-            completion(nil, error);
-        }
+        });
     }];
 }
 
+// Completion Runs On stateQueue
 - (void) addChatWithId:(NSString *)chatId
                toUsers:(NSArray *)users
    withCompletionBlock:(void (^)(NSString * newChat, NSError * error))completion {
@@ -159,10 +495,9 @@ NSString *const kMessageChatId = @"chatId";
     
     if (users.count > 0) {
         for (NSString * user in users) {
-            NSString * user1URL = [NSString stringWithFormat:@"%@Users/%@/chats/", _urlRefString, user];
-            Firebase * chatsRef = [[Firebase alloc]initWithUrl:user1URL];
+            Firebase * chatsRef = [self.refCache refWithRoot:[self rootForUserId:user] collection:@"Users" id:user leaf:@"chats"];
             
-            [chatsRef runTransactionBlock:^FTransactionResult *(FMutableData *currentData) {
+            [self.retrier runTransactionOnRef:chatsRef operation:kFSOperationUpdateUserChats block:^FTransactionResult *(FMutableData *currentData) {
                 NSMutableArray * chatsArray;
                 
                 if (currentData.value != [NSNull new]) {
@@ -178,19 +513,21 @@ NSString *const kMessageChatId = @"chatId";
                 
                 [currentData setValue:chatsArray];
                 return [FTransactionResult successWithValue:currentData];
-            } andCompletionBlock:^(NSError *error, BOOL committed, FDataSnapshot *snapshot) {
-                
-                count++;
-                if (!error) {
-                    if (count == users.count) {
-                        completion(chatId, nil);
+            } completion:^(NSError *error, BOOL committed, FDataSnapshot *snapshot) {
+                dispatch_async(stateQueue, ^{
+                    
+                    count++;
+                    if (!error) {
+                        if (count == users.count) {
+                            completion(chatId, nil);
+                        }
                     }
-                }
-                else {
-                    completion(nil, error);
-                }
-                
-            } withLocalEvents:NO];
+                    else {
+                        completion(nil, error);
+                    }
+                    
+                });
+            }];
             
         }
     }
@@ -203,59 +540,104 @@ NSString *const kMessageChatId = @"chatId";
 
 - (void) addUserId:(NSString *)userId
           toChatId:(NSString *)chatId
-withCompletionBlock:(void (^)(NSString * chatId, NSError * error))completion {
+withCompletionBlock:(void (^)(NSString * chatId, NSError * error))completionBlock {
+    
+    // Measure Header And User Chats Together
+    FSMetrics * metrics = self.metrics;
+    NSTimeInterval start = FSMetricsNow();
+    void (^completion)(NSString *, NSError *) = ^(NSString * addedChatId, NSError * error) {
+        [metrics recordOperation:kFSOperationAddUserToChat latency:FSMetricsNow() - start error:error];
+        if (completionBlock) [self deliver:^{
+            completionBlock(addedChatId, error);
+        }];
+    };
     
     // Get Header
-    NSString * headerRefURL = [NSString stringWithFormat:@"%@Chats/%@/header/", _urlRefString, chatId];
-    Firebase * headerRef = [[Firebase alloc]initWithUrl:headerRefURL];
+    Firebase * headerRef = [self.refCache refWithRoot:[self rootForChatId:chatId] collection:@"Chats" id:chatId leaf:kChatHeader];
     
     NSString * timestamp = TimeStamp;
+    FSChatSchemaVersion schemaVersion = self.schemaVersion;
     
-    // Transact
-    [headerRef runTransactionBlock:^FTransactionResult *(FMutableData *currentData) {
+    // Transact -- May Run More Than Once, So It Only Touches currentData
+    [self.retrier runTransactionOnRef:headerRef operation:kFSOperationUpdateHeader block:^FTransactionResult *(FMutableData *currentData) {
         
         if (currentData.value != [NSNull new]) {
             
             // Get Header From Value
-            NSMutableDictionary * header = currentData.value;
+            NSMutableDictionary * header = FSChatSchemaDecodeHeader(currentData.value);
             
             NSMutableArray * usersArr = header[kHeaderUsers];
             if (![usersArr containsObject:userId]) {
                 [usersArr addObject:userId];
             }
             
-            _users = [NSArray arrayWithArray:usersArr];
-            
             if (usersArr) header[@"users"] = usersArr;
             if (timestamp) header[userId] = timestamp;
-            [currentData setValue:header];
+            [currentData setValue:FSChatSchemaEncodeHeader(header, schemaVersion)];
         }
         
         // Return It
         return [FTransactionResult successWithValue:currentData];
-    } andCompletionBlock:^(NSError *error, BOOL committed, FDataSnapshot *snapshot) {
-        if (!error) {
-            
-            // Done!
-            [self addChatWithId:chatId toUsers:@[userId] withCompletionBlock:completion];
-        }
-    } withLocalEvents:NO];
+    } completion:^(NSError *error, BOOL committed, FDataSnapshot *snapshot) {
+        NSDictionary * header = FSChatSchemaDecodeHeader(snapshot.value);
+        dispatch_async(stateQueue, ^{
+            if (!error) {
+                
+                // Keep Our Users In Step If This Is The Open Chat
+                if ([chatId isEqualToString:_chatId] && header[kHeaderUsers]) {
+                    _users = [NSArray arrayWithArray:header[kHeaderUsers]];
+                }
+                
+                // Everyone's Feed Shows The New Member -- Then Done!
+                NSArray * users = header ? header[kHeaderUsers] : @[userId];
+                [self addChatWithId:chatId toUsers:@[userId] withCompletionBlock:^(NSString *addedChatId, NSError *error) {
+                    if (error) {
+                        completion(nil, error);
+                        return;
+                    }
+                    [self recordChangeOfChatId:chatId forUserIds:users completion:^(NSError *feedError) {
+                        completion(feedError ? nil : addedChatId, feedError);
+                    }];
+                }];
+            }
+            else {
+                completion(nil, error);
+            }
+        });
+    }];
     
 }
 
 #pragma mark HEADERS QUERY
 
 - (void) getChatHeadersForUserId:(NSString *)userId
-             WithCompletionBlock:(void (^)(NSArray * headers, NSError * error))completion {
+             WithCompletionBlock:(void (^)(NSArray * headers, NSError * error))completionBlock {
 
-    NSString * userChatsURL = [NSString stringWithFormat:@"%@Users/%@/chats/",_urlRefString, userId];
-    Firebase * userChatsRef = [[Firebase alloc]initWithUrl:userChatsURL];
+    // Measure The Whole Fan Out
+    FSMetrics * metrics = self.metrics;
+    FSTracer * tracer = self.tracer;
+    NSTimeInterval start = FSMetricsNow();
+    FSTraceSpan headersSpan = [tracer beginSpan:"chat.getChatHeaders" parent:FSTraceSpanNone];
+    void (^completion)(NSArray *, NSError *) = ^(NSArray * headers, NSError * error) {
+        [metrics recordOperation:kFSOperationGetChatHeaders latency:FSMetricsNow() - start error:error];
+        [tracer endSpan:headersSpan];
+        if (completionBlock) [self deliver:^{
+            completionBlock(headers, error);
+        }];
+    };
     
+    Firebase * userChatsRef = [self.refCache refWithRoot:[self rootForUserId:userId] collection:@"Users" id:userId leaf:@"chats"];
+    
+    [metrics recordRoundTrips:1];
+    FSTraceSpan userChatsSpan = [tracer beginSpan:"chat.getChatHeaders.userChats" parent:headersSpan];
     [userChatsRef observeSingleEventOfType:FEventTypeValue withBlock:^(FDataSnapshot *snapshot) {
+        [tracer endSpan:userChatsSpan];
         if (snapshot.value != [NSNull new]) {
             
             // An Array Of Chat Ids
-            [self getHeadersForArray:snapshot.value withCompletionBlock:completion];
+            [self getHeadersForChatIds:snapshot.value parentSpan:headersSpan withCompletionBlock:^(NSDictionary *headersByChatId, NSError *error) {
+                completion([headersByChatId allValues], error);
+            }];
             
         }
         else {
@@ -263,50 +645,266 @@ withCompletionBlock:(void (^)(NSString * chatId, NSError * error))completion {
             completion(nil, nil);
         }
     } withCancelBlock:^(NSError *error) {
+        [tracer endSpan:userChatsSpan];
         completion(nil, error);
     }];
 }
 
-- (void) getHeadersForArray:(NSArray *)headers
-        withCompletionBlock:(void (^)(NSArray * headers, NSError * error))completion {
+// Completion Runs On stateQueue -- Chats Without A Header Are Left Out
+- (void) getHeadersForChatIds:(NSArray *)headers
+                   parentSpan:(FSTraceSpan)parentSpan
+          withCompletionBlock:(void (^)(NSDictionary * headersByChatId, NSError * error))completion {
+    
+    // One Dictionary Per Query -- Concurrent Queries Don't Share
+    NSMutableDictionary * receivedHeaders = [NSMutableDictionary new];
     
-    if (!_receivedHeadersArray) _receivedHeadersArray = [NSMutableArray new];
+    // Nothing To Wait For
+    if (headers.count == 0) {
+        completion(receivedHeaders, nil);
+        return;
+    }
     
     __block int blockCount = 0;
+    __block NSError * firstError;
+    
+    // One Read Per Header
+    [self.metrics recordRoundTrips:headers.count];
+    FSTracer * tracer = self.tracer;
+    FSTraceSpan fanOutSpan = [tracer beginSpan:"chat.getChatHeaders.fanOut" parent:parentSpan];
+    FSDecodeStream * stream = [self.decodePool streamWithTargetQueue:stateQueue];
     
     for (NSString * chatIdString in headers) {
         
         // Construct header ref
-        NSString * headerString = [NSString stringWithFormat:@"%@Chats/%@/header/",_urlRefString, chatIdString];
-        Firebase * headerSnap = [[Firebase alloc]initWithUrl:headerString];
+        Firebase * headerSnap = [self.refCache refWithRoot:[self rootForChatId:chatIdString] collection:@"Chats" id:chatIdString leaf:kChatHeader];
         
         [headerSnap observeSingleEventOfType:FEventTypeValue withBlock:^(FDataSnapshot *snapshot) {
-            
-            blockCount++;
-            
-            if (snapshot.value != [NSNull new]) {
-                [_receivedHeadersArray addObject:snapshot.value];
+            [self decodeHeaderSnapshot:snapshot inStream:stream completion:^(id header) {
                 
-            }
-            else {
-                NSLog(@"Chat doesn't exist: %@", chatIdString);
-            }
+                blockCount++;
+                
+                if (header) {
+                    receivedHeaders[chatIdString] = header;
+                    
+                }
+                else {
+                    NSLog(@"Chat doesn't exist: %@", chatIdString);
+                }
+        
+                // Check if we've received everything we're expecting.
+                if (blockCount == headers.count) {
+                    [tracer endSpan:fanOutSpan];
+                    completion(firstError ? nil : receivedHeaders, firstError);
+                }
+                
+            }];
+        } withCancelBlock:^(NSError *error) {
+            dispatch_async(stateQueue, ^{
+                
+                // Cancelled Reads Still Count -- Otherwise We'd Wait Forever
+                blockCount++;
+                if (!firstError) firstError = error;
+                
+                if (blockCount == headers.count) {
+                    [tracer endSpan:fanOutSpan];
+                    completion(nil, firstError);
+                }
+                
+            });
+        }];
+    }
+}
+     
+#pragma mark CHANGE FEED
+
+// Feeds A Send Touches -- Groups Past fanOutThreshold Pull Headers Instead, Like Their Alerts.  @param header As Stored, Either Version.
+- (NSArray *) changeFeedUsersForHeader:(id)header {
+    NSArray * users = FSChatSchemaDecodeHeader(header)[kHeaderUsers];
+    if (![users isKindOfClass:[NSArray class]]) return nil;
+    if (users.count > 2 && users.count - 1 > self.fanOutThreshold) return nil;
+    return users;
+}
+
+// Users/<userId>/chatChanges/<chatId> For Each User, Stamped And Ordered By Server Time -- One Write Per Database.  Any Queue; completion Runs On stateQueue.
+- (void) recordChangeOfChatId:(NSString *)chatId forUserIds:(NSArray *)userIds completion:(void (^)(NSError * error))completion {
+    [self recordChangesOfChatIds:@{chatId: userIds ?: @[]} completion:completion];
+}
+
+// As Above For Several Chats -- @param userIdsByChatId Maps Each To The Feeds It Touches
+- (void) recordChangesOfChatIds:(NSDictionary *)userIdsByChatId completion:(void (^)(NSError * error))completion {
     
-            // Check if we've received everything we're expecting.
-            if (blockCount == headers.count) {
-                completion(_receivedHeadersArray, nil);
-                _receivedHeadersArray = nil;
+    NSMutableDictionary * valuesByRoot = [NSMutableDictionary new];
+    for (NSString * chatId in userIdsByChatId) {
+        for (NSString * userId in userIdsByChatId[chatId]) {
+            NSString * root = [self rootForUserId:userId];
+            NSMutableDictionary * values = valuesByRoot[root];
+            if (!values) {
+                values = [NSMutableDictionary new];
+                valuesByRoot[root] = values;
             }
             
+            // The Server's Clock -- A Client's Could Stamp A Change Behind Someone's Watermark
+            values[[NSString stringWithFormat:@"%@/%@/%@", userId, kUserChatChanges, chatId]] = @{@".value": kFirebaseServerValueTimestamp, @".priority": kFirebaseServerValueTimestamp};
+        }
+    }
+    
+    if (valuesByRoot.count == 0) {
+        if (completion) dispatch_async(stateQueue, ^{
+            completion(nil);
+        });
+        return;
+    }
+    
+    FSMetrics * metrics = self.metrics;
+    __block NSUInteger remaining = valuesByRoot.count;
+    __block NSError * firstError;
+    for (NSString * root in valuesByRoot) {
+        Firebase * usersRef = [self.refCache refWithRoot:root collection:@"Users" id:nil leaf:nil];
+        NSTimeInterval start = FSMetricsNow();
+        [metrics recordBytes:FSMetricsEstimatedBytes(valuesByRoot[root]) forOperation:kFSOperationRecordChatChange];
+        [metrics recordRoundTrips:1];
+        
+        [self.retrier updateChildValues:valuesByRoot[root] onRef:usersRef operation:kFSOperationRecordChatChange completion:^(NSError *error, Firebase *ref) {
+            [metrics recordOperation:kFSOperationRecordChatChange latency:FSMetricsNow() - start error:error];
+            
+            dispatch_async(stateQueue, ^{
+                if (error && !firstError) firstError = error;
+                if (--remaining > 0) return;
+                if (completion) completion(firstError);
+            });
         }];
     }
 }
-     
+
+- (void) getChatHeaderChangesForUserId:(NSString *)userId
+                        sinceWatermark:(NSNumber *)watermark
+                   withCompletionBlock:(void (^)(NSDictionary * headers, NSNumber * watermark, NSError * error))completionBlock {
+    
+    // Measure Feed And Headers Together
+    FSMetrics * metrics = self.metrics;
+    FSTracer * tracer = self.tracer;
+    NSTimeInterval start = FSMetricsNow();
+    FSTraceSpan changesSpan = [tracer beginSpan:"chat.getChatHeaderChanges" parent:FSTraceSpanNone];
+    void (^completion)(NSDictionary *, NSNumber *, NSError *) = ^(NSDictionary * headers, NSNumber * newWatermark, NSError * error) {
+        [metrics recordOperation:kFSOperationGetChatHeaderChanges latency:FSMetricsNow() - start error:error];
+        [tracer endSpan:changesSpan];
+        if (completionBlock) [self deliver:^{
+            completionBlock(headers, newWatermark, error);
+        }];
+    };
+    
+    NSString * root = [self rootForUserId:userId];
+    Firebase * changesRef = [self.refCache refWithRoot:root collection:@"Users" id:userId leaf:kUserChatChanges];
+    
+    // No Watermark -- Every Chat, And The Newest Change So Far.  Read First, So Changes During The Sync Come Again Next Time.
+    FQuery * changesQuery = watermark ? [changesRef queryStartingAtPriority:watermark] : [changesRef queryLimitedToNumberOfChildren:1];
+    
+    [metrics recordRoundTrips:1];
+    FSTraceSpan feedSpan = [tracer beginSpan:"chat.getChatHeaderChanges.feed" parent:changesSpan];
+    [changesQuery observeSingleEventOfType:FEventTypeValue withBlock:^(FDataSnapshot *snapshot) {
+        [tracer endSpan:feedSpan];
+        
+        // Highest Server Time Seen -- Starting There Again Repeats Its Changes Rather Than Missing Any In The Same Millisecond
+        NSNumber * newWatermark = watermark ?: @0;
+        NSMutableArray * changedChatIds = [NSMutableArray new];
+        for (FDataSnapshot * child in snapshot.children) {
+            [changedChatIds addObject:child.name];
+            if ([child.priority isKindOfClass:[NSNumber class]] && [child.priority compare:newWatermark] == NSOrderedDescending) {
+                newWatermark = child.priority;
+            }
+        }
+        
+        void (^finish)(NSDictionary *, NSError *) = ^(NSDictionary * headers, NSError * error) {
+            completion(headers, error ? nil : newWatermark, error);
+        };
+        
+        dispatch_async(stateQueue, ^{
+            if (watermark) {
+                [self getHeadersForChatIds:changedChatIds parentSpan:changesSpan withCompletionBlock:finish];
+                return;
+            }
+            
+            // Full Sync -- Chats From Before The Feed Have No Entry In It
+            Firebase * userChatsRef = [self.refCache refWithRoot:root collection:@"Users" id:userId leaf:@"chats"];
+            [metrics recordRoundTrips:1];
+            FSTraceSpan userChatsSpan = [tracer beginSpan:"chat.getChatHeaderChanges.userChats" parent:changesSpan];
+            [userChatsRef observeSingleEventOfType:FEventTypeValue withBlock:^(FDataSnapshot *chatsSnapshot) {
+                [tracer endSpan:userChatsSpan];
+                NSArray * chatIds = [chatsSnapshot.value isKindOfClass:[NSArray class]] ? chatsSnapshot.value : @[];
+                dispatch_async(stateQueue, ^{
+                    [self getHeadersForChatIds:chatIds parentSpan:changesSpan withCompletionBlock:finish];
+                });
+            } withCancelBlock:^(NSError *error) {
+                [tracer endSpan:userChatsSpan];
+                finish(nil, error);
+            }];
+        });
+    } withCancelBlock:^(NSError *error) {
+        [tracer endSpan:feedSpan];
+        completion(nil, nil, error);
+    }];
+}
+
+#pragma mark LINK ESTIMATES
+
+// Moved Toward @param sample -- The First Stands Alone
+static double FSLinkSmoothed(double estimate, double sample) {
+    return estimate > 0 ? estimate + kLinkEstimateWeight * (sample - estimate) : sample;
+}
+
+/*
+ Messages that fit in @param target after the header's and the query's round trips, between @param minimum and @param requested.  A link too slow for even the round trips gets minimum; one whose throughput isn't known yet gets requested.
+ */
+static NSUInteger FSAdaptiveWindow(NSUInteger requested, NSUInteger minimum, NSTimeInterval target, NSTimeInterval roundTrip, double bytesPerSecond, double bytesPerMessage) {
+    if (target <= 0) return requested;
+    
+    NSTimeInterval budget = target - 2 * roundTrip;
+    if (budget <= 0) return MIN(requested, minimum);
+    if (bytesPerSecond <= 0 || bytesPerMessage <= 0) return requested;
+    
+    double fits = floor(budget * bytesPerSecond / bytesPerMessage);
+    return MIN(requested, MAX(minimum, (NSUInteger)fits));
+}
+
+// Must Be Called On stateQueue
+- (void) recordRoundTripSample:(NSTimeInterval)seconds {
+    linkRoundTrip = FSLinkSmoothed(linkRoundTrip, seconds);
+}
+
+// Must Be Called On stateQueue -- @param seconds From Asking To The Last Message, So One Round Trip Comes Off
+- (void) recordTransferOfMessages:(NSUInteger)count bytes:(NSUInteger)bytes seconds:(NSTimeInterval)seconds {
+    if (count == 0 || bytes == 0) return;
+    NSTimeInterval transfer = MAX(seconds - linkRoundTrip, kLinkMinimumTransfer);
+    linkBytesPerSecond = FSLinkSmoothed(linkBytesPerSecond, bytes / transfer);
+    linkBytesPerMessage = FSLinkSmoothed(linkBytesPerMessage, (double)bytes / count);
+}
+
+// Must Be Called On stateQueue
+- (NSUInteger) adaptiveWindowForCount:(NSUInteger)count {
+    return FSAdaptiveWindow(count, MAX(self.minimumInitialMessageCount, 1), self.initialLoadTargetLatency, linkRoundTrip, linkBytesPerSecond, linkBytesPerMessage);
+}
+
 #pragma mark START CHAT SESSION
 
 - (void) loadChatSessionWithChatId:(NSString *)chatId andNumberOfRecentMessages:(int)numberOfMessages {
+    FSStateQueueAsync(stateQueue, ^{
+        [self loadChatSessionOnStateQueueWithChatId:chatId andNumberOfRecentMessages:numberOfMessages resume:NO completion:nil];
+    });
+}
+
+- (void) resumeChatSessionWithChatId:(NSString *)chatId andNumberOfRecentMessages:(int)numberOfMessages {
+    FSStateQueueAsync(stateQueue, ^{
+        [self loadChatSessionOnStateQueueWithChatId:chatId andNumberOfRecentMessages:numberOfMessages resume:YES completion:nil];
+    });
+}
+
+// NO If Another Session Is Already Open
+- (BOOL) loadChatSessionOnStateQueueWithChatId:(NSString *)chatId
+                     andNumberOfRecentMessages:(int)numberOfMessages
+                                        resume:(BOOL)resume
+                                    completion:(void (^)(NSDictionary * response, NSError * error))completion {
     
-    if (_messagesRef) {
+    if (_messagesRef || isLoadingSession) {
         
         // -- Opt 1 - Return Error: Already In Use
         
@@ -320,7 +918,12 @@ withCompletionBlock:(void (^)(NSString * chatId, NSError * error))completion {
                                               code:FSChatErrorAlreadyInUse
                                           userInfo:userInfo];
         
-        [_delegate chatSessionLoadDidFailWithError:error];
+        [self.metrics recordOperation:kFSOperationLoadChatSession latency:0 error:error];
+        id<FSChatManagerDelegate> delegate = self.delegate;
+        [self deliver:^{
+            [delegate chatSessionLoadDidFailWithError:error];
+            if (completion) completion(nil, error);
+        }];
         
         
         // Opt 2 - End automatically
@@ -331,93 +934,161 @@ withCompletionBlock:(void (^)(NSString * chatId, NSError * error))completion {
         }];
         */
         
-        return;
+        return NO;
     }
     
+    // Ranks Chats For Prefetching
+    if (!openCounts) openCounts = [NSMutableDictionary new];
+    openCounts[chatId] = @([openCounts[chatId] unsignedIntegerValue] + 1);
+    
     // Set Our Values
+    session++;
+    isLoadingSession = YES;
+    loadCompletion = completion;
     _chatId = chatId;
     maxMessageCount = numberOfMessages;
+    isResumingSession = resume;
+    loadStartTime = FSMetricsNow();
+    loadSpan = [self.tracer beginSpan:"chat.loadChatSession" parent:FSTraceSpanNone];
+    
+    // Prefetched -- Answer Now, Catch Up Behind It
+    NSDictionary * prefetched = prefetchedChats[chatId];
+    [prefetchedChats removeObjectForKey:chatId];
+    if (prefetched && !(resume && [self cursorsOnStateQueue][chatId])) {
+        BOOL isComplete = [prefetched[kPrefetchComplete] boolValue];
+        if (isComplete || [prefetched[kPrefetchMessages] count] >= (NSUInteger)MAX(numberOfMessages, 0)) {
+            [self openPrefetchedChat:prefetched];
+            return YES;
+        }
+    }
     
     // ** Get Header ...
     [self getHeader];
     
+    return YES;
 }
 
-// Step 1 - Get Header
-- (void) getHeader {
+// Current User's Last Seen Timestamp -- May Run More Than Once, So It Only Touches currentData
+- (void) stampHeaderWithOperation:(NSString *)operation completion:(void (^)(NSError * error, BOOL committed, FDataSnapshot * snapshot))completion {
     
     NSString * timestamp = TimeStamp;
+    NSString * currentUserId = self.currentUserId;
+    FSChatSchemaVersion schemaVersion = self.schemaVersion;
     
     // Create Header Ref If Necessary
     if (!_chatHeaderRef) {
-        NSString * headerRefString = [NSString stringWithFormat:@"%@Chats/%@/header/", _urlRefString, _chatId];
-        _chatHeaderRef = [[Firebase alloc]initWithUrl:headerRefString];
+        _chatHeaderRef = [self.refCache refWithRoot:[self rootForChatId:_chatId] collection:@"Chats" id:_chatId leaf:kChatHeader];
     }
     
-    // Update Header To Latest Timestamp for CurrentUser
-    [_chatHeaderRef runTransactionBlock:^FTransactionResult *(FMutableData *currentData) {
+    [self.retrier runTransactionOnRef:_chatHeaderRef operation:operation block:^FTransactionResult *(FMutableData *currentData) {
         
         // Does Header Exist?
         if (currentData.value != [NSNull new]) {
             
             // Get Header From Value
-            NSMutableDictionary * header = currentData.value;
-            
-            // Update Current User Timestamp -  Set Last Time Our Current User Performed An Action
-            if (_currentUserId) {
-                // Add Last Seen Timestamp If Newer
-                if ([timestamp doubleValue] > [header[_currentUserId] doubleValue]) {
-                    // Set Last Time
-                    header[_currentUserId] = timestamp;
-                }
-            }
+            NSMutableDictionary * header = FSChatSchemaDecodeHeader(currentData.value);
             
-            // Get Our Users ...
-            if (header[kHeaderUsers]) _users = header[kHeaderUsers];
+            // Add Last Seen Timestamp If Newer
+            if (currentUserId && [timestamp doubleValue] > [header[currentUserId] doubleValue]) {
+                header[currentUserId] = timestamp;
+            }
             
             // Set Value To Our Updated Header
-            [currentData setValue:header];
+            [currentData setValue:FSChatSchemaEncodeHeader(header, schemaVersion)];
         }
         
         // Return It
         return [FTransactionResult successWithValue:currentData];
-    } andCompletionBlock:^(NSError *error, BOOL committed, FDataSnapshot *snapshot) {
-        
-        // Continue
-        if (snapshot.value != [NSNull new]) {
+    } completion:completion];
+}
+
+// Step 1 - Get Header
+- (void) getHeader {
+    
+    NSUInteger loadSession = session;
+    
+    // Update Header To Latest Timestamp for CurrentUser
+    FSTraceSpan headerSpan = [self.tracer beginSpan:"chat.loadChatSession.getHeader" parent:loadSpan];
+    NSTimeInterval headerStart = FSMetricsNow();
+    [self stampHeaderWithOperation:kFSOperationUpdateHeader completion:^(NSError *error, BOOL committed, FDataSnapshot *snapshot) {
+        NSTimeInterval headerDuration = FSMetricsNow() - headerStart;
+        NSDictionary * header = FSChatSchemaDecodeHeader(snapshot.value);
+        dispatch_async(stateQueue, ^{
+            
+            [self.tracer endSpan:headerSpan];
+            if (!error) [self recordRoundTripSample:headerDuration];
             
-            _responseHeader = snapshot.value;
+            // Session Ended While We Waited
+            if (loadSession != session) return;
             
-            if (_responseHeader[kHeaderMessageCount] && [_responseHeader[kHeaderMessageCount] intValue] > 0)
-            {
-                // Received Count, Get Messages
-                [self getMessagesForCount:[_responseHeader[kHeaderMessageCount] intValue]];
+            // Continue
+            if (header) {
+                
+                _responseHeader = FSHeaderForCallers(header);
+                
+                // Get Our Users ...
+                if (_responseHeader[kHeaderUsers]) _users = _responseHeader[kHeaderUsers];
+                
+                // Resume -- Everything Since The Cursor Arrives Through newMessageReceived:
+                if (isResumingSession && [self cursorsOnStateQueue][_chatId]) {
+                    NSMutableDictionary * response = [NSMutableDictionary new];
+                    response[kResponseHeader] = _responseHeader;
+                    response[kResponseMessages] = [NSNull new];
+                    response[kResponseResumed] = @YES;
+                    [self finishLoadWithResponse:response];
+                    
+                    [self monitorIncomingMessages];
+                    return;
+                }
+                
+                // Archived Messages Are Gone From kChatMessages -- Only Wait On The Live Ones
+                int liveCount = [_responseHeader[kHeaderMessageCount] intValue] - [_responseHeader[kHeaderArchivedCount] intValue];
+                if (liveCount > 0)
+                {
+                    // Received Count, Get Messages
+                    [self getMessagesForCount:liveCount];
+                }
+                else {
+                    
+                    // No Messages Exist -- Send Response
+                    NSMutableDictionary * response = [NSMutableDictionary new];
+                    response[kResponseHeader] = _responseHeader;
+                    response[kResponseMessages] = [NSNull new];
+                    [self finishLoadWithResponse:response];
+                    
+                    // Start Monitor -- From The Header, Not A Cursor Left By Messages Since Removed
+                    [[self cursorsOnStateQueue] removeObjectForKey:_chatId];
+                    monitorStartPriority = _responseHeader[kHeaderTimeStamp];
+                    [self monitorIncomingMessages];
+                }
             }
             else {
+                // Return Error
+                NSDictionary *userInfo = @{
+                                           NSLocalizedDescriptionKey: NSLocalizedString(kErrorFailedToGetHeader, nil),
+                                           NSLocalizedFailureReasonErrorKey: NSLocalizedString(@"Doesn't Exist", nil),
+                                           NSLocalizedRecoverySuggestionErrorKey: NSLocalizedString(@"Chat was likely created incorrectly.", nil)
+                                           };
+                NSError * error = [NSError errorWithDomain:kFSChatManagerErrorDomain
+                                                      code:FSChatErrorFailedToGetHeader
+                                                  userInfo:userInfo];
+                [self.metrics recordOperation:kFSOperationLoadChatSession latency:FSMetricsNow() - loadStartTime error:error];
+                isLoadingSession = NO;
                 
-                // No Messages Exist -- Send Response
-                NSMutableDictionary * response = [NSMutableDictionary new];
-                response[kResponseHeader] = _responseHeader;
-                response[kResponseMessages] = [NSNull new];
-                [_delegate chatSessionLoadDidFinishWithResponse:response];
-                
-                // Start Monitor
-                [self monitorIncomingMessagesWithPriority:_responseHeader[kHeaderTimeStamp]];
+                FSTracer * tracer = self.tracer;
+                FSTraceSpan failedSpan = loadSpan;
+                id<FSChatManagerDelegate> delegate = self.delegate;
+                void (^completion)(NSDictionary *, NSError *) = loadCompletion;
+                loadCompletion = nil;
+                [self deliver:^{
+                    [delegate chatSessionLoadDidFailWithError:error];
+                    if (completion) completion(nil, error);
+                    [tracer endSpan:failedSpan];
+                }];
             }
-        }
-        else {
-            // Return Error
-            NSDictionary *userInfo = @{
-                                       NSLocalizedDescriptionKey: NSLocalizedString(kErrorFailedToGetHeader, nil),
-                                       NSLocalizedFailureReasonErrorKey: NSLocalizedString(@"Doesn't Exist", nil),
-                                       NSLocalizedRecoverySuggestionErrorKey: NSLocalizedString(@"Chat was likely created incorrectly.", nil)
-                                       };
-            NSError * error = [NSError errorWithDomain:kFSChatManagerErrorDomain
-                                                  code:FSChatErrorFailedToGetHeader
-                                              userInfo:userInfo];
-            [_delegate chatSessionLoadDidFailWithError:error];
-        }
-    } withLocalEvents:NO];
+            
+        });
+    }];
 }
 
 // Step 2 - Get Messages
@@ -426,10 +1097,13 @@ withCompletionBlock:(void (^)(NSString * chatId, NSError * error))completion {
     // Set Total Messages To Max If Greater Than
     if (count > maxMessageCount) count = maxMessageCount;
     
+    // Adaptive -- As Many As Land In Time, The Rest Paged In Behind
+    int requested = count;
+    count = (int)[self adaptiveWindowForCount:(NSUInteger)MAX(count, 0)];
+    
     // Create Messages Ref If Necessary
     if (!_messagesRef) {
-        NSString * messagesURL = [NSString stringWithFormat:@"%@Chats/%@/messages/", _urlRefString, _chatId];
-        _messagesRef = [[Firebase alloc] initWithUrl:messagesURL];
+        _messagesRef = [self.refCache refWithRoot:[self rootForChatId:_chatId] collection:@"Chats" id:_chatId leaf:kChatMessages];
     }
     
     // Set Query
@@ -439,142 +1113,579 @@ withCompletionBlock:(void (^)(NSString * chatId, NSError * error))completion {
     if (!_receivedMessagesArray) _receivedMessagesArray = [NSMutableArray new];
     
     __block int queryCount = 0;
+    __block NSUInteger queryBytes = 0;
+    NSTimeInterval queryStart = FSMetricsNow();
+    NSUInteger loadSession = session;
+    NSString * chatId = _chatId;
     
     // Run Query
+    FSTraceSpan querySpan = [self.tracer beginSpan:"chat.loadChatSession.getMessages" parent:loadSpan];
+    FSDecodeStream * stream = [self.decodePool streamWithTargetQueue:stateQueue];
+    isQueryingMessages = YES;
+    [self.metrics adjustListenerCount:1];
+    [self.metrics recordRoundTrips:1];
     queryHandle = [firebaseQ observeEventType:FEventTypeChildAdded withBlock:^(FDataSnapshot *snapshot) {
-        
-        // Query Count - Fire regardless, messages shouldn't be nil
-        queryCount++;
-        
-        // Received Value -- > Add To Array
-        if (snapshot.value != [NSNull new]) [_receivedMessagesArray addObject:snapshot.value];
-        
-        // Finished Query -- > All Expected Objects Retrieved
-        if (queryCount == count) {
+        [self decodeMessageSnapshot:snapshot ofChatId:chatId inStream:stream completion:^(id message) {
             
-            // Remove Query
-            [_messagesRef removeObserverWithHandle:queryHandle];
+            // Query Removed Or Session Ended While Queued
+            if (loadSession != session || !isQueryingMessages) return;
             
-            // Run Completion -- Send Response
-            NSMutableDictionary * response = [NSMutableDictionary new];
-            response[kResponseHeader] = _responseHeader;
-            response[kResponseMessages] = _receivedMessagesArray;
-            [_delegate chatSessionLoadDidFinishWithResponse:response];
+            // Query Count - Fire regardless, messages shouldn't be nil
+            queryCount++;
+            queryBytes += FSMetricsEstimatedBytes(snapshot.value);
             
-            // Monitor Any Messages Since Last Retrieved Message
-            [self monitorIncomingMessagesWithPriority:[NSString stringWithFormat:@"%f", [snapshot.priority doubleValue] + 1]];
+            // Received Value -- > Add To Array
+            if (message) [_receivedMessagesArray addObject:message];
             
-            // Clear Array, No Longer Needed
-            _receivedMessagesArray = nil;
-        }
-    }];
-}
-
-// Step 3 - Monitor Incoming Messages
-- (void) monitorIncomingMessagesWithPriority:(NSString *)priority {
-    
-    // Create Messages Ref If Necessary -- SHOULD ALREADY EXIST!
-    if (!_messagesRef) {
-        NSString * messagesURL = [NSString stringWithFormat:@"%@Chats/%@/messages/", _urlRefString, _chatId];
-        _messagesRef = [[Firebase alloc] initWithUrl:messagesURL];
-    }
-    
-    // Set Query For Messages After Last Message Of Query Or Newer
-    FQuery * nowOrNewerQuery = [_messagesRef queryStartingAtPriority:priority];
-    
-    // Set Handle To Remove Later
-    messageMonitorHandle = [nowOrNewerQuery observeEventType:FEventTypeChildAdded withBlock:^(FDataSnapshot *snapshot) {
+            // Finished Query -- > All Expected Objects Retrieved
+            if (queryCount == count) {
+                
+                // Remove Query
+                [_messagesRef removeObserverWithHandle:queryHandle];
+                isQueryingMessages = NO;
+                [self.metrics adjustListenerCount:-1];
+                [self.tracer endSpan:querySpan];
+                [self recordTransferOfMessages:(NSUInteger)count bytes:queryBytes seconds:FSMetricsNow() - queryStart];
+                
+                // Run Completion -- Send Response
+                NSMutableDictionary * response = [NSMutableDictionary new];
+                response[kResponseHeader] = _responseHeader;
+                response[kResponseMessages] = _receivedMessagesArray;
+                if (requested > count) response[kResponseEarlierCount] = @(requested - count);
+                [self finishLoadWithResponse:response];
+                
+                // Monitor Any Messages Since Last Retrieved Message
+                [self advanceCursorOfChatId:chatId toSnapshot:snapshot];
+                [self monitorIncomingMessages];
+                
+                // Then Page In The Rest, Newest First
+                if (requested > count) {
+                    [self loadEarlierMessages:(NSUInteger)(requested - count) beforeTimestamp:[_receivedMessagesArray firstObject][kMessageTimestamp]];
+                }
+                
+                // Clear Array, No Longer Needed
+                _receivedMessagesArray = nil;
+            }
+            
+        }];
+    }];
+}
+
+// Hand The Initial Load To The Delegate -- Load Span Ends Once It Returns
+- (void) finishLoadWithResponse:(NSDictionary *)response {
+    [self.metrics recordOperation:kFSOperationLoadChatSession latency:FSMetricsNow() - loadStartTime error:nil];
+    isLoadingSession = NO;
+    
+    FSTracer * tracer = self.tracer;
+    FSTraceSpan finishedSpan = loadSpan;
+    id<FSChatManagerDelegate> delegate = self.delegate;
+    void (^completion)(NSDictionary *, NSError *) = loadCompletion;
+    loadCompletion = nil;
+    [self deliver:^{
+        FSTraceSpan delegateSpan = [tracer beginSpan:"chat.loadChatSession.delegate" parent:finishedSpan];
+        [delegate chatSessionLoadDidFinishWithResponse:response];
+        [tracer endSpan:delegateSpan];
+        if (completion) completion(response, nil);
+        [tracer endSpan:finishedSpan];
+    }];
+}
+
+// Step 2b - Adaptive Loads Only -- Each Page Sized Like A First Window, Until remaining Are Delivered, The Chat Runs Out Or The Session Ends
+- (void) loadEarlierMessages:(NSUInteger)remaining beforeTimestamp:(NSString *)timestamp {
+    
+    NSUInteger pageSession = session;
+    NSUInteger count = [self adaptiveWindowForCount:remaining];
+    NSTimeInterval start = FSMetricsNow();
+    
+    [self getMessagesForChatId:_chatId beforeTimestamp:timestamp count:count withCompletionBlock:^(NSArray *messages, NSError *error) {
+        NSTimeInterval duration = FSMetricsNow() - start;
+        FSStateQueueAsync(stateQueue, ^{
+            if (pageSession != session) return;
+            if (error) {
+                NSLog(@"ChatManager: Failed To Load Earlier Messages: %@", error);
+                return;
+            }
+            if (messages.count == 0) return;
+            
+            [self recordTransferOfMessages:messages.count bytes:FSMetricsEstimatedBytes(messages) seconds:duration];
+            
+            id<FSChatManagerDelegate> delegate = self.delegate;
+            [self deliver:^{
+                if ([(NSObject *)delegate respondsToSelector:@selector(chatSessionDidLoadEarlierMessages:)]) {
+                    [delegate chatSessionDidLoadEarlierMessages:messages];
+                }
+            }];
+            
+            if (messages.count < count || messages.count >= remaining) return;
+            [self loadEarlierMessages:remaining - messages.count beforeTimestamp:[messages firstObject][kMessageTimestamp]];
+        });
+    }];
+}
+
+// Step 3 - Monitor Incoming Messages -- From The Cursor, Skipping The Message It Names
+- (void) monitorIncomingMessages {
+    
+    // Create Messages Ref If Necessary
+    if (!_messagesRef) {
+        _messagesRef = [self.refCache refWithRoot:[self rootForChatId:_chatId] collection:@"Chats" id:_chatId leaf:kChatMessages];
+    }
+    
+    // Set Query For The Last Delivered Message Or Newer
+    NSDictionary * cursor = [self cursorsOnStateQueue][_chatId];
+    id priority = cursor ? cursor[kCursorPriority] : monitorStartPriority;
+    if (priority == [NSNull null]) priority = nil;
+    NSString * anchorName = cursor[kCursorName];
+    FQuery * nowOrNewerQuery = [_messagesRef queryStartingAtPriority:priority andChildName:anchorName];
+    NSUInteger monitorSession = session;
+    NSUInteger generation = ++monitorGeneration;
+    NSString * chatId = _chatId;
+    
+    // Set Handle To Remove Later
+    FSDecodeStream * stream = [self.decodePool streamWithTargetQueue:stateQueue];
+    isMonitoringMessages = YES;
+    [self.metrics adjustListenerCount:1];
+    [self.metrics recordRoundTrips:1];
+    messageMonitorHandle = [nowOrNewerQuery observeEventType:FEventTypeChildAdded withBlock:^(FDataSnapshot *snapshot) {
+        [self decodeMessageSnapshot:snapshot ofChatId:chatId inStream:stream completion:^(id message) {
+            
+            // Session Ended Or Monitor Replaced While Queued
+            if (monitorSession != session || generation != monitorGeneration) return;
+            
+            // Already Delivered
+            if ([snapshot.name isEqualToString:anchorName]) return;
+            
+            // If there's data, send it to delegate!
+            if (message) {
+                
+                [self advanceCursorOfChatId:chatId toSnapshot:snapshot];
+                
+                // Our Own Send, Already Shown
+                if (localEchoes[snapshot.name]) {
+                    [localEchoes removeObjectForKey:snapshot.name];
+                    return;
+                }
+                
+                // Notify Delegate
+                id<FSChatManagerDelegate> delegate = self.delegate;
+                [self deliver:^{
+                    [delegate newMessageReceived:message];
+                }];
+            }
+            
+        }];
+    }];
+    
+    [self observeConnection];
+}
+
+// Once Per Session -- The Stored Value Fires On Observe, Then On Every Change
+- (void) observeConnection {
+    if (connectedToken) return;
+    
+    NSUInteger connectionSession = session;
+    connectedToken = [self.eventHub observeEventType:FEventTypeValue atRoot:[self rootForChatId:_chatId] collection:@".info" id:@"connected" leaf:nil withBlock:^(FDataSnapshot *snapshot) {
+        BOOL isConnected = [snapshot.value boolValue];
+        dispatch_async(stateQueue, ^{
+            if (connectionSession != session) return;
+            [self connectionDidChange:isConnected];
+        });
+    }];
+}
+
+// Offline, The SDK Would Re-Sync The Monitor From Where It First Started -- Drop It And Start Again From The Cursor
+- (void) connectionDidChange:(BOOL)isConnected {
+    if (!isConnected) {
+        if (!isMonitoringMessages) return;
         
-        // If there's data, send it to delegate!
-        if (snapshot.value != [NSNull new]) {
-            // Notify Delegate
-            [_delegate newMessageReceived:snapshot.value];
+        [_messagesRef removeObserverWithHandle:messageMonitorHandle];
+        monitorGeneration++;
+        isMonitoringMessages = NO;
+        isMonitorPaused = YES;
+        [self.metrics adjustListenerCount:-1];
+        [self saveCursors];
+    }
+    else if (isMonitorPaused) {
+        isMonitorPaused = NO;
+        [self monitorIncomingMessages];
+    }
+}
+
+// Version 1 Keys, nil For An Empty Snapshot -- completion Runs On stateQueue In Arrival Order, Decoded On The Pool If There Is One
+- (void) decodeHeaderSnapshot:(FDataSnapshot *)snapshot inStream:(FSDecodeStream *)stream completion:(void (^)(id header))completion {
+    [self decode:^id{
+        return FSHeaderForCallers(FSChatSchemaDecodeHeader(snapshot.value));
+    } inStream:stream completion:completion];
+}
+
+- (void) decodeMessageSnapshot:(FDataSnapshot *)snapshot ofChatId:(NSString *)chatId inStream:(FSDecodeStream *)stream completion:(void (^)(id message))completion {
+    [self decode:^id{
+        return FSChatSchemaDecodeMessage(snapshot.value, chatId);
+    } inStream:stream completion:completion];
+}
+
+// Any Other Work Off The State Queue -- Same Order And Queue As Above
+- (void) decode:(id (^)(void))decode inStream:(FSDecodeStream *)stream completion:(void (^)(id value))completion {
+    if (stream) {
+        [stream decode:decode completion:completion];
+    }
+    else {
+        dispatch_async(stateQueue, ^{
+            completion(decode());
+        });
+    }
+}
+
+#pragma mark CURSORS
+
+// Read Once Per cursorPath -- A Missing Or Unreadable File Starts Empty
+- (NSMutableDictionary *) cursorsOnStateQueue {
+    NSString * path = self.cursorPath;
+    if (!cursors || (path && ![path isEqualToString:cursorsPath])) {
+        cursors = [NSMutableDictionary new];
+        cursorsPath = path;
+        
+        NSData * data = path ? [NSData dataWithContentsOfFile:path] : nil;
+        id saved = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:nil] : nil;
+        if ([saved isKindOfClass:[NSDictionary class]]) [cursors addEntriesFromDictionary:saved];
+    }
+    return cursors;
+}
+
+- (void) advanceCursorOfChatId:(NSString *)chatId toSnapshot:(FDataSnapshot *)snapshot {
+    [self cursorsOnStateQueue][chatId] = @{kCursorPriority: snapshot.priority ?: [NSNull null], kCursorName: snapshot.name};
+    
+    if (isCursorSaveScheduled || !self.cursorPath) return;
+    isCursorSaveScheduled = YES;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kCursorSaveDelay * NSEC_PER_SEC)), stateQueue, ^{
+        [self saveCursors];
+    });
+}
+
+// Whole File, Replaced Atomically -- A Crash Loses At Most kCursorSaveDelay Of Progress, Redelivered On Resume
+- (void) saveCursors {
+    isCursorSaveScheduled = NO;
+    NSString * path = self.cursorPath;
+    if (!path || !cursors) return;
+    
+    NSData * data = [NSJSONSerialization dataWithJSONObject:cursors options:0 error:nil];
+    if (![data writeToFile:path atomically:YES]) NSLog(@"ChatManager: Failed To Save Cursors To %@", path);
+}
+
+#pragma mark PREFETCH
+
+// Prefetched Load -- The Header Is Stamped In The Background, Anything Newer Than The Last Prefetched Message Follows Through newMessageReceived:
+- (void) openPrefetchedChat:(NSDictionary *)prefetched {
+    
+    _responseHeader = prefetched[kPrefetchHeader];
+    if (_responseHeader[kHeaderUsers]) _users = _responseHeader[kHeaderUsers];
+    
+    [self stampHeaderWithOperation:kFSOperationUpdateHeader completion:nil];
+    
+    // Newest maxMessageCount
+    NSArray * messages = prefetched[kPrefetchMessages];
+    NSUInteger count = MIN(messages.count, (NSUInteger)MAX(maxMessageCount, 0));
+    messages = [messages subarrayWithRange:NSMakeRange(messages.count - count, count)];
+    
+    NSMutableDictionary * response = [NSMutableDictionary new];
+    response[kResponseHeader] = _responseHeader;
+    response[kResponseMessages] = count > 0 ? [messages mutableCopy] : [NSNull new];
+    [self finishLoadWithResponse:response];
+    
+    if (prefetched[kPrefetchCursor]) {
+        [self cursorsOnStateQueue][_chatId] = prefetched[kPrefetchCursor];
+    }
+    else {
+        [[self cursorsOnStateQueue] removeObjectForKey:_chatId];
+        monitorStartPriority = _responseHeader[kHeaderTimeStamp];
+    }
+    [self monitorIncomingMessages];
+}
+
+// Most Opened First, Then Most Recently Active
+static NSArray * FSPrefetchRankedChatIds(NSDictionary * headers, NSDictionary * openCounts) {
+    return [[headers allKeys] sortedArrayUsingComparator:^NSComparisonResult(NSString * a, NSString * b) {
+        NSComparisonResult byOpens = [openCounts[b] ?: @0 compare:openCounts[a] ?: @0];
+        if (byOpens != NSOrderedSame) return byOpens;
+        double activityA = [headers[a][kHeaderTimeStamp] doubleValue];
+        double activityB = [headers[b][kHeaderTimeStamp] doubleValue];
+        if (activityA != activityB) return activityA > activityB ? NSOrderedAscending : NSOrderedDescending;
+        return [a compare:b];
+    }];
+}
+
+// Messages Oldest First, As A Load Returns Them, With The Cursor Of The Newest
+static NSDictionary * FSPrefetchedChatInSnapshot(FDataSnapshot * snapshot, NSString * chatId, NSDictionary * header, NSUInteger liveCount) {
+    NSMutableArray * messages = [NSMutableArray new];
+    NSDictionary * cursor;
+    for (FDataSnapshot * child in snapshot.children) {
+        NSMutableDictionary * message = FSChatSchemaDecodeMessage(child.value, chatId);
+        if (!message) continue;
+        [messages addObject:message];
+        cursor = @{kCursorPriority: child.priority ?: [NSNull null], kCursorName: child.name};
+    }
+    
+    NSMutableDictionary * prefetched = [NSMutableDictionary new];
+    prefetched[kPrefetchHeader] = header;
+    prefetched[kPrefetchMessages] = messages;
+    prefetched[kPrefetchComplete] = @(messages.count >= liveCount);
+    prefetched[kPrefetchBytes] = @(FSMetricsEstimatedBytes(header) + FSMetricsEstimatedBytes(snapshot.value));
+    if (cursor) prefetched[kPrefetchCursor] = cursor;
+    return prefetched;
+}
+
+- (void) prefetchChatsWithHeaders:(NSDictionary *)headers withCompletionBlock:(void (^)(NSUInteger prefetchedCount, NSError * error))completionBlock {
+    FSStateQueueAsync(stateQueue, ^{
+        
+        FSMetrics * metrics = self.metrics;
+        FSTracer * tracer = self.tracer;
+        NSTimeInterval start = FSMetricsNow();
+        FSTraceSpan prefetchSpan = [tracer beginSpan:"chat.prefetch" parent:FSTraceSpanNone];
+        void (^completion)(NSUInteger, NSError *) = ^(NSUInteger prefetchedCount, NSError * error) {
+            [metrics recordOperation:kFSOperationPrefetch latency:FSMetricsNow() - start error:error];
+            [tracer endSpan:prefetchSpan];
+            if (completionBlock) [self deliver:^{
+                completionBlock(prefetchedCount, error);
+            }];
+        };
+        
+        // Only The Top Chats Stay Warm -- The Open One Is Already Live
+        NSArray * ranked = FSPrefetchRankedChatIds(headers, openCounts);
+        NSMutableArray * chatIds = [NSMutableArray new];
+        for (NSString * chatId in ranked) {
+            if (chatIds.count == self.prefetchChatCount) break;
+            if (![chatId isEqualToString:_chatId]) [chatIds addObject:chatId];
+        }
+        
+        NSMutableDictionary * kept = [NSMutableDictionary new];
+        for (NSString * chatId in chatIds) {
+            if (prefetchedChats[chatId]) kept[chatId] = prefetchedChats[chatId];
+        }
+        prefetchedChats = kept;
+        
+        FSDecodeStream * stream = [self.decodePool streamWithTargetQueue:stateQueue];
+        [self prefetchChatIds:chatIds atIndex:0 headers:headers bytes:0 fetched:0 stream:stream parentSpan:prefetchSpan completion:completion];
+    });
+}
+
+// One Chat At A Time, Best First, Until The Budget Runs Out -- Never On A Load's Critical Path
+- (void) prefetchChatIds:(NSArray *)chatIds
+                 atIndex:(NSUInteger)index
+                 headers:(NSDictionary *)headers
+                   bytes:(NSUInteger)bytes
+                 fetched:(NSUInteger)fetched
+                  stream:(FSDecodeStream *)stream
+              parentSpan:(FSTraceSpan)parentSpan
+              completion:(void (^)(NSUInteger prefetchedCount, NSError * error))completion {
+    
+    if (index >= chatIds.count) {
+        completion(fetched, nil);
+        return;
+    }
+    
+    NSString * chatId = chatIds[index];
+    NSDictionary * header = FSHeaderForCallers(FSChatSchemaDecodeHeader(headers[chatId]));
+    NSDictionary * cached = prefetchedChats[chatId];
+    
+    // Unchanged Since Last Time -- Costs Memory, Not Bandwidth
+    if (cached && [cached[kPrefetchHeader][kHeaderTimeStamp] isEqual:header[kHeaderTimeStamp]]) {
+        NSUInteger cachedBytes = [cached[kPrefetchBytes] unsignedIntegerValue];
+        if (bytes + cachedBytes > self.prefetchByteBudget) {
+            [self trimPrefetchedChatsFromIndex:index ofChatIds:chatIds];
+            completion(fetched, nil);
+            return;
         }
+        [self prefetchChatIds:chatIds atIndex:index + 1 headers:headers bytes:bytes + cachedBytes fetched:fetched + 1 stream:stream parentSpan:parentSpan completion:completion];
+        return;
+    }
+    [prefetchedChats removeObjectForKey:chatId];
+    if (!header) {
+        [self prefetchChatIds:chatIds atIndex:index + 1 headers:headers bytes:bytes fetched:fetched stream:stream parentSpan:parentSpan completion:completion];
+        return;
+    }
+    
+    NSUInteger liveCount = (NSUInteger)MAX([header[kHeaderMessageCount] intValue] - [header[kHeaderArchivedCount] intValue], 0);
+    NSUInteger messageCount = MIN(liveCount, self.prefetchMessageCount);
+    void (^store)(NSDictionary *) = ^(NSDictionary * prefetched) {
+        NSUInteger prefetchedBytes = [prefetched[kPrefetchBytes] unsignedIntegerValue];
         
+        // Over Budget -- Nothing Past This Chat Is Kept Either
+        if (bytes + prefetchedBytes > self.prefetchByteBudget) {
+            [self trimPrefetchedChatsFromIndex:index ofChatIds:chatIds];
+            completion(fetched, nil);
+            return;
+        }
+        prefetchedChats[chatId] = prefetched;
+        [self prefetchChatIds:chatIds atIndex:index + 1 headers:headers bytes:bytes + prefetchedBytes fetched:fetched + 1 stream:stream parentSpan:parentSpan completion:completion];
+    };
+    
+    // Empty Chat -- The Header Is Everything
+    if (messageCount == 0) {
+        store(FSPrefetchedChatInSnapshot(nil, chatId, header, liveCount));
+        return;
+    }
+    
+    Firebase * messagesRef = [self.refCache refWithRoot:[self rootForChatId:chatId] collection:@"Chats" id:chatId leaf:kChatMessages];
+    FSTracer * tracer = self.tracer;
+    FSTraceSpan readSpan = [tracer beginSpan:"chat.prefetch.messages" parent:parentSpan];
+    [self.metrics recordRoundTrips:1];
+    [[messagesRef queryLimitedToNumberOfChildren:messageCount] observeSingleEventOfType:FEventTypeValue withBlock:^(FDataSnapshot *snapshot) {
+        [tracer endSpan:readSpan];
+        [self decode:^id{
+            return FSPrefetchedChatInSnapshot(snapshot, chatId, header, liveCount);
+        } inStream:stream completion:store];
+    } withCancelBlock:^(NSError *error) {
+        [tracer endSpan:readSpan];
+        dispatch_async(stateQueue, ^{
+            completion(fetched, error);
+        });
     }];
 }
 
+- (void) trimPrefetchedChatsFromIndex:(NSUInteger)index ofChatIds:(NSArray *)chatIds {
+    for (NSUInteger i = index; i < chatIds.count; i++) {
+        [prefetchedChats removeObjectForKey:chatIds[i]];
+    }
+}
+
 #pragma mark END CHAT SESSION
 
 - (void) endChatSessionWithCompletionBlock:(void (^)(NSError * error))completion {
+    FSStateQueueAsync(stateQueue, ^{
+        [self endChatSessionOnStateQueueWithCompletionBlock:completion];
+    });
+}
+
+- (void) endChatSessionOnStateQueueWithCompletionBlock:(void (^)(NSError * error))completion {
     
     if (_chatId) {
-        // Get our timestamp
-        NSString * timestamp = TimeStamp;
-        
-        // Create Header Ref If Necessary
-        if (!_chatHeaderRef) {
-            NSString * headerRefString = [NSString stringWithFormat:@"%@Chats/%@/header/", _urlRefString, _chatId];
-            _chatHeaderRef = [[Firebase alloc]initWithUrl:headerRefString];
-        }
-        
         // Update Header To Latest Timestamp for CurrentUser
-        [_chatHeaderRef runTransactionBlock:^FTransactionResult *(FMutableData *currentData) {
-            
-            // Declare Header Variable
-            NSMutableDictionary * header;
-            
-            // Does Header Exist?
-            if (currentData.value != [NSNull new]) {
+        [self stampHeaderWithOperation:kFSOperationEndChatSession completion:^(NSError *error, BOOL committed, FDataSnapshot *snapshot) {
+            dispatch_async(stateQueue, ^{
                 
-                // Get Header From Value
-                header = currentData.value;
+                // Drop Anything Still Queued For This Session
+                session++;
+                isLoadingSession = NO;
                 
-                // Set Last Time Our Current User Performed An Action
-                if (_currentUserId) {
-                    
-                    // Add Last Seen Timestamp If Newer
-                    if ([timestamp doubleValue] > [header[_currentUserId] doubleValue]) {
-                        
-                        // Set Last Time
-                        header[_currentUserId] = timestamp;
-                        
-                    }
-                }
+                // Release Listener Gauges
+                if (isQueryingMessages) [self.metrics adjustListenerCount:-1];
+                if (isMonitoringMessages) [self.metrics adjustListenerCount:-1];
+                isQueryingMessages = NO;
+                isMonitoringMessages = NO;
+                isMonitorPaused = NO;
+                isResumingSession = NO;
+                monitorStartPriority = nil;
                 
-                [currentData setValue:header];
-            }
-            
-            // Return It
-            return [FTransactionResult successWithValue:currentData];
-        } andCompletionBlock:^(NSError *error, BOOL committed, FDataSnapshot *snapshot) {
-            
-            [_messagesRef removeObserverWithHandle:messageMonitorHandle];
-            [_messagesRef removeAllObservers];
-            _messagesRef = nil;
-            
-            [_chatHeaderRef removeAllObservers];
-            _chatHeaderRef = nil;
-            
-            [_countRef removeAllObservers];
-            _countRef = nil;
-            
-            _users = nil;
-            _chatId = nil;
-            
-            [_receivedMessagesArray removeAllObjects];
-            _receivedMessagesArray = nil;
-            
-            _responseHeader = nil;
-            
-            [_receivedHeadersArray removeAllObjects];
-            _receivedHeadersArray = nil;
-            
-            completion(error);
-            
-        } withLocalEvents:NO];
+                [self.eventHub removeObserverWithToken:connectedToken];
+                connectedToken = 0;
+                [self saveCursors];
+                
+                [_messagesRef removeObserverWithHandle:messageMonitorHandle];
+                [_messagesRef removeAllObservers];
+                _messagesRef = nil;
+                
+                [_chatHeaderRef removeAllObservers];
+                _chatHeaderRef = nil;
+                
+                [_countRef removeAllObservers];
+                _countRef = nil;
+                
+                _users = nil;
+                _chatId = nil;
+                
+                [_receivedMessagesArray removeAllObjects];
+                _receivedMessagesArray = nil;
+                
+                _responseHeader = nil;
+                
+                [localEchoes removeAllObjects];
+                localEchoes = nil;
+                
+                // A Load Still In Flight Will Never Finish
+                void (^pendingLoad)(NSDictionary *, NSError *) = loadCompletion;
+                loadCompletion = nil;
+                
+                [self deliver:^{
+                    if (pendingLoad) pendingLoad(nil, [NSError errorWithDomain:kFSChatManagerErrorDomain
+                                                                           code:FSChatErrorSessionEnded
+                                                                       userInfo:@{NSLocalizedDescriptionKey: NSLocalizedString(kErrorSessionEnded, nil)}]);
+                    if (completion) completion(error);
+                }];
+                
+            });
+        }];
     }
     else {
-        completion(nil);
+        if (completion) [self deliver:^{
+            completion(nil);
+        }];
     }
 }
 
 #pragma mark ADD MESSAGE TO CHAT
 
 - (void) sendNewMessage:(NSString *)content {
+    FSStateQueueAsync(stateQueue, ^{
+        [self sendNewMessageOnStateQueue:content completion:nil];
+    });
+}
+
+// Waits On rateLimiter, Then Writes -- Coalescing Into A Send Already Waiting If Asked To
+- (void) sendNewMessageOnStateQueue:(NSString *)content completion:(void (^)(NSDictionary * message, NSError * error))completion {
+    
+    FSRateLimiter * rateLimiter = self.rateLimiter;
+    if (![rateLimiter isEnabled]) {
+        [self writeNewMessageOnStateQueue:content completion:completion];
+        return;
+    }
+    
+    if (limitedSend && content && self.coalescesLimitedSends) {
+        limitedSend[kLimitedSendContent] = [NSString stringWithFormat:@"%@\n%@", limitedSend[kLimitedSendContent], content];
+        if (completion) [limitedSend[kLimitedSendCompletions] addObject:completion];
+        return;
+    }
+    
+    NSString * chatId = _chatId;
+    NSUInteger sendSession = session;
+    NSMutableDictionary * send = [NSMutableDictionary new];
+    if (content) send[kLimitedSendContent] = content;
+    send[kLimitedSendCompletions] = completion ? [NSMutableArray arrayWithObject:completion] : [NSMutableArray new];
+    
+    // Only A Send That Will Wait Can Be Joined
+    if (content && [rateLimiter isLimitingKey:chatId]) limitedSend = send;
+    
+    [rateLimiter acquireForKey:chatId onQueue:stateQueue completion:^(NSError *error) {
+        if (limitedSend == send) limitedSend = nil;
+        NSArray * completions = send[kLimitedSendCompletions];
+        
+        // The Chat It Was Typed In Closed While It Waited
+        if (!error && sendSession != session) {
+            error = [NSError errorWithDomain:kFSChatManagerErrorDomain
+                                        code:FSChatErrorSessionEnded
+                                    userInfo:@{NSLocalizedDescriptionKey: NSLocalizedString(kErrorSessionEnded, nil)}];
+        }
+        
+        if (error) {
+            NSMutableDictionary * message = [NSMutableDictionary new];
+            if (send[kLimitedSendContent]) message[kMessageContent] = send[kLimitedSendContent];
+            if (chatId) message[kMessageChatId] = chatId;
+            id<FSChatManagerDelegate> delegate = self.delegate;
+            [self deliver:^{
+                [delegate sendMessage:message didFailWithError:error];
+                for (void (^waiting)(NSDictionary *, NSError *) in completions) waiting(nil, error);
+            }];
+            return;
+        }
+        
+        [self writeNewMessageOnStateQueue:send[kLimitedSendContent] completion:completions.count == 0 ? nil : ^(NSDictionary *message, NSError *writeError) {
+            for (void (^waiting)(NSDictionary *, NSError *) in completions) waiting(message, writeError);
+        }];
+    }];
+}
+
+- (void) writeNewMessageOnStateQueue:(NSString *)content completion:(void (^)(NSDictionary * message, NSError * error))completion {
     
     // Get Users
-    NSString * sentById = _currentUserId;
+    NSString * sentById = self.currentUserId;
     
     // SentTo - Opponent
     // If more than 2, is for chat, and not directly to a user
@@ -584,6 +1695,12 @@ withCompletionBlock:(void (^)(NSString * chatId, NSError * error))completion {
         if ([sentById isEqualToString:sentToId]) sentToId = _users[1];
     }
     
+    // Everyone Else In A Group -- Captured Now, Members May Change Before The Ack
+    NSArray * recipients;
+    if (_users.count > 2) {
+        recipients = [_users filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"SELF != %@", sentById]];
+    }
+    
     /*
      Firebase Priority Doesn't Calculate Decimals in priorities, Multiply By 1000 To Expose Milliseconds and have more accurate priorities!
      */
@@ -601,94 +1718,1600 @@ withCompletionBlock:(void (^)(NSString * chatId, NSError * error))completion {
     
     // Create Message Ref If Necessary
     if (!_messagesRef) {
-        NSString * messageRefString = [NSString stringWithFormat:@"%@Chats/%@/messages/", _urlRefString, _chatId];
-        _messagesRef = [[Firebase alloc]initWithUrl:messageRefString];
+        _messagesRef = [self.refCache refWithRoot:[self rootForChatId:_chatId] collection:@"Chats" id:_chatId leaf:kChatMessages];
+    }
+    
+    // The Child Name -- Matches The Server's Copy To Our Echo, And Keys Outbox Replays
+    Firebase * messageRef = [_messagesRef childByAutoId];
+    NSString * key = messageRef.name;
+    NSMutableDictionary * echo = [self echoMessage:message withKey:key];
+    
+    // Journal First -- The Outbox Sends It, Retrying And Replaying As Needed
+    if (_outbox) {
+        [self enqueueMessage:message withKey:key echo:echo sentToId:sentToId recipients:recipients completion:completion];
+        return;
     }
     
+    // Stored Without The Keys Its Path Already Gives
+    NSDictionary * storedMessage = FSChatSchemaEncodeMessage(message, self.schemaVersion);
+    
+    // Measure Until Server Acknowledges
+    FSMetrics * metrics = self.metrics;
+    FSTracer * tracer = self.tracer;
+    NSTimeInterval start = FSMetricsNow();
+    [metrics recordBytes:FSMetricsEstimatedBytes(storedMessage) forOperation:kFSOperationSendMessage];
+    [metrics recordRoundTrips:1];
+    FSTraceSpan sendSpan = [tracer beginSpan:"chat.sendNewMessage" parent:FSTraceSpanNone];
+    FSTraceSpan writeSpan = [tracer beginSpan:"chat.sendNewMessage.write" parent:sendSpan];
+    
     // Send It Off -- Priority In Milliseconds
-    [[_messagesRef childByAutoId]setValue:message andPriority:timestamp withCompletionBlock:^(NSError *error, Firebase *ref) {
+    [self.retrier setValue:storedMessage andPriority:timestamp onRef:messageRef operation:kFSOperationSendMessage completion:^(NSError *error, Firebase *ref) {
+        [metrics recordOperation:kFSOperationSendMessage latency:FSMetricsNow() - start error:error];
+        [tracer endSpan:writeSpan];
         if (!error) {
             
             // ---- Message Sent! Update Everything Else ---- //
             
-            // Update Header
-            [self updateHeaderWithMessage:message];
+            // Update Header -- Ends sendSpan
+            [self updateHeaderWithMessage:message withKey:key sendSpan:sendSpan];
             
             // Notify User -- via Alerts -- add parameter, if online, else push?
             // Maybe just let developer do this
-            if (sentToId) [self notifyUserWithId:sentToId ofMessage:message];
+            if (sentToId) [self notifyUserWithId:sentToId ofMessage:message withKey:key];
+            else [self notifyUserIds:recipients ofMessage:message withKey:key];
+            
+            [self updateEcho:echo toState:kMessageSendStateSent];
+            if (completion) [self deliver:^{
+                completion(message, nil);
+            }];
         }
         else {
-            [_delegate sendMessage:message didFailWithError:error];
+            [self failEcho:echo withKey:key];
+            id<FSChatManagerDelegate> delegate = self.delegate;
+            [self deliver:^{
+                [delegate sendMessage:message didFailWithError:error];
+                if (completion) completion(nil, error);
+            }];
+            [tracer endSpan:sendSpan];
         }
     }];
     
 }
 
-- (void) updateHeaderWithMessage:(NSMutableDictionary *)message {
+// Sender, Ordering Key, Message Id And At Most previewLength Characters -- Headers Stay Small However Long The Message
+static NSDictionary * FSHeaderPreviewOfMessage(NSDictionary * message, NSString * key, NSUInteger previewLength) {
+    NSMutableDictionary * preview = [NSMutableDictionary new];
+    if (message[kMessageSentBy]) preview[kMessageSentBy] = message[kMessageSentBy];
+    if (message[kMessageTimestamp]) preview[kMessageTimestamp] = message[kMessageTimestamp];
+    if (key) preview[kMessageId] = key;
+    
+    NSString * content = message[kMessageContent];
+    if ([content isKindOfClass:[NSString class]]) {
+        
+        // Cut Where The Character Straddling The Limit Starts -- Never Through An Emoji Or Accent
+        if (content.length > previewLength) {
+            content = [content substringToIndex:[content rangeOfComposedCharacterSequenceAtIndex:previewLength].location];
+            preview[kPreviewTruncated] = @YES;
+        }
+        preview[kMessageContent] = content;
+    }
+    return preview;
+}
 
-    // Create Header Ref If Necessary
-    if (!_chatHeaderRef) {
-        NSString * headerRefString = [NSString stringWithFormat:@"%@Chats/%@/header/", _urlRefString, _chatId];
-        _chatHeaderRef = [[Firebase alloc]initWithUrl:headerRefString];
+// Sender's Last Action And The Newest Message -- Callers Update The Count
+static void FSHeaderApplyMessage(NSMutableDictionary * header, NSDictionary * message, NSString * key, NSUInteger previewLength) {
+    
+    // Set Last Time Our Current User Performed An Action
+    NSString * sentById = message[kMessageSentBy];
+    if (sentById) {
+        
+        // Add Message Timestamp If Newer
+        if ([message[kMessageTimestamp] doubleValue] > [header[sentById] doubleValue]) {
+            
+            // Set Last Time
+            header[sentById] = message[kMessageTimestamp];
+            
+        }
+    }
+    
+    // Is Our Message Newer?
+    if ([message[kMessageTimestamp] doubleValue] > [header[kHeaderTimeStamp] doubleValue]) {
+        
+        // Update Message
+        header[kHeaderTimeStamp] = message[kMessageTimestamp]; // Last Updated
+        header[kHeaderLastMessage] = FSHeaderPreviewOfMessage(message, key, previewLength);
     }
+}
+
+// Touches No Session State -- The Chat May Have Closed Since The Send
+- (void) updateHeaderWithMessage:(NSDictionary *)message withKey:(NSString *)key sendSpan:(FSTraceSpan)sendSpan {
+
+    NSString * chatId = message[kMessageChatId];
+    NSUInteger previewLength = self.headerPreviewLength;
+    FSChatSchemaVersion schemaVersion = self.schemaVersion;
+    Firebase * headerRef = [self.refCache refWithRoot:[self rootForChatId:chatId] collection:@"Chats" id:chatId leaf:kChatHeader];
     
     // Update Header If It's Newer Via Transaction
-    [_chatHeaderRef runTransactionBlock:^FTransactionResult *(FMutableData *currentData) {
+    FSTraceSpan headerSpan = [self.tracer beginSpan:"chat.sendNewMessage.updateHeader" parent:sendSpan];
+    [self.retrier runTransactionOnRef:headerRef operation:kFSOperationUpdateHeader block:^FTransactionResult *(FMutableData *currentData) {
         
         // Does Header Exist?
         if (currentData.value != [NSNull new]) {
             
             // Get Header From Value
-            NSMutableDictionary * header = currentData.value;
-            // Set Last Time Our Current User Performed An Action
-            if (_currentUserId) {
-                
-                // Add Message Timestamp If Newer
-                if ([message[kMessageTimestamp] doubleValue] > [header[_currentUserId] doubleValue]) {
-                    
-                    // Set Last Time
-                    header[_currentUserId] = message[kMessageTimestamp];
-                    
-                }
-            }
-                
-            // Is Our Message Newer?
-            if ([message[kMessageTimestamp] doubleValue] > [header[kHeaderTimeStamp] doubleValue]) {
-                
-                // Update Message
-                header[kHeaderTimeStamp] = message[kMessageTimestamp]; // Last Updated
-                header[kHeaderLastMessage] = message;
-            }
+            NSMutableDictionary * header = FSChatSchemaDecodeHeader(currentData.value);
+            FSHeaderApplyMessage(header, message, key, previewLength);
             
             // Update Count
             header[kHeaderMessageCount] = [NSNumber numberWithInt:[header[kHeaderMessageCount] intValue ] + 1];
             
             // Set Our Updated Header
-            [currentData setValue:header];
+            [currentData setValue:FSChatSchemaEncodeHeader(header, schemaVersion)];
         }
         
         // Return It
         return [FTransactionResult successWithValue:currentData];
-    } andCompletionBlock:^(NSError *error, BOOL committed, FDataSnapshot *snapshot) {
-        if (!error) {
-            // Done!
-            // If sent properly, should be received through didReceiveMessage.
+    } completion:^(NSError *error, BOOL committed, FDataSnapshot *snapshot) {
+        [self.tracer endSpan:headerSpan];
+        [self.tracer endSpan:sendSpan];
+        
+        // Retries Ran Out -- The Message Is Stored, But Not Counted
+        if (error) {
+            NSLog(@"ChatManager: Header Update Failed For Chat %@: %@", chatId, error);
+            return;
         }
-    } withLocalEvents:NO];
+        [self recordChangeOfChatId:chatId forUserIds:[self changeFeedUsersForHeader:snapshot.value] completion:nil];
+    }];
 }
 
-#pragma mark NOTIFY OPPONENT OF NEW MESSAGE -- Might Omit ...
+#pragma mark LOCAL ECHO
 
-- (void) notifyUserWithId:(NSString *)userToNotifyId ofMessage:(NSDictionary *)message {
+// Show A Sent Message Now -- Nil If Echo Is Off Or No Session Is Open
+- (NSMutableDictionary *) echoMessage:(NSDictionary *)message withKey:(NSString *)key {
+    if (!self.localEcho || !_chatId) return nil;
     
-    // Update Opponent via Alert Channel
-    FSChannelManager * channelManager = [FSChannelManager singleton];
-    [channelManager sendAlertToUserId:userToNotifyId
-                        withAlertType:kAlertTypeNewMessage
-                              andData:message
-                       withCompletion:nil]; // Possibly some error detection here
+    NSMutableDictionary * echo = [message mutableCopy];
+    echo[kMessageId] = key;
+    echo[kMessageSendState] = kMessageSendStatePending;
     
+    if (!localEchoes) localEchoes = [NSMutableDictionary new];
+    localEchoes[key] = echo;
+    
+    id<FSChatManagerDelegate> delegate = self.delegate;
+    [self deliver:^{
+        [delegate newMessageReceived:echo];
+    }];
+    return echo;
+}
+
+// Any Queue -- The Echo Is Only Changed On callbackQueue, Where The Delegate Reads It
+- (void) updateEcho:(NSMutableDictionary *)echo toState:(NSString *)state {
+    if (!echo) return;
+    
+    id<FSChatManagerDelegate> delegate = self.delegate;
+    [self deliver:^{
+        echo[kMessageSendState] = state;
+        if ([(NSObject *)delegate respondsToSelector:@selector(messageSendStateDidChange:)]) {
+            [delegate messageSendStateDidChange:echo];
+        }
+    }];
+}
+
+// Any Queue -- No Server Copy Is Coming
+- (void) failEcho:(NSMutableDictionary *)echo withKey:(NSString *)key {
+    if (!echo) return;
+    
+    FSStateQueueAsync(stateQueue, ^{
+        [localEchoes removeObjectForKey:key];
+    });
+    [self updateEcho:echo toState:kMessageSendStateFailed];
+}
+
+#pragma mark OUTBOX
+
+// Replays Overwrite Rather Than Duplicate -- @param key Is The Message's Child Name
+- (void) enqueueMessage:(NSDictionary *)message
+                withKey:(NSString *)key
+                   echo:(NSMutableDictionary *)echo
+               sentToId:(NSString *)sentToId
+             recipients:(NSArray *)recipients
+             completion:(void (^)(NSDictionary * message, NSError * error))completion {
+    
+    NSString * lane = [NSString stringWithFormat:@"Chats/%@", message[kMessageChatId]];
+    
+    // The Alert Is Owed By The Entry Itself -- A Replay After A Relaunch Still Sends It
+    NSMutableDictionary * entry = [[FSOutbox entryWithKind:kOutboxKindMessage lane:lane key:key payload:message] mutableCopy];
+    if (sentToId) entry[kOutboxEntryAlertTo] = sentToId;
+    else if (recipients.count > 0) entry[kOutboxEntryAlertTo] = recipients;
+    
+    NSError * error;
+    BOOL isQueued = [_outbox enqueueEntry:entry completion:^(NSError *error) {
+        if (error) {
+            [self failEcho:echo withKey:key];
+            if (completion) [self deliver:^{
+                completion(nil, error);
+            }];
+            return;
+        }
+        
+        [self updateEcho:echo toState:kMessageSendStateSent];
+        if (completion) [self deliver:^{
+            completion(message, nil);
+        }];
+    } error:&error];
+    
+    if (!isQueued) {
+        [self failEcho:echo withKey:key];
+        id<FSChatManagerDelegate> delegate = self.delegate;
+        [self deliver:^{
+            [delegate sendMessage:message didFailWithError:error];
+            if (completion) completion(nil, error);
+        }];
+    }
+}
+
+// Outbox Sender -- A Batch Shares One Chat: One Multi-Location Write, Then One Header Transaction
+- (void) sendOutboxMessages:(NSArray *)entries
+               fromOutboxId:(NSString *)outboxId
+                 completion:(void (^)(NSError * error))completion {
+    
+    NSString * chatId = entries[0][kOutboxEntryPayload][kMessageChatId];
+    Firebase * messagesRef = [self.refCache refWithRoot:[self rootForChatId:chatId] collection:@"Chats" id:chatId leaf:kChatMessages];
+    
+    // Priority In Milliseconds, As With A Direct Send -- Journaled With Version 1 Keys, Stored In Ours
+    FSChatSchemaVersion schemaVersion = self.schemaVersion;
+    NSMutableDictionary * values = [NSMutableDictionary dictionaryWithCapacity:entries.count];
+    for (NSDictionary * entry in entries) {
+        NSMutableDictionary * message = [FSChatSchemaEncodeMessage(entry[kOutboxEntryPayload], schemaVersion) mutableCopy];
+        message[@".priority"] = message[kMessageTimestamp];
+        values[entry[kOutboxEntryKey]] = message;
+    }
+    
+    // Measure Until Server Acknowledges -- Each Message Counts As A Send
+    FSMetrics * metrics = self.metrics;
+    FSTracer * tracer = self.tracer;
+    NSTimeInterval start = FSMetricsNow();
+    [metrics recordBytes:FSMetricsEstimatedBytes(values) forOperation:kFSOperationSendMessage];
+    [metrics recordRoundTrips:1];
+    FSTraceSpan sendSpan = [tracer beginSpan:"chat.outbox.send" parent:FSTraceSpanNone];
+    
+    [self.retrier updateChildValues:values onRef:messagesRef operation:kFSOperationSendMessage completion:^(NSError *error, Firebase *ref) {
+        NSTimeInterval latency = FSMetricsNow() - start;
+        for (NSUInteger i = 0; i < entries.count; i++) {
+            [metrics recordOperation:kFSOperationSendMessage latency:latency error:error];
+        }
+        
+        if (error) {
+            [tracer endSpan:sendSpan];
+            completion(error);
+            return;
+        }
+        [self updateHeaderWithOutboxEntries:entries fromOutboxId:outboxId sendSpan:sendSpan completion:^(NSError *error) {
+            
+            // Alerts Follow The Message They Announce -- Queued Before The Entry Is Done, Under Its Key So A Replay Overwrites
+            if (!error) {
+                for (NSDictionary * entry in entries) [self notifyRecipientsOfOutboxEntry:entry];
+            }
+            completion(error);
+        }];
+    }];
+}
+
+- (void) notifyRecipientsOfOutboxEntry:(NSDictionary *)entry {
+    id alertTo = entry[kOutboxEntryAlertTo];
+    if ([alertTo isKindOfClass:[NSString class]]) {
+        [self notifyUserWithId:alertTo ofMessage:entry[kOutboxEntryPayload] withKey:entry[kOutboxEntryKey]];
+    }
+    else if ([alertTo isKindOfClass:[NSArray class]]) {
+        [self notifyUserIds:alertTo ofMessage:entry[kOutboxEntryPayload] withKey:entry[kOutboxEntryKey]];
+    }
+}
+
+// Dropped For Good -- Live Sends Also Hear Through Their Completions
+- (void) outboxDidDropMessages:(NSArray *)entries withError:(NSError *)error {
+    id<FSChatManagerDelegate> delegate = self.delegate;
+    [self deliver:^{
+        for (NSDictionary * entry in entries) {
+            [delegate sendMessage:entry[kOutboxEntryPayload] didFailWithError:error];
+        }
+    }];
+}
+
+// Counts Each Entry Once -- Chats/<id>/outbox Keeps The Highest Sequence Counted Per Outbox, And A Lane Sends In Sequence
+- (void) updateHeaderWithOutboxEntries:(NSArray *)entries
+                          fromOutboxId:(NSString *)outboxId
+                              sendSpan:(FSTraceSpan)sendSpan
+                            completion:(void (^)(NSError * error))completion {
+    
+    NSString * chatId = entries[0][kOutboxEntryPayload][kMessageChatId];
+    FSTracer * tracer = self.tracer;
+    [self getOutboxWatermarkOfChatId:chatId forOutboxId:outboxId completion:^(long long watermark, NSError *error) {
+        if (error) {
+            [tracer endSpan:sendSpan];
+            completion(error);
+            return;
+        }
+        [self updateHeaderWithOutboxEntries:entries fromOutboxId:outboxId watermark:watermark sendSpan:sendSpan completion:completion];
+    }];
+}
+
+- (void) updateHeaderWithOutboxEntries:(NSArray *)entries
+                          fromOutboxId:(NSString *)outboxId
+                             watermark:(long long)watermark
+                              sendSpan:(FSTraceSpan)sendSpan
+                            completion:(void (^)(NSError * error))completion {
+    
+    NSString * chatId = entries[0][kOutboxEntryPayload][kMessageChatId];
+    Firebase * headerRef = [self.refCache refWithRoot:[self rootForChatId:chatId] collection:@"Chats" id:chatId leaf:kChatHeader];
+    
+    NSUInteger previewLength = self.headerPreviewLength;
+    FSChatSchemaVersion schemaVersion = self.schemaVersion;
+    
+    FSTracer * tracer = self.tracer;
+    FSTraceSpan headerSpan = [tracer beginSpan:"chat.outbox.updateHeader" parent:sendSpan];
+    [self.retrier runTransactionOnRef:headerRef operation:kFSOperationUpdateHeader block:^FTransactionResult *(FMutableData *currentData) {
+        
+        // Does Header Exist?
+        if (currentData.value != [NSNull new]) {
+            
+            NSMutableDictionary * header = FSChatSchemaDecodeHeader(currentData.value);
+            
+            // Skip What A Previous Attempt Already Counted -- The Header's Marker Covers A Batch Whose Watermark Never Landed
+            NSMutableDictionary * marker = [NSMutableDictionary new];
+            if ([header[kHeaderOutboxSequences] isKindOfClass:[NSDictionary class]]) [marker addEntriesFromDictionary:header[kHeaderOutboxSequences]];
+            long long counted = MAX(watermark, [marker[outboxId] longLongValue]);
+            
+            int added = 0;
+            for (NSDictionary * entry in entries) {
+                long long sequence = [entry[kOutboxEntrySequence] longLongValue];
+                if (sequence <= counted) continue;
+                
+                FSHeaderApplyMessage(header, entry[kOutboxEntryPayload], entry[kOutboxEntryKey], previewLength);
+                counted = sequence;
+                added++;
+            }
+            
+            // Other Outboxes' Entries Stay Until Their Own Watermarks Land
+            header[kHeaderMessageCount] = [NSNumber numberWithInt:[header[kHeaderMessageCount] intValue] + added];
+            marker[outboxId] = @(counted);
+            header[kHeaderOutboxSequences] = marker;
+            [currentData setValue:FSChatSchemaEncodeHeader(header, schemaVersion)];
+        }
+        
+        // Return It
+        return [FTransactionResult successWithValue:currentData];
+    } completion:^(NSError *error, BOOL committed, FDataSnapshot *snapshot) {
+        [tracer endSpan:headerSpan];
+        if (error) {
+            [tracer endSpan:sendSpan];
+            completion(error);
+            return;
+        }
+        
+        // Watermark Next -- Until It Lands, The Header's Marker Keeps A Replay From Counting Again
+        long long sequence = [[entries lastObject][kOutboxEntrySequence] longLongValue];
+        [self setOutboxWatermark:sequence ofChatId:chatId forOutboxId:outboxId completion:^(NSError *error) {
+            [tracer endSpan:sendSpan];
+            if (error) {
+                completion(error);
+                return;
+            }
+            [self pruneOutboxMarkerOfChatId:chatId forOutboxId:outboxId throughSequence:sequence];
+            
+            // Part Of The Entry -- A Failed Feed Write Replays The Batch, Which The Watermark Already Covers
+            [self recordChangeOfChatId:chatId forUserIds:[self changeFeedUsersForHeader:snapshot.value] completion:completion];
+        }];
+    }];
+}
+
+#pragma mark OUTBOX WATERMARKS
+
+// Our Watermark Has Landed, So Our Marker Entry Is Spare -- Best Effort, A Later Batch Prunes It Otherwise
+- (void) pruneOutboxMarkerOfChatId:(NSString *)chatId forOutboxId:(NSString *)outboxId throughSequence:(long long)sequence {
+    Firebase * headerRef = [self.refCache refWithRoot:[self rootForChatId:chatId] collection:@"Chats" id:chatId leaf:kChatHeader];
+    FSChatSchemaVersion schemaVersion = self.schemaVersion;
+    
+    [self.retrier runTransactionOnRef:headerRef operation:kFSOperationUpdateHeader block:^FTransactionResult *(FMutableData *currentData) {
+        if (currentData.value != [NSNull new]) {
+            
+            // A Later Batch Already Moved It On
+            NSMutableDictionary * header = FSChatSchemaDecodeHeader(currentData.value);
+            NSDictionary * marker = header[kHeaderOutboxSequences];
+            if (![marker isKindOfClass:[NSDictionary class]] || !marker[outboxId] || [marker[outboxId] longLongValue] > sequence) {
+                return [FTransactionResult abort];
+            }
+            
+            NSMutableDictionary * pruned = [marker mutableCopy];
+            [pruned removeObjectForKey:outboxId];
+            if (pruned.count > 0) header[kHeaderOutboxSequences] = pruned;
+            else [header removeObjectForKey:kHeaderOutboxSequences];
+            [currentData setValue:FSChatSchemaEncodeHeader(header, schemaVersion)];
+        }
+        return [FTransactionResult successWithValue:currentData];
+    } completion:^(NSError *error, BOOL committed, FDataSnapshot *snapshot) {
+        if (error) NSLog(@"ChatManager: Failed To Prune Outbox Marker Of %@: %@", chatId, error);
+    }];
+}
+
+- (NSString *) outboxWatermarkKeyOfChatId:(NSString *)chatId forOutboxId:(NSString *)outboxId {
+    return [NSString stringWithFormat:@"%@/%@", chatId, outboxId];
+}
+
+// Read Once Per Chat And Outbox -- Nobody Else Writes Our Watermark
+- (void) getOutboxWatermarkOfChatId:(NSString *)chatId
+                        forOutboxId:(NSString *)outboxId
+                         completion:(void (^)(long long watermark, NSError * error))completion {
+    
+    NSString * key = [self outboxWatermarkKeyOfChatId:chatId forOutboxId:outboxId];
+    __block NSNumber * cached;
+    FSStateQueueSync(stateQueue, ^{
+        cached = outboxWatermarks[key];
+    });
+    if (cached) {
+        completion([cached longLongValue], nil);
+        return;
+    }
+    
+    NSString * leaf = [NSString stringWithFormat:@"%@/%@", kChatOutbox, outboxId];
+    Firebase * watermarkRef = [self.refCache refWithRoot:[self rootForChatId:chatId] collection:@"Chats" id:chatId leaf:leaf];
+    
+    [self.metrics recordRoundTrips:1];
+    [watermarkRef observeSingleEventOfType:FEventTypeValue withBlock:^(FDataSnapshot *snapshot) {
+        long long watermark = [snapshot.value isKindOfClass:[NSNumber class]] ? [snapshot.value longLongValue] : 0;
+        [self cacheOutboxWatermark:watermark forKey:key];
+        completion(watermark, nil);
+    } withCancelBlock:^(NSError *error) {
+        completion(0, error);
+    }];
+}
+
+- (void) setOutboxWatermark:(long long)watermark
+                   ofChatId:(NSString *)chatId
+                forOutboxId:(NSString *)outboxId
+                 completion:(void (^)(NSError * error))completion {
+    
+    NSString * leaf = [NSString stringWithFormat:@"%@/%@", kChatOutbox, outboxId];
+    Firebase * watermarkRef = [self.refCache refWithRoot:[self rootForChatId:chatId] collection:@"Chats" id:chatId leaf:leaf];
+    
+    NSString * key = [self outboxWatermarkKeyOfChatId:chatId forOutboxId:outboxId];
+    [self.retrier setValue:@(watermark) andPriority:nil onRef:watermarkRef operation:kFSOperationUpdateHeader completion:^(NSError *error, Firebase *ref) {
+        if (!error) [self cacheOutboxWatermark:watermark forKey:key];
+        completion(error);
+    }];
+}
+
+- (void) cacheOutboxWatermark:(long long)watermark forKey:(NSString *)key {
+    FSStateQueueSync(stateQueue, ^{
+        if (!outboxWatermarks) outboxWatermarks = [NSMutableDictionary new];
+        if (!outboxWatermarks[key] || watermark > [outboxWatermarks[key] longLongValue]) outboxWatermarks[key] = @(watermark);
+    });
+}
+
+#pragma mark NOTIFY OPPONENT OF NEW MESSAGE -- Might Omit ...
+
+// The Alert Takes The Message's Key -- Sent Twice, It Lands Once
+- (void) notifyUserWithId:(NSString *)userToNotifyId ofMessage:(NSDictionary *)message withKey:(NSString *)key {
+    
+    // Update Opponent via Alert Channel
+    [self.channelManager sendAlertToUserId:userToNotifyId
+                             withAlertType:kAlertTypeNewMessage
+                                   andData:message
+                                       key:key
+                            withCompletion:nil]; // Possibly some error detection here
+    
+}
+
+// Group Members Get A Compact Alert In One Fan Out -- Too Many Of Them, And They Pull Headers Instead
+- (void) notifyUserIds:(NSArray *)userIds ofMessage:(NSDictionary *)message withKey:(NSString *)key {
+    
+    if (userIds.count == 0 || userIds.count > self.fanOutThreshold) return;
+    
+    NSMutableDictionary * data = [NSMutableDictionary new];
+    if (message[kMessageChatId]) data[kMessageChatId] = message[kMessageChatId];
+    if (message[kMessageSentBy]) data[kMessageSentBy] = message[kMessageSentBy];
+    if (message[kMessageTimestamp]) data[kMessageTimestamp] = message[kMessageTimestamp];
+    if (key) data[kMessageId] = key;
+    
+    [self.channelManager sendAlertToUserIds:userIds
+                              withAlertType:kAlertTypeNewGroupMessage
+                                    andData:data
+                                        key:key
+                             withCompletion:nil];
+}
+
+#pragma mark ARCHIVE
+
+// Deflated JSON, Base64 So It Stores As One String -- nil If It Can't Be Packed
+static NSString * FSArchivePackMessages(NSArray * messages) {
+    NSData * json = [NSJSONSerialization dataWithJSONObject:messages options:0 error:nil];
+    if (!json) return nil;
+    
+    uLongf length = compressBound((uLong)json.length);
+    NSMutableData * deflated = [NSMutableData dataWithLength:length];
+    if (compress2(deflated.mutableBytes, &length, json.bytes, (uLong)json.length, Z_BEST_COMPRESSION) != Z_OK) return nil;
+    deflated.length = length;
+    
+    return [deflated base64EncodedStringWithOptions:0];
+}
+
+// nil If The Bucket Is Damaged Or In An Encoding We Don't Know
+static NSArray * FSArchiveUnpackBucket(NSDictionary * bucket) {
+    if (![bucket isKindOfClass:[NSDictionary class]]) return nil;
+    if (![bucket[kArchiveEncoding] isEqual:kArchiveEncodingDeflatedJSON] || ![bucket[kArchiveData] isKindOfClass:[NSString class]]) return nil;
+    
+    NSData * deflated = [[NSData alloc] initWithBase64EncodedString:bucket[kArchiveData] options:0];
+    if (deflated.length == 0) return nil;
+    
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (inflateInit(&stream) != Z_OK) return nil;
+    stream.next_in = (Bytef *)deflated.bytes;
+    stream.avail_in = (uInt)deflated.length;
+    
+    // Grow Until It All Fits -- Chat JSON Deflates Several Times Over
+    NSMutableData * json = [NSMutableData dataWithLength:deflated.length * 4];
+    int status = Z_OK;
+    while (status == Z_OK) {
+        if (stream.total_out == json.length) json.length *= 2;
+        stream.next_out = (Bytef *)json.mutableBytes + stream.total_out;
+        stream.avail_out = (uInt)(json.length - stream.total_out);
+        status = inflate(&stream, Z_NO_FLUSH);
+    }
+    json.length = stream.total_out;
+    inflateEnd(&stream);
+    if (status != Z_STREAM_END) return nil;
+    
+    id messages = [NSJSONSerialization JSONObjectWithData:json options:NSJSONReadingMutableContainers error:nil];
+    return [messages isKindOfClass:[NSArray class]] ? messages : nil;
+}
+
+// yyyyMMdd In UTC -- Every Client Buckets The Same Way
+static NSString * FSArchiveDayForTimestamp(NSString * timestamp) {
+    time_t seconds = (time_t)([timestamp doubleValue] / 1000);
+    struct tm day;
+    gmtime_r(&seconds, &day);
+    
+    char buffer[16];
+    strftime(buffer, sizeof(buffer), "%Y%m%d", &day);
+    return [NSString stringWithUTF8String:buffer];
+}
+
+/*
+ The oldest messages before cutoff as @[buckets, more] -- each bucket @[name, value, message ids].  The archive must stay the oldest part of the chat, so packing stops at the first run that fails.
+ */
+static NSArray * FSArchiveBucketsForSnapshot(FDataSnapshot * snapshot, NSString * chatId, double cutoff, NSUInteger bucketSize) {
+    
+    // Runs Of One UTC Day, At Most bucketSize Long
+    NSMutableArray * runs = [NSMutableArray new];
+    NSMutableArray * run;
+    NSString * runDay;
+    BOOL reachedCutoff = NO;
+    for (FDataSnapshot * child in snapshot.children) {
+        NSMutableDictionary * message = FSChatSchemaDecodeMessage(child.value, chatId);
+        if (!message[kMessageTimestamp]) continue;
+        
+        NSString * timestamp = message[kMessageTimestamp];
+        if ([timestamp doubleValue] >= cutoff) {
+            reachedCutoff = YES;
+            break;
+        }
+        
+        NSString * day = FSArchiveDayForTimestamp(timestamp);
+        if (!run || run.count >= bucketSize || ![day isEqualToString:runDay]) {
+            run = [NSMutableArray new];
+            runDay = day;
+            [runs addObject:run];
+        }
+        
+        message[kMessageId] = child.name;
+        [run addObject:message];
+    }
+    
+    NSMutableArray * buckets = [NSMutableArray arrayWithCapacity:runs.count];
+    for (NSArray * messages in runs) {
+        NSString * data = FSArchivePackMessages(messages);
+        if (!data) break;
+        
+        // Named By Its First Message -- A Repeated Pass Rewrites The Same Bucket
+        NSString * first = [messages firstObject][kMessageTimestamp];
+        NSString * name = [NSString stringWithFormat:@"%@_%@", FSArchiveDayForTimestamp(first), [messages firstObject][kMessageId]];
+        NSDictionary * value = @{
+                                 kArchiveFirstTimestamp: first,
+                                 kArchiveLastTimestamp: [messages lastObject][kMessageTimestamp],
+                                 kArchiveMessageCount: @(messages.count),
+                                 kArchiveEncoding: kArchiveEncodingDeflatedJSON,
+                                 kArchiveData: data,
+                                 @".priority": first,
+                                 };
+        [buckets addObject:@[name, value, [messages valueForKey:kMessageId]]];
+    }
+    
+    // A Full Read That Never Reached cutoff Leaves Older Messages Behind
+    BOOL more = !reachedCutoff && snapshot.childrenCount >= kCompactionBatchSize && buckets.count > 0 && buckets.count == runs.count;
+    return @[buckets, @(more)];
+}
+
+- (void) compactChatWithId:(NSString *)chatId
+                 olderThan:(NSTimeInterval)age
+       withCompletionBlock:(void (^)(NSUInteger archivedCount, NSError * error))completionBlock {
+    
+    // Measure The Whole Pass, However Many Writes It Takes
+    FSMetrics * metrics = self.metrics;
+    FSTracer * tracer = self.tracer;
+    NSTimeInterval start = FSMetricsNow();
+    FSTraceSpan compactSpan = [tracer beginSpan:"chat.compactArchive" parent:FSTraceSpanNone];
+    void (^completion)(NSUInteger, NSError *) = ^(NSUInteger archivedCount, NSError * error) {
+        [metrics recordOperation:kFSOperationCompactArchive latency:FSMetricsNow() - start error:error];
+        [tracer endSpan:compactSpan];
+        if (completionBlock) [self deliver:^{
+            completionBlock(archivedCount, error);
+        }];
+    };
+    
+    double cutoff = ([[NSDate new] timeIntervalSince1970] - age) * 1000;
+    Firebase * headerRef = [self.refCache refWithRoot:[self rootForChatId:chatId] collection:@"Chats" id:chatId leaf:kChatHeader];
+    
+    // Writes Set The Total Outright, So A Retried Write Can't Count Twice -- Under The Key The Header's Version Uses
+    [metrics recordRoundTrips:1];
+    [headerRef observeSingleEventOfType:FEventTypeValue withBlock:^(FDataSnapshot *snapshot) {
+        NSUInteger archivedCount = [FSChatSchemaDecodeHeader(snapshot.value)[kHeaderArchivedCount] unsignedIntegerValue];
+        NSString * archivedCountPath = [NSString stringWithFormat:@"%@/%@", kChatHeader, FSChatSchemaHeaderKey(kHeaderArchivedCount, FSChatSchemaVersionOfHeader(snapshot.value))];
+        dispatch_async(stateQueue, ^{
+            [self compactBatchOfChatId:chatId before:cutoff archivedCountPath:archivedCountPath archivedCount:archivedCount archived:0 parentSpan:compactSpan completion:completion];
+        });
+    } withCancelBlock:^(NSError *error) {
+        completion(0, error);
+    }];
+}
+
+// One Read Of The Oldest Messages, Then One Write Per Bucket -- Again Until Nothing Before cutoff Is Left
+- (void) compactBatchOfChatId:(NSString *)chatId
+                       before:(double)cutoff
+            archivedCountPath:(NSString *)archivedCountPath
+                archivedCount:(NSUInteger)archivedCount
+                     archived:(NSUInteger)archived
+                   parentSpan:(FSTraceSpan)parentSpan
+                   completion:(void (^)(NSUInteger archived, NSError * error))completion {
+    
+    Firebase * messagesRef = [self.refCache refWithRoot:[self rootForChatId:chatId] collection:@"Chats" id:chatId leaf:kChatMessages];
+    NSUInteger bucketSize = MAX(self.archiveBucketSize, 1);
+    
+    // Oldest First -- nil Starts Before Every Priority
+    FQuery * oldestQuery = [[messagesRef queryStartingAtPriority:nil] queryLimitedToNumberOfChildren:kCompactionBatchSize];
+    
+    FSTracer * tracer = self.tracer;
+    FSTraceSpan readSpan = [tracer beginSpan:"chat.compactArchive.read" parent:parentSpan];
+    FSDecodeStream * stream = [self.decodePool streamWithTargetQueue:stateQueue];
+    [self.metrics recordRoundTrips:1];
+    [oldestQuery observeSingleEventOfType:FEventTypeValue withBlock:^(FDataSnapshot *snapshot) {
+        [tracer endSpan:readSpan];
+        [self decode:^id{
+            return FSArchiveBucketsForSnapshot(snapshot, chatId, cutoff, bucketSize);
+        } inStream:stream completion:^(NSArray * batch) {
+            [self writeArchiveBuckets:batch[0] ofChatId:chatId archivedCountPath:archivedCountPath archivedCount:archivedCount parentSpan:parentSpan completion:^(NSUInteger total, NSError *error) {
+                
+                NSUInteger nowArchived = archived + total - archivedCount;
+                if (error || ![batch[1] boolValue]) {
+                    completion(nowArchived, error);
+                    return;
+                }
+                
+                [self compactBatchOfChatId:chatId before:cutoff archivedCountPath:archivedCountPath archivedCount:total archived:nowArchived parentSpan:parentSpan completion:completion];
+            }];
+        }];
+    } withCancelBlock:^(NSError *error) {
+        [tracer endSpan:readSpan];
+        completion(archived, error);
+    }];
+}
+
+// Oldest Bucket First -- Each Write Adds The Bucket And Removes Its Messages Together.  completion Runs On stateQueue With The New Total.
+- (void) writeArchiveBuckets:(NSArray *)buckets
+                    ofChatId:(NSString *)chatId
+           archivedCountPath:(NSString *)archivedCountPath
+               archivedCount:(NSUInteger)archivedCount
+                  parentSpan:(FSTraceSpan)parentSpan
+                  completion:(void (^)(NSUInteger archivedCount, NSError * error))completion {
+    
+    if (buckets.count == 0) {
+        completion(archivedCount, nil);
+        return;
+    }
+    
+    NSArray * bucket = buckets[0];
+    NSUInteger total = archivedCount + [bucket[2] count];
+    
+    NSMutableDictionary * values = [NSMutableDictionary new];
+    values[[NSString stringWithFormat:@"%@/%@", kChatArchive, bucket[0]]] = bucket[1];
+    for (NSString * messageId in bucket[2]) {
+        values[[NSString stringWithFormat:@"%@/%@", kChatMessages, messageId]] = [NSNull null];
+    }
+    values[archivedCountPath] = @(total);
+    
+    Firebase * chatRef = [self.refCache refWithRoot:[self rootForChatId:chatId] collection:@"Chats" id:chatId leaf:nil];
+    
+    FSTracer * tracer = self.tracer;
+    FSTraceSpan writeSpan = [tracer beginSpan:"chat.compactArchive.write" parent:parentSpan];
+    [self.metrics recordBytes:FSMetricsEstimatedBytes(bucket[1]) forOperation:kFSOperationCompactArchive];
+    [self.metrics recordRoundTrips:1];
+    [self.retrier updateChildValues:values onRef:chatRef operation:kFSOperationCompactArchive completion:^(NSError *error, Firebase *ref) {
+        [tracer endSpan:writeSpan];
+        dispatch_async(stateQueue, ^{
+            if (error) {
+                completion(archivedCount, error);
+                return;
+            }
+            [self writeArchiveBuckets:[buckets subarrayWithRange:NSMakeRange(1, buckets.count - 1)]
+                             ofChatId:chatId
+                    archivedCountPath:archivedCountPath
+                        archivedCount:total
+                           parentSpan:parentSpan
+                           completion:completion];
+        });
+    }];
+}
+
+#pragma mark HISTORY
+
+// Messages Before timestamp, Oldest First, Each With kMessageId
+static NSArray * FSHistoryMessagesInSnapshot(FDataSnapshot * snapshot, NSString * chatId, NSString * timestamp) {
+    NSMutableArray * messages = [NSMutableArray new];
+    for (FDataSnapshot * child in snapshot.children) {
+        NSMutableDictionary * message = FSChatSchemaDecodeMessage(child.value, chatId);
+        if (!message) continue;
+        if (timestamp && [message[kMessageTimestamp] doubleValue] >= [timestamp doubleValue]) continue;
+        
+        message[kMessageId] = child.name;
+        [messages addObject:message];
+    }
+    return messages;
+}
+
+// @[name, priority, messages before timestamp] Per Bucket, Oldest First -- nil If Any Is Unreadable
+static NSArray * FSHistoryBucketsInSnapshot(FDataSnapshot * snapshot, NSString * skipName, NSString * timestamp) {
+    NSMutableArray * buckets = [NSMutableArray new];
+    for (FDataSnapshot * child in snapshot.children) {
+        if ([child.name isEqualToString:skipName]) continue;
+        
+        NSArray * packed = FSArchiveUnpackBucket(child.value);
+        if (!packed) return nil;
+        
+        NSMutableArray * messages = [NSMutableArray arrayWithCapacity:packed.count];
+        for (NSDictionary * message in packed) {
+            if (timestamp && [message[kMessageTimestamp] doubleValue] >= [timestamp doubleValue]) continue;
+            [messages addObject:message];
+        }
+        [buckets addObject:@[child.name, child.priority ?: [NSNull null], messages]];
+    }
+    return buckets;
+}
+
+- (void) getMessagesForChatId:(NSString *)chatId
+              beforeTimestamp:(NSString *)timestamp
+                        count:(NSUInteger)count
+          withCompletionBlock:(void (^)(NSArray * messages, NSError * error))completionBlock {
+    
+    // Measure The Whole Page, However Many Reads It Takes
+    FSMetrics * metrics = self.metrics;
+    FSTracer * tracer = self.tracer;
+    NSTimeInterval start = FSMetricsNow();
+    FSTraceSpan historySpan = [tracer beginSpan:"chat.loadHistory" parent:FSTraceSpanNone];
+    void (^completion)(NSArray *, NSError *) = ^(NSArray * messages, NSError * error) {
+        [metrics recordOperation:kFSOperationLoadHistory latency:FSMetricsNow() - start error:error];
+        [tracer endSpan:historySpan];
+        if (completionBlock) [self deliver:^{
+            completionBlock(messages, error);
+        }];
+    };
+    
+    if (count == 0) {
+        completion(@[], nil);
+        return;
+    }
+    
+    Firebase * messagesRef = [self.refCache refWithRoot:[self rootForChatId:chatId] collection:@"Chats" id:chatId leaf:kChatMessages];
+    
+    // Ending At timestamp Includes It -- One Extra Makes Up For It
+    FQuery * liveQuery = timestamp ? [[messagesRef queryEndingAtPriority:timestamp] queryLimitedToNumberOfChildren:count + 1] : [messagesRef queryLimitedToNumberOfChildren:count];
+    
+    FSTraceSpan liveSpan = [tracer beginSpan:"chat.loadHistory.live" parent:historySpan];
+    FSDecodeStream * stream = [self.decodePool streamWithTargetQueue:stateQueue];
+    [metrics recordRoundTrips:1];
+    [liveQuery observeSingleEventOfType:FEventTypeValue withBlock:^(FDataSnapshot *snapshot) {
+        [tracer endSpan:liveSpan];
+        [self decode:^id{
+            return FSHistoryMessagesInSnapshot(snapshot, chatId, timestamp);
+        } inStream:stream completion:^(NSArray * live) {
+            
+            // Enough Live Messages -- Everything Archived Is Older
+            if (live.count >= count) {
+                completion([live subarrayWithRange:NSMakeRange(live.count - count, count)], nil);
+                return;
+            }
+            
+            Firebase * archiveRef = [self.refCache refWithRoot:[self rootForChatId:chatId] collection:@"Chats" id:chatId leaf:kChatArchive];
+            [self readArchive:archiveRef
+             endingAtPriority:timestamp
+                    childName:nil
+                  bucketLimit:1
+              beforeTimestamp:timestamp
+                        count:count - live.count
+                     messages:@[]
+                       stream:stream
+                   parentSpan:historySpan
+                   completion:^(NSArray *archived, NSError *error) {
+                       completion(error ? nil : [archived arrayByAddingObjectsFromArray:live], error);
+                   }];
+        }];
+    } withCancelBlock:^(NSError *error) {
+        [tracer endSpan:liveSpan];
+        completion(nil, error);
+    }];
+}
+
+// Newest Buckets First, Until count Messages Turn Up Or The Archive Runs Out
+- (void) readArchive:(Firebase *)archiveRef
+    endingAtPriority:(id)priority
+           childName:(NSString *)childName
+         bucketLimit:(NSUInteger)bucketLimit
+     beforeTimestamp:(NSString *)timestamp
+               count:(NSUInteger)count
+            messages:(NSArray *)messages
+              stream:(FSDecodeStream *)stream
+          parentSpan:(FSTraceSpan)parentSpan
+          completion:(void (^)(NSArray * messages, NSError * error))completion {
+    
+    // Anchored On The Last Bucket Read -- It Comes Back Too, So Ask For One More
+    FQuery * bucketQuery = archiveRef;
+    if (childName) bucketQuery = [archiveRef queryEndingAtPriority:priority andChildName:childName];
+    else if (priority) bucketQuery = [archiveRef queryEndingAtPriority:priority];
+    bucketQuery = [bucketQuery queryLimitedToNumberOfChildren:bucketLimit + (childName ? 1 : 0)];
+    
+    FSTracer * tracer = self.tracer;
+    FSTraceSpan readSpan = [tracer beginSpan:"chat.loadHistory.archive" parent:parentSpan];
+    [self.metrics recordRoundTrips:1];
+    [bucketQuery observeSingleEventOfType:FEventTypeValue withBlock:^(FDataSnapshot *snapshot) {
+        [tracer endSpan:readSpan];
+        [self decode:^id{
+            return FSHistoryBucketsInSnapshot(snapshot, childName, timestamp);
+        } inStream:stream completion:^(NSArray * buckets) {
+            
+            if (!buckets) {
+                NSDictionary *userInfo = @{
+                                           NSLocalizedDescriptionKey: NSLocalizedString(kErrorArchiveUnreadable, nil),
+                                           NSLocalizedFailureReasonErrorKey: NSLocalizedString(@"Damaged Data Or Unknown Encoding", nil),
+                                           NSLocalizedRecoverySuggestionErrorKey: NSLocalizedString(@"The archive was likely written by a newer version.", nil)
+                                           };
+                completion(nil, [NSError errorWithDomain:kFSChatManagerErrorDomain code:FSChatErrorArchiveUnreadable userInfo:userInfo]);
+                return;
+            }
+            
+            NSMutableArray * found = [NSMutableArray new];
+            for (NSArray * bucket in buckets) [found addObjectsFromArray:bucket[2]];
+            [found addObjectsFromArray:messages];
+            
+            // Enough, Or Nothing Older Left
+            if (found.count >= count || buckets.count < bucketLimit) {
+                NSUInteger length = MIN(found.count, count);
+                completion([found subarrayWithRange:NSMakeRange(found.count - length, length)], nil);
+                return;
+            }
+            
+            NSArray * oldest = buckets[0];
+            [self readArchive:archiveRef
+             endingAtPriority:oldest[1]
+                    childName:oldest[0]
+                  bucketLimit:MIN(bucketLimit * 2, kHistoryMaxBucketsPerRead)
+              beforeTimestamp:timestamp
+                        count:count
+                     messages:found
+                       stream:stream
+                   parentSpan:parentSpan
+                   completion:completion];
+        }];
+    } withCancelBlock:^(NSError *error) {
+        [tracer endSpan:readSpan];
+        completion(nil, error);
+    }];
+}
+
+#pragma mark MIGRATION
+
+/*
+ Chat ids listed by one page of users, as @[chat ids, last name, last priority, users read].  skipName is the previous page's last user, which comes back first.
+ */
+static NSArray * FSMigrationChatIdsInSnapshot(FDataSnapshot * snapshot, NSString * skipName) {
+    NSMutableOrderedSet * chatIds = [NSMutableOrderedSet new];
+    FDataSnapshot * last;
+    NSUInteger read = 0;
+    for (FDataSnapshot * user in snapshot.children) {
+        last = user;
+        if ([user.name isEqualToString:skipName]) continue;
+        read++;
+        
+        // Stored As An Array -- Or A Dictionary Once It Has Gaps
+        id chats = [user childSnapshotForPath:@"chats"].value;
+        if ([chats isKindOfClass:[NSDictionary class]]) chats = [chats allValues];
+        if (![chats isKindOfClass:[NSArray class]]) continue;
+        for (id chatId in chats) {
+            if ([chatId isKindOfClass:[NSString class]]) [chatIds addObject:chatId];
+        }
+    }
+    return @[[chatIds array], last.name ?: [NSNull null], last.priority ?: [NSNull null], @(read)];
+}
+
+/*
+ One window of a chat's messages, as @[values to write, last name, last priority, messages read] -- only those not yet stored in version are written.  skipName is the previous window's last message, which comes back first.
+ */
+static NSArray * FSMigrationMessagesInSnapshot(FDataSnapshot * snapshot, NSString * chatId, NSString * skipName, FSChatSchemaVersion version) {
+    NSMutableDictionary * values = [NSMutableDictionary new];
+    FDataSnapshot * last;
+    NSUInteger read = 0;
+    for (FDataSnapshot * child in snapshot.children) {
+        last = child;
+        if ([child.name isEqualToString:skipName]) continue;
+        read++;
+        if (FSChatSchemaMessageIsInVersion(child.value, version)) continue;
+        
+        // Priorities Kept -- Queries Order Messages By Them
+        NSMutableDictionary * message = [FSChatSchemaEncodeMessage(FSChatSchemaDecodeMessage(child.value, chatId), version) mutableCopy];
+        if (child.priority && child.priority != [NSNull new]) message[@".priority"] = child.priority;
+        values[child.name] = message;
+    }
+    return @[values, last.name ?: [NSNull null], last.priority ?: [NSNull null], @(read)];
+}
+
+- (void) migrateChatsToSchemaVersion:(FSChatSchemaVersion)version
+                 withCompletionBlock:(void (^)(NSUInteger migratedCount, NSError * error))completionBlock {
+    
+    // Measure The Whole Run, Every Database
+    FSMetrics * metrics = self.metrics;
+    FSTracer * tracer = self.tracer;
+    NSTimeInterval start = FSMetricsNow();
+    FSTraceSpan migrateSpan = [tracer beginSpan:"chat.migrateSchema" parent:FSTraceSpanNone];
+    void (^completion)(NSUInteger, NSError *) = ^(NSUInteger migratedCount, NSError * error) {
+        [metrics recordOperation:kFSOperationMigrateSchema latency:FSMetricsNow() - start error:error];
+        [tracer endSpan:migrateSpan];
+        if (completionBlock) [self deliver:^{
+            completionBlock(migratedCount, error);
+        }];
+    };
+    
+    NSArray * roots = self.shardRouter.databaseURLs;
+    if (!roots) roots = self.urlRefString ? @[self.urlRefString] : @[];
+    
+    // Chat Ids Only -- A Chat Listed By Several Members Is Migrated Once
+    NSMutableSet * seen = [NSMutableSet new];
+    FSStateQueueAsync(stateQueue, ^{
+        [self migrateUsersOfRoots:roots afterPriority:nil childName:nil toSchemaVersion:version seen:seen migrated:0 parentSpan:migrateSpan completion:completion];
+    });
+}
+
+// One Page Of Users From The First Root, For The Chats They List -- Then The Next Page, Or The Next Root
+- (void) migrateUsersOfRoots:(NSArray *)roots
+               afterPriority:(id)priority
+                   childName:(NSString *)childName
+             toSchemaVersion:(FSChatSchemaVersion)version
+                        seen:(NSMutableSet *)seen
+                    migrated:(NSUInteger)migrated
+                  parentSpan:(FSTraceSpan)parentSpan
+                  completion:(void (^)(NSUInteger migrated, NSError * error))completion {
+    
+    if (roots.count == 0) {
+        completion(migrated, nil);
+        return;
+    }
+    
+    NSString * root = roots[0];
+    NSUInteger batchSize = MAX(self.migrationBatchSize, 1);
+    Firebase * usersRef = [self.refCache refWithRoot:root collection:@"Users" id:nil leaf:nil];
+    
+    // Anchored On The Last User Read -- It Comes Back Too, So Ask For One More
+    FQuery * pageQuery = [[usersRef queryStartingAtPriority:priority andChildName:childName] queryLimitedToNumberOfChildren:batchSize + (childName ? 1 : 0)];
+    
+    FSTracer * tracer = self.tracer;
+    FSTraceSpan readSpan = [tracer beginSpan:"chat.migrateSchema.read" parent:parentSpan];
+    FSDecodeStream * stream = [self.decodePool streamWithTargetQueue:stateQueue];
+    [self.metrics recordRoundTrips:1];
+    [pageQuery observeSingleEventOfType:FEventTypeValue withBlock:^(FDataSnapshot *snapshot) {
+        [tracer endSpan:readSpan];
+        [self decode:^id{
+            return FSMigrationChatIdsInSnapshot(snapshot, childName);
+        } inStream:stream completion:^(NSArray * page) {
+            
+            NSMutableArray * chatIds = [NSMutableArray new];
+            for (NSString * chatId in page[0]) {
+                if ([seen containsObject:chatId]) continue;
+                [seen addObject:chatId];
+                [chatIds addObject:chatId];
+            }
+            
+            BOOL isLastPage = [page[3] unsignedIntegerValue] < batchSize;
+            [self migrateChatIds:chatIds fromIndex:0 toSchemaVersion:version migrated:migrated parentSpan:parentSpan completion:^(NSUInteger nowMigrated, NSError *error) {
+                
+                // Stop Where It Failed -- Chats Already Migrated Are Skipped Next Time
+                if (error) {
+                    completion(nowMigrated, error);
+                }
+                else if (isLastPage) {
+                    [self migrateUsersOfRoots:[roots subarrayWithRange:NSMakeRange(1, roots.count - 1)] afterPriority:nil childName:nil toSchemaVersion:version seen:seen migrated:nowMigrated parentSpan:parentSpan completion:completion];
+                }
+                else {
+                    id lastPriority = page[2] != [NSNull new] ? page[2] : nil;
+                    [self migrateUsersOfRoots:roots afterPriority:lastPriority childName:page[1] toSchemaVersion:version seen:seen migrated:nowMigrated parentSpan:parentSpan completion:completion];
+                }
+            }];
+        }];
+    } withCancelBlock:^(NSError *error) {
+        [tracer endSpan:readSpan];
+        dispatch_async(stateQueue, ^{
+            completion(migrated, error);
+        });
+    }];
+}
+
+// migrationBatchSize Chats At Once, Each In Its Own Database.  completion Runs On stateQueue.
+- (void) migrateChatIds:(NSArray *)chatIds
+              fromIndex:(NSUInteger)index
+        toSchemaVersion:(FSChatSchemaVersion)version
+               migrated:(NSUInteger)migrated
+             parentSpan:(FSTraceSpan)parentSpan
+             completion:(void (^)(NSUInteger migrated, NSError * error))completion {
+    
+    if (index >= chatIds.count) {
+        completion(migrated, nil);
+        return;
+    }
+    
+    NSUInteger count = MIN(MAX(self.migrationBatchSize, 1), chatIds.count - index);
+    __block NSUInteger remaining = count;
+    __block NSUInteger rewritten = 0;
+    __block NSError * firstError;
+    for (NSString * chatId in [chatIds subarrayWithRange:NSMakeRange(index, count)]) {
+        [self migrateChatWithId:chatId toSchemaVersion:version parentSpan:parentSpan completion:^(BOOL isRewritten, NSError *error) {
+            if (isRewritten) rewritten++;
+            if (error && !firstError) firstError = error;
+            if (--remaining > 0) return;
+            
+            if (firstError) completion(migrated + rewritten, firstError);
+            else [self migrateChatIds:chatIds fromIndex:index + count toSchemaVersion:version migrated:migrated + rewritten parentSpan:parentSpan completion:completion];
+        }];
+    }
+}
+
+// Messages A Window At A Time, Each In One Multi-Location Write, Then The Header By Transaction So Sends Meanwhile Aren't Lost.  completion Runs On stateQueue.
+- (void) migrateChatWithId:(NSString *)chatId
+           toSchemaVersion:(FSChatSchemaVersion)version
+                parentSpan:(FSTraceSpan)parentSpan
+                completion:(void (^)(BOOL isRewritten, NSError * error))completion {
+    
+    NSString * root = [self rootForChatId:chatId];
+    FSMetrics * metrics = self.metrics;
+    FSTracer * tracer = self.tracer;
+    FSTraceSpan chatSpan = [tracer beginSpan:"chat.migrateSchema.chat" parent:parentSpan];
+    void (^finish)(BOOL, NSError *) = ^(BOOL isRewritten, NSError * error) {
+        [tracer endSpan:chatSpan];
+        dispatch_async(stateQueue, ^{
+            completion(isRewritten, error);
+        });
+    };
+    
+    void (^migrateHeader)(BOOL) = ^(BOOL isRewritten) {
+        Firebase * headerRef = [self.refCache refWithRoot:root collection:@"Chats" id:chatId leaf:kChatHeader];
+        [metrics recordRoundTrips:1];
+        [headerRef observeSingleEventOfType:FEventTypeValue withBlock:^(FDataSnapshot *snapshot) {
+            
+            // Gone, Or Already There
+            if (![snapshot.value isKindOfClass:[NSDictionary class]] || FSChatSchemaVersionOfHeader(snapshot.value) == version) {
+                finish(isRewritten, nil);
+                return;
+            }
+            
+            [metrics recordRoundTrips:1];
+            [self.retrier runTransactionOnRef:headerRef operation:kFSOperationMigrateSchema block:^FTransactionResult *(FMutableData *currentData) {
+                if (currentData.value != [NSNull new]) {
+                    [currentData setValue:FSChatSchemaEncodeHeader(FSChatSchemaDecodeHeader(currentData.value), version)];
+                }
+                return [FTransactionResult successWithValue:currentData];
+            } completion:^(NSError *error, BOOL committed, FDataSnapshot *snapshot) {
+                finish(!error, error);
+            }];
+        } withCancelBlock:^(NSError *error) {
+            finish(isRewritten, error);
+        }];
+    };
+    
+    FSDecodeStream * stream = [self.decodePool streamWithTargetQueue:stateQueue];
+    [self migrateMessagesOfChatId:chatId inRoot:root afterPriority:nil childName:nil toSchemaVersion:version rewrote:NO stream:stream parentSpan:chatSpan completion:^(BOOL isRewritten, NSError *error) {
+        if (error) {
+            finish(isRewritten, error);
+            return;
+        }
+        migrateHeader(isRewritten);
+    }];
+}
+
+// One Window Of kMigrationMessageWindow Messages -- Then The Next, Until One Comes Back Short.  completion Runs On stateQueue.
+- (void) migrateMessagesOfChatId:(NSString *)chatId
+                          inRoot:(NSString *)root
+                   afterPriority:(id)priority
+                       childName:(NSString *)childName
+                 toSchemaVersion:(FSChatSchemaVersion)version
+                         rewrote:(BOOL)rewrote
+                          stream:(FSDecodeStream *)stream
+                      parentSpan:(FSTraceSpan)parentSpan
+                      completion:(void (^)(BOOL isRewritten, NSError * error))completion {
+    
+    Firebase * messagesRef = [self.refCache refWithRoot:root collection:@"Chats" id:chatId leaf:kChatMessages];
+    
+    // Anchored On The Last Message Read -- It Comes Back Too, So Ask For One More
+    FQuery * windowQuery = [[messagesRef queryStartingAtPriority:priority andChildName:childName] queryLimitedToNumberOfChildren:kMigrationMessageWindow + (childName ? 1 : 0)];
+    
+    FSMetrics * metrics = self.metrics;
+    FSTracer * tracer = self.tracer;
+    FSTraceSpan readSpan = [tracer beginSpan:"chat.migrateSchema.messages" parent:parentSpan];
+    [metrics recordRoundTrips:1];
+    [windowQuery observeSingleEventOfType:FEventTypeValue withBlock:^(FDataSnapshot *snapshot) {
+        [tracer endSpan:readSpan];
+        [self decode:^id{
+            return FSMigrationMessagesInSnapshot(snapshot, chatId, childName, version);
+        } inStream:stream completion:^(NSArray * window) {
+            
+            NSDictionary * values = window[0];
+            BOOL isLastWindow = [window[3] unsignedIntegerValue] < kMigrationMessageWindow;
+            void (^next)(void) = ^{
+                BOOL nowRewrote = rewrote || values.count > 0;
+                if (isLastWindow) {
+                    completion(nowRewrote, nil);
+                }
+                else {
+                    id lastPriority = window[2] != [NSNull new] ? window[2] : nil;
+                    [self migrateMessagesOfChatId:chatId inRoot:root afterPriority:lastPriority childName:window[1] toSchemaVersion:version rewrote:nowRewrote stream:stream parentSpan:parentSpan completion:completion];
+                }
+            };
+            
+            if (values.count == 0) {
+                next();
+                return;
+            }
+            
+            [metrics recordBytes:FSMetricsEstimatedBytes(values) forOperation:kFSOperationMigrateSchema];
+            [metrics recordRoundTrips:1];
+            [self.retrier updateChildValues:values onRef:messagesRef operation:kFSOperationMigrateSchema completion:^(NSError *error, Firebase *ref) {
+                dispatch_async(stateQueue, ^{
+                    if (error) completion(rewrote, error);
+                    else next();
+                });
+            }];
+        }];
+    } withCancelBlock:^(NSError *error) {
+        [tracer endSpan:readSpan];
+        dispatch_async(stateQueue, ^{
+            completion(rewrote, error);
+        });
+    }];
+}
+
+#pragma mark IMPORT
+
+// Push Id Shaped -- 8 Characters Of Milliseconds, Then 12 Of The Message's Place In Its Chat.  Sorts With Later Sends By Time, And A Rerun Gets The Same Key.
+static NSString * FSImportOrderingKey(double milliseconds, NSUInteger place) {
+    unichar chars[20];
+    uint64_t time = milliseconds > 0 ? (uint64_t)milliseconds : 0;
+    for (NSInteger i = 7; i >= 0; i--) {
+        chars[i] = [kImportKeyChars characterAtIndex:(NSUInteger)(time % 64)];
+        time /= 64;
+    }
+    for (NSInteger i = 19; i >= 8; i--) {
+        chars[i] = [kImportKeyChars characterAtIndex:place % 64];
+        place /= 64;
+    }
+    return [NSString stringWithCharacters:chars length:20];
+}
+
+/*
+ @[chat id, keys oldest first, stored messages by key, stored header] -- nil without a chat id.  Messages keep their order when timestamps tie.
+ */
+static NSArray * FSImportPreparedChat(NSDictionary * chat, FSChatSchemaVersion version, NSUInteger previewLength) {
+    NSString * chatId = chat[kImportChatId];
+    if (![chatId isKindOfClass:[NSString class]] || chatId.length == 0) return nil;
+    
+    NSArray * users = chat[kImportUsers];
+    NSArray * messages = [chat[kImportMessages] sortedArrayWithOptions:NSSortStable usingComparator:^NSComparisonResult(NSDictionary * a, NSDictionary * b) {
+        double aTime = [a[kMessageTimestamp] doubleValue];
+        double bTime = [b[kMessageTimestamp] doubleValue];
+        return aTime < bTime ? NSOrderedAscending : aTime > bTime ? NSOrderedDescending : NSOrderedSame;
+    }];
+    
+    NSString * createdAt = chat[kImportCreatedAt] ?: [messages firstObject][kMessageTimestamp] ?: TimeStamp;
+    NSMutableDictionary * header = [NSMutableDictionary new];
+    if (users.count > 0) header[kHeaderUsers] = users;
+    header[kHeaderLastMessage] = @"";
+    header[kHeaderCreatedAt] = createdAt;
+    
+    NSMutableArray * keys = [NSMutableArray arrayWithCapacity:messages.count];
+    NSMutableDictionary * values = [NSMutableDictionary dictionaryWithCapacity:messages.count];
+    for (NSUInteger i = 0; i < messages.count; i++) {
+        NSMutableDictionary * message = [messages[i] mutableCopy];
+        message[kMessageChatId] = chatId;
+        NSString * key = FSImportOrderingKey([message[kMessageTimestamp] doubleValue], i);
+        FSHeaderApplyMessage(header, message, key, previewLength);
+        
+        // Priority In Milliseconds, As A Send Stores It
+        NSMutableDictionary * stored = [FSChatSchemaEncodeMessage(message, version) mutableCopy];
+        if (message[kMessageTimestamp]) stored[@".priority"] = message[kMessageTimestamp];
+        [keys addObject:key];
+        values[key] = stored;
+    }
+    header[kHeaderMessageCount] = @(messages.count);
+    if (!header[kHeaderTimeStamp]) header[kHeaderTimeStamp] = createdAt;
+    
+    // Imported History Counts As Read
+    for (NSString * user in users) header[user] = header[kHeaderTimeStamp];
+    
+    return @[chatId, keys, values, FSChatSchemaEncodeHeader(header, version)];
+}
+
+// Values For @param root In One Write, Created On First Use
+static NSMutableDictionary * FSImportValuesForRoot(NSMutableDictionary * write, NSString * root) {
+    NSMutableDictionary * values = write[root];
+    if (!values) {
+        values = [NSMutableDictionary new];
+        write[root] = values;
+    }
+    return values;
+}
+
+- (void) importChats:(NSEnumerator *)chats
+      checkpointPath:(NSString *)checkpointPath
+   withProgressBlock:(void (^)(NSUInteger importedCount))progressBlock
+  andCompletionBlock:(void (^)(NSUInteger importedCount, NSError * error))completionBlock {
+    
+    // Measure The Whole Run
+    FSMetrics * metrics = self.metrics;
+    FSTracer * tracer = self.tracer;
+    NSTimeInterval start = FSMetricsNow();
+    FSTraceSpan importSpan = [tracer beginSpan:"chat.importChats" parent:FSTraceSpanNone];
+    
+    FSChatImport * run = [FSChatImport new];
+    run.chats = chats;
+    run.checkpointPath = checkpointPath;
+    run.span = importSpan;
+    run.finished = [NSMutableDictionary new];
+    if (progressBlock) run.progress = ^(NSUInteger importedCount) {
+        [self deliver:^{
+            progressBlock(importedCount);
+        }];
+    };
+    run.completion = ^(NSUInteger importedCount, NSError * error) {
+        [metrics recordOperation:kFSOperationImportChats latency:FSMetricsNow() - start error:error];
+        [tracer endSpan:importSpan];
+        if (completionBlock) [self deliver:^{
+            completionBlock(importedCount, error);
+        }];
+    };
+    
+    FSStateQueueAsync(stateQueue, ^{
+        
+        // Pick Up Where The Last Run Stopped -- Same Stream, Same Order
+        NSData * data = checkpointPath ? [NSData dataWithContentsOfFile:checkpointPath] : nil;
+        id saved = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:nil] : nil;
+        NSUInteger skip = [saved isKindOfClass:[NSDictionary class]] ? [saved[kImportCheckpointImported] unsignedIntegerValue] : 0;
+        while (run.taken < skip && [chats nextObject]) run.taken++;
+        run.imported = run.taken;
+        
+        [self fillImportWindowOfRun:run];
+    });
+}
+
+// Chunks Go Out Until importMaxInFlight Are Outstanding Or The Stream Runs Dry -- Finishes Once The Last Lands, Or After A Failure Once The Rest Have
+- (void) fillImportWindowOfRun:(FSChatImport *)run {
+    NSUInteger maxInFlight = MAX(self.importMaxInFlight, 1);
+    
+    while (!run.error && !run.isExhausted && run.inFlight < maxInFlight) {
+        NSUInteger first = run.taken;
+        NSArray * chunk = [self nextImportChunkOfRun:run];
+        if (chunk.count == 0) break;
+        
+        run.inFlight++;
+        [self writeImportChunk:chunk parentSpan:run.span completion:^(NSError *error) {
+            run.inFlight--;
+            if (error && !run.error) run.error = error;
+            if (!error) [self finishImportChunkAtIndex:first count:chunk.count ofRun:run];
+            [self fillImportWindowOfRun:run];
+        }];
+    }
+    
+    if (run.inFlight > 0 || run.isFinished || !(run.error || run.isExhausted)) return;
+    run.isFinished = YES;
+    run.completion(run.imported, run.error);
+}
+
+// Whole Chats Up To importBatchSize Messages, Or Chats -- One Bigger Than That Goes Alone
+- (NSArray *) nextImportChunkOfRun:(FSChatImport *)run {
+    NSUInteger batchSize = MAX(self.importBatchSize, 1);
+    NSUInteger previewLength = self.headerPreviewLength;
+    FSChatSchemaVersion version = self.schemaVersion;
+    
+    NSMutableArray * chunk = [NSMutableArray new];
+    NSUInteger messageCount = 0;
+    while (messageCount < batchSize && chunk.count < batchSize) {
+        NSDictionary * chat = run.pending ?: [run.chats nextObject];
+        run.pending = nil;
+        if (!chat) {
+            run.isExhausted = YES;
+            break;
+        }
+        
+        NSUInteger count = [chat[kImportMessages] count];
+        if (chunk.count > 0 && messageCount + count > batchSize) {
+            run.pending = chat;
+            break;
+        }
+        
+        // Stop Taking -- Whatever Came Before Still Goes In
+        NSArray * prepared = FSImportPreparedChat(chat, version, previewLength);
+        if (!prepared) {
+            run.error = [NSError errorWithDomain:kFSChatManagerErrorDomain
+                                            code:FSChatErrorImportInvalidChat
+                                        userInfo:@{NSLocalizedDescriptionKey: NSLocalizedString(kErrorImportInvalidChat, nil)}];
+            break;
+        }
+        [chunk addObject:prepared];
+        run.taken++;
+        messageCount += count;
+    }
+    return chunk;
+}
+
+// Messages And Headers, Then Each Member's Chat List, Then Their Change Feeds -- The Order A Created Chat Gets.  completion Runs On stateQueue.
+- (void) writeImportChunk:(NSArray *)chunk parentSpan:(FSTraceSpan)parentSpan completion:(void (^)(NSError * error))completion {
+    NSUInteger batchSize = MAX(self.importBatchSize, 1);
+    
+    // Writes In Order, Each Up To batchSize Messages -- A Chat's Header Goes With Its Last
+    NSMutableArray * writes = [NSMutableArray new];
+    NSMutableDictionary * write = [NSMutableDictionary new];
+    NSUInteger writeCount = 0;
+    NSMutableDictionary * chatIdsByUserId = [NSMutableDictionary new];
+    NSMutableDictionary * feedUserIdsByChatId = [NSMutableDictionary new];
+    
+    for (NSArray * chat in chunk) {
+        NSString * chatId = chat[0];
+        NSDictionary * values = chat[2];
+        NSString * root = [self rootForChatId:chatId];
+        
+        for (NSString * key in chat[1]) {
+            if (writeCount == batchSize) {
+                [writes addObject:write];
+                write = [NSMutableDictionary new];
+                writeCount = 0;
+            }
+            FSImportValuesForRoot(write, root)[[NSString stringWithFormat:@"Chats/%@/%@/%@", chatId, kChatMessages, key]] = values[key];
+            writeCount++;
+        }
+        FSImportValuesForRoot(write, root)[[NSString stringWithFormat:@"Chats/%@/%@", chatId, kChatHeader]] = chat[3];
+        
+        for (NSString * userId in FSChatSchemaDecodeHeader(chat[3])[kHeaderUsers]) {
+            if (!chatIdsByUserId[userId]) chatIdsByUserId[userId] = [NSMutableArray new];
+            [chatIdsByUserId[userId] addObject:chatId];
+        }
+        feedUserIdsByChatId[chatId] = [self changeFeedUsersForHeader:chat[3]] ?: @[];
+    }
+    [writes addObject:write];
+    
+    FSTracer * tracer = self.tracer;
+    FSTraceSpan chunkSpan = [tracer beginSpan:"chat.importChats.chunk" parent:parentSpan];
+    void (^finish)(NSError *) = ^(NSError * error) {
+        [tracer endSpan:chunkSpan];
+        completion(error);
+    };
+    
+    [self writeImportValues:writes atIndex:0 completion:^(NSError *error) {
+        if (error) {
+            finish(error);
+            return;
+        }
+        [self addChatIdsByUserId:chatIdsByUserId completion:^(NSError *error) {
+            if (error) {
+                finish(error);
+                return;
+            }
+            [self recordChangesOfChatIds:feedUserIdsByChatId completion:finish];
+        }];
+    }];
+}
+
+// One Multi-Location Write Per Database, The Next Once All Have Landed.  completion Runs On stateQueue.
+- (void) writeImportValues:(NSArray *)writes atIndex:(NSUInteger)index completion:(void (^)(NSError * error))completion {
+    if (index == writes.count) {
+        completion(nil);
+        return;
+    }
+    
+    NSDictionary * write = writes[index];
+    FSMetrics * metrics = self.metrics;
+    __block NSUInteger remaining = write.count;
+    __block NSError * firstError;
+    for (NSString * root in write) {
+        [metrics recordBytes:FSMetricsEstimatedBytes(write[root]) forOperation:kFSOperationImportChats];
+        [metrics recordRoundTrips:1];
+        [self.retrier updateChildValues:write[root] onRef:[self.refCache rootRefForURL:root] operation:kFSOperationImportChats completion:^(NSError *error, Firebase *ref) {
+            dispatch_async(stateQueue, ^{
+                if (error && !firstError) firstError = error;
+                if (--remaining > 0) return;
+                if (firstError) completion(firstError);
+                else [self writeImportValues:writes atIndex:index + 1 completion:completion];
+            });
+        }];
+    }
+}
+
+// One Transaction Per User For All Their Chats -- Ids Already Listed Aren't Added Again.  completion Runs On stateQueue.
+- (void) addChatIdsByUserId:(NSDictionary *)chatIdsByUserId completion:(void (^)(NSError * error))completion {
+    if (chatIdsByUserId.count == 0) {
+        completion(nil);
+        return;
+    }
+    
+    __block NSUInteger remaining = chatIdsByUserId.count;
+    __block NSError * firstError;
+    for (NSString * userId in chatIdsByUserId) {
+        NSArray * chatIds = chatIdsByUserId[userId];
+        Firebase * chatsRef = [self.refCache refWithRoot:[self rootForUserId:userId] collection:@"Users" id:userId leaf:@"chats"];
+        [self.metrics recordRoundTrips:1];
+        [self.retrier runTransactionOnRef:chatsRef operation:kFSOperationUpdateUserChats block:^FTransactionResult *(FMutableData *currentData) {
+            NSMutableArray * chatsArray = currentData.value != [NSNull new] ? [currentData.value mutableCopy] : [NSMutableArray new];
+            for (NSString * chatId in chatIds) {
+                if (![chatsArray containsObject:chatId]) [chatsArray addObject:chatId];
+            }
+            [currentData setValue:chatsArray];
+            return [FTransactionResult successWithValue:currentData];
+        } completion:^(NSError *error, BOOL committed, FDataSnapshot *snapshot) {
+            dispatch_async(stateQueue, ^{
+                if (error && !firstError) firstError = error;
+                if (--remaining > 0) return;
+                completion(firstError);
+            });
+        }];
+    }
+}
+
+// Advance The Count Past Every Chunk Finished Without A Gap, Then Save It
+- (void) finishImportChunkAtIndex:(NSUInteger)index count:(NSUInteger)count ofRun:(FSChatImport *)run {
+    run.finished[@(index)] = @(count);
+    
+    NSUInteger imported = run.imported;
+    NSNumber * next;
+    while ((next = run.finished[@(run.imported)])) {
+        [run.finished removeObjectForKey:@(run.imported)];
+        run.imported += [next unsignedIntegerValue];
+    }
+    if (run.imported == imported) return;
+    
+    // Replaced Atomically -- A Crash Redoes At Most The Chunks In Flight
+    if (run.checkpointPath) {
+        NSData * data = [NSJSONSerialization dataWithJSONObject:@{kImportCheckpointImported: @(run.imported)} options:0 error:nil];
+        if (![data writeToFile:run.checkpointPath atomically:YES]) NSLog(@"ChatManager: Failed To Save Import Checkpoint To %@", run.checkpointPath);
+    }
+    if (run.progress) run.progress(run.imported);
+}
+
+#pragma mark PROMISES
+
+- (FSPromise *) createNewChatForUsers:(NSArray *)users withCustomId:(NSString *)customId {
+    FSPromise * promise = [FSPromise promise];
+    [self createNewChatForUsers:users withCustomId:customId andCompletionBlock:promise.resolver];
+    return promise;
+}
+
+- (FSPromise *) addUserId:(NSString *)userId toChatId:(NSString *)chatId {
+    FSPromise * promise = [FSPromise promise];
+    [self addUserId:userId toChatId:chatId withCompletionBlock:promise.resolver];
+    return promise;
+}
+
+- (FSPromise *) chatHeadersForUserId:(NSString *)userId {
+    FSPromise * promise = [FSPromise promise];
+    [self getChatHeadersForUserId:userId WithCompletionBlock:^(NSArray *headers, NSError *error) {
+        promise.resolver(error ? nil : headers ?: @[], error);
+    }];
+    return promise;
+}
+
+- (FSPromise *) openChatSessionWithChatId:(NSString *)chatId andNumberOfRecentMessages:(int)numberOfMessages {
+    return [self openChatSessionWithChatId:chatId andNumberOfRecentMessages:numberOfMessages resume:NO];
+}
+
+- (FSPromise *) reopenChatSessionWithChatId:(NSString *)chatId andNumberOfRecentMessages:(int)numberOfMessages {
+    return [self openChatSessionWithChatId:chatId andNumberOfRecentMessages:numberOfMessages resume:YES];
+}
+
+- (FSPromise *) openChatSessionWithChatId:(NSString *)chatId andNumberOfRecentMessages:(int)numberOfMessages resume:(BOOL)resume {
+    FSPromise * promise = [FSPromise promise];
+    
+    // Remembered So Cancel Only Ends The Session It Started
+    __block NSUInteger loadSession = NSNotFound;
+    FSStateQueueAsync(stateQueue, ^{
+        if ([self loadChatSessionOnStateQueueWithChatId:chatId andNumberOfRecentMessages:numberOfMessages resume:resume completion:promise.resolver]) {
+            loadSession = session;
+        }
+    });
+    
+    [promise addCancelBlock:^{
+        FSStateQueueAsync(stateQueue, ^{
+            if (loadSession != session) return;
+            
+            // Drop Load Callbacks Still In Flight -- The End Below Removes Any Queries
+            if (isLoadingSession) {
+                session++;
+                [self.tracer endSpan:loadSpan];
+            }
+            [self endChatSessionOnStateQueueWithCompletionBlock:nil];
+        });
+    }];
+    return promise;
+}
+
+- (FSPromise *) endChatSession {
+    FSPromise * promise = [FSPromise promise];
+    [self endChatSessionWithCompletionBlock:^(NSError *error) {
+        promise.resolver([NSNull null], error);
+    }];
+    return promise;
+}
+
+- (FSPromise *) sendMessage:(NSString *)content {
+    FSPromise * promise = [FSPromise promise];
+    FSStateQueueAsync(stateQueue, ^{
+        [self sendNewMessageOnStateQueue:content completion:promise.resolver];
+    });
+    return promise;
+}
+
+- (FSPromise *) chatHeaderChangesForUserId:(NSString *)userId sinceWatermark:(NSNumber *)watermark {
+    FSPromise * promise = [FSPromise promise];
+    [self getChatHeaderChangesForUserId:userId sinceWatermark:watermark withCompletionBlock:^(NSDictionary *headers, NSNumber *newWatermark, NSError *error) {
+        promise.resolver(error ? nil : @{kResponseHeaders: headers ?: @{}, kResponseWatermark: newWatermark}, error);
+    }];
+    return promise;
+}
+
+- (FSPromise *) compactChatWithId:(NSString *)chatId olderThan:(NSTimeInterval)age {
+    FSPromise * promise = [FSPromise promise];
+    [self compactChatWithId:chatId olderThan:age withCompletionBlock:^(NSUInteger archivedCount, NSError *error) {
+        promise.resolver(error ? nil : @(archivedCount), error);
+    }];
+    return promise;
+}
+
+- (FSPromise *) messagesForChatId:(NSString *)chatId beforeTimestamp:(NSString *)timestamp count:(NSUInteger)count {
+    FSPromise * promise = [FSPromise promise];
+    [self getMessagesForChatId:chatId beforeTimestamp:timestamp count:count withCompletionBlock:promise.resolver];
+    return promise;
+}
+
+- (FSPromise *) migrateChatsToSchemaVersion:(FSChatSchemaVersion)version {
+    FSPromise * promise = [FSPromise promise];
+    [self migrateChatsToSchemaVersion:version withCompletionBlock:^(NSUInteger migratedCount, NSError *error) {
+        promise.resolver(error ? nil : @(migratedCount), error);
+    }];
+    return promise;
+}
+
+- (FSPromise *) prefetchChatsWithHeaders:(NSDictionary *)headers {
+    FSPromise * promise = [FSPromise promise];
+    [self prefetchChatsWithHeaders:headers withCompletionBlock:^(NSUInteger prefetchedCount, NSError *error) {
+        promise.resolver(error ? nil : @(prefetchedCount), error);
+    }];
+    return promise;
+}
+
+- (FSPromise *) importChats:(NSEnumerator *)chats checkpointPath:(NSString *)checkpointPath {
+    FSPromise * promise = [FSPromise promise];
+    [self importChats:chats checkpointPath:checkpointPath withProgressBlock:nil andCompletionBlock:^(NSUInteger importedCount, NSError *error) {
+        promise.resolver(error ? nil : @(importedCount), error);
+    }];
+    return promise;
 }
 
 @end
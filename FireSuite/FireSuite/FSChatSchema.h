@@ -0,0 +1,61 @@
+//
+//  FSChatSchema.h
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#pragma mark CONSTANTS
+
+typedef enum {
+    FSChatSchemaVersion1 = 1,
+    FSChatSchemaVersion2 = 2,
+} FSChatSchemaVersion;
+
+// Header Key -- Only Written By Version 2 And Later, As A Number; Headers Without It Are Version 1
+FOUNDATION_EXPORT NSString *const kHeaderSchemaVersion;
+
+#pragma mark SCHEMA
+
+/*
+ How headers and messages are stored.  Everything above the wire -- delegates, responses, the outbox, the archive -- sees version 1 keys (kHeader..., kMessage...), with each user's timestamp a top-level header key named by their id.
+
+ Version 2 stores the same values under one-letter keys, nests user timestamps in one map and drops kMessageChatId, which the message's path already names.  Its top level only holds fields, so no user id can be read as one.  Keys it doesn't know pass through unchanged.
+ */
+
+/*!
+ The version @param header is stored in -- anything that isn't a version 2 header is version 1.  A version 1 member whose id is kHeaderSchemaVersion doesn't make it version 2.
+ */
+FOUNDATION_EXPORT FSChatSchemaVersion FSChatSchemaVersionOfHeader(id header);
+
+/*!
+ A stored header of either version with version 1 keys -- mutable, nested values untouched.  nil for NSNull.
+ */
+FOUNDATION_EXPORT NSMutableDictionary * FSChatSchemaDecodeHeader(id header);
+
+/*!
+ @param header with version 1 keys, as stored in @param version
+ */
+FOUNDATION_EXPORT NSDictionary * FSChatSchemaEncodeHeader(NSDictionary * header, FSChatSchemaVersion version);
+
+/*!
+ Where @param key -- a kHeader... key or a user id -- is stored in @param version, for writing one header value directly.  May be a path.
+ */
+FOUNDATION_EXPORT NSString * FSChatSchemaHeaderKey(NSString * key, FSChatSchemaVersion version);
+
+/*!
+ A stored message or header preview of either version with version 1 keys -- mutable.  @param chatId fills kMessageChatId when the stored copy leaves it out; nil for previews.  nil for NSNull.
+ */
+FOUNDATION_EXPORT NSMutableDictionary * FSChatSchemaDecodeMessage(id message, NSString * chatId);
+
+/*!
+ @param message with version 1 keys, as stored in @param version
+ */
+FOUNDATION_EXPORT NSDictionary * FSChatSchemaEncodeMessage(NSDictionary * message, FSChatSchemaVersion version);
+
+/*!
+ YES if @param message, as stored, is already in @param version
+ */
+FOUNDATION_EXPORT BOOL FSChatSchemaMessageIsInVersion(id message, FSChatSchemaVersion version);
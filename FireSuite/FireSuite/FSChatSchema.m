@@ -0,0 +1,211 @@
+//
+//  FSChatSchema.m
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import "FSChatSchema.h"
+#import "FSChatManager.h"
+
+#pragma mark CONSTANTS
+
+NSString *const kHeaderSchemaVersion = @"v";
+
+// Version 2 Header Keys
+static NSString *const kV2HeaderLastMessage = @"l";
+static NSString *const kV2HeaderTimeStamp = @"t";
+static NSString *const kV2HeaderCreatedAt = @"c";
+static NSString *const kV2HeaderUsers = @"u";
+static NSString *const kV2HeaderMessageCount = @"n";
+static NSString *const kV2HeaderOutboxSequences = @"q";
+static NSString *const kV2HeaderArchivedCount = @"a";
+static NSString *const kV2HeaderUserTimestamps = @"s";
+
+// Version 2 Message Keys -- Previews Share Them
+static NSString *const kV2MessageContent = @"c";
+static NSString *const kV2MessageSentBy = @"b";
+static NSString *const kV2MessageSentTo = @"r";
+static NSString *const kV2MessageTimestamp = @"t";
+static NSString *const kV2MessageHasViewed = @"h";
+static NSString *const kV2MessageId = @"i";
+static NSString *const kV2PreviewTruncated = @"x";
+
+#pragma mark KEY MAPS
+
+// Version 1 Key -> Version 2 Key
+static NSDictionary * FSChatSchemaV2HeaderKeys(void) {
+    static dispatch_once_t pred;
+    static NSDictionary * keys;
+    dispatch_once(&pred, ^{
+        keys = @{
+                 kHeaderLastMessage: kV2HeaderLastMessage,
+                 kHeaderTimeStamp: kV2HeaderTimeStamp,
+                 kHeaderCreatedAt: kV2HeaderCreatedAt,
+                 kHeaderUsers: kV2HeaderUsers,
+                 kHeaderMessageCount: kV2HeaderMessageCount,
+                 kHeaderOutboxSequences: kV2HeaderOutboxSequences,
+                 kHeaderArchivedCount: kV2HeaderArchivedCount,
+                 };
+    });
+    return keys;
+}
+
+static NSDictionary * FSChatSchemaV2MessageKeys(void) {
+    static dispatch_once_t pred;
+    static NSDictionary * keys;
+    dispatch_once(&pred, ^{
+        keys = @{
+                 kMessageContent: kV2MessageContent,
+                 kMessageSentBy: kV2MessageSentBy,
+                 kMessageSentTo: kV2MessageSentTo,
+                 kMessageTimestamp: kV2MessageTimestamp,
+                 kMessageHasViewed: kV2MessageHasViewed,
+                 kMessageId: kV2MessageId,
+                 kPreviewTruncated: kV2PreviewTruncated,
+                 };
+    });
+    return keys;
+}
+
+// Version 2 Key -> Version 1 Key
+static NSDictionary * FSChatSchemaInvertedKeys(NSDictionary * keys) {
+    NSMutableDictionary * inverted = [NSMutableDictionary dictionaryWithCapacity:keys.count];
+    for (NSString * key in keys) inverted[keys[key]] = key;
+    return inverted;
+}
+
+static NSDictionary * FSChatSchemaV1HeaderKeys(void) {
+    static dispatch_once_t pred;
+    static NSDictionary * keys;
+    dispatch_once(&pred, ^{
+        keys = FSChatSchemaInvertedKeys(FSChatSchemaV2HeaderKeys());
+    });
+    return keys;
+}
+
+static NSDictionary * FSChatSchemaV1MessageKeys(void) {
+    static dispatch_once_t pred;
+    static NSDictionary * keys;
+    dispatch_once(&pred, ^{
+        keys = FSChatSchemaInvertedKeys(FSChatSchemaV2MessageKeys());
+    });
+    return keys;
+}
+
+#pragma mark HEADERS
+
+// A Version 1 Member Named Like The Marker Holds A Timestamp, And Is Listed In kHeaderUsers -- Version 2 Lists Users Under Its Own Key
+FSChatSchemaVersion FSChatSchemaVersionOfHeader(id header) {
+    if (![header isKindOfClass:[NSDictionary class]]) return FSChatSchemaVersion1;
+
+    id marker = header[kHeaderSchemaVersion];
+    if (![marker isKindOfClass:[NSNumber class]] || [marker integerValue] != FSChatSchemaVersion2) return FSChatSchemaVersion1;
+    if ([header[kHeaderUsers] isKindOfClass:[NSArray class]] && [header[kHeaderUsers] containsObject:kHeaderSchemaVersion]) return FSChatSchemaVersion1;
+    return FSChatSchemaVersion2;
+}
+
+NSMutableDictionary * FSChatSchemaDecodeHeader(id header) {
+    if (![header isKindOfClass:[NSDictionary class]]) return nil;
+    if (FSChatSchemaVersionOfHeader(header) == FSChatSchemaVersion1) return [header mutableCopy];
+
+    // User Timestamps Only Come From Their Map -- A Top-Level Key Is Always A Field
+    NSMutableDictionary * decoded = [NSMutableDictionary dictionaryWithCapacity:[header count] + 2];
+    if ([header[kV2HeaderUserTimestamps] isKindOfClass:[NSDictionary class]]) {
+        [decoded addEntriesFromDictionary:header[kV2HeaderUserTimestamps]];
+    }
+
+    NSDictionary * keys = FSChatSchemaV1HeaderKeys();
+    for (NSString * key in header) {
+        if ([key isEqualToString:kHeaderSchemaVersion] || [key isEqualToString:kV2HeaderUserTimestamps]) continue;
+
+        // Unknown Keys Pass Through, But Never Over A User's Timestamp
+        NSString * v1Key = keys[key] ?: key;
+        if (!keys[key] && decoded[v1Key]) continue;
+        id value = header[key];
+        if ([v1Key isEqualToString:kHeaderLastMessage] && [value isKindOfClass:[NSDictionary class]]) {
+            value = FSChatSchemaDecodeMessage(value, nil);
+        }
+        decoded[v1Key] = value;
+    }
+    return decoded;
+}
+
+NSDictionary * FSChatSchemaEncodeHeader(NSDictionary * header, FSChatSchemaVersion version) {
+    if (version < FSChatSchemaVersion2) return header;
+
+    NSMutableDictionary * encoded = [NSMutableDictionary dictionaryWithCapacity:header.count];
+    NSMutableDictionary * userTimestamps = [NSMutableDictionary new];
+    encoded[kHeaderSchemaVersion] = @(FSChatSchemaVersion2);
+
+    // Every Key That Isn't Fixed Is A User's Timestamp, As In Version 1
+    NSDictionary * keys = FSChatSchemaV2HeaderKeys();
+    for (NSString * key in header) {
+        if ([key isEqualToString:kHeaderSchemaVersion]) continue;
+
+        id value = header[key];
+        NSString * v2Key = keys[key];
+        if (!v2Key) {
+            userTimestamps[key] = value;
+            continue;
+        }
+        if ([key isEqualToString:kHeaderLastMessage] && [value isKindOfClass:[NSDictionary class]]) {
+            value = FSChatSchemaEncodeMessage(value, version);
+        }
+        encoded[v2Key] = value;
+    }
+
+    if (userTimestamps.count > 0) encoded[kV2HeaderUserTimestamps] = userTimestamps;
+    return encoded;
+}
+
+NSString * FSChatSchemaHeaderKey(NSString * key, FSChatSchemaVersion version) {
+    if (version < FSChatSchemaVersion2) return key;
+
+    // Anything That Isn't Fixed Is A User's Timestamp
+    NSString * v2Key = FSChatSchemaV2HeaderKeys()[key];
+    return v2Key ?: [NSString stringWithFormat:@"%@/%@", kV2HeaderUserTimestamps, key];
+}
+
+#pragma mark MESSAGES
+
+// Every Version 1 Message Carries kMessageTimestamp -- Version 2 Never Does
+static BOOL FSChatSchemaIsV1Message(NSDictionary * message) {
+    return message[kMessageTimestamp] != nil;
+}
+
+NSMutableDictionary * FSChatSchemaDecodeMessage(id message, NSString * chatId) {
+    if (![message isKindOfClass:[NSDictionary class]]) return nil;
+
+    NSMutableDictionary * decoded;
+    if (FSChatSchemaIsV1Message(message)) {
+        decoded = [message mutableCopy];
+    }
+    else {
+        NSDictionary * keys = FSChatSchemaV1MessageKeys();
+        decoded = [NSMutableDictionary dictionaryWithCapacity:[message count] + 1];
+        for (NSString * key in message) {
+            decoded[keys[key] ?: key] = message[key];
+        }
+    }
+
+    if (chatId && !decoded[kMessageChatId]) decoded[kMessageChatId] = chatId;
+    return decoded;
+}
+
+NSDictionary * FSChatSchemaEncodeMessage(NSDictionary * message, FSChatSchemaVersion version) {
+    if (version < FSChatSchemaVersion2) return message;
+
+    NSDictionary * keys = FSChatSchemaV2MessageKeys();
+    NSMutableDictionary * encoded = [NSMutableDictionary dictionaryWithCapacity:message.count];
+    for (NSString * key in message) {
+        if ([key isEqualToString:kMessageChatId]) continue;
+        encoded[keys[key] ?: key] = message[key];
+    }
+    return encoded;
+}
+
+BOOL FSChatSchemaMessageIsInVersion(id message, FSChatSchemaVersion version) {
+    if (![message isKindOfClass:[NSDictionary class]]) return YES;
+    return FSChatSchemaIsV1Message(message) == (version < FSChatSchemaVersion2);
+}
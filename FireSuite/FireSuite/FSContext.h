@@ -0,0 +1,74 @@
+//
+//  FSContext.h
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "FSChatManager.h"
+#import "FSPresenceManager.h"
+#import "FSChannelManager.h"
+
+/*!
+ One user against one database -- its own managers, ref cache and metrics, so many can run side by side in one process.  FireSuite's class methods use defaultContext.
+ */
+@interface FSContext : NSObject
+
+/*!
+ Wraps the manager singletons
+ */
++ (FSContext *) defaultContext;
+
++ (instancetype) contextWithFirebaseURL:(NSString *)firebaseURL currentUserId:(NSString *)currentUserId;
+
+/*!
+ Pushed into every manager -- a trailing slash is added if missing
+ */
+@property (strong, nonatomic) NSString * firebaseURL;
+@property (strong, nonatomic) NSString * currentUserId;
+
+/*!
+ Spread chats and users over several databases -- firebaseURL defaults to the first one
+ */
+@property (strong, nonatomic) FSShardRouter * shardRouter;
+
+/*!
+ Where every manager delivers delegate calls, completions and observer selectors -- defaults to the main queue
+ */
+@property (strong, nonatomic) dispatch_queue_t callbackQueue;
+
+/*!
+ Journals this user's sends and alerts, draining on reconnect to firebaseURL or any of shardRouter's databases -- one outbox per context
+ */
+@property (strong, nonatomic) FSOutbox * outbox;
+
+@property (strong, nonatomic, readonly) FSChatManager * chatManager;
+@property (strong, nonatomic, readonly) FSPresenceManager * presenceManager;
+@property (strong, nonatomic, readonly) FSChannelManager * channelManager;
+
+@property (strong, nonatomic, readonly) FSRefCache * refCache;
+@property (strong, nonatomic, readonly) FSMetrics * metrics;
+
+/*!
+ Retries failed writes and transactions for every manager, under one budget -- reports to metrics
+ */
+@property (strong, nonatomic, readonly) FSRetrier * retrier;
+
+/*!
+ Paces this user's sends, per chat and overall -- off until a rate is set
+ */
+@property (strong, nonatomic, readonly) FSRateLimiter * rateLimiter;
+
+/*!
+ One listener per path for every manager -- presence, the chat monitor and alerts share this user's .info/connected and Users/ listeners
+ */
+@property (strong, nonatomic, readonly) FSEventHub * eventHub;
+
+/*!
+ Shared by every context -- spans from all users land in one trace
+ */
+@property (strong, nonatomic, readonly) FSTracer * tracer;
+
+@end
@@ -0,0 +1,184 @@
+//
+//  FSContext.m
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import "FSContext.h"
+
+// A Context Touches A Handful Of Paths -- Keep Thousands Of Them Small
+static NSUInteger const kContextRefCacheCapacity = 64;
+
+@interface FSContext ()
+
+@property (strong, nonatomic, readwrite) FSChatManager * chatManager;
+@property (strong, nonatomic, readwrite) FSPresenceManager * presenceManager;
+@property (strong, nonatomic, readwrite) FSChannelManager * channelManager;
+
+@property (strong, nonatomic, readwrite) FSRefCache * refCache;
+@property (strong, nonatomic, readwrite) FSMetrics * metrics;
+@property (strong, nonatomic, readwrite) FSRetrier * retrier;
+@property (strong, nonatomic, readwrite) FSRateLimiter * rateLimiter;
+@property (strong, nonatomic, readwrite) FSEventHub * eventHub;
+@property (strong, nonatomic, readwrite) FSTracer * tracer;
+
+@end
+
+@implementation FSContext
+
+#pragma mark DEFAULT CONTEXT
+
++ (FSContext *) defaultContext {
+    static dispatch_once_t pred;
+    static FSContext *shared = nil;
+    
+    dispatch_once(&pred, ^{
+        shared = [[FSContext alloc] initWithChatManager:[FSChatManager singleton]
+                                        presenceManager:[FSPresenceManager singleton]
+                                         channelManager:[FSChannelManager singleton]
+                                               refCache:[FSRefCache singleton]
+                                                metrics:[FSMetrics singleton]
+                                                retrier:[FSRetrier singleton]
+                                            rateLimiter:[FSRateLimiter singleton]
+                                               eventHub:[FSEventHub singleton]];
+    });
+    return shared;
+}
+
+#pragma mark INIT
+
++ (instancetype) contextWithFirebaseURL:(NSString *)firebaseURL currentUserId:(NSString *)currentUserId {
+    FSContext * context = [[self alloc] init];
+    context.firebaseURL = firebaseURL;
+    context.currentUserId = currentUserId;
+    return context;
+}
+
+- (instancetype) init {
+    return [self initWithChatManager:[FSChatManager new]
+                     presenceManager:[FSPresenceManager new]
+                      channelManager:[FSChannelManager new]
+                            refCache:[[FSRefCache alloc] initWithCapacity:kContextRefCacheCapacity]
+                             metrics:[FSMetrics new]
+                             retrier:[FSRetrier new]
+                         rateLimiter:[FSRateLimiter new]
+                            eventHub:[FSEventHub new]];
+}
+
+- (instancetype) initWithChatManager:(FSChatManager *)chatManager
+                     presenceManager:(FSPresenceManager *)presenceManager
+                      channelManager:(FSChannelManager *)channelManager
+                            refCache:(FSRefCache *)refCache
+                             metrics:(FSMetrics *)metrics
+                             retrier:(FSRetrier *)retrier
+                         rateLimiter:(FSRateLimiter *)rateLimiter
+                            eventHub:(FSEventHub *)eventHub {
+    self = [super init];
+    if (self) {
+        _chatManager = chatManager;
+        _presenceManager = presenceManager;
+        _channelManager = channelManager;
+        _refCache = refCache;
+        _metrics = metrics;
+        _retrier = retrier;
+        _retrier.metrics = metrics;
+        _rateLimiter = rateLimiter;
+        _rateLimiter.metrics = metrics;
+        _eventHub = eventHub;
+        _eventHub.refCache = refCache;
+        _eventHub.metrics = metrics;
+        _tracer = [FSTracer singleton];
+        _callbackQueue = dispatch_get_main_queue();
+        
+        // Wire Managers To Our Tools
+        _chatManager.refCache = refCache;
+        _chatManager.metrics = metrics;
+        _chatManager.retrier = retrier;
+        _chatManager.tracer = _tracer;
+        _chatManager.channelManager = channelManager;
+        _chatManager.rateLimiter = rateLimiter;
+        _chatManager.eventHub = eventHub;
+        
+        _presenceManager.refCache = refCache;
+        _presenceManager.metrics = metrics;
+        _presenceManager.retrier = retrier;
+        _presenceManager.tracer = _tracer;
+        _presenceManager.eventHub = eventHub;
+        
+        _channelManager.refCache = refCache;
+        _channelManager.metrics = metrics;
+        _channelManager.retrier = retrier;
+        _channelManager.tracer = _tracer;
+        _channelManager.eventHub = eventHub;
+    }
+    return self;
+}
+
+#pragma mark SET URL & CURRENT USER ID
+
+- (void) setFirebaseURL:(NSString *)firebaseURL {
+    
+    if (firebaseURL && ![firebaseURL hasSuffix:@"/"]) {
+        firebaseURL = [NSString stringWithFormat:@"%@/", firebaseURL];
+    }
+    _firebaseURL = firebaseURL;
+    
+    // Set Our Tools
+    _chatManager.urlRefString = firebaseURL;
+    _presenceManager.urlRefString = firebaseURL;
+    _channelManager.urlRefString = firebaseURL;
+    [_outbox drainOnReconnectToURLs:[self outboxDatabaseURLs]];
+}
+
+- (void) setShardRouter:(FSShardRouter *)shardRouter {
+    _shardRouter = shardRouter;
+    
+    // Unrouted Work -- Auto Ids -- Still Needs A Root
+    if (!_firebaseURL) self.firebaseURL = shardRouter.databaseURLs[0];
+    
+    // Set Our Tools
+    _chatManager.shardRouter = shardRouter;
+    _presenceManager.shardRouter = shardRouter;
+    _channelManager.shardRouter = shardRouter;
+    [_outbox drainOnReconnectToURLs:[self outboxDatabaseURLs]];
+}
+
+// Every Database A Batch Can Be Routed To -- Each One's Reconnect Restarts The Outbox
+- (NSArray *) outboxDatabaseURLs {
+    NSMutableOrderedSet * urls = [NSMutableOrderedSet orderedSetWithArray:_shardRouter.databaseURLs ?: @[]];
+    if (_firebaseURL) [urls addObject:_firebaseURL];
+    return urls.array;
+}
+
+- (void) setCallbackQueue:(dispatch_queue_t)callbackQueue {
+    _callbackQueue = callbackQueue;
+    
+    // Set Our Tools
+    _chatManager.callbackQueue = callbackQueue;
+    _presenceManager.callbackQueue = callbackQueue;
+    _channelManager.callbackQueue = callbackQueue;
+    _rateLimiter.callbackQueue = callbackQueue;
+}
+
+- (void) setOutbox:(FSOutbox *)outbox {
+    [_outbox drainOnReconnectToURLs:nil];
+    _outbox = outbox;
+    
+    // Set Our Tools
+    _chatManager.outbox = outbox;
+    _channelManager.outbox = outbox;
+    outbox.eventHub = _eventHub;
+    [outbox drainOnReconnectToURLs:[self outboxDatabaseURLs]];
+}
+
+- (void) setCurrentUserId:(NSString *)currentUserId {
+    _currentUserId = currentUserId;
+    
+    // Set Our Tools
+    _chatManager.currentUserId = currentUserId;
+    _presenceManager.currentUserId = currentUserId;
+    _channelManager.currentUserId = currentUserId;
+}
+
+@end
@@ -0,0 +1,51 @@
+//
+//  FSDecodePool.h
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@class FSDecodeStream;
+
+/*!
+ Builds snapshot values off the queues that deliver them -- at most width decodes run at once, the rest wait their turn.  Shared by every context.
+ */
+@interface FSDecodePool : NSObject
+
+/*!
+ One decode per active processor
+ */
++ (FSDecodePool *) singleton;
+
+- (instancetype) initWithWidth:(NSUInteger)width;
+
+@property (nonatomic, readonly) NSUInteger width;
+
+/*!
+ Results come back on @param targetQueue in the order they were submitted
+ */
+- (FSDecodeStream *) streamWithTargetQueue:(dispatch_queue_t)targetQueue;
+
+#pragma mark STATS
+
+/*!
+ Waiting for a slot -- and running
+ */
+- (NSUInteger) pendingCount;
+- (NSUInteger) runningCount;
+
+@end
+
+/*!
+ One ordered sequence of decodes -- e.g. a query's children
+ */
+@interface FSDecodeStream : NSObject
+
+/*!
+ Runs @param decode on the pool, then @param completion with its result on the target queue -- after every earlier completion in this stream
+ */
+- (void) decode:(id (^)(void))decode completion:(void (^)(id value))completion;
+
+@end
@@ -0,0 +1,194 @@
+//
+//  FSDecodePool.m
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import "FSDecodePool.h"
+#import <pthread.h>
+
+#pragma mark POOL
+
+@interface FSDecodePool ()
+{
+    // Guards Pending And Running
+    pthread_mutex_t _lock;
+    NSMutableArray * _pending;
+    NSUInteger _running;
+}
+
+- (void) enqueueWork:(dispatch_block_t)work;
+
+@end
+
+#pragma mark STREAM
+
+@interface FSDecodeStream ()
+{
+    // Guards Sequence And Results -- And Dispatch Order To The Target Queue
+    pthread_mutex_t _lock;
+    uint64_t _nextSequence;
+    uint64_t _nextDelivery;
+    NSMutableDictionary * _finished;
+}
+
+@property (weak, nonatomic) FSDecodePool * pool;
+@property (strong, nonatomic) dispatch_queue_t targetQueue;
+
+@end
+
+@implementation FSDecodeStream
+
+- (instancetype) init {
+    self = [super init];
+    if (self) {
+        _finished = [NSMutableDictionary new];
+        pthread_mutex_init(&_lock, NULL);
+    }
+    return self;
+}
+
+- (void) dealloc {
+    pthread_mutex_destroy(&_lock);
+}
+
+- (void) decode:(id (^)(void))decode completion:(void (^)(id value))completion {
+
+    pthread_mutex_lock(&_lock);
+    uint64_t sequence = _nextSequence++;
+    pthread_mutex_unlock(&_lock);
+
+    // Pool Gone -- Decode Where We Deliver
+    FSDecodePool * pool = self.pool;
+    if (!pool) {
+        dispatch_async(_targetQueue, ^{
+            if (completion) completion(decode());
+        });
+        return;
+    }
+
+    [pool enqueueWork:^{
+        id value = decode();
+        [self finishSequence:sequence delivery:^{
+            if (completion) completion(value);
+        }];
+    }];
+}
+
+// Hand Over Everything Now In Order -- Later Results Wait For Earlier Ones
+- (void) finishSequence:(uint64_t)sequence delivery:(dispatch_block_t)delivery {
+
+    pthread_mutex_lock(&_lock);
+    _finished[@(sequence)] = delivery;
+
+    NSMutableArray * ready = [NSMutableArray new];
+    dispatch_block_t next;
+    while ((next = _finished[@(_nextDelivery)])) {
+        [ready addObject:next];
+        [_finished removeObjectForKey:@(_nextDelivery)];
+        _nextDelivery++;
+    }
+
+    // Dispatched Under The Lock, So Batches Arrive In Order Too
+    if (ready.count > 0) {
+        dispatch_async(_targetQueue, ^{
+            for (dispatch_block_t block in ready) block();
+        });
+    }
+    pthread_mutex_unlock(&_lock);
+}
+
+@end
+
+@implementation FSDecodePool
+
+#pragma mark SINGLETON
+
++ (FSDecodePool *) singleton {
+    static dispatch_once_t pred;
+    static FSDecodePool *shared = nil;
+
+    dispatch_once(&pred, ^{
+        shared = [[FSDecodePool alloc] initWithWidth:[[NSProcessInfo processInfo] activeProcessorCount]];
+    });
+    return shared;
+}
+
+- (instancetype) init {
+    return [self initWithWidth:[[NSProcessInfo processInfo] activeProcessorCount]];
+}
+
+- (instancetype) initWithWidth:(NSUInteger)width {
+    self = [super init];
+    if (self) {
+        _width = MAX(width, 1);
+        _pending = [NSMutableArray new];
+        pthread_mutex_init(&_lock, NULL);
+    }
+    return self;
+}
+
+- (void) dealloc {
+    pthread_mutex_destroy(&_lock);
+}
+
+- (FSDecodeStream *) streamWithTargetQueue:(dispatch_queue_t)targetQueue {
+    FSDecodeStream * stream = [FSDecodeStream new];
+    stream.pool = self;
+    stream.targetQueue = targetQueue;
+    return stream;
+}
+
+#pragma mark WORK
+
+- (void) enqueueWork:(dispatch_block_t)work {
+    pthread_mutex_lock(&_lock);
+    [_pending addObject:[work copy]];
+    pthread_mutex_unlock(&_lock);
+    [self startWork];
+}
+
+// Fill Free Slots, Oldest First
+- (void) startWork {
+
+    pthread_mutex_lock(&_lock);
+    while (_running < _width && _pending.count > 0) {
+        dispatch_block_t work = _pending[0];
+        [_pending removeObjectAtIndex:0];
+        _running++;
+
+        dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            @autoreleasepool {
+                work();
+            }
+            [self finishWork];
+        });
+    }
+    pthread_mutex_unlock(&_lock);
+}
+
+- (void) finishWork {
+    pthread_mutex_lock(&_lock);
+    _running--;
+    pthread_mutex_unlock(&_lock);
+    [self startWork];
+}
+
+#pragma mark STATS
+
+- (NSUInteger) pendingCount {
+    pthread_mutex_lock(&_lock);
+    NSUInteger count = _pending.count;
+    pthread_mutex_unlock(&_lock);
+    return count;
+}
+
+- (NSUInteger) runningCount {
+    pthread_mutex_lock(&_lock);
+    NSUInteger count = _running;
+    pthread_mutex_unlock(&_lock);
+    return count;
+}
+
+@end
@@ -0,0 +1,78 @@
+//
+//  FSEventHub.h
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <Firebase/Firebase.h>
+#import "FSRefCache.h"
+#import "FSMetrics.h"
+
+#pragma mark CONSTANTS
+
+/*!
+ Names one observer -- 0 is never handed out
+ */
+typedef NSUInteger FSEventHubToken;
+
+#pragma mark EVENT HUB
+
+/*!
+ One Firebase listener per root / path / event type, shared by every manager observing it -- .info/connected for presence and the chat monitor, Users/{id}/alerts for alerts, Users/{id}/connections for each user watched.  Events are routed to observers by path; the listener opens with the first observer and closes with the last.
+
+ An observer joining a value listener that has already fired gets the last snapshot right away, as if it had its own.  Child listeners don't replay -- a late observer only hears children that arrive after it.
+
+ Blocks run on a private serial queue, in arrival order.  Listeners are counted in metrics here, not by the managers.
+ */
+@interface FSEventHub : NSObject
+
++ (FSEventHub *) singleton;
+
+/*!
+ Shared Firebase refs -- defaults to [FSRefCache singleton]
+ */
+@property (strong) FSRefCache * refCache;
+
+/*!
+ Receives listener counts and round trips -- defaults to [FSMetrics singleton]
+ */
+@property (strong) FSMetrics * metrics;
+
+/*!
+ Observe @param eventType at the ref FSRefCache names by @param rootURL, @param collection, @param identifier and @param leaf -- @param cancelBlock runs, and the observer is dropped, if Firebase cancels the listener
+ */
+- (FSEventHubToken) observeEventType:(FEventType)eventType
+                              atRoot:(NSString *)rootURL
+                          collection:(NSString *)collection
+                                  id:(NSString *)identifier
+                                leaf:(NSString *)leaf
+                           withBlock:(void (^)(FDataSnapshot * snapshot))block
+                     withCancelBlock:(void (^)(NSError * error))cancelBlock;
+
+- (FSEventHubToken) observeEventType:(FEventType)eventType
+                              atRoot:(NSString *)rootURL
+                          collection:(NSString *)collection
+                                  id:(NSString *)identifier
+                                leaf:(NSString *)leaf
+                           withBlock:(void (^)(FDataSnapshot * snapshot))block;
+
+/*!
+ Nothing reaches @param token's block once this returns, barring one already running -- the listener closes with its last observer
+ */
+- (void) removeObserverWithToken:(FSEventHubToken)token;
+
+#pragma mark STATS
+
+/*!
+ Firebase listeners open
+ */
+- (NSUInteger) listenerCount;
+
+/*!
+ Observers across them
+ */
+- (NSUInteger) observerCount;
+
+@end
@@ -0,0 +1,248 @@
+//
+//  FSEventHub.m
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import "FSEventHub.h"
+
+#pragma mark OBSERVER
+
+@interface FSEventObserver : NSObject
+
+@property (nonatomic) FSEventHubToken token;
+@property (copy, nonatomic) void (^block)(FDataSnapshot * snapshot);
+@property (copy, nonatomic) void (^cancelBlock)(NSError * error);
+
+// Set Under The Hub's Lock, Read On Its Queue
+@property (atomic) BOOL isRemoved;
+
+// Only Touched On The Hub's Queue
+@property (nonatomic) BOOL hasFired;
+
+@end
+
+@implementation FSEventObserver
+@end
+
+#pragma mark ROUTE
+
+@interface FSEventRoute : NSObject
+
+@property (strong, nonatomic) NSString * key;
+@property (strong, nonatomic) Firebase * ref;
+@property (nonatomic) FirebaseHandle handle;
+@property (nonatomic) FEventType eventType;
+@property (strong, nonatomic) NSMutableArray * observers;
+@property (nonatomic) BOOL isClosed;
+
+// Value Routes -- Only Touched On The Hub's Queue
+@property (strong, nonatomic) FDataSnapshot * lastSnapshot;
+
+@end
+
+@implementation FSEventRoute
+@end
+
+#pragma mark EVENT HUB
+
+@interface FSEventHub ()
+{
+    // Routes And Observers -- Guarded By @synchronized (self)
+    NSMutableDictionary * _routes;
+    NSMutableDictionary * _routesByToken;
+    FSEventHubToken _lastToken;
+
+    // Deliveries, In Arrival Order
+    dispatch_queue_t _queue;
+}
+
+@end
+
+@implementation FSEventHub
+
+#pragma mark SINGLETON
+
++ (FSEventHub *) singleton {
+    static dispatch_once_t pred;
+    static FSEventHub *shared = nil;
+
+    dispatch_once(&pred, ^{
+        shared = [[FSEventHub alloc] init];
+    });
+    return shared;
+}
+
+- (instancetype) init {
+    self = [super init];
+    if (self) {
+        _queue = dispatch_queue_create("com.firesuite.eventHub", DISPATCH_QUEUE_SERIAL);
+        _routes = [NSMutableDictionary new];
+        _routesByToken = [NSMutableDictionary new];
+        _refCache = [FSRefCache singleton];
+        _metrics = [FSMetrics singleton];
+    }
+    return self;
+}
+
+#pragma mark OBSERVE
+
+- (FSEventHubToken) observeEventType:(FEventType)eventType
+                              atRoot:(NSString *)rootURL
+                          collection:(NSString *)collection
+                                  id:(NSString *)identifier
+                                leaf:(NSString *)leaf
+                           withBlock:(void (^)(FDataSnapshot * snapshot))block {
+    return [self observeEventType:eventType atRoot:rootURL collection:collection id:identifier leaf:leaf withBlock:block withCancelBlock:nil];
+}
+
+- (FSEventHubToken) observeEventType:(FEventType)eventType
+                              atRoot:(NSString *)rootURL
+                          collection:(NSString *)collection
+                                  id:(NSString *)identifier
+                                leaf:(NSString *)leaf
+                           withBlock:(void (^)(FDataSnapshot * snapshot))block
+                     withCancelBlock:(void (^)(NSError * error))cancelBlock {
+
+    FSEventObserver * observer = [FSEventObserver new];
+    observer.block = block;
+    observer.cancelBlock = cancelBlock;
+
+    NSString * key = [NSString stringWithFormat:@"%@|%@|%@|%@|%ld", rootURL, collection, identifier ?: @"", leaf ?: @"", (long)eventType];
+    FSEventRoute * route;
+    BOOL isNewRoute = NO;
+
+    @synchronized (self) {
+        observer.token = ++_lastToken;
+
+        route = _routes[key];
+        if (!route) {
+            route = [FSEventRoute new];
+            route.key = key;
+            route.eventType = eventType;
+            route.observers = [NSMutableArray new];
+            route.ref = [self.refCache refWithRoot:rootURL collection:collection id:identifier leaf:leaf];
+            _routes[key] = route;
+            isNewRoute = YES;
+        }
+        [route.observers addObject:observer];
+        _routesByToken[@(observer.token)] = route;
+
+        // Opened Under The Lock -- The Last Observer Can't Leave Before The Handle Exists
+        if (isNewRoute) [self openRoute:route];
+    }
+
+    // Already Fired -- Hand Over The Last Value Unless A Live One Gets There First
+    if (!isNewRoute && eventType == FEventTypeValue) {
+        dispatch_async(_queue, ^{
+            if (!route.lastSnapshot || observer.hasFired) return;
+            [self deliverSnapshot:route.lastSnapshot toObserver:observer];
+        });
+    }
+
+    return observer.token;
+}
+
+// Must Be Called Under The Lock
+- (void) openRoute:(FSEventRoute *)route {
+    route.handle = [route.ref observeEventType:route.eventType withBlock:^(FDataSnapshot *snapshot) {
+        dispatch_async(_queue, ^{
+            [self route:route receivedSnapshot:snapshot];
+        });
+    } withCancelBlock:^(NSError *error) {
+        dispatch_async(_queue, ^{
+            [self route:route cancelledWithError:error];
+        });
+    }];
+
+    [self.metrics adjustListenerCount:1];
+    [self.metrics recordRoundTrips:1];
+}
+
+// Must Be Called Under The Lock -- Firebase Already Dropped A Cancelled Listener
+- (void) closeRoute:(FSEventRoute *)route removingListener:(BOOL)removesListener {
+    if (route.isClosed) return;
+    route.isClosed = YES;
+
+    if (_routes[route.key] == route) [_routes removeObjectForKey:route.key];
+    for (FSEventObserver * observer in route.observers) {
+        observer.isRemoved = YES;
+        [_routesByToken removeObjectForKey:@(observer.token)];
+    }
+    [route.observers removeAllObjects];
+
+    if (removesListener) [route.ref removeObserverWithHandle:route.handle];
+    [self.metrics adjustListenerCount:-1];
+}
+
+#pragma mark REMOVE
+
+- (void) removeObserverWithToken:(FSEventHubToken)token {
+    if (token == 0) return;
+
+    @synchronized (self) {
+        FSEventRoute * route = _routesByToken[@(token)];
+        if (!route) return;
+        [_routesByToken removeObjectForKey:@(token)];
+
+        for (FSEventObserver * observer in [NSArray arrayWithArray:route.observers]) {
+            if (observer.token == token) {
+                observer.isRemoved = YES;
+                [route.observers removeObject:observer];
+            }
+        }
+
+        if (route.observers.count == 0) [self closeRoute:route removingListener:YES];
+    }
+}
+
+#pragma mark DELIVER
+
+// Must Be Called On _queue
+- (void) route:(FSEventRoute *)route receivedSnapshot:(FDataSnapshot *)snapshot {
+    if (route.eventType == FEventTypeValue) route.lastSnapshot = snapshot;
+
+    NSArray * observers;
+    @synchronized (self) {
+        observers = [NSArray arrayWithArray:route.observers];
+    }
+    for (FSEventObserver * observer in observers) {
+        [self deliverSnapshot:snapshot toObserver:observer];
+    }
+}
+
+// Must Be Called On _queue
+- (void) route:(FSEventRoute *)route cancelledWithError:(NSError *)error {
+    NSArray * observers;
+    @synchronized (self) {
+        observers = [NSArray arrayWithArray:route.observers];
+        [self closeRoute:route removingListener:NO];
+    }
+    for (FSEventObserver * observer in observers) {
+        if (observer.cancelBlock) observer.cancelBlock(error);
+    }
+}
+
+// Must Be Called On _queue
+- (void) deliverSnapshot:(FDataSnapshot *)snapshot toObserver:(FSEventObserver *)observer {
+    if (observer.isRemoved) return;
+    observer.hasFired = YES;
+    observer.block(snapshot);
+}
+
+#pragma mark STATS
+
+- (NSUInteger) listenerCount {
+    @synchronized (self) {
+        return _routes.count;
+    }
+}
+
+- (NSUInteger) observerCount {
+    @synchronized (self) {
+        return _routesByToken.count;
+    }
+}
+
+@end
@@ -0,0 +1,154 @@
+//
+//  FSMetrics.h
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <Firebase/Firebase.h>
+
+#pragma mark CONSTANTS
+
+// Operation Keys
+FOUNDATION_EXPORT NSString *const kFSOperationCreateChat;
+FOUNDATION_EXPORT NSString *const kFSOperationAddUserToChat;
+FOUNDATION_EXPORT NSString *const kFSOperationUpdateUserChats;
+FOUNDATION_EXPORT NSString *const kFSOperationGetChatHeaders;
+FOUNDATION_EXPORT NSString *const kFSOperationGetChatHeaderChanges;
+FOUNDATION_EXPORT NSString *const kFSOperationRecordChatChange;
+FOUNDATION_EXPORT NSString *const kFSOperationLoadChatSession;
+FOUNDATION_EXPORT NSString *const kFSOperationEndChatSession;
+FOUNDATION_EXPORT NSString *const kFSOperationSendMessage;
+FOUNDATION_EXPORT NSString *const kFSOperationUpdateHeader;
+FOUNDATION_EXPORT NSString *const kFSOperationSendAlert;
+FOUNDATION_EXPORT NSString *const kFSOperationFanOutAlert;
+FOUNDATION_EXPORT NSString *const kFSOperationReceiveAlert;
+FOUNDATION_EXPORT NSString *const kFSOperationCompactArchive;
+FOUNDATION_EXPORT NSString *const kFSOperationLoadHistory;
+FOUNDATION_EXPORT NSString *const kFSOperationMigrateSchema;
+FOUNDATION_EXPORT NSString *const kFSOperationPrefetch;
+FOUNDATION_EXPORT NSString *const kFSOperationRateLimit;
+FOUNDATION_EXPORT NSString *const kFSOperationImportChats;
+FOUNDATION_EXPORT NSString *const kFSOperationPresenceConnect;
+FOUNDATION_EXPORT NSString *const kFSOperationPresenceDisconnect;
+
+// Snapshot Keys
+FOUNDATION_EXPORT NSString *const kMetricsRoundTrips;
+FOUNDATION_EXPORT NSString *const kMetricsTransactionAttempts;
+FOUNDATION_EXPORT NSString *const kMetricsTransactionRetries;
+FOUNDATION_EXPORT NSString *const kMetricsRetries;
+FOUNDATION_EXPORT NSString *const kMetricsRetriesDenied;
+FOUNDATION_EXPORT NSString *const kMetricsListeners;
+FOUNDATION_EXPORT NSString *const kMetricsObservers;
+FOUNDATION_EXPORT NSString *const kMetricsOperations;
+
+/*!
+ Monotonic enough for latency -- seconds
+ */
+FOUNDATION_EXPORT NSTimeInterval FSMetricsNow(void);
+
+/*!
+ Approximate JSON size of @param value without serializing it
+ */
+FOUNDATION_EXPORT NSUInteger FSMetricsEstimatedBytes(id value);
+
+#pragma mark HISTOGRAM
+
+/*!
+ Log-linear (HDR style) latency histogram -- 16 sub-buckets per power of two, ~6% precision from 1µs up.  Recording is lock free.
+ */
+@interface FSLatencyHistogram : NSObject
+
+- (void) recordLatency:(NSTimeInterval)seconds;
+
+- (uint64_t) count;
+- (NSTimeInterval) mean;
+- (NSTimeInterval) max;
+- (NSTimeInterval) valueAtPercentile:(double)percentile;
+
+- (void) reset;
+
+@end
+
+#pragma mark OPERATION METRICS
+
+/*!
+ Calls, errors, bytes written and latency for one FireSuite API call
+ */
+@interface FSOperationMetrics : NSObject
+
+@property (strong, nonatomic, readonly) NSString * name;
+@property (strong, nonatomic, readonly) FSLatencyHistogram * latency;
+
+- (int64_t) calls;
+- (int64_t) errors;
+- (int64_t) bytesEncoded;
+
+/*!
+ Attempts FSRetrier made again -- and ones it refused for lack of budget
+ */
+- (int64_t) retries;
+- (int64_t) retriesDenied;
+
+@end
+
+#pragma mark REGISTRY
+
+/*!
+ Counters, gauges and latency histograms fed by every FireSuite manager.  Cheap enough to leave on -- set enabled to NO to skip recording entirely.
+ */
+@interface FSMetrics : NSObject
+
++ (FSMetrics *) singleton;
+
+@property (nonatomic) BOOL enabled;
+
+#pragma mark RECORD
+
+- (void) recordOperation:(NSString *)operation latency:(NSTimeInterval)seconds error:(NSError *)error;
+- (void) recordBytes:(NSUInteger)bytes forOperation:(NSString *)operation;
+- (void) recordRoundTrips:(NSUInteger)roundTrips;
+- (void) recordTransactionAttempts:(NSUInteger)attempts;
+- (void) recordRetryForOperation:(NSString *)operation;
+- (void) recordRetryDeniedForOperation:(NSString *)operation;
+
+/*!
+ Live Firebase listeners and registered observer objects
+ */
+- (void) adjustListenerCount:(NSInteger)delta;
+- (void) adjustObserverCount:(NSInteger)delta;
+
+/*!
+ Runs a transaction on @param ref without local events, counting each run of @param block as an attempt and round trip
+ */
+- (void) runTransactionOnRef:(Firebase *)ref
+                   operation:(NSString *)operation
+                       block:(FTransactionResult * (^)(FMutableData * currentData))block
+                  completion:(void (^)(NSError * error, BOOL committed, FDataSnapshot * snapshot))completion;
+
+#pragma mark READ
+
+- (int64_t) roundTrips;
+- (int64_t) transactionAttempts;
+- (int64_t) transactionRetries;
+- (int64_t) retries;
+- (int64_t) retriesDenied;
+- (int64_t) listenerCount;
+- (int64_t) observerCount;
+
+- (FSOperationMetrics *) metricsForOperation:(NSString *)operation;
+
+/*!
+ Everything above as plain values -- keys kMetrics..., operations keyed by kFSOperation...
+ */
+- (NSDictionary *) snapshot;
+
+/*!
+ snapshot as JSON
+ */
+- (NSData *) exportJSON;
+
+- (void) reset;
+
+@end
@@ -0,0 +1,456 @@
+//
+//  FSMetrics.m
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import "FSMetrics.h"
+#import <pthread.h>
+
+#pragma mark KEYS
+
+// Operation Keys
+NSString *const kFSOperationCreateChat = @"createNewChat";
+NSString *const kFSOperationAddUserToChat = @"addUserToChat";
+NSString *const kFSOperationUpdateUserChats = @"updateUserChats";
+NSString *const kFSOperationGetChatHeaders = @"getChatHeaders";
+NSString *const kFSOperationGetChatHeaderChanges = @"getChatHeaderChanges";
+NSString *const kFSOperationRecordChatChange = @"recordChatChange";
+NSString *const kFSOperationLoadChatSession = @"loadChatSession";
+NSString *const kFSOperationEndChatSession = @"endChatSession";
+NSString *const kFSOperationSendMessage = @"sendNewMessage";
+NSString *const kFSOperationUpdateHeader = @"updateHeader";
+NSString *const kFSOperationSendAlert = @"sendAlert";
+NSString *const kFSOperationFanOutAlert = @"fanOutAlert";
+NSString *const kFSOperationReceiveAlert = @"receiveAlert";
+NSString *const kFSOperationCompactArchive = @"compactArchive";
+NSString *const kFSOperationLoadHistory = @"loadHistory";
+NSString *const kFSOperationMigrateSchema = @"migrateSchema";
+NSString *const kFSOperationPrefetch = @"prefetch";
+NSString *const kFSOperationRateLimit = @"rateLimit";
+NSString *const kFSOperationImportChats = @"importChats";
+NSString *const kFSOperationPresenceConnect = @"presenceConnect";
+NSString *const kFSOperationPresenceDisconnect = @"presenceDisconnect";
+
+// Snapshot Keys
+NSString *const kMetricsRoundTrips = @"roundTrips";
+NSString *const kMetricsTransactionAttempts = @"transactionAttempts";
+NSString *const kMetricsTransactionRetries = @"transactionRetries";
+NSString *const kMetricsRetries = @"retries";
+NSString *const kMetricsRetriesDenied = @"retriesDenied";
+NSString *const kMetricsListeners = @"listeners";
+NSString *const kMetricsObservers = @"observers";
+NSString *const kMetricsOperations = @"operations";
+
+#pragma mark FUNCTIONS
+
+NSTimeInterval FSMetricsNow(void) {
+    return [NSDate timeIntervalSinceReferenceDate];
+}
+
+NSUInteger FSMetricsEstimatedBytes(id value) {
+    if ([value isKindOfClass:[NSString class]]) {
+        return [value lengthOfBytesUsingEncoding:NSUTF8StringEncoding] + 2;
+    }
+    else if ([value isKindOfClass:[NSNumber class]]) {
+        return 8;
+    }
+    else if ([value isKindOfClass:[NSDictionary class]]) {
+        NSUInteger bytes = 2;
+        for (NSString * key in value) {
+            bytes += [key lengthOfBytesUsingEncoding:NSUTF8StringEncoding] + 4;
+            bytes += FSMetricsEstimatedBytes(value[key]);
+        }
+        return bytes;
+    }
+    else if ([value isKindOfClass:[NSArray class]]) {
+        NSUInteger bytes = 2;
+        for (id child in value) bytes += FSMetricsEstimatedBytes(child) + 1;
+        return bytes;
+    }
+    return 4; // null
+}
+
+#pragma mark HISTOGRAM
+
+// 16 Sub Buckets Per Power Of Two, Values In Microseconds
+#define kSubBucketBits 4
+#define kSubBucketHalf (1 << kSubBucketBits)
+#define kBucketCount ((64 - kSubBucketBits) * kSubBucketHalf + kSubBucketHalf)
+
+static int FSHistogramIndex(uint64_t value) {
+    if (value < 2 * kSubBucketHalf) return (int)value;
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - kSubBucketBits;
+    return (shift + 1) * kSubBucketHalf + (int)((value >> shift) - kSubBucketHalf);
+}
+
+static uint64_t FSHistogramLowestValue(int index) {
+    if (index < 2 * kSubBucketHalf) return index;
+    int shift = index / kSubBucketHalf - 1;
+    return (uint64_t)(index % kSubBucketHalf + kSubBucketHalf) << shift;
+}
+
+static uint64_t FSHistogramMidpointValue(int index) {
+    if (index < 2 * kSubBucketHalf) return index;
+    int shift = index / kSubBucketHalf - 1;
+    return FSHistogramLowestValue(index) + ((1ull << shift) >> 1);
+}
+
+@interface FSLatencyHistogram ()
+{
+    uint64_t _buckets[kBucketCount];
+    uint64_t _count;
+    uint64_t _sum;
+    uint64_t _max;
+}
+
+@end
+
+@implementation FSLatencyHistogram
+
+- (void) recordLatency:(NSTimeInterval)seconds {
+    uint64_t micros = seconds > 0 ? (uint64_t)(seconds * 1000000.0) : 0;
+    int index = FSHistogramIndex(micros);
+    if (index >= kBucketCount) index = kBucketCount - 1;
+
+    __sync_fetch_and_add(&_buckets[index], 1);
+    __sync_fetch_and_add(&_count, 1);
+    __sync_fetch_and_add(&_sum, micros);
+
+    // Raise Max If Necessary
+    uint64_t max = _max;
+    while (micros > max && !__sync_bool_compare_and_swap(&_max, max, micros)) {
+        max = _max;
+    }
+}
+
+- (uint64_t) count {
+    return __sync_fetch_and_add(&_count, 0);
+}
+
+- (NSTimeInterval) mean {
+    uint64_t count = [self count];
+    if (count == 0) return 0;
+    return __sync_fetch_and_add(&_sum, 0) / (double)count / 1000000.0;
+}
+
+- (NSTimeInterval) max {
+    return __sync_fetch_and_add(&_max, 0) / 1000000.0;
+}
+
+- (NSTimeInterval) valueAtPercentile:(double)percentile {
+    uint64_t count = [self count];
+    if (count == 0) return 0;
+
+    // Nearest Rank
+    uint64_t rank = (uint64_t)ceil(percentile / 100.0 * count);
+    if (rank == 0) rank = 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < kBucketCount; i++) {
+        seen += _buckets[i];
+        if (seen >= rank) {
+            uint64_t value = MIN(FSHistogramMidpointValue(i), _max);
+            return value / 1000000.0;
+        }
+    }
+    return [self max];
+}
+
+- (void) reset {
+    for (int i = 0; i < kBucketCount; i++) _buckets[i] = 0;
+    _count = 0;
+    _sum = 0;
+    _max = 0;
+    __sync_synchronize();
+}
+
+@end
+
+#pragma mark OPERATION METRICS
+
+@interface FSOperationMetrics ()
+{
+    @public
+    int64_t _calls;
+    int64_t _errors;
+    int64_t _bytesEncoded;
+    int64_t _retries;
+    int64_t _retriesDenied;
+}
+
+@property (strong, nonatomic, readwrite) NSString * name;
+@property (strong, nonatomic, readwrite) FSLatencyHistogram * latency;
+
+- (NSDictionary *) snapshot;
+- (void) reset;
+
+@end
+
+@implementation FSOperationMetrics
+
+- (int64_t) calls {
+    return __sync_fetch_and_add(&_calls, 0);
+}
+
+- (int64_t) errors {
+    return __sync_fetch_and_add(&_errors, 0);
+}
+
+- (int64_t) bytesEncoded {
+    return __sync_fetch_and_add(&_bytesEncoded, 0);
+}
+
+- (int64_t) retries {
+    return __sync_fetch_and_add(&_retries, 0);
+}
+
+- (int64_t) retriesDenied {
+    return __sync_fetch_and_add(&_retriesDenied, 0);
+}
+
+- (NSDictionary *) snapshot {
+    FSLatencyHistogram * latency = _latency;
+    return @{
+             @"calls" : @([self calls]),
+             @"errors" : @([self errors]),
+             @"bytesEncoded" : @([self bytesEncoded]),
+             @"retries" : @([self retries]),
+             @"retriesDenied" : @([self retriesDenied]),
+             @"p50Ms" : @([latency valueAtPercentile:50] * 1000),
+             @"p90Ms" : @([latency valueAtPercentile:90] * 1000),
+             @"p99Ms" : @([latency valueAtPercentile:99] * 1000),
+             @"maxMs" : @([latency max] * 1000),
+             @"meanMs" : @([latency mean] * 1000),
+             };
+}
+
+- (void) reset {
+    _calls = 0;
+    _errors = 0;
+    _bytesEncoded = 0;
+    _retries = 0;
+    _retriesDenied = 0;
+    [_latency reset];
+}
+
+@end
+
+#pragma mark REGISTRY
+
+@interface FSMetrics ()
+{
+    int64_t _roundTrips;
+    int64_t _transactionAttempts;
+    int64_t _transactionRetries;
+    int64_t _retries;
+    int64_t _retriesDenied;
+    int64_t _listenerCount;
+    int64_t _observerCount;
+
+    // Operations Are Read Lock Free From An Immutable Dictionary -- The Lock Only Serializes Adding One.
+    // Every Dictionary Published Is Kept In _publishedOperations, So A Reader's Never Goes Away Under It.
+    pthread_mutex_t _operationsLock;
+    void * _operations;
+    NSMutableArray * _publishedOperations;
+}
+
+@end
+
+@implementation FSMetrics
+
+#pragma mark SINGLETON
+
++ (FSMetrics *) singleton {
+    static dispatch_once_t pred;
+    static FSMetrics *shared = nil;
+
+    dispatch_once(&pred, ^{
+        shared = [[FSMetrics alloc] init];
+    });
+    return shared;
+}
+
+- (instancetype) init {
+    self = [super init];
+    if (self) {
+        _enabled = YES;
+        _publishedOperations = [NSMutableArray arrayWithObject:@{}];
+        _operations = (__bridge void *)_publishedOperations[0];
+        pthread_mutex_init(&_operationsLock, NULL);
+    }
+    return self;
+}
+
+- (void) dealloc {
+    pthread_mutex_destroy(&_operationsLock);
+}
+
+#pragma mark RECORD
+
+- (NSDictionary *) operations {
+    return (__bridge NSDictionary *)__atomic_load_n(&_operations, __ATOMIC_ACQUIRE);
+}
+
+- (FSOperationMetrics *) metricsForOperation:(NSString *)operation {
+    FSOperationMetrics * metrics = [self operations][operation];
+    if (metrics) return metrics;
+    
+    // First Sighting -- Copy, Add, Then Publish
+    pthread_mutex_lock(&_operationsLock);
+    NSDictionary * operations = [self operations];
+    metrics = operations[operation];
+    if (!metrics) {
+        metrics = [FSOperationMetrics new];
+        metrics.name = operation;
+        metrics.latency = [FSLatencyHistogram new];
+        
+        NSMutableDictionary * next = [operations mutableCopy];
+        next[operation] = metrics;
+        NSDictionary * published = [next copy];
+        [_publishedOperations addObject:published];
+        __atomic_store_n(&_operations, (__bridge void *)published, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&_operationsLock);
+    return metrics;
+}
+
+- (void) recordOperation:(NSString *)operation latency:(NSTimeInterval)seconds error:(NSError *)error {
+    if (!_enabled) return;
+    FSOperationMetrics * metrics = [self metricsForOperation:operation];
+    __sync_fetch_and_add(&metrics->_calls, 1);
+    if (error) __sync_fetch_and_add(&metrics->_errors, 1);
+    [metrics.latency recordLatency:seconds];
+}
+
+- (void) recordBytes:(NSUInteger)bytes forOperation:(NSString *)operation {
+    if (!_enabled) return;
+    FSOperationMetrics * metrics = [self metricsForOperation:operation];
+    __sync_fetch_and_add(&metrics->_bytesEncoded, (int64_t)bytes);
+}
+
+- (void) recordRoundTrips:(NSUInteger)roundTrips {
+    if (!_enabled) return;
+    __sync_fetch_and_add(&_roundTrips, (int64_t)roundTrips);
+}
+
+- (void) recordTransactionAttempts:(NSUInteger)attempts {
+    if (!_enabled || attempts == 0) return;
+    __sync_fetch_and_add(&_transactionAttempts, (int64_t)attempts);
+    __sync_fetch_and_add(&_transactionRetries, (int64_t)attempts - 1);
+}
+
+- (void) recordRetryForOperation:(NSString *)operation {
+    if (!_enabled) return;
+    FSOperationMetrics * metrics = [self metricsForOperation:operation];
+    __sync_fetch_and_add(&metrics->_retries, 1);
+    __sync_fetch_and_add(&_retries, 1);
+}
+
+- (void) recordRetryDeniedForOperation:(NSString *)operation {
+    if (!_enabled) return;
+    FSOperationMetrics * metrics = [self metricsForOperation:operation];
+    __sync_fetch_and_add(&metrics->_retriesDenied, 1);
+    __sync_fetch_and_add(&_retriesDenied, 1);
+}
+
+- (void) adjustListenerCount:(NSInteger)delta {
+    // Gauges Always Track -- Otherwise Toggling enabled Would Leave Them Skewed
+    __sync_fetch_and_add(&_listenerCount, (int64_t)delta);
+}
+
+- (void) adjustObserverCount:(NSInteger)delta {
+    __sync_fetch_and_add(&_observerCount, (int64_t)delta);
+}
+
+- (void) runTransactionOnRef:(Firebase *)ref
+                   operation:(NSString *)operation
+                       block:(FTransactionResult * (^)(FMutableData * currentData))block
+                  completion:(void (^)(NSError * error, BOOL committed, FDataSnapshot * snapshot))completion {
+
+    NSTimeInterval start = FSMetricsNow();
+    __block int32_t attempts = 0;
+
+    [ref runTransactionBlock:^FTransactionResult *(FMutableData *currentData) {
+        // Each Run Is A Fresh Attempt Against The Latest Server Value
+        __sync_fetch_and_add(&attempts, 1);
+        return block(currentData);
+    } andCompletionBlock:^(NSError *error, BOOL committed, FDataSnapshot *snapshot) {
+        [self recordTransactionAttempts:attempts];
+        [self recordRoundTrips:attempts];
+        if (committed) [self recordBytes:FSMetricsEstimatedBytes(snapshot.value) forOperation:operation];
+        [self recordOperation:operation latency:FSMetricsNow() - start error:error];
+        if (completion) completion(error, committed, snapshot);
+    } withLocalEvents:NO];
+}
+
+#pragma mark READ
+
+- (int64_t) roundTrips {
+    return __sync_fetch_and_add(&_roundTrips, 0);
+}
+
+- (int64_t) transactionAttempts {
+    return __sync_fetch_and_add(&_transactionAttempts, 0);
+}
+
+- (int64_t) transactionRetries {
+    return __sync_fetch_and_add(&_transactionRetries, 0);
+}
+
+- (int64_t) retries {
+    return __sync_fetch_and_add(&_retries, 0);
+}
+
+- (int64_t) retriesDenied {
+    return __sync_fetch_and_add(&_retriesDenied, 0);
+}
+
+- (int64_t) listenerCount {
+    return __sync_fetch_and_add(&_listenerCount, 0);
+}
+
+- (int64_t) observerCount {
+    return __sync_fetch_and_add(&_observerCount, 0);
+}
+
+- (NSDictionary *) snapshot {
+
+    NSArray * operations = [[self operations] allValues];
+
+    NSMutableDictionary * operationSnapshots = [NSMutableDictionary new];
+    for (FSOperationMetrics * metrics in operations) {
+        operationSnapshots[metrics.name] = [metrics snapshot];
+    }
+
+    return @{
+             kMetricsRoundTrips : @([self roundTrips]),
+             kMetricsTransactionAttempts : @([self transactionAttempts]),
+             kMetricsTransactionRetries : @([self transactionRetries]),
+             kMetricsRetries : @([self retries]),
+             kMetricsRetriesDenied : @([self retriesDenied]),
+             kMetricsListeners : @([self listenerCount]),
+             kMetricsObservers : @([self observerCount]),
+             kMetricsOperations : operationSnapshots,
+             };
+}
+
+- (NSData *) exportJSON {
+    return [NSJSONSerialization dataWithJSONObject:[self snapshot] options:NSJSONWritingPrettyPrinted error:nil];
+}
+
+- (void) reset {
+    // Gauges Are Live State -- Leave Them
+    _roundTrips = 0;
+    _transactionAttempts = 0;
+    _transactionRetries = 0;
+    _retries = 0;
+    _retriesDenied = 0;
+
+    for (FSOperationMetrics * metrics in [[self operations] allValues]) [metrics reset];
+    __sync_synchronize();
+}
+
+@end
@@ -0,0 +1,117 @@
+//
+//  FSOutbox.h
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "FSEventHub.h"
+#import "FSRetrier.h"
+
+#pragma mark CONSTANTS
+
+typedef enum {
+    FSOutboxErrorFull = 1,
+    FSOutboxErrorJournal = 2,
+} FSOutboxErrorCode;
+
+// Error Keys
+FOUNDATION_EXPORT NSString *const kFSOutboxErrorDomain;
+
+// Entry Keys
+FOUNDATION_EXPORT NSString *const kOutboxEntryKey;
+FOUNDATION_EXPORT NSString *const kOutboxEntryKind;
+FOUNDATION_EXPORT NSString *const kOutboxEntryLane;
+FOUNDATION_EXPORT NSString *const kOutboxEntryPayload;
+FOUNDATION_EXPORT NSString *const kOutboxEntrySequence;
+
+// Entry Kinds
+FOUNDATION_EXPORT NSString *const kOutboxKindMessage;
+FOUNDATION_EXPORT NSString *const kOutboxKindAlert;
+FOUNDATION_EXPORT NSString *const kOutboxKindAlertFanOut;
+
+/*!
+ Pending writes journaled to an append-only file, so they survive failures and relaunches.  Each entry carries an idempotency key -- the child name it writes to -- so sending it twice lands it once.
+
+ Entries in a lane go out in order, batchSize at a time, with at most maxInFlight batches outstanding across lanes.  A batch that fails with an error retryPolicy retries pauses only its lane, which is tried again after retryPolicy's delay, or at once on drain -- called on reconnect when drainOnReconnectToURLs: is set.  Any other error drops the batch: its completions and the kind's dead letter handler get the error, and the lane moves on.  One outbox per user; thread safe.
+ */
+@interface FSOutbox : NSObject
+
+/*!
+ Opens the journal at @param path, creating it if needed -- entries left pending by a previous run are sent again
+ */
++ (instancetype) outboxWithPath:(NSString *)path;
+
+/*!
+ An entry for enqueueEntry: -- entries sharing @param lane are sent in order
+ */
++ (NSDictionary *) entryWithKind:(NSString *)kind lane:(NSString *)lane key:(NSString *)key payload:(NSDictionary *)payload;
+
+@property (strong, readonly) NSString * path;
+
+/*!
+ Stable for the life of the journal -- names this outbox in replay watermarks
+ */
+@property (strong, readonly) NSString * outboxId;
+
+/*!
+ Pending entries allowed before enqueueEntry: fails with FSOutboxErrorFull -- defaults to 10000
+ */
+@property NSUInteger capacity;
+
+/*!
+ Entries per batch -- defaults to 50
+ */
+@property NSUInteger batchSize;
+
+/*!
+ Batches outstanding at once -- defaults to 8
+ */
+@property NSUInteger maxInFlight;
+
+@property (readonly) NSUInteger pendingCount;
+
+/*!
+ Why the last lane paused -- nil once every lane drains again
+ */
+@property (strong, readonly) NSError * lastError;
+
+/*!
+ Which errors pause a lane rather than drop its batch, and how long a paused lane waits -- maxAttempts is ignored, a lane retries until its batch lands.  Defaults to 1s doubling to at most 60s, half of each delay jittered.
+ */
+@property (copy) FSRetryPolicy * retryPolicy;
+
+/*!
+ Watches the connections for drainOnReconnectToURLs:, alongside the managers -- defaults to [FSEventHub singleton]
+ */
+@property (strong) FSEventHub * eventHub;
+
+#pragma mark SEND
+
+/*!
+ Sends batches of @param kind -- call done with nil once every entry has landed, or the error -- retryPolicy decides whether the batch is kept or dropped
+ */
+- (void) setSender:(void (^)(NSArray * entries, void (^done)(NSError * error)))sender forKind:(NSString *)kind;
+
+/*!
+ Gets batches of @param kind dropped for an error retryPolicy doesn't retry -- replayed entries included, which have no completion to tell
+ */
+- (void) setDeadLetterHandler:(void (^)(NSArray * entries, NSError * error))handler forKind:(NSString *)kind;
+
+/*!
+ Journal @param entry and send it.  @param completion runs with nil once it has landed, or the error it was dropped for -- not if the process exits first.
+ */
+- (BOOL) enqueueEntry:(NSDictionary *)entry completion:(void (^)(NSError * error))completion error:(NSError **)error;
+
+/*!
+ Retry every paused lane now
+ */
+- (void) drain;
+
+/*!
+ Drain whenever .info/connected under any of @param urls turns true -- every database a lane may write to.  nil stops watching.
+ */
+- (void) drainOnReconnectToURLs:(NSArray *)urls;
+
+@end
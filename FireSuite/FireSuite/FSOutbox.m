@@ -0,0 +1,434 @@
+//
+//  FSOutbox.m
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import "FSOutbox.h"
+#import "FSStateQueue.h"
+#import <Firebase/Firebase.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#pragma mark KEYS
+
+// Error Keys
+NSString *const kFSOutboxErrorDomain = @"kFSOutboxErrorDomain";
+
+// Entry Keys
+NSString *const kOutboxEntryKey = @"key";
+NSString *const kOutboxEntryKind = @"kind";
+NSString *const kOutboxEntryLane = @"lane";
+NSString *const kOutboxEntryPayload = @"payload";
+NSString *const kOutboxEntrySequence = @"sequence";
+
+// Entry Kinds
+NSString *const kOutboxKindMessage = @"message";
+NSString *const kOutboxKindAlert = @"alert";
+NSString *const kOutboxKindAlertFanOut = @"alertFanOut";
+
+// Journal Keys -- First Line Names The Outbox, Then One Line Per Entry Or Done Key
+static NSString *const kJournalOutboxId = @"outboxId";
+static NSString *const kJournalNextSequence = @"nextSequence";
+static NSString *const kJournalDone = @"done";
+
+// Done Lines Before The Journal Is Rewritten With Only What's Pending -- Even While Sends Are Outstanding
+static NSUInteger const kJournalCompactionThreshold = 1000;
+
+// Paused Lane Backoff
+static NSTimeInterval const kDefaultRetryBaseDelay = 1;
+static NSTimeInterval const kDefaultRetryMaxDelay = 60;
+
+static NSError * FSOutboxError(FSOutboxErrorCode code, NSString * description) {
+    return [NSError errorWithDomain:kFSOutboxErrorDomain
+                               code:code
+                           userInfo:@{NSLocalizedDescriptionKey: NSLocalizedString(description, nil)}];
+}
+
+@interface FSOutbox ()
+{
+    // Owns Everything Below -- Only Touched On This Queue
+    dispatch_queue_t stateQueue;
+    
+    // Append Only -- Rewritten When Empty, Reopened Or Past kJournalCompactionThreshold Done Lines
+    int journal;
+    long long nextSequence;
+    NSUInteger doneSinceRewrite;
+    
+    // Lanes With Pending Entries, Oldest First
+    NSMutableArray * laneOrder;
+    NSMutableDictionary * lanes;
+    NSMutableSet * busyLanes;
+    NSUInteger inFlight;
+    NSUInteger pending;
+    
+    // Failures In A Row By Lane -- A Lane In pausedLanes Waits For Its Retry Or A Drain
+    NSMutableDictionary * laneFailures;
+    NSMutableSet * pausedLanes;
+    NSError * pauseError;
+    
+    NSMutableDictionary * senders;
+    NSMutableDictionary * deadLetterHandlers;
+    NSMutableDictionary * completions;
+    
+    // Reconnect Triggers, One Per Database
+    NSMutableArray * connectedTokens;
+}
+
+@property (strong, readwrite) NSString * path;
+@property (strong, readwrite) NSString * outboxId;
+
+@end
+
+@implementation FSOutbox
+
+#pragma mark INIT
+
++ (instancetype) outboxWithPath:(NSString *)path {
+    return [[self alloc] initWithPath:path];
+}
+
++ (NSDictionary *) entryWithKind:(NSString *)kind lane:(NSString *)lane key:(NSString *)key payload:(NSDictionary *)payload {
+    return @{
+             kOutboxEntryKind: kind,
+             kOutboxEntryLane: lane,
+             kOutboxEntryKey: key,
+             kOutboxEntryPayload: payload,
+             };
+}
+
+- (instancetype) initWithPath:(NSString *)path {
+    self = [super init];
+    if (self) {
+        stateQueue = FSStateQueueCreate("com.firesuite.outbox");
+        journal = -1;
+        nextSequence = 1;
+        laneOrder = [NSMutableArray new];
+        lanes = [NSMutableDictionary new];
+        busyLanes = [NSMutableSet new];
+        laneFailures = [NSMutableDictionary new];
+        pausedLanes = [NSMutableSet new];
+        senders = [NSMutableDictionary new];
+        deadLetterHandlers = [NSMutableDictionary new];
+        completions = [NSMutableDictionary new];
+        connectedTokens = [NSMutableArray new];
+        
+        _path = path;
+        _capacity = 10000;
+        _batchSize = 50;
+        _maxInFlight = 8;
+        _eventHub = [FSEventHub singleton];
+        
+        _retryPolicy = [FSRetryPolicy policyWithMaxAttempts:0 baseDelay:kDefaultRetryBaseDelay maxDelay:kDefaultRetryMaxDelay];
+        _retryPolicy.jitter = 0.5;
+        
+        [self loadJournal];
+    }
+    return self;
+}
+
+- (void) dealloc {
+    if (journal >= 0) close(journal);
+    for (NSNumber * token in connectedTokens) [_eventHub removeObserverWithToken:[token unsignedIntegerValue]];
+}
+
+#pragma mark JOURNAL
+
+// Replay The Journal -- Entries Without A Done Line Are Still Pending
+- (void) loadJournal {
+    NSString * contents = [NSString stringWithContentsOfFile:_path encoding:NSUTF8StringEncoding error:nil];
+    NSMutableDictionary * entriesByKey = [NSMutableDictionary new];
+    
+    for (NSString * line in [contents componentsSeparatedByString:@"\n"]) {
+        NSData * data = [line dataUsingEncoding:NSUTF8StringEncoding];
+        if (data.length == 0) continue;
+        
+        // A Torn Last Line From A Crash Mid Write
+        NSDictionary * record = [NSJSONSerialization JSONObjectWithData:data options:0 error:nil];
+        if (![record isKindOfClass:[NSDictionary class]]) continue;
+        
+        if (record[kJournalOutboxId]) {
+            _outboxId = record[kJournalOutboxId];
+            nextSequence = MAX(nextSequence, [record[kJournalNextSequence] longLongValue]);
+        }
+        else if (record[kJournalDone]) {
+            [entriesByKey removeObjectForKey:record[kJournalDone]];
+        }
+        else if (record[kOutboxEntryKey]) {
+            entriesByKey[record[kOutboxEntryKey]] = record;
+            nextSequence = MAX(nextSequence, [record[kOutboxEntrySequence] longLongValue] + 1);
+        }
+    }
+    
+    if (!_outboxId) _outboxId = [[NSUUID UUID] UUIDString];
+    
+    NSArray * entries = [[entriesByKey allValues] sortedArrayUsingDescriptors:@[[NSSortDescriptor sortDescriptorWithKey:kOutboxEntrySequence ascending:YES]]];
+    for (NSDictionary * entry in entries) [self addEntry:entry];
+    
+    // Start Fresh With Only What's Pending
+    [self rewriteJournalWithEntries:entries];
+}
+
+// Write @param entries To A Temporary File And Swap It In -- A Crash Leaves The Old Journal Whole
+- (BOOL) rewriteJournalWithEntries:(NSArray *)entries {
+    if (journal >= 0) close(journal);
+    journal = -1;
+    
+    NSString * temporaryPath = [_path stringByAppendingString:@".tmp"];
+    int temporary = open(temporaryPath.fileSystemRepresentation, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (temporary < 0) {
+        [self openJournal];
+        return NO;
+    }
+    
+    NSMutableArray * records = [NSMutableArray arrayWithObject:@{kJournalOutboxId: _outboxId, kJournalNextSequence: @(nextSequence)}];
+    [records addObjectsFromArray:entries];
+    BOOL isWritten = [self appendRecords:records toFile:temporary sync:YES];
+    close(temporary);
+    
+    // Keep Appending To The Old One -- It's Still Whole
+    if (!isWritten || rename(temporaryPath.fileSystemRepresentation, _path.fileSystemRepresentation) != 0) {
+        [self openJournal];
+        return NO;
+    }
+    
+    doneSinceRewrite = 0;
+    return [self openJournal];
+}
+
+- (BOOL) openJournal {
+    journal = open(_path.fileSystemRepresentation, O_WRONLY | O_APPEND | O_CREAT, 0600);
+    return journal >= 0;
+}
+
+// Everything Not Yet Done, In Sequence -- In Flight Included
+- (NSArray *) pendingEntries {
+    NSMutableArray * entries = [NSMutableArray arrayWithCapacity:pending];
+    for (NSString * lane in laneOrder) [entries addObjectsFromArray:lanes[lane]];
+    return [entries sortedArrayUsingDescriptors:@[[NSSortDescriptor sortDescriptorWithKey:kOutboxEntrySequence ascending:YES]]];
+}
+
+// One Line Per Record -- @param sync Waits For The Disk
+- (BOOL) appendRecords:(NSArray *)records toFile:(int)file sync:(BOOL)sync {
+    if (file < 0) return NO;
+    
+    NSMutableData * data = [NSMutableData new];
+    for (NSDictionary * record in records) {
+        NSData * json = [NSJSONSerialization dataWithJSONObject:record options:0 error:nil];
+        if (!json) return NO;
+        [data appendData:json];
+        [data appendBytes:"\n" length:1];
+    }
+    
+    if (write(file, data.bytes, data.length) != (ssize_t)data.length) return NO;
+    if (sync && fsync(file) != 0) return NO;
+    return YES;
+}
+
+#pragma mark STATE
+
+- (NSUInteger) pendingCount {
+    __block NSUInteger pendingCount;
+    FSStateQueueSync(stateQueue, ^{
+        pendingCount = pending;
+    });
+    return pendingCount;
+}
+
+- (NSError *) lastError {
+    __block NSError * error;
+    FSStateQueueSync(stateQueue, ^{
+        error = pauseError;
+    });
+    return error;
+}
+
+- (void) addEntry:(NSDictionary *)entry {
+    NSString * lane = entry[kOutboxEntryLane];
+    NSMutableArray * entries = lanes[lane];
+    if (!entries) {
+        entries = [NSMutableArray new];
+        lanes[lane] = entries;
+        [laneOrder addObject:lane];
+    }
+    [entries addObject:entry];
+    pending++;
+}
+
+#pragma mark SEND
+
+- (void) setSender:(void (^)(NSArray * entries, void (^done)(NSError * error)))sender forKind:(NSString *)kind {
+    FSStateQueueAsync(stateQueue, ^{
+        if (sender) senders[kind] = [sender copy];
+        else [senders removeObjectForKey:kind];
+        
+        // Entries From A Previous Run May Have Been Waiting On It
+        [self drainOnStateQueue];
+    });
+}
+
+- (void) setDeadLetterHandler:(void (^)(NSArray * entries, NSError * error))handler forKind:(NSString *)kind {
+    FSStateQueueAsync(stateQueue, ^{
+        if (handler) deadLetterHandlers[kind] = [handler copy];
+        else [deadLetterHandlers removeObjectForKey:kind];
+    });
+}
+
+- (BOOL) enqueueEntry:(NSDictionary *)entry completion:(void (^)(NSError * error))completion error:(NSError **)error {
+    __block NSError * enqueueError;
+    FSStateQueueSync(stateQueue, ^{
+        
+        // Back Pressure -- Refuse Rather Than Grow Without Bound
+        if (pending >= self.capacity) {
+            enqueueError = FSOutboxError(FSOutboxErrorFull, @"Outbox Is Full");
+            return;
+        }
+        
+        // On Disk Before We Send -- Retry A Journal We Lost Earlier
+        if (journal < 0) [self openJournal];
+        NSMutableDictionary * record = [entry mutableCopy];
+        record[kOutboxEntrySequence] = @(nextSequence);
+        if (![self appendRecords:@[record] toFile:journal sync:YES]) {
+            enqueueError = FSOutboxError(FSOutboxErrorJournal, @"Failed To Write Outbox Journal");
+            return;
+        }
+        nextSequence++;
+        
+        [self addEntry:record];
+        if (completion) completions[record[kOutboxEntryKey]] = [completion copy];
+        [self drainOnStateQueue];
+    });
+    
+    if (enqueueError && error) *error = enqueueError;
+    return enqueueError == nil;
+}
+
+- (void) drain {
+    FSStateQueueAsync(stateQueue, ^{
+        [pausedLanes removeAllObjects];
+        [self drainOnStateQueue];
+    });
+}
+
+- (void) drainOnStateQueue {
+    NSUInteger maxInFlight = MAX(self.maxInFlight, 1);
+    for (NSString * lane in [laneOrder copy]) {
+        if (inFlight >= maxInFlight) return;
+        if ([busyLanes containsObject:lane] || [pausedLanes containsObject:lane]) continue;
+        
+        // Nobody To Send It Yet
+        NSArray * batch = [self nextBatchInLane:lane];
+        void (^sender)(NSArray *, void (^)(NSError *)) = senders[batch[0][kOutboxEntryKind]];
+        if (!sender) continue;
+        
+        [busyLanes addObject:lane];
+        inFlight++;
+        sender(batch, ^(NSError * error) {
+            dispatch_async(stateQueue, ^{
+                [self finishBatch:batch inLane:lane error:error];
+            });
+        });
+    }
+}
+
+// Oldest Entries Of One Kind
+- (NSArray *) nextBatchInLane:(NSString *)lane {
+    NSArray * entries = lanes[lane];
+    NSString * kind = entries[0][kOutboxEntryKind];
+    NSUInteger batchSize = MAX(self.batchSize, 1);
+    
+    NSUInteger count = 0;
+    while (count < entries.count && count < batchSize && [entries[count][kOutboxEntryKind] isEqualToString:kind]) count++;
+    return [entries subarrayWithRange:NSMakeRange(0, count)];
+}
+
+- (void) finishBatch:(NSArray *)batch inLane:(NSString *)lane error:(NSError *)error {
+    [busyLanes removeObject:lane];
+    inFlight--;
+    
+    // Keep Them -- Replays Are Harmless, So Whatever Partly Landed Can Go Again
+    FSRetryPolicy * retryPolicy = self.retryPolicy;
+    if (error && [retryPolicy shouldRetryError:error]) {
+        [self pauseLane:lane withError:error delay:[retryPolicy delayBeforeRetry:[laneFailures[lane] unsignedIntegerValue] + 1]];
+        [self drainOnStateQueue];
+        return;
+    }
+    
+    // Landed, Or Never Will -- Either Way The Lane Moves On
+    [laneFailures removeObjectForKey:lane];
+    if (laneFailures.count == 0) pauseError = nil;
+    
+    NSMutableArray * entries = lanes[lane];
+    [entries removeObjectsInRange:NSMakeRange(0, batch.count)];
+    if (entries.count == 0) {
+        [lanes removeObjectForKey:lane];
+        [laneOrder removeObject:lane];
+    }
+    pending -= batch.count;
+    
+    // A Lost Done Line Only Means A Harmless Replay -- No Need To Wait For The Disk
+    BOOL isCompacting = pending == 0 || doneSinceRewrite + batch.count >= kJournalCompactionThreshold;
+    if (!isCompacting || ![self rewriteJournalWithEntries:[self pendingEntries]]) {
+        NSMutableArray * records = [NSMutableArray arrayWithCapacity:batch.count];
+        for (NSDictionary * entry in batch) [records addObject:@{kJournalDone: entry[kOutboxEntryKey]}];
+        [self appendRecords:records toFile:journal sync:NO];
+        doneSinceRewrite += batch.count;
+    }
+    
+    if (error) {
+        void (^deadLetterHandler)(NSArray *, NSError *) = deadLetterHandlers[batch[0][kOutboxEntryKind]];
+        NSLog(@"Outbox: Dropped %lu Entries In %@: %@", (unsigned long)batch.count, lane, error);
+        if (deadLetterHandler) deadLetterHandler(batch, error);
+    }
+    
+    for (NSDictionary * entry in batch) {
+        void (^completion)(NSError *) = completions[entry[kOutboxEntryKey]];
+        [completions removeObjectForKey:entry[kOutboxEntryKey]];
+        if (completion) completion(error);
+    }
+    
+    [self drainOnStateQueue];
+}
+
+// Only This Lane Waits -- The Rest Keep Draining
+- (void) pauseLane:(NSString *)lane withError:(NSError *)error delay:(NSTimeInterval)delay {
+    NSUInteger failures = [laneFailures[lane] unsignedIntegerValue] + 1;
+    laneFailures[lane] = @(failures);
+    [pausedLanes addObject:lane];
+    pauseError = error;
+    
+    // Not Tied To A Connection -- A Database We Don't Watch Still Gets Retried
+    __weak FSOutbox * weakSelf = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), stateQueue, ^{
+        [weakSelf resumeLane:lane afterFailures:failures];
+    });
+}
+
+- (void) resumeLane:(NSString *)lane afterFailures:(NSUInteger)failures {
+    
+    // A Drain Or A Later Failure Got Here First
+    if ([laneFailures[lane] unsignedIntegerValue] != failures) return;
+    [pausedLanes removeObject:lane];
+    [self drainOnStateQueue];
+}
+
+#pragma mark RECONNECT
+
+- (void) drainOnReconnectToURLs:(NSArray *)urls {
+    FSStateQueueAsync(stateQueue, ^{
+        for (NSNumber * token in connectedTokens) [self.eventHub removeObserverWithToken:[token unsignedIntegerValue]];
+        [connectedTokens removeAllObjects];
+        
+        // Shares The Managers' Listeners
+        __weak FSOutbox * weakSelf = self;
+        for (NSString * url in urls) {
+            FSEventHubToken token = [self.eventHub observeEventType:FEventTypeValue atRoot:url collection:@".info" id:@"connected" leaf:nil withBlock:^(FDataSnapshot *snapshot) {
+                if ([snapshot.value boolValue]) [weakSelf drain];
+            }];
+            [connectedTokens addObject:@(token)];
+        }
+    });
+}
+
+@end
@@ -7,9 +7,16 @@
 
 #import <Foundation/Foundation.h>
 #import <Firebase/Firebase.h>
+#import "FSMetrics.h"
+#import "FSTracer.h"
+#import "FSRefCache.h"
+#import "FSRetrier.h"
+#import "FSShardRouter.h"
+#import "FSPromise.h"
+#import "FSEventHub.h"
 
 /*!
- Manage Firebase User Presence System -- Requires goOffline | goOnline In App Delegate!
+ Manage Firebase User Presence System -- Requires goOffline | goOnline In App Delegate!  Safe to call from any thread -- observers are kept on a private serial queue and notified on callbackQueue.
  */
 @interface FSPresenceManager : NSObject
 
@@ -20,12 +27,47 @@
 /*!
  Firebase URL -- set by FireSuite
  */
-@property (strong, nonatomic) NSString * urlRefString;
+@property (strong) NSString * urlRefString;
 
 /*!
  Current User Id -- set by FireSuite
  */
-@property (strong, nonatomic) NSString * currentUserId;
+@property (strong) NSString * currentUserId;
+
+/*!
+ Where observer selectors and completions are delivered -- defaults to the main queue, like Firebase
+ */
+@property (strong) dispatch_queue_t callbackQueue;
+
+/*!
+ Receives counters and latencies -- defaults to [FSMetrics singleton]
+ */
+@property (strong) FSMetrics * metrics;
+
+/*!
+ Records a span for each step -- defaults to [FSTracer singleton]
+ */
+@property (strong) FSTracer * tracer;
+
+/*!
+ Shared Firebase refs -- defaults to [FSRefCache singleton]
+ */
+@property (strong) FSRefCache * refCache;
+
+/*!
+ Retries failed writes and transactions -- defaults to [FSRetrier singleton]
+ */
+@property (strong) FSRetrier * retrier;
+
+/*!
+ Routes Chats/ and Users/ paths across databases -- nil keeps everything under urlRefString
+ */
+@property (strong) FSShardRouter * shardRouter;
+
+/*!
+ Shares the connection listener, and one listener per watched user across observers -- defaults to [FSEventHub singleton]
+ */
+@property (strong) FSEventHub * eventHub;
 
 #pragma mark START PRESENCE MANAGER
 
@@ -63,8 +105,18 @@
 - (void) removeAllUserStatusObserversExceptForUserId:(NSString *)userIdToKeep;
 - (void) removeAllUserStatusObserversExceptForObserverObject:(NSObject *)observerToKeep andUserId:(NSString *)userIdToKeep;
 
+#pragma mark PROMISES
+
+/*!
+ Fulfilled with @YES or @NO on callbackQueue -- the observer is removed after the first status, or when cancelled
+ */
+- (FSPromise *) userStatusForUserId:(NSString *)userId;
+
 #pragma mark END PRESENCE MONITOR
 
+/*!
+ Removes every observer and takes this device's connection down -- @param completion runs once the server has it removed
+ */
 - (void) stopPresenceMonitorWithCompletion:(void(^)(void))completion;
 
 @end
@@ -6,11 +6,24 @@
 //
 
 #import "FSPresenceManager.h"
+#import "FSStateQueue.h"
 
 @interface FSPresenceManager ()
 
-// Current User's Connection To Firebase
-@property (strong, nonatomic) Firebase * connectionMonitor;
+{
+    // Owns Everything Below -- Only Touched On This Queue
+    dispatch_queue_t stateQueue;
+    
+    // Current User's Connection To Firebase
+    FSEventHubToken connectionToken;
+    
+    // This Device's Child Under Users/<id>/connections -- Set While Connected, Removed When We Stop
+    Firebase * connectionRef;
+    
+    // Metrics -- Last Value Reported To Gauges, Listeners Are The Hub's
+    NSInteger reportedObserverCount;
+}
+
 // Connection Observers To Notify
 @property (strong, nonatomic) NSMutableArray * connectionStatusObservers;
 
@@ -35,63 +48,129 @@
     return shared;
 }
 
+- (instancetype) init {
+    self = [super init];
+    if (self) {
+        stateQueue = FSStateQueueCreate("com.firesuite.presenceManager");
+        _callbackQueue = dispatch_get_main_queue();
+        
+        // Default Tools
+        _metrics = [FSMetrics singleton];
+        _tracer = [FSTracer singleton];
+        _refCache = [FSRefCache singleton];
+        _retrier = [FSRetrier singleton];
+        _eventHub = [FSEventHub singleton];
+    }
+    return self;
+}
+
+#pragma mark STATE
+
+// Hand A Result To The Developer
+- (void) deliver:(dispatch_block_t)block {
+    dispatch_async(self.callbackQueue ?: dispatch_get_main_queue(), block);
+}
+
+#pragma mark SHARDS
+
+- (NSString *) rootForUserId:(NSString *)userId {
+    FSShardRouter * shardRouter = self.shardRouter;
+    return shardRouter ? [shardRouter databaseURLForUserId:userId] : self.urlRefString;
+}
+
+// Report Changes In Observers Since Last Update
+- (void) updateMetricsGauges {
+    NSInteger observerCount = _userStatusObservers.count + _connectionStatusObservers.count;
+    
+    [self.metrics adjustObserverCount:observerCount - reportedObserverCount];
+    
+    reportedObserverCount = observerCount;
+}
+
 #pragma mark START CONNECTION MONITOR
 
 - (void) startPresenceManager {
+    FSStateQueueAsync(stateQueue, ^{
+        
+        // If ConnectionMonitor Isn't Already Monitoring, Start Monitoring
+        if (!connectionToken) {
+            
+            // Begin Observing -- Shared With Every Other Manager Watching The Connection
+            connectionToken = [self.eventHub observeEventType:FEventTypeValue atRoot:[self rootForUserId:self.currentUserId] collection:@".info" id:@"connected" leaf:nil withBlock:^(FDataSnapshot *snapshot) {
+                dispatch_async(stateQueue, ^{
+                    [self connectionStatusDidChange:snapshot];
+                });
+            }];
+        }
+        else {
+            NSLog(@"PresenceManager: Already Monitoring Connection!");
+        }
+        
+    });
+}
+
+- (void) connectionStatusDidChange:(FDataSnapshot *)snapshot {
+    
+    // Stopped While Queued
+    if (!connectionToken) return;
     
-    // If ConnectionMonitor Isn't Already Monitoring, Start Monitoring
-    if (!_connectionMonitor) {
+    // Dropped -- The Server's onDisconnect Takes Our Child, The Next Connect Writes Another
+    if (![snapshot.value boolValue]) connectionRef = nil;
+    
+    // The Hub Replays The Last Value -- Still Connected, Our Child Is Still There
+    else if (!connectionRef) {
         
-        // Prep ConnectionRefString
-        NSString * refString = [NSString stringWithFormat:@"%@.info/connected", _urlRefString];
+        // Connection Established! (or I've reconnected after a loss of connection)
+        NSString * currentUserId = self.currentUserId;
         
-        // Load ConnectionMonitor
-        _connectionMonitor = [[Firebase alloc] initWithUrl:refString];
+        // Get ConnectionsRef
+        Firebase * con = [self.refCache refWithRoot:[self rootForUserId:currentUserId] collection:@"Users" id:currentUserId leaf:@"connections"];
         
-        // Begin Observing
-        [_connectionMonitor observeEventType:FEventTypeValue withBlock:^(FDataSnapshot *snapshot) {
-            if([snapshot.value boolValue]) {
-                
-                // Connection Established! (or I've reconnected after a loss of connection)
-                
-                // Get ConnectionsRef
-                Firebase * con = [[Firebase alloc]initWithUrl:[NSString stringWithFormat:@"%@Users/%@/connections/", _urlRefString, _currentUserId]];
-                
-                // Create New Connection For This Device
-                Firebase * newConnection = [con childByAutoId];
-                
-                // Set New Connection To Timestamp
-                [newConnection setValue:[NSString stringWithFormat:@"%f",[[NSDate new] timeIntervalSince1970]]];
-                
-                // Set Disconnect To Remove Device;
-                [newConnection onDisconnectRemoveValue];
-                
-                // Set Last Online Timestamp
-                Firebase * lastOnlineRef = [[Firebase alloc]initWithUrl:[NSString stringWithFormat:@"%@Users/%@/lastOnline/", _urlRefString, _currentUserId]];
-                
-                // Set Last Online To Timestamp
-                [lastOnlineRef onDisconnectSetValue:[NSString stringWithFormat:@"%f",[[NSDate new] timeIntervalSince1970]]];
-            }
-            
-            // Notify Observers Of Connection Status Change -- Regardless Of Direction
-            if (snapshot.value != [NSNull new]) [self notifyConnectionStatusObservers:[snapshot.value boolValue]];
-            
+        // Create New Connection For This Device
+        Firebase * newConnection = [con childByAutoId];
+        connectionRef = newConnection;
+        
+        // Set New Connection To Timestamp -- Measure Until Acknowledged
+        FSMetrics * metrics = self.metrics;
+        FSTracer * tracer = self.tracer;
+        NSTimeInterval start = FSMetricsNow();
+        FSTraceSpan connectSpan = [tracer beginSpan:"presence.connect" parent:FSTraceSpanNone];
+        NSString * connectedAt = [NSString stringWithFormat:@"%f",[[NSDate new] timeIntervalSince1970]];
+        [metrics recordBytes:FSMetricsEstimatedBytes(connectedAt) forOperation:kFSOperationPresenceConnect];
+        [metrics recordRoundTrips:3];
+        [self.retrier setValue:connectedAt andPriority:nil onRef:newConnection operation:kFSOperationPresenceConnect completion:^(NSError *error, Firebase *ref) {
+            [metrics recordOperation:kFSOperationPresenceConnect latency:FSMetricsNow() - start error:error];
+            [tracer endSpan:connectSpan];
         }];
+        
+        // Set Disconnect To Remove Device;
+        [newConnection onDisconnectRemoveValue];
+        
+        // Set Last Online Timestamp
+        Firebase * lastOnlineRef = [self.refCache refWithRoot:[self rootForUserId:currentUserId] collection:@"Users" id:currentUserId leaf:@"lastOnline"];
+        
+        // Set Last Online To Timestamp
+        [lastOnlineRef onDisconnectSetValue:[NSString stringWithFormat:@"%f",[[NSDate new] timeIntervalSince1970]]];
     }
-    else {
-        NSLog(@"PresenceManager: Already Monitoring Connection!");
-    }
+    
+    // Notify Observers Of Connection Status Change -- Regardless Of Direction
+    if (snapshot.value != [NSNull new]) [self notifyConnectionStatusObservers:[snapshot.value boolValue]];
+    
 }
+
 // Broadcast Connection Status
 - (void) notifyConnectionStatusObservers:(BOOL)isConnected {
     
     //NSLog(@"PresenceManager: Notifying ConnectionStatusObservers isOnline: %@", isConnected ? @"YES" : @"NO");
     
-    // See If Any Observers Exist
-    if (_connectionStatusObservers) {
+    // See If Any Observers Exist -- Copied, So They May Unregister While Being Notified
+    if (_connectionStatusObservers.count == 0) return;
+    
+    NSArray * observers = [_connectionStatusObservers copy];
+    [self deliver:^{
         
         // Notify All Observers
-        for (NSDictionary * observer in _connectionStatusObservers) {
+        for (NSDictionary * observer in observers) {
             
             // Parse Observer Object
             NSObject * ob = observer[@"observerObject"];
@@ -99,11 +178,11 @@
             
             // Double Check That Selector Exists
             if ([ob respondsToSelector:selector]) {
-                
+            
                 IMP imp = [ob methodForSelector:selector];
                 void (*func)(id, SEL, BOOL) = (void *)imp;
                 func(ob, selector, isConnected);
-                
+            
             }
             else {
                 NSLog(@"\n\n **** Presence Manager: Attempt To Notify Connection Status Observer: %@ failed because selector did not exist **** \n\n", observer[@"observerObject"]);
@@ -138,109 +217,124 @@
              */
             
         }
-    }
+    }];
 }
 
 #pragma mark SET CONNECTION STATUS OBSERVERS
 
 - (void) registerConnectionStatusObserver:(NSObject *)observer
                              withSelector:(SEL)selector {
+    FSStateQueueAsync(stateQueue, ^{
     
-    if (!_connectionMonitor) {
-        [self startPresenceManager];
-    }
+        if (!connectionToken) {
+            [self startPresenceManager];
+        }
     
-    NSMethodSignature * sig = [observer methodSignatureForSelector:selector];
+        NSMethodSignature * sig = [observer methodSignatureForSelector:selector];
     
-    if ([sig numberOfArguments] != 3) {
-        // Why 3? -- "The hidden arguments self (of type id) and _cmd (of type SEL) are at indices 0 and 1; method-specific arguments begin at index 2." -- total count 3 means one arg
-        NSLog(@"\n\n**** 1:PresenceManager: Connection Status Observer Selector Must Take 1 Argument And That Argument Must Be Of Type: BOOL ****\n\n");
-        return;
-    }
+        if ([sig numberOfArguments] != 3) {
+            // Why 3? -- "The hidden arguments self (of type id) and _cmd (of type SEL) are at indices 0 and 1; method-specific arguments begin at index 2." -- total count 3 means one arg
+            NSLog(@"\n\n**** 1:PresenceManager: Connection Status Observer Selector Must Take 1 Argument And That Argument Must Be Of Type: BOOL ****\n\n");
+            return;
+        }
     
-    const char * arg = [sig getArgumentTypeAtIndex:2];
-    const char * arbooli = @encode(BOOL);
-    
-    // strcmp(str1, str2)
-    // 0 if same
-    // A value greater than zero indicates that the first character that does not match has a greater value in str1 than in str2;
-    // And a value less than zero indicates the opposite.
-    int stringCompare = strcmp(arg, arbooli);
-    
-    /* Option 1 - ASSERT
-     NSString * errorAssertString = @"***** Connection Status Observer Selector Must Take 1 Argument And That Argument Must Be BOOL *****";
-     NSAssert((0 == stringCompare && [sig numberOfArguments] == 3), errorAssertString);
-     // Why 3? -- "The hidden arguments self (of type id) and _cmd (of type SEL) are at indices 0 and 1; method-specific arguments begin at index 2." -- total count 3 means one arg
-     */
-    //NSLog(@"string compare: %i", stringCompare);
-    
-    /* Option 2 - WARN */
-    if (stringCompare != 0) {
-        // Why 3? -- "The hidden arguments self (of type id) and _cmd (of type SEL) are at indices 0 and 1; method-specific arguments begin at index 2." -- total count 3 means one arg
-        NSLog(@"\n\n**** 2:PresenceManager: Connection Status Observer Selector Must Take 1 Argument And That Argument Must Be Of Type: BOOL ****\n\n");
-        return;
-    }
+        const char * arg = [sig getArgumentTypeAtIndex:2];
+        const char * arbooli = @encode(BOOL);
+    
+        // strcmp(str1, str2)
+        // 0 if same
+        // A value greater than zero indicates that the first character that does not match has a greater value in str1 than in str2;
+        // And a value less than zero indicates the opposite.
+        int stringCompare = strcmp(arg, arbooli);
+    
+        /* Option 1 - ASSERT
+         NSString * errorAssertString = @"***** Connection Status Observer Selector Must Take 1 Argument And That Argument Must Be BOOL *****";
+         NSAssert((0 == stringCompare && [sig numberOfArguments] == 3), errorAssertString);
+         // Why 3? -- "The hidden arguments self (of type id) and _cmd (of type SEL) are at indices 0 and 1; method-specific arguments begin at index 2." -- total count 3 means one arg
+         */
+        //NSLog(@"string compare: %i", stringCompare);
+    
+        /* Option 2 - WARN */
+        if (stringCompare != 0) {
+            // Why 3? -- "The hidden arguments self (of type id) and _cmd (of type SEL) are at indices 0 and 1; method-specific arguments begin at index 2." -- total count 3 means one arg
+            NSLog(@"\n\n**** 2:PresenceManager: Connection Status Observer Selector Must Take 1 Argument And That Argument Must Be Of Type: BOOL ****\n\n");
+            return;
+        }
     
-    // Create Connection Status Observers Pool If Necessary
-    if (!_connectionStatusObservers) _connectionStatusObservers = [NSMutableArray new];
+        // Create Connection Status Observers Pool If Necessary
+        if (!_connectionStatusObservers) _connectionStatusObservers = [NSMutableArray new];
     
-    // Check Registration
-    if (![self isConnectionStatusObserverAlreadyRegistered:observer]) {
+        // Check Registration
+        if (![self isConnectionStatusObserverAlreadyRegistered:observer]) {
         
-        // Generate New Observer
-        NSMutableDictionary * newObserver = [NSMutableDictionary new];
-        newObserver[@"observerObject"] = observer;
-        newObserver[@"selector"] = [NSValue valueWithPointer:selector];
-        [_connectionStatusObservers addObject:newObserver];
-    }
-    else {
-        // Observer Already Exists
-        NSLog(@"\n\n **** 3:PresenceManager: Attempt to add connectionStatusObserver that already exists **** \n\n");
-    }
+            // Generate New Observer
+            NSMutableDictionary * newObserver = [NSMutableDictionary new];
+            newObserver[@"observerObject"] = observer;
+            newObserver[@"selector"] = [NSValue valueWithPointer:selector];
+            [_connectionStatusObservers addObject:newObserver];
+            [self updateMetricsGauges];
+        }
+        else {
+            // Observer Already Exists
+            NSLog(@"\n\n **** 3:PresenceManager: Attempt to add connectionStatusObserver that already exists **** \n\n");
+        }
     
-    //NSAssert(0 == strcmp(@encode(BOOL), [sig getArgumentTypeAtIndex:2]),
-    //       @"Selector must take a BOOL as its sole argument.");
-    // NSLog(@"%s",[sig getArgumentTypeAtIndex:2]);
-    //NSAssert(0 == strcmp(@encode(id), [sig getArgumentTypeAtIndex:2]),
-    //       @"Selector must take a NSString as its sole argument.");
+        //NSAssert(0 == strcmp(@encode(BOOL), [sig getArgumentTypeAtIndex:2]),
+        //       @"Selector must take a BOOL as its sole argument.");
+        // NSLog(@"%s",[sig getArgumentTypeAtIndex:2]);
+        //NSAssert(0 == strcmp(@encode(id), [sig getArgumentTypeAtIndex:2]),
+        //       @"Selector must take a NSString as its sole argument.");
     
+    });
 }
 
 #pragma mark REMOVE CONNECTION STATUS OBSERVERS
 
 - (void) removeAllConnectionStatusObservers {
-    if (_connectionStatusObservers) {
-        [_connectionStatusObservers removeAllObjects];
-        _connectionStatusObservers = nil;
-    }
+    FSStateQueueAsync(stateQueue, ^{
+        if (_connectionStatusObservers) {
+            [_connectionStatusObservers removeAllObjects];
+            _connectionStatusObservers = nil;
+            [self updateMetricsGauges];
+        }
+    });
 }
 
 - (void) removeConnectionStatusObserver:(NSObject *)observer {
-    if ([self isConnectionStatusObserverAlreadyRegistered:observer]) {
-        [_connectionStatusObservers removeObject:observer];
-    }
+    FSStateQueueAsync(stateQueue, ^{
+        if ([self isConnectionStatusObserverAlreadyRegistered:observer]) {
+            NSIndexSet * matches = [_connectionStatusObservers indexesOfObjectsPassingTest:^BOOL(NSDictionary * dict, NSUInteger idx, BOOL *stop) {
+                return dict[@"observerObject"] == observer;
+            }];
+            [_connectionStatusObservers removeObjectsAtIndexes:matches];
+            [self updateMetricsGauges];
+        }
+    });
 }
 
 - (void) removeAllConnectionStatusObserversExcept:(NSObject *)observer {
-    if (_connectionStatusObservers) {
-        if ([self isConnectionStatusObserverAlreadyRegistered:observer]) {
-            NSMutableDictionary * observerToSave;
-            for (NSMutableDictionary * dict in _connectionStatusObservers) {
-                if (dict[@"observerObject"] == observer) {
-                    observerToSave = dict;
-                    break;
+    FSStateQueueAsync(stateQueue, ^{
+        if (_connectionStatusObservers) {
+            if ([self isConnectionStatusObserverAlreadyRegistered:observer]) {
+                NSMutableDictionary * observerToSave;
+                for (NSMutableDictionary * dict in _connectionStatusObservers) {
+                    if (dict[@"observerObject"] == observer) {
+                        observerToSave = dict;
+                        break;
+                    }
                 }
+                [_connectionStatusObservers removeAllObjects];
+                if (observerToSave) [_connectionStatusObservers addObject:observerToSave];
+                [self updateMetricsGauges];
+            }
+            else {
+                NSLog(@"\n\n **** PresenceManager: Attempt to RemoveAllConnectionStatusObserversExcept: - Observer Hasn't Been Created **** \n\n");
             }
-            [_connectionStatusObservers removeAllObjects];
-            if (observerToSave) [_connectionStatusObservers addObject:observerToSave];
         }
         else {
-            NSLog(@"\n\n **** PresenceManager: Attempt to RemoveAllConnectionStatusObserversExcept: - Observer Hasn't Been Created **** \n\n");
+            NSLog(@"\n\n **** PresenceManager: Attempt to RemoveAllConnectionStatusObserversExcept: - No Observers Exist **** \n\n");
         }
-    }
-    else {
-        NSLog(@"\n\n **** PresenceManager: Attempt to RemoveAllConnectionStatusObserversExcept: - No Observers Exist **** \n\n");
-    }
+    });
 }
 
 // Instance Level
@@ -261,122 +355,139 @@
 - (void) registerUserStatusObserver:(NSObject *)observer
                        withSelector:(SEL)selector
                           forUserId:(NSString *)userIdToObserve {
+    FSStateQueueAsync(stateQueue, ^{
     
-    //--> GoodSelector = userStatusDidUpdateWithId:(NSString *)userId andStatus:(BOOL)isOnline;
+        //--> GoodSelector = userStatusDidUpdateWithId:(NSString *)userId andStatus:(BOOL)isOnline;
     
-    // Verify Selector
-    NSMethodSignature * sig = [observer methodSignatureForSelector:selector];
+        // Verify Selector
+        NSMethodSignature * sig = [observer methodSignatureForSelector:selector];
     
-    // Check For 2 Arguments
-    if ([sig numberOfArguments] != 4) {
-        // Why 4? -- "The hidden arguments self (of type id) and _cmd (of type SEL) are at indices 0 and 1; method-specific arguments begin at index 2." -- total count 4 means two args
-        NSLog(@"\n\n 1:**** PresenceManager: User Status Observer Selector Must Take 2 Arguments - (1st = NSString, 2nd = BOOL)  ****\n\n");
-        return;
-    }
+        // Check For 2 Arguments
+        if ([sig numberOfArguments] != 4) {
+            // Why 4? -- "The hidden arguments self (of type id) and _cmd (of type SEL) are at indices 0 and 1; method-specific arguments begin at index 2." -- total count 4 means two args
+            NSLog(@"\n\n 1:**** PresenceManager: User Status Observer Selector Must Take 2 Arguments - (1st = NSString, 2nd = BOOL)  ****\n\n");
+            return;
+        }
     
-    // Get Argument Chars
-    const char * arg1 = [sig getArgumentTypeAtIndex:2];
-    const char * arg2 = [sig getArgumentTypeAtIndex:3];
+        // Get Argument Chars
+        const char * arg1 = [sig getArgumentTypeAtIndex:2];
+        const char * arg2 = [sig getArgumentTypeAtIndex:3];
     
-    const char * obChar = @encode(id);
-    const char * boolChar = @encode(BOOL);
+        const char * obChar = @encode(id);
+        const char * boolChar = @encode(BOOL);
     
-    // strcmp(str1, str2)
-    // 0 if same
-    // A value greater than zero indicates that the first character that does not match has a greater value in str1 than in str2;
-    // And a value less than zero indicates the opposite.
+        // strcmp(str1, str2)
+        // 0 if same
+        // A value greater than zero indicates that the first character that does not match has a greater value in str1 than in str2;
+        // And a value less than zero indicates the opposite.
     
-    // Ob 1 -> Object (should be NSString)
-    int firstArgStringCompare = strcmp(arg1, obChar);
+        // Ob 1 -> Object (should be NSString)
+        int firstArgStringCompare = strcmp(arg1, obChar);
     
-    // Ob 2 -> BOOL
-    int secondArgStringCompare = strcmp(arg2, boolChar);
+        // Ob 2 -> BOOL
+        int secondArgStringCompare = strcmp(arg2, boolChar);
     
-    // Argument Types Check
-    if (firstArgStringCompare != 0 || secondArgStringCompare != 0) {
-        NSLog(@"\n\n**** 2:PresenceManager: User Status Observer Selector Must Take 2 Arguments - (1st = NSString, 2nd = BOOL)  ****\n\n");
-        return;
-    }
+        // Argument Types Check
+        if (firstArgStringCompare != 0 || secondArgStringCompare != 0) {
+            NSLog(@"\n\n**** 2:PresenceManager: User Status Observer Selector Must Take 2 Arguments - (1st = NSString, 2nd = BOOL)  ****\n\n");
+            return;
+        }
     
-    // At this point, the selector has passed verification!
+        // At this point, the selector has passed verification!
     
-    // Generate New Observer
-    NSMutableDictionary * newObserver = [NSMutableDictionary new];
-    newObserver[@"observerObject"] = observer;
-    newObserver[@"selector"] = [NSValue valueWithPointer:selector];
-    newObserver[@"userId"] = userIdToObserve;
+        // Generate New Observer
+        NSMutableDictionary * newObserver = [NSMutableDictionary new];
+        newObserver[@"observerObject"] = observer;
+        newObserver[@"selector"] = [NSValue valueWithPointer:selector];
+        newObserver[@"userId"] = userIdToObserve;
     
-    // Check Registration
-    if (![self doesUserStatusObserverAlreadyExist:newObserver]) {
+        // Check Registration
+        if (![self doesUserStatusObserverAlreadyExist:newObserver]) {
         
-        // Is New User Status Observer
-        [self createMonitorForNewUserStatusObserver:newObserver];
+            // Is New User Status Observer
+            [self createMonitorForNewUserStatusObserver:newObserver];
         
-    }
-    else {
+        }
+        else {
         
-        // User Status Observer Already Exists
-        NSLog(@"\n\n 3:PresenceManager: Attempt to add userStatusObserver that already exists \n\n");
-    }
+            // User Status Observer Already Exists
+            NSLog(@"\n\n 3:PresenceManager: Attempt to add userStatusObserver that already exists \n\n");
+        }
     
+    });
 }
 // Broadcast User Status
 - (void) createMonitorForNewUserStatusObserver:(NSMutableDictionary *)newObserver {
     
     // Create UserStatusMonitor If Necessary
     if (!_userStatusMonitor) {
-        NSString * userStatusMonitorString = [NSString stringWithFormat:@"%@%@", _urlRefString, @"Users/"];
-        //NSLog(@"STRING: %@", userStatusMonitorString);
-        _userStatusMonitor = [[Firebase alloc]initWithUrl:userStatusMonitorString];
-        //NSLog(@"userStatusMonitor: %@", userStatusMonitor);
+        _userStatusMonitor = [self.refCache refWithRoot:self.urlRefString collection:@"Users" id:nil leaf:nil];
     }
     
-    // Generate Child For User
-    Firebase * childRef = [_userStatusMonitor childByAppendingPath:[NSString stringWithFormat:@"%@/connections/", newObserver[@"userId"]]];
-    
-    // Monitor This User's Connection Status
-    FirebaseHandle userHandle = [childRef observeEventType:FEventTypeValue withBlock:^(FDataSnapshot *snapshot) {
-        
-//        NSLog(@"Received User Statusupdate: %@", snapshot.value);
-        
-        // Set Offline
-        BOOL isOnline = NO;
-        
-        // Snapshot Array Of Connected Devices
-        if (snapshot.value != [NSNull new]) {
+    // Monitor This User's Connection Status -- Registration Ends With The First Status, Observers Of One User Share A Listener
+    FSTracer * tracer = self.tracer;
+    FSTraceSpan registerSpan = [tracer beginSpan:"presence.registerUserStatusObserver" parent:FSTraceSpanNone];
+    __block BOOL hasReceivedStatus = NO;
+    FSEventHubToken userToken = [self.eventHub observeEventType:FEventTypeValue atRoot:[self rootForUserId:newObserver[@"userId"]] collection:@"Users" id:newObserver[@"userId"] leaf:@"connections" withBlock:^(FDataSnapshot *snapshot) {
+        dispatch_async(stateQueue, ^{
             
-            // User Is Online
-            isOnline = YES;
-        }
-        
-        // Parse Out Observer Dict
-        NSObject * ob = newObserver[@"observerObject"];
-        SEL selector = [newObserver[@"selector"] pointerValue];
-        
-        // Double Check That Selector Exists
-        if ([ob respondsToSelector:selector]) {
+//            NSLog(@"Received User Statusupdate: %@", snapshot.value);
             
-            // Parse And Execute Selector
-            IMP imp = [ob methodForSelector:selector];
-            void (*func)(id, SEL, NSString*, BOOL) = (void *)imp;
-            func(ob, selector, newObserver[@"userId"], isOnline);
+            // Removed While Queued
+            if ([_userStatusObservers indexOfObjectIdenticalTo:newObserver] == NSNotFound) return;
             
-        }
-        else {
+            // Set Offline
+            BOOL isOnline = NO;
             
-            // Notify Of Error
-            NSLog(@"\n\n **** Presence Manager: Attempt To Notify UserStatusObserver: %@ failed because selector did not exist **** \n\n", newObserver[@"observerObject"]);
-        }
+            // Snapshot Array Of Connected Devices
+            if (snapshot.value != [NSNull new]) {
+                
+                // User Is Online
+                isOnline = YES;
+            }
+            
+            // The First Status Closes Registration
+            FSTraceSpan parentSpan = hasReceivedStatus ? FSTraceSpanNone : registerSpan;
+            hasReceivedStatus = YES;
+            
+            [self deliver:^{
+                
+                // Parse Out Observer Dict
+                NSObject * ob = newObserver[@"observerObject"];
+                SEL selector = [newObserver[@"selector"] pointerValue];
+                
+                // Double Check That Selector Exists
+                if ([ob respondsToSelector:selector]) {
+                    
+                    // Parse And Execute Selector
+                    FSTraceSpan notifySpan = [tracer beginSpan:"presence.notifyUserStatusObserver" parent:parentSpan];
+                    IMP imp = [ob methodForSelector:selector];
+                    void (*func)(id, SEL, NSString*, BOOL) = (void *)imp;
+                    func(ob, selector, newObserver[@"userId"], isOnline);
+                    [tracer endSpan:notifySpan];
+                    
+                }
+                else {
+                    
+                    // Notify Of Error
+                    NSLog(@"\n\n **** Presence Manager: Attempt To Notify UserStatusObserver: %@ failed because selector did not exist **** \n\n", newObserver[@"observerObject"]);
+                }
+                
+                if (parentSpan.spanId) [tracer endSpan:registerSpan];
+            }];
+            
+        });
     }];
     
-    // Add Handle To Stop Later
-    newObserver[@"firebaseHandle"] = [NSNumber numberWithInt:userHandle];
+    // Add Token To Stop Later
+    newObserver[@"eventToken"] = @(userToken);
     
     // Create UserStatusObservers Pool If Necessary
     if (!_userStatusObservers) _userStatusObservers = [NSMutableArray new];
     
     // Add Observer To Our Collection
     [_userStatusObservers addObject:newObserver];
+    [self updateMetricsGauges];
     
     // NSLog(@"UserStatusObservers: %@", userStatusObservers);
     
@@ -385,104 +496,125 @@
 #pragma mark REMOVE USER STATUS OBSERVERS
 
 - (void) removeAllUserStatusObservers {
-    if (_userStatusObservers) {
-        for (NSMutableDictionary * observerOb in _userStatusObservers) {
-            [_userStatusMonitor removeObserverWithHandle:[observerOb[@"firebaseHandle"]intValue]];
+    FSStateQueueAsync(stateQueue, ^{
+        if (_userStatusObservers) {
+            for (NSMutableDictionary * observerOb in _userStatusObservers) {
+                [self.eventHub removeObserverWithToken:[observerOb[@"eventToken"] unsignedIntegerValue]];
+            }
+            _userStatusObservers = nil;
+            [self updateMetricsGauges];
         }
-        _userStatusObservers = nil;
-    }
+    });
 }
 
 - (void) removeUserStatusObserversForObject:(NSObject *)observerToRemove {
-    if (_userStatusObservers) {
-        NSMutableArray * keepers = [NSMutableArray new];
-        for (NSMutableDictionary * observerOb in _userStatusObservers) {
-            if (observerOb[@"observerObject"] == observerToRemove) {
-                [_userStatusMonitor removeObserverWithHandle:[observerOb[@"firebaseHandle"]intValue]];
-            }
-            else {
-                [keepers addObject:observerOb];
+    FSStateQueueAsync(stateQueue, ^{
+        if (_userStatusObservers) {
+            NSMutableArray * keepers = [NSMutableArray new];
+            for (NSMutableDictionary * observerOb in _userStatusObservers) {
+                if (observerOb[@"observerObject"] == observerToRemove) {
+                    [self.eventHub removeObserverWithToken:[observerOb[@"eventToken"] unsignedIntegerValue]];
+                }
+                else {
+                    [keepers addObject:observerOb];
+                }
             }
+            _userStatusObservers = keepers;
+            [self updateMetricsGauges];
         }
-        _userStatusObservers = keepers;
-    }
+    });
 }
 
 - (void) removeUserStatusObserversForUserId:(NSString *)userIdToRemove {
-    if (_userStatusObservers) {
-        NSMutableArray * keepers = [NSMutableArray new];
-        for (NSMutableDictionary * observerOb in _userStatusObservers) {
-            if ([observerOb[@"userId"] isEqualToString:userIdToRemove]) {
-                [_userStatusMonitor removeObserverWithHandle:[observerOb[@"firebaseHandle"]intValue]];
-            }
-            else {
-                [keepers addObject:observerOb];
+    FSStateQueueAsync(stateQueue, ^{
+        if (_userStatusObservers) {
+            NSMutableArray * keepers = [NSMutableArray new];
+            for (NSMutableDictionary * observerOb in _userStatusObservers) {
+                if ([observerOb[@"userId"] isEqualToString:userIdToRemove]) {
+                    [self.eventHub removeObserverWithToken:[observerOb[@"eventToken"] unsignedIntegerValue]];
+                }
+                else {
+                    [keepers addObject:observerOb];
+                }
             }
+            _userStatusObservers = keepers;
+            [self updateMetricsGauges];
         }
-        _userStatusObservers = keepers;
-    }
+    });
 }
 
 - (void) removeStatusObserverForObject:(NSObject *)observerToRemove
                              andUserId:(NSString *)userIdToRemove {
-    if (_userStatusObservers) {
-        NSMutableArray * keepers = [NSMutableArray new];
-        for (NSMutableDictionary * observerOb in _userStatusObservers) {
-            if (observerOb[@"observerObject"] == observerToRemove && [observerOb[@"userId"]isEqualToString:userIdToRemove]) {
-                [_userStatusMonitor removeObserverWithHandle:[observerOb[@"firebaseHandle"]intValue]];
-            }
-            else {
-                [keepers addObject:observerOb];
+    FSStateQueueAsync(stateQueue, ^{
+        if (_userStatusObservers) {
+            NSMutableArray * keepers = [NSMutableArray new];
+            for (NSMutableDictionary * observerOb in _userStatusObservers) {
+                if (observerOb[@"observerObject"] == observerToRemove && [observerOb[@"userId"]isEqualToString:userIdToRemove]) {
+                    [self.eventHub removeObserverWithToken:[observerOb[@"eventToken"] unsignedIntegerValue]];
+                }
+                else {
+                    [keepers addObject:observerOb];
+                }
             }
+            _userStatusObservers = keepers;
+            [self updateMetricsGauges];
         }
-        _userStatusObservers = keepers;
-    }
+    });
 }
 
 - (void) removeAllUserStatusObserverObjectsExcept:(NSObject *)observerToKeep {
-    if (_userStatusObservers) {
-        NSMutableArray * keepers = [NSMutableArray new];
-        for (NSMutableDictionary * observerOb in _userStatusObservers) {
-            if (observerOb[@"observerObject"] == observerToKeep) {
-                [keepers addObject:observerOb];
-            }
-            else {
-                [_userStatusMonitor removeObserverWithHandle:[observerOb[@"firebaseHandle"]intValue]];
+    FSStateQueueAsync(stateQueue, ^{
+        if (_userStatusObservers) {
+            NSMutableArray * keepers = [NSMutableArray new];
+            for (NSMutableDictionary * observerOb in _userStatusObservers) {
+                if (observerOb[@"observerObject"] == observerToKeep) {
+                    [keepers addObject:observerOb];
+                }
+                else {
+                    [self.eventHub removeObserverWithToken:[observerOb[@"eventToken"] unsignedIntegerValue]];
+                }
             }
+            _userStatusObservers = keepers;
+            [self updateMetricsGauges];
         }
-        _userStatusObservers = keepers;
-    }
+    });
 }
 
 - (void) removeAllUserStatusObserversExceptForUserId:(NSString *)userIdToKeep {
-    if (_userStatusObservers) {
-        NSMutableArray * keepers = [NSMutableArray new];
-        for (NSMutableDictionary * observerOb in _userStatusObservers) {
-            if ([observerOb[@"userId"]isEqualToString:userIdToKeep]) {
-                [keepers addObject:observerOb];
-            }
-            else {
-                [_userStatusMonitor removeObserverWithHandle:[observerOb[@"firebaseHandle"]intValue]];
+    FSStateQueueAsync(stateQueue, ^{
+        if (_userStatusObservers) {
+            NSMutableArray * keepers = [NSMutableArray new];
+            for (NSMutableDictionary * observerOb in _userStatusObservers) {
+                if ([observerOb[@"userId"]isEqualToString:userIdToKeep]) {
+                    [keepers addObject:observerOb];
+                }
+                else {
+                    [self.eventHub removeObserverWithToken:[observerOb[@"eventToken"] unsignedIntegerValue]];
+                }
             }
+            _userStatusObservers = keepers;
+            [self updateMetricsGauges];
         }
-        _userStatusObservers = keepers;
-    }
+    });
 }
 
 - (void) removeAllUserStatusObserversExceptForObserverObject:(NSObject *)observerToKeep
                                                    andUserId:(NSString *)userIdToKeep {
-    if (_userStatusObservers) {
-        NSMutableArray * keepers = [NSMutableArray new];
-        for (NSMutableDictionary * observerOb in _userStatusObservers) {
-            if (observerOb[@"observerObject"] == observerToKeep && [observerOb[@"userId"]isEqualToString:userIdToKeep]) {
-                [keepers addObject:observerOb];
-            }
-            else {
-                [_userStatusMonitor removeObserverWithHandle:[observerOb[@"firebaseHandle"]intValue]];
+    FSStateQueueAsync(stateQueue, ^{
+        if (_userStatusObservers) {
+            NSMutableArray * keepers = [NSMutableArray new];
+            for (NSMutableDictionary * observerOb in _userStatusObservers) {
+                if (observerOb[@"observerObject"] == observerToKeep && [observerOb[@"userId"]isEqualToString:userIdToKeep]) {
+                    [keepers addObject:observerOb];
+                }
+                else {
+                    [self.eventHub removeObserverWithToken:[observerOb[@"eventToken"] unsignedIntegerValue]];
+                }
             }
+            _userStatusObservers = keepers;
+            [self updateMetricsGauges];
         }
-        _userStatusObservers = keepers;
-    }
+    });
 }
 
 // Instance Checker
@@ -498,14 +630,91 @@
     
 }
 
+#pragma mark PROMISES
+
+- (FSPromise *) userStatusForUserId:(NSString *)userId {
+    FSPromise * promise = [FSPromise promise];
+    
+    // Both Only Touched On stateQueue
+    __block FSEventHubToken token;
+    __block BOOL isObserving = NO;
+    
+    void (^stopObserving)(void) = ^{
+        if (!isObserving) return;
+        isObserving = NO;
+        [self.eventHub removeObserverWithToken:token];
+    };
+    
+    FSStateQueueAsync(stateQueue, ^{
+        
+        // Cancelled Before We Started
+        if (promise.isSettled) return;
+        
+        isObserving = YES;
+        token = [self.eventHub observeEventType:FEventTypeValue atRoot:[self rootForUserId:userId] collection:@"Users" id:userId leaf:@"connections" withBlock:^(FDataSnapshot *snapshot) {
+            dispatch_async(stateQueue, ^{
+                if (!isObserving) return;
+                stopObserving();
+                
+                BOOL isOnline = snapshot.value != [NSNull new];
+                [self deliver:^{
+                    [promise fulfillWithValue:@(isOnline)];
+                }];
+            });
+        } withCancelBlock:^(NSError *error) {
+            dispatch_async(stateQueue, ^{
+                if (!isObserving) return;
+                stopObserving();
+                
+                [self deliver:^{
+                    [promise rejectWithError:error];
+                }];
+            });
+        }];
+    });
+    
+    [promise addCancelBlock:^{
+        FSStateQueueAsync(stateQueue, stopObserving);
+    }];
+    return promise;
+}
+
 #pragma mark END PRESENCE MONITOR
 
 - (void) stopPresenceMonitorWithCompletion:(void(^)(void))completion {
-    [self removeAllUserStatusObservers];
-    [self removeAllConnectionStatusObservers];
-    [_connectionMonitor removeAllObservers];
-    [_userStatusMonitor removeAllObservers];
-    completion();
+    FSStateQueueAsync(stateQueue, ^{
+        [self removeAllUserStatusObservers];
+        [self removeAllConnectionStatusObservers];
+        [_userStatusMonitor removeAllObservers];
+        
+        // Released So The Next Start Observes Again
+        [self.eventHub removeObserverWithToken:connectionToken];
+        connectionToken = 0;
+        
+        // Never Connected -- Nothing Of Ours To Take Down
+        Firebase * connection = connectionRef;
+        connectionRef = nil;
+        if (!connection) {
+            if (completion) [self deliver:completion];
+            return;
+        }
+        
+        // Offline Now, Not When The Socket Drops -- Done Here What The onDisconnects Would Have Done
+        NSString * currentUserId = self.currentUserId;
+        Firebase * lastOnlineRef = [self.refCache refWithRoot:[self rootForUserId:currentUserId] collection:@"Users" id:currentUserId leaf:@"lastOnline"];
+        [connection cancelDisconnectOperations];
+        [lastOnlineRef cancelDisconnectOperations];
+        [lastOnlineRef setValue:[NSString stringWithFormat:@"%f",[[NSDate new] timeIntervalSince1970]]];
+        
+        // Complete Once The Server Has Us Offline
+        FSMetrics * metrics = self.metrics;
+        NSTimeInterval start = FSMetricsNow();
+        [metrics recordRoundTrips:3];
+        [self.retrier removeValueOnRef:connection operation:kFSOperationPresenceDisconnect completion:^(NSError *error, Firebase *ref) {
+            [metrics recordOperation:kFSOperationPresenceDisconnect latency:FSMetricsNow() - start error:error];
+            if (completion) [self deliver:completion];
+        }];
+    });
 }
 
 @end
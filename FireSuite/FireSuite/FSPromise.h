@@ -0,0 +1,92 @@
+//
+//  FSPromise.h
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#pragma mark CONSTANTS
+
+typedef enum {
+    FSPromiseErrorCancelled = 1,
+    FSPromiseErrorTimedOut = 2,
+    FSPromiseErrorNoneFulfilled = 3,
+} FSPromiseErrorCode;
+
+// Error Keys
+FOUNDATION_EXPORT NSString *const kFSPromiseErrorDomain;
+
+/*!
+ A result that arrives later -- fulfilled with a value or rejected with an error, exactly once.  Chain steps with then:, run independent ones side by side with all: / any:, bound them with withDeadline:.  Cancelling rejects with FSPromiseErrorCancelled and runs the cancel blocks, which tear down whatever is producing the result -- observers, queries, upstream promises.
+
+ Blocks run on the thread that settles the promise -- for manager promises, the manager's callbackQueue -- or right away if it already has.  Thread safe.
+ */
+@interface FSPromise : NSObject
+
+#pragma mark CREATE
+
++ (FSPromise *) promise;
++ (FSPromise *) promiseWithValue:(id)value;
++ (FSPromise *) promiseWithError:(NSError *)error;
+
+/*!
+ Fulfilled with an array of every value, in order -- nil values become NSNull.  The first rejection rejects it and cancels the rest.
+ */
++ (FSPromise *) all:(NSArray *)promises;
+
+/*!
+ Fulfilled with the first value and cancels the rest.  Rejected with the last error once every promise fails.
+ */
++ (FSPromise *) any:(NSArray *)promises;
+
+#pragma mark SETTLE
+
+/*!
+ @return NO if already settled
+ */
+- (BOOL) fulfillWithValue:(id)value;
+- (BOOL) rejectWithError:(NSError *)error;
+
+@property (readonly) BOOL isSettled;
+@property (readonly) BOOL isCancelled;
+
+/*!
+ nil until settled
+ */
+@property (strong, readonly) id value;
+@property (strong, readonly) NSError * error;
+
+/*!
+ Settles the promise from a completion block -- rejects if error is set, otherwise fulfills with value
+ */
+@property (copy, readonly) void (^resolver)(id value, NSError * error);
+
+#pragma mark OBSERVE
+
+- (void) addCompletionBlock:(void (^)(id value, NSError * error))completion;
+
+/*!
+ Runs @param block with the value -- return a value, an FSPromise to wait on, or an NSError to reject.  Errors skip the block and pass through.  Cancelling the result cancels this promise and the one the block returned.
+ */
+- (FSPromise *) then:(id (^)(id value))block;
+
+/*!
+ Cancelled with FSPromiseErrorTimedOut, cancelling this promise too, if it hasn't settled within @param seconds
+ */
+- (FSPromise *) withDeadline:(NSTimeInterval)seconds;
+
+#pragma mark CANCEL
+
+/*!
+ Run when the promise is cancelled -- right away if it already was
+ */
+- (void) addCancelBlock:(dispatch_block_t)block;
+
+/*!
+ No-op once settled
+ */
+- (void) cancel;
+
+@end
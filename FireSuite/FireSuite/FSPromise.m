@@ -0,0 +1,300 @@
+//
+//  FSPromise.m
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import "FSPromise.h"
+#import <pthread.h>
+
+#pragma mark KEYS
+
+// Error Keys
+NSString *const kFSPromiseErrorDomain = @"kFSPromiseErrorDomain";
+
+static NSError * FSPromiseError(FSPromiseErrorCode code, NSString * description) {
+    return [NSError errorWithDomain:kFSPromiseErrorDomain
+                               code:code
+                           userInfo:@{NSLocalizedDescriptionKey: NSLocalizedString(description, nil)}];
+}
+
+@interface FSPromise ()
+{
+    pthread_mutex_t _lock;
+    
+    BOOL _isSettled;
+    BOOL _isCancelled;
+    id _value;
+    NSError * _error;
+    
+    // Dropped Once Run
+    NSMutableArray * _completionBlocks;
+    NSMutableArray * _cancelBlocks;
+}
+@end
+
+@implementation FSPromise
+
+#pragma mark CREATE
+
++ (FSPromise *) promise {
+    return [FSPromise new];
+}
+
++ (FSPromise *) promiseWithValue:(id)value {
+    FSPromise * promise = [FSPromise new];
+    [promise fulfillWithValue:value];
+    return promise;
+}
+
++ (FSPromise *) promiseWithError:(NSError *)error {
+    FSPromise * promise = [FSPromise new];
+    [promise rejectWithError:error];
+    return promise;
+}
+
+- (instancetype) init {
+    self = [super init];
+    if (self) {
+        pthread_mutex_init(&_lock, NULL);
+    }
+    return self;
+}
+
+- (void) dealloc {
+    pthread_mutex_destroy(&_lock);
+}
+
+#pragma mark COMBINE
+
++ (FSPromise *) all:(NSArray *)promises {
+    FSPromise * combined = [FSPromise new];
+    if (promises.count == 0) {
+        [combined fulfillWithValue:@[]];
+        return combined;
+    }
+    
+    NSMutableArray * values = [NSMutableArray arrayWithCapacity:promises.count];
+    for (NSUInteger i = 0; i < promises.count; i++) [values addObject:[NSNull null]];
+    __block NSUInteger remaining = promises.count;
+    
+    [promises enumerateObjectsUsingBlock:^(FSPromise * promise, NSUInteger i, BOOL *stop) {
+        [promise addCompletionBlock:^(id value, NSError * error) {
+            if (error) {
+                if ([combined rejectWithError:error]) [FSPromise cancelPromises:promises];
+                return;
+            }
+            BOOL isLast;
+            @synchronized (values) {
+                if (value) values[i] = value;
+                isLast = --remaining == 0;
+            }
+            if (isLast) [combined fulfillWithValue:[values copy]];
+        }];
+    }];
+    
+    [combined addCancelBlock:^{
+        [FSPromise cancelPromises:promises];
+    }];
+    return combined;
+}
+
++ (FSPromise *) any:(NSArray *)promises {
+    FSPromise * combined = [FSPromise new];
+    if (promises.count == 0) {
+        [combined rejectWithError:FSPromiseError(FSPromiseErrorNoneFulfilled, @"No Promises To Wait On")];
+        return combined;
+    }
+    
+    __block NSUInteger remaining = promises.count;
+    NSObject * lock = [NSObject new];
+    
+    for (FSPromise * promise in promises) {
+        [promise addCompletionBlock:^(id value, NSError * error) {
+            if (!error) {
+                if ([combined fulfillWithValue:value]) [FSPromise cancelPromises:promises];
+                return;
+            }
+            BOOL isLast;
+            @synchronized (lock) {
+                isLast = --remaining == 0;
+            }
+            if (isLast) [combined rejectWithError:error];
+        }];
+    }
+    
+    [combined addCancelBlock:^{
+        [FSPromise cancelPromises:promises];
+    }];
+    return combined;
+}
+
++ (void) cancelPromises:(NSArray *)promises {
+    for (FSPromise * promise in promises) [promise cancel];
+}
+
+#pragma mark SETTLE
+
+- (BOOL) fulfillWithValue:(id)value {
+    return [self settleWithValue:value error:nil cancelled:NO];
+}
+
+- (BOOL) rejectWithError:(NSError *)error {
+    return [self settleWithValue:nil error:error cancelled:NO];
+}
+
+- (BOOL) settleWithValue:(id)value error:(NSError *)error cancelled:(BOOL)cancelled {
+    pthread_mutex_lock(&_lock);
+    if (_isSettled) {
+        pthread_mutex_unlock(&_lock);
+        return NO;
+    }
+    _isSettled = YES;
+    _isCancelled = cancelled;
+    _value = value;
+    _error = error;
+    
+    NSArray * completionBlocks = _completionBlocks;
+    NSArray * cancelBlocks = cancelled ? _cancelBlocks : nil;
+    _completionBlocks = nil;
+    _cancelBlocks = nil;
+    pthread_mutex_unlock(&_lock);
+    
+    // Outside The Lock -- Blocks May Chain Back Into Us
+    for (dispatch_block_t block in cancelBlocks) block();
+    for (void (^completion)(id, NSError *) in completionBlocks) completion(value, error);
+    return YES;
+}
+
+- (void (^)(id, NSError *)) resolver {
+    return ^(id value, NSError * error) {
+        if (error) [self rejectWithError:error];
+        else [self fulfillWithValue:value];
+    };
+}
+
+- (BOOL) isSettled {
+    pthread_mutex_lock(&_lock);
+    BOOL isSettled = _isSettled;
+    pthread_mutex_unlock(&_lock);
+    return isSettled;
+}
+
+- (BOOL) isCancelled {
+    pthread_mutex_lock(&_lock);
+    BOOL isCancelled = _isCancelled;
+    pthread_mutex_unlock(&_lock);
+    return isCancelled;
+}
+
+- (id) value {
+    pthread_mutex_lock(&_lock);
+    id value = _value;
+    pthread_mutex_unlock(&_lock);
+    return value;
+}
+
+- (NSError *) error {
+    pthread_mutex_lock(&_lock);
+    NSError * error = _error;
+    pthread_mutex_unlock(&_lock);
+    return error;
+}
+
+#pragma mark OBSERVE
+
+- (void) addCompletionBlock:(void (^)(id value, NSError * error))completion {
+    pthread_mutex_lock(&_lock);
+    if (!_isSettled) {
+        if (!_completionBlocks) _completionBlocks = [NSMutableArray new];
+        [_completionBlocks addObject:[completion copy]];
+        pthread_mutex_unlock(&_lock);
+        return;
+    }
+    id value = _value;
+    NSError * error = _error;
+    pthread_mutex_unlock(&_lock);
+    
+    completion(value, error);
+}
+
+- (FSPromise *) then:(id (^)(id value))block {
+    FSPromise * next = [FSPromise new];
+    
+    [self addCompletionBlock:^(id value, NSError * error) {
+        if (error) {
+            [next rejectWithError:error];
+            return;
+        }
+        
+        // The Next Step Was Cancelled While We Waited
+        if (next.isSettled) return;
+        
+        id result = block(value);
+        if ([result isKindOfClass:[FSPromise class]]) {
+            [next addCancelBlock:^{
+                [result cancel];
+            }];
+            [result addCompletionBlock:^(id innerValue, NSError * innerError) {
+                if (innerError) [next rejectWithError:innerError];
+                else [next fulfillWithValue:innerValue];
+            }];
+        }
+        else if ([result isKindOfClass:[NSError class]]) {
+            [next rejectWithError:result];
+        }
+        else {
+            [next fulfillWithValue:result];
+        }
+    }];
+    
+    [next addCancelBlock:^{
+        [self cancel];
+    }];
+    return next;
+}
+
+- (FSPromise *) withDeadline:(NSTimeInterval)seconds {
+    FSPromise * bounded = [FSPromise new];
+    
+    [self addCompletionBlock:^(id value, NSError * error) {
+        if (error) [bounded rejectWithError:error];
+        else [bounded fulfillWithValue:value];
+    }];
+    [bounded addCancelBlock:^{
+        [self cancel];
+    }];
+    
+    // A Cancel With Its Own Error -- The Work Behind It Is Torn Down Before Completions Run
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(seconds * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        [bounded cancelWithError:FSPromiseError(FSPromiseErrorTimedOut, @"Deadline Exceeded")];
+    });
+    return bounded;
+}
+
+#pragma mark CANCEL
+
+- (void) addCancelBlock:(dispatch_block_t)block {
+    pthread_mutex_lock(&_lock);
+    if (!_isSettled) {
+        if (!_cancelBlocks) _cancelBlocks = [NSMutableArray new];
+        [_cancelBlocks addObject:[block copy]];
+        pthread_mutex_unlock(&_lock);
+        return;
+    }
+    BOOL isCancelled = _isCancelled;
+    pthread_mutex_unlock(&_lock);
+    
+    if (isCancelled) block();
+}
+
+- (void) cancel {
+    [self cancelWithError:FSPromiseError(FSPromiseErrorCancelled, @"Cancelled")];
+}
+
+- (void) cancelWithError:(NSError *)error {
+    [self settleWithValue:nil error:error cancelled:YES];
+}
+
+@end
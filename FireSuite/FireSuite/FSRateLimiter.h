@@ -0,0 +1,84 @@
+//
+//  FSRateLimiter.h
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "FSMetrics.h"
+
+#pragma mark CONSTANTS
+
+typedef enum {
+    FSRateLimitErrorQueueFull = 1001,
+} FSRateLimitErrorCode;
+
+// Error Keys
+FOUNDATION_EXPORT NSString *const kFSRateLimiterErrorDomain;
+FOUNDATION_EXPORT NSString *const kErrorRateLimitQueueFull;
+
+#pragma mark RATE LIMITER
+
+/*!
+ Token buckets in front of every send -- one for the whole context and one per key, a chat id.  A bucket holds up to its burst and refills at its rate; each send takes a token from both.  Sends without tokens wait their turn, oldest first, up to maxQueueDepth -- past that they fail with FSRateLimitErrorQueueFull.  Waits are recorded in metrics as kFSOperationRateLimit.
+
+ Off until a rate is set.
+ */
+@interface FSRateLimiter : NSObject
+
++ (FSRateLimiter *) singleton;
+
+/*!
+ Sends per second across every key, and most that can go at once -- 0 doesn't limit.  Defaults to 0, bursts of 50.
+ */
+@property (nonatomic) double ratePerSecond;
+@property (nonatomic) double burst;
+
+/*!
+ Sends per second to any one key, and most that can go at once -- 0 doesn't limit.  Defaults to 0, bursts of 20.
+ */
+@property (nonatomic) double keyRatePerSecond;
+@property (nonatomic) double keyBurst;
+
+/*!
+ Most sends left waiting.  Defaults to 100.
+ */
+@property (nonatomic) NSUInteger maxQueueDepth;
+
+/*!
+ Called on callbackQueue whenever the number of waiting sends changes -- back-pressure for whatever is producing them
+ */
+@property (copy) void (^queueDepthHandler)(NSUInteger queueDepth);
+
+/*!
+ Where queueDepthHandler is called -- defaults to the main queue
+ */
+@property (strong) dispatch_queue_t callbackQueue;
+
+/*!
+ Receives waits and rejections -- defaults to [FSMetrics singleton]
+ */
+@property (strong) FSMetrics * metrics;
+
+/*!
+ YES once either rate is set -- senders skip the limiter entirely otherwise
+ */
+- (BOOL) isEnabled;
+
+/*!
+ Sends waiting right now
+ */
+- (NSUInteger) queueDepth;
+
+/*!
+ YES if a send to @param key would wait rather than go now
+ */
+- (BOOL) isLimitingKey:(NSString *)key;
+
+/*!
+ Take a token for @param key and for the context -- @param completion runs on @param queue once both are taken, or with an error if the queue is full
+ */
+- (void) acquireForKey:(NSString *)key onQueue:(dispatch_queue_t)queue completion:(void (^)(NSError * error))completion;
+
+@end
@@ -0,0 +1,291 @@
+//
+//  FSRateLimiter.m
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import "FSRateLimiter.h"
+
+#pragma mark KEYS
+
+// Error Keys
+NSString *const kFSRateLimiterErrorDomain = @"kFSRateLimiterErrorDomain";
+NSString *const kErrorRateLimitQueueFull = @"Too Many Sends Waiting";
+
+static double const kDefaultBurst = 50;
+static double const kDefaultKeyBurst = 20;
+static NSUInteger const kDefaultMaxQueueDepth = 100;
+
+#pragma mark BUCKET
+
+@interface FSTokenBucket : NSObject
+
+@property (nonatomic) double tokens;
+@property (nonatomic) NSTimeInterval refilledAt;
+
+@end
+
+@implementation FSTokenBucket
+@end
+
+// Tops @param bucket Up To burst For The Time Since It Was Last Refilled
+static void FSTokenBucketRefill(FSTokenBucket * bucket, double rate, double burst, NSTimeInterval now) {
+    bucket.tokens = MIN(burst, bucket.tokens + rate * (now - bucket.refilledAt));
+    bucket.refilledAt = now;
+}
+
+// Seconds Until @param bucket Holds A Whole Token -- 0 If It Does, Or Isn't Limited
+static NSTimeInterval FSTokenBucketWait(FSTokenBucket * bucket, double rate) {
+    if (rate <= 0 || bucket.tokens >= 1) return 0;
+    return (1 - bucket.tokens) / rate;
+}
+
+#pragma mark WAITER
+
+@interface FSRateLimitWaiter : NSObject
+
+@property (strong, nonatomic) NSString * key;
+@property (strong, nonatomic) dispatch_queue_t queue;
+@property (copy, nonatomic) void (^completion)(NSError * error);
+@property (nonatomic) NSTimeInterval enqueuedAt;
+
+@end
+
+@implementation FSRateLimitWaiter
+@end
+
+#pragma mark RATE LIMITER
+
+@interface FSRateLimiter ()
+{
+    // Owns Buckets And Waiters
+    dispatch_queue_t _queue;
+    FSTokenBucket * _bucket;
+    NSMutableDictionary * _keyBuckets;
+    NSMutableArray * _waiters;
+    BOOL _isDrainScheduled;
+}
+
+@end
+
+@implementation FSRateLimiter
+
+#pragma mark SINGLETON
+
++ (FSRateLimiter *) singleton {
+    static dispatch_once_t pred;
+    static FSRateLimiter *shared = nil;
+
+    dispatch_once(&pred, ^{
+        shared = [[FSRateLimiter alloc] init];
+    });
+    return shared;
+}
+
+- (instancetype) init {
+    self = [super init];
+    if (self) {
+        _queue = dispatch_queue_create("com.firesuite.rateLimiter", DISPATCH_QUEUE_SERIAL);
+        _bucket = [FSTokenBucket new];
+        _keyBuckets = [NSMutableDictionary new];
+        _waiters = [NSMutableArray new];
+        _burst = kDefaultBurst;
+        _keyBurst = kDefaultKeyBurst;
+        _maxQueueDepth = kDefaultMaxQueueDepth;
+        _callbackQueue = dispatch_get_main_queue();
+        _metrics = [FSMetrics singleton];
+
+        // Start Full
+        _bucket.tokens = kDefaultBurst;
+        _bucket.refilledAt = FSMetricsNow();
+    }
+    return self;
+}
+
+#pragma mark SETTINGS
+
+// Changing A Burst Refills Its Buckets
+- (void) setBurst:(double)burst {
+    dispatch_sync(_queue, ^{
+        _burst = burst;
+        _bucket.tokens = burst;
+        [self drain];
+    });
+}
+
+- (void) setKeyBurst:(double)keyBurst {
+    dispatch_sync(_queue, ^{
+        _keyBurst = keyBurst;
+        [_keyBuckets removeAllObjects];
+        [self drain];
+    });
+}
+
+- (void) setRatePerSecond:(double)ratePerSecond {
+    dispatch_sync(_queue, ^{
+        _ratePerSecond = ratePerSecond;
+        [self drain];
+    });
+}
+
+- (void) setKeyRatePerSecond:(double)keyRatePerSecond {
+    dispatch_sync(_queue, ^{
+        _keyRatePerSecond = keyRatePerSecond;
+        [self drain];
+    });
+}
+
+#pragma mark STATE
+
+- (BOOL) isEnabled {
+    return _ratePerSecond > 0 || _keyRatePerSecond > 0;
+}
+
+- (NSUInteger) queueDepth {
+    __block NSUInteger depth;
+    dispatch_sync(_queue, ^{
+        depth = _waiters.count;
+    });
+    return depth;
+}
+
+- (BOOL) isLimitingKey:(NSString *)key {
+    __block BOOL isLimiting;
+    dispatch_sync(_queue, ^{
+        isLimiting = ![self canTakeTokensForKey:key];
+        for (FSRateLimitWaiter * waiter in _waiters) {
+            if (isLimiting) break;
+            isLimiting = [waiter.key isEqualToString:key];
+        }
+    });
+    return isLimiting;
+}
+
+// Must Be Called On _queue -- New Keys Start Full
+- (FSTokenBucket *) bucketForKey:(NSString *)key {
+    FSTokenBucket * bucket = _keyBuckets[key];
+    if (!bucket) {
+        bucket = [FSTokenBucket new];
+        bucket.tokens = _keyBurst;
+        bucket.refilledAt = FSMetricsNow();
+        _keyBuckets[key] = bucket;
+    }
+    return bucket;
+}
+
+// Must Be Called On _queue
+- (BOOL) canTakeTokensForKey:(NSString *)key {
+    NSTimeInterval now = FSMetricsNow();
+    FSTokenBucketRefill(_bucket, _ratePerSecond, _burst, now);
+    if (FSTokenBucketWait(_bucket, _ratePerSecond) > 0) return NO;
+    if (!key) return YES;
+
+    FSTokenBucket * bucket = [self bucketForKey:key];
+    FSTokenBucketRefill(bucket, _keyRatePerSecond, _keyBurst, now);
+    return FSTokenBucketWait(bucket, _keyRatePerSecond) == 0;
+}
+
+// Must Be Called On _queue -- Unlimited Buckets Aren't Drawn Down
+- (void) takeTokensForKey:(NSString *)key {
+    if (_ratePerSecond > 0) _bucket.tokens -= 1;
+    if (key && _keyRatePerSecond > 0) [self bucketForKey:key].tokens -= 1;
+}
+
+#pragma mark ACQUIRE
+
+- (void) acquireForKey:(NSString *)key onQueue:(dispatch_queue_t)queue completion:(void (^)(NSError * error))completion {
+    dispatch_async(_queue, ^{
+        FSMetrics * metrics = self.metrics;
+
+        // Nobody Ahead -- Straight Through
+        if (_waiters.count == 0 && [self canTakeTokensForKey:key]) {
+            [self takeTokensForKey:key];
+            [metrics recordOperation:kFSOperationRateLimit latency:0 error:nil];
+            dispatch_async(queue, ^{
+                completion(nil);
+            });
+            return;
+        }
+
+        if (_waiters.count >= _maxQueueDepth) {
+            NSError * error = [NSError errorWithDomain:kFSRateLimiterErrorDomain
+                                                  code:FSRateLimitErrorQueueFull
+                                              userInfo:@{NSLocalizedDescriptionKey: NSLocalizedString(kErrorRateLimitQueueFull, nil)}];
+            [metrics recordOperation:kFSOperationRateLimit latency:0 error:error];
+            dispatch_async(queue, ^{
+                completion(error);
+            });
+            return;
+        }
+
+        FSRateLimitWaiter * waiter = [FSRateLimitWaiter new];
+        waiter.key = key;
+        waiter.queue = queue;
+        waiter.completion = completion;
+        waiter.enqueuedAt = FSMetricsNow();
+        [_waiters addObject:waiter];
+        [self notifyQueueDepth];
+        [self drain];
+    });
+}
+
+// Must Be Called On _queue -- Oldest First; A Waiter Only Passes Those Held Up By A Different Key
+- (void) drain {
+    NSUInteger depth = _waiters.count;
+    NSMutableSet * blockedKeys = [NSMutableSet new];
+    NSTimeInterval wait = 0;
+
+    for (FSRateLimitWaiter * waiter in [NSArray arrayWithArray:_waiters]) {
+        if (waiter.key && [blockedKeys containsObject:waiter.key]) continue;
+
+        if (![self canTakeTokensForKey:waiter.key]) {
+            // Context Bucket Empty -- Nobody Goes
+            NSTimeInterval contextWait = FSTokenBucketWait(_bucket, _ratePerSecond);
+            if (contextWait > 0) {
+                wait = contextWait;
+                break;
+            }
+            NSTimeInterval keyWait = FSTokenBucketWait([self bucketForKey:waiter.key], _keyRatePerSecond);
+            wait = wait > 0 ? MIN(wait, keyWait) : keyWait;
+            [blockedKeys addObject:waiter.key];
+            continue;
+        }
+
+        [self takeTokensForKey:waiter.key];
+        [_waiters removeObject:waiter];
+        [self.metrics recordOperation:kFSOperationRateLimit latency:FSMetricsNow() - waiter.enqueuedAt error:nil];
+        dispatch_async(waiter.queue, ^{
+            waiter.completion(nil);
+        });
+    }
+
+    // Full, Idle Buckets Are The Same As New Ones
+    for (NSString * key in [_keyBuckets allKeys]) {
+        FSTokenBucket * bucket = _keyBuckets[key];
+        FSTokenBucketRefill(bucket, _keyRatePerSecond, _keyBurst, FSMetricsNow());
+        if (bucket.tokens >= _keyBurst && ![blockedKeys containsObject:key]) [_keyBuckets removeObjectForKey:key];
+    }
+
+    if (depth != _waiters.count) [self notifyQueueDepth];
+    if (_waiters.count == 0 || _isDrainScheduled) return;
+
+    _isDrainScheduled = YES;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(wait * NSEC_PER_SEC)), _queue, ^{
+        _isDrainScheduled = NO;
+        [self drain];
+    });
+}
+
+// Must Be Called On _queue
+- (void) notifyQueueDepth {
+    void (^handler)(NSUInteger) = self.queueDepthHandler;
+    if (!handler) return;
+
+    NSUInteger depth = _waiters.count;
+    dispatch_async(self.callbackQueue, ^{
+        handler(depth);
+    });
+}
+
+@end
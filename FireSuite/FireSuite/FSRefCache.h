@@ -0,0 +1,46 @@
+//
+//  FSRefCache.h
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <Firebase/Firebase.h>
+
+/*!
+ Shared Firebase refs keyed by root / collection / id / leaf -- e.g. (url, @"Chats", chatId, @"header").  Each root URL is parsed once; everything below it is derived with childByAppendingPath: and kept, least recently used first out.  A hit allocates nothing.
+ */
+@interface FSRefCache : NSObject
+
++ (FSRefCache *) singleton;
+
+/*!
+ @param capacity max cached refs below the roots
+ */
+- (instancetype) initWithCapacity:(NSUInteger)capacity;
+
+@property (nonatomic, readonly) NSUInteger capacity;
+
+/*!
+ @param identifier and @param leaf may be nil -- leaf may contain slashes
+ */
+- (Firebase *) refWithRoot:(NSString *)rootURL
+                collection:(NSString *)collection
+                        id:(NSString *)identifier
+                      leaf:(NSString *)leaf;
+
+/*!
+ The parsed root for @param rootURL
+ */
+- (Firebase *) rootRefForURL:(NSString *)rootURL;
+
+#pragma mark STATS
+
+- (NSUInteger) count;
+- (NSUInteger) hits;
+- (NSUInteger) misses;
+
+- (void) removeAllRefs;
+
+@end
@@ -0,0 +1,245 @@
+//
+//  FSRefCache.m
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import "FSRefCache.h"
+#import <pthread.h>
+
+static NSUInteger const kDefaultCapacity = 512;
+
+#pragma mark ENTRY
+
+@interface FSRefCacheEntry : NSObject
+{
+    @public
+    Firebase * ref;
+
+    // Keys -- NSNull For Missing Parts
+    NSString * root;
+    NSString * collection;
+    id identifier;
+    id leaf;
+
+    // Recency List -- head Is Most Recent
+    FSRefCacheEntry * next;
+    __unsafe_unretained FSRefCacheEntry * previous;
+}
+@end
+
+@implementation FSRefCacheEntry
+@end
+
+#pragma mark CACHE
+
+@interface FSRefCache ()
+{
+    pthread_mutex_t _lock;
+
+    // root -> collection -> id -> leaf -> entry
+    NSMutableDictionary * _tree;
+    NSMutableDictionary * _roots;
+
+    FSRefCacheEntry * _head;
+    __unsafe_unretained FSRefCacheEntry * _tail;
+    NSUInteger _count;
+
+    NSUInteger _hits;
+    NSUInteger _misses;
+}
+
+@end
+
+@implementation FSRefCache
+
+#pragma mark SINGLETON
+
++ (FSRefCache *) singleton {
+    static dispatch_once_t pred;
+    static FSRefCache *shared = nil;
+
+    dispatch_once(&pred, ^{
+        shared = [[FSRefCache alloc] init];
+    });
+    return shared;
+}
+
+- (instancetype) init {
+    return [self initWithCapacity:kDefaultCapacity];
+}
+
+- (instancetype) initWithCapacity:(NSUInteger)capacity {
+    self = [super init];
+    if (self) {
+        _capacity = MAX(capacity, 1);
+        _tree = [NSMutableDictionary new];
+        _roots = [NSMutableDictionary new];
+        pthread_mutex_init(&_lock, NULL);
+    }
+    return self;
+}
+
+- (void) dealloc {
+    pthread_mutex_destroy(&_lock);
+}
+
+#pragma mark LOOKUP
+
+- (Firebase *) rootRefForURL:(NSString *)rootURL {
+    pthread_mutex_lock(&_lock);
+    Firebase * root = [self rootRefForURLLocked:rootURL];
+    pthread_mutex_unlock(&_lock);
+    return root;
+}
+
+- (Firebase *) rootRefForURLLocked:(NSString *)rootURL {
+    Firebase * root = _roots[rootURL];
+    if (!root) {
+        root = [[Firebase alloc] initWithUrl:rootURL];
+        _roots[rootURL] = root;
+    }
+    return root;
+}
+
+- (Firebase *) refWithRoot:(NSString *)rootURL
+                collection:(NSString *)collection
+                        id:(NSString *)identifier
+                      leaf:(NSString *)leaf {
+
+    id identifierKey = identifier ?: [NSNull null];
+    id leafKey = leaf ?: [NSNull null];
+
+    pthread_mutex_lock(&_lock);
+
+    FSRefCacheEntry * entry = _tree[rootURL][collection][identifierKey][leafKey];
+    if (entry) {
+        _hits++;
+        [self moveToHead:entry];
+        Firebase * ref = entry->ref;
+        pthread_mutex_unlock(&_lock);
+        return ref;
+    }
+
+    // Miss -- Derive From The Root, One Level At A Time
+    _misses++;
+    Firebase * ref = [[self rootRefForURLLocked:rootURL] childByAppendingPath:collection];
+    if (identifier) ref = [ref childByAppendingPath:identifier];
+    if (leaf) ref = [ref childByAppendingPath:leaf];
+
+    entry = [FSRefCacheEntry new];
+    entry->ref = ref;
+    entry->root = rootURL;
+    entry->collection = collection;
+    entry->identifier = identifierKey;
+    entry->leaf = leafKey;
+    [self insertEntry:entry];
+
+    // Evict Least Recently Used
+    while (_count > _capacity) [self removeEntry:_tail];
+
+    pthread_mutex_unlock(&_lock);
+    return ref;
+}
+
+#pragma mark LIST & TREE -- Lock Held
+
+- (void) insertEntry:(FSRefCacheEntry *)entry {
+    NSMutableDictionary * collections = _tree[entry->root];
+    if (!collections) _tree[entry->root] = collections = [NSMutableDictionary new];
+    NSMutableDictionary * identifiers = collections[entry->collection];
+    if (!identifiers) collections[entry->collection] = identifiers = [NSMutableDictionary new];
+    NSMutableDictionary * leaves = identifiers[entry->identifier];
+    if (!leaves) identifiers[entry->identifier] = leaves = [NSMutableDictionary new];
+    leaves[entry->leaf] = entry;
+
+    [self linkAtHead:entry];
+    _count++;
+}
+
+- (void) removeEntry:(FSRefCacheEntry *)entry {
+    NSMutableDictionary * collections = _tree[entry->root];
+    NSMutableDictionary * identifiers = collections[entry->collection];
+    NSMutableDictionary * leaves = identifiers[entry->identifier];
+
+    // Prune Empty Branches
+    [leaves removeObjectForKey:entry->leaf];
+    if (leaves.count == 0) [identifiers removeObjectForKey:entry->identifier];
+    if (identifiers.count == 0) [collections removeObjectForKey:entry->collection];
+    if (collections.count == 0) [_tree removeObjectForKey:entry->root];
+
+    [self unlink:entry];
+    _count--;
+}
+
+- (void) linkAtHead:(FSRefCacheEntry *)entry {
+    entry->previous = nil;
+    entry->next = _head;
+    if (_head) _head->previous = entry;
+    _head = entry;
+    if (!_tail) _tail = entry;
+}
+
+- (void) unlink:(FSRefCacheEntry *)entry {
+    // Keep entry Alive Until Fully Unlinked
+    FSRefCacheEntry * retained = entry;
+
+    if (retained->previous) retained->previous->next = retained->next;
+    else _head = retained->next;
+
+    if (retained->next) retained->next->previous = retained->previous;
+    else _tail = retained->previous;
+
+    retained->next = nil;
+    retained->previous = nil;
+}
+
+- (void) moveToHead:(FSRefCacheEntry *)entry {
+    if (_head == entry) return;
+    [self unlink:entry];
+    [self linkAtHead:entry];
+}
+
+#pragma mark STATS
+
+- (NSUInteger) count {
+    pthread_mutex_lock(&_lock);
+    NSUInteger count = _count;
+    pthread_mutex_unlock(&_lock);
+    return count;
+}
+
+- (NSUInteger) hits {
+    pthread_mutex_lock(&_lock);
+    NSUInteger hits = _hits;
+    pthread_mutex_unlock(&_lock);
+    return hits;
+}
+
+- (NSUInteger) misses {
+    pthread_mutex_lock(&_lock);
+    NSUInteger misses = _misses;
+    pthread_mutex_unlock(&_lock);
+    return misses;
+}
+
+- (void) removeAllRefs {
+    pthread_mutex_lock(&_lock);
+    [_tree removeAllObjects];
+    [_roots removeAllObjects];
+
+    // Break The Chain Iteratively -- A Long List Would Otherwise Release Recursively
+    while (_head) {
+        FSRefCacheEntry * next = _head->next;
+        _head->next = nil;
+        _head = next;
+    }
+    _tail = nil;
+    _count = 0;
+    _hits = 0;
+    _misses = 0;
+    pthread_mutex_unlock(&_lock);
+}
+
+@end
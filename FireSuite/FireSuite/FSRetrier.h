@@ -0,0 +1,149 @@
+//
+//  FSRetrier.h
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <Firebase/Firebase.h>
+#import "FSMetrics.h"
+
+#pragma mark CONSTANTS
+
+// Firebase Error Codes -- As The SDK Reports Them
+typedef enum {
+    FSFirebaseErrorPermissionDenied = -3,
+    FSFirebaseErrorDisconnected = -4,
+    FSFirebaseErrorMaxRetries = -8,
+    FSFirebaseErrorWriteCanceled = -9,
+    FSFirebaseErrorUnavailable = -10,
+    FSFirebaseErrorNetworkError = -24,
+} FSFirebaseErrorCode;
+
+// Error Keys
+FOUNDATION_EXPORT NSString *const kFSFirebaseErrorDomain;
+
+/*!
+ Disconnects, contended transactions, unavailable servers and network errors -- worth another try.  Permission and validation failures are not.
+ */
+FOUNDATION_EXPORT BOOL FSRetryIsTransientError(NSError * error);
+
+#pragma mark POLICY
+
+/*!
+ How often and how patiently one operation is retried
+ */
+@interface FSRetryPolicy : NSObject <NSCopying>
+
+/*!
+ 4 attempts, 50ms doubling to at most 2s, half of each delay jittered
+ */
++ (instancetype) defaultPolicy;
+
+/*!
+ One attempt -- errors pass straight up
+ */
++ (instancetype) noRetryPolicy;
+
++ (instancetype) policyWithMaxAttempts:(NSUInteger)maxAttempts baseDelay:(NSTimeInterval)baseDelay maxDelay:(NSTimeInterval)maxDelay;
+
+/*!
+ Including the first -- 1 never retries
+ */
+@property (nonatomic) NSUInteger maxAttempts;
+
+/*!
+ Before the first retry, doubling for each one after, capped at maxDelay
+ */
+@property (nonatomic) NSTimeInterval baseDelay;
+@property (nonatomic) NSTimeInterval maxDelay;
+
+/*!
+ 0 - 1: how much of each delay is randomly taken off, so failed clients don't retry in lockstep
+ */
+@property (nonatomic) double jitter;
+
+/*!
+ Which errors are retried -- nil uses FSRetryIsTransientError
+ */
+@property (copy, nonatomic) BOOL (^isRetryable)(NSError * error);
+
+- (BOOL) shouldRetryError:(NSError *)error;
+
+/*!
+ @param retry 1 for the first retry
+ */
+- (NSTimeInterval) delayBeforeRetry:(NSUInteger)retry;
+
+@end
+
+#pragma mark RETRIER
+
+/*!
+ Retries every manager's writes and transactions under a shared budget -- each call earns budgetRatio of a retry, each retry spends one, so a failing backend sees at most that fraction of extra load.  Retries and denials are recorded in metrics.
+ */
+@interface FSRetrier : NSObject
+
++ (FSRetrier *) singleton;
+
+/*!
+ Used for operations without an override
+ */
+@property (copy) FSRetryPolicy * defaultPolicy;
+
+/*!
+ @param operation a kFSOperation... key -- a nil @param policy removes the override
+ */
+- (void) setPolicy:(FSRetryPolicy *)policy forOperation:(NSString *)operation;
+- (FSRetryPolicy *) policyForOperation:(NSString *)operation;
+
+/*!
+ Retries earned per call, default 0.2 -- and most that can be banked, default 10.  Setting budgetCapacity refills the budget.
+ */
+@property (nonatomic) double budgetRatio;
+@property (nonatomic) double budgetCapacity;
+
+- (double) budgetBalance;
+
+/*!
+ Receives retries and denials -- defaults to [FSMetrics singleton]
+ */
+@property (strong) FSMetrics * metrics;
+
+#pragma mark RUN
+
+/*!
+ Runs @param attempt until it finishes without error, the error isn't retryable, attempts run out or the budget does.  @param completion gets the last error on the queue the last attempt finished on.
+ */
+- (void) runOperation:(NSString *)operation
+              attempt:(void (^)(void (^finished)(NSError * error)))attempt
+           completion:(void (^)(NSError * error))completion;
+
+/*!
+ @param priority may be nil
+ */
+- (void) setValue:(id)value
+      andPriority:(id)priority
+            onRef:(Firebase *)ref
+        operation:(NSString *)operation
+       completion:(void (^)(NSError * error, Firebase * ref))completion;
+
+- (void) updateChildValues:(NSDictionary *)values
+                     onRef:(Firebase *)ref
+                 operation:(NSString *)operation
+                completion:(void (^)(NSError * error, Firebase * ref))completion;
+
+- (void) removeValueOnRef:(Firebase *)ref
+                operation:(NSString *)operation
+               completion:(void (^)(NSError * error, Firebase * ref))completion;
+
+/*!
+ As [FSMetrics runTransactionOnRef:...] -- each attempt is measured as a call.  @param block may run again on a retry, so it should only touch currentData.
+ */
+- (void) runTransactionOnRef:(Firebase *)ref
+                   operation:(NSString *)operation
+                       block:(FTransactionResult * (^)(FMutableData * currentData))block
+                  completion:(void (^)(NSError * error, BOOL committed, FDataSnapshot * snapshot))completion;
+
+@end
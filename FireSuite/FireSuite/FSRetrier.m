@@ -0,0 +1,302 @@
+//
+//  FSRetrier.m
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import "FSRetrier.h"
+#import <pthread.h>
+
+#pragma mark KEYS
+
+// Error Keys
+NSString *const kFSFirebaseErrorDomain = @"FirebaseError";
+
+static NSUInteger const kDefaultMaxAttempts = 4;
+static NSTimeInterval const kDefaultBaseDelay = 0.05;
+static NSTimeInterval const kDefaultMaxDelay = 2.0;
+static double const kDefaultJitter = 0.5;
+static double const kDefaultBudgetRatio = 0.2;
+static double const kDefaultBudgetCapacity = 10;
+
+#pragma mark FUNCTIONS
+
+BOOL FSRetryIsTransientError(NSError * error) {
+    if (!error) return NO;
+
+    if ([error.domain isEqualToString:NSURLErrorDomain]) return error.code != NSURLErrorCancelled;
+    if (![error.domain isEqualToString:kFSFirebaseErrorDomain]) return NO;
+
+    switch (error.code) {
+        case FSFirebaseErrorDisconnected:
+        case FSFirebaseErrorMaxRetries:
+        case FSFirebaseErrorUnavailable:
+        case FSFirebaseErrorNetworkError:
+            return YES;
+        default:
+            return NO;
+    }
+}
+
+#pragma mark POLICY
+
+@implementation FSRetryPolicy
+
++ (instancetype) defaultPolicy {
+    return [self policyWithMaxAttempts:kDefaultMaxAttempts baseDelay:kDefaultBaseDelay maxDelay:kDefaultMaxDelay];
+}
+
++ (instancetype) noRetryPolicy {
+    return [self policyWithMaxAttempts:1 baseDelay:0 maxDelay:0];
+}
+
++ (instancetype) policyWithMaxAttempts:(NSUInteger)maxAttempts baseDelay:(NSTimeInterval)baseDelay maxDelay:(NSTimeInterval)maxDelay {
+    FSRetryPolicy * policy = [self new];
+    policy.maxAttempts = MAX(maxAttempts, 1);
+    policy.baseDelay = baseDelay;
+    policy.maxDelay = maxDelay;
+    policy.jitter = kDefaultJitter;
+    return policy;
+}
+
+- (id) copyWithZone:(NSZone *)zone {
+    FSRetryPolicy * policy = [[[self class] allocWithZone:zone] init];
+    policy.maxAttempts = _maxAttempts;
+    policy.baseDelay = _baseDelay;
+    policy.maxDelay = _maxDelay;
+    policy.jitter = _jitter;
+    policy.isRetryable = _isRetryable;
+    return policy;
+}
+
+- (BOOL) shouldRetryError:(NSError *)error {
+    if (!error) return NO;
+    return _isRetryable ? _isRetryable(error) : FSRetryIsTransientError(error);
+}
+
+- (NSTimeInterval) delayBeforeRetry:(NSUInteger)retry {
+    NSTimeInterval delay = MIN(_baseDelay * pow(2, (double)MAX(retry, 1) - 1), _maxDelay);
+    double jitter = MIN(MAX(_jitter, 0), 1);
+    return delay * (1 - jitter * ((double)arc4random() / UINT32_MAX));
+}
+
+@end
+
+#pragma mark RETRIER
+
+@interface FSRetrier ()
+{
+    // Guards Policies And Budget
+    pthread_mutex_t _lock;
+    NSMutableDictionary * _policies;
+    double _budgetBalance;
+}
+
+@end
+
+@implementation FSRetrier
+
+@synthesize defaultPolicy = _defaultPolicy;
+
+#pragma mark SINGLETON
+
++ (FSRetrier *) singleton {
+    static dispatch_once_t pred;
+    static FSRetrier *shared = nil;
+
+    dispatch_once(&pred, ^{
+        shared = [[FSRetrier alloc] init];
+    });
+    return shared;
+}
+
+- (instancetype) init {
+    self = [super init];
+    if (self) {
+        _defaultPolicy = [FSRetryPolicy defaultPolicy];
+        _policies = [NSMutableDictionary new];
+        _budgetRatio = kDefaultBudgetRatio;
+        _budgetCapacity = kDefaultBudgetCapacity;
+        _budgetBalance = kDefaultBudgetCapacity;
+        _metrics = [FSMetrics singleton];
+        pthread_mutex_init(&_lock, NULL);
+    }
+    return self;
+}
+
+- (void) dealloc {
+    pthread_mutex_destroy(&_lock);
+}
+
+#pragma mark POLICIES
+
+- (FSRetryPolicy *) defaultPolicy {
+    pthread_mutex_lock(&_lock);
+    FSRetryPolicy * policy = _defaultPolicy;
+    pthread_mutex_unlock(&_lock);
+    return policy;
+}
+
+- (void) setDefaultPolicy:(FSRetryPolicy *)defaultPolicy {
+    defaultPolicy = [defaultPolicy copy] ?: [FSRetryPolicy defaultPolicy];
+    pthread_mutex_lock(&_lock);
+    _defaultPolicy = defaultPolicy;
+    pthread_mutex_unlock(&_lock);
+}
+
+- (void) setPolicy:(FSRetryPolicy *)policy forOperation:(NSString *)operation {
+    policy = [policy copy];
+    pthread_mutex_lock(&_lock);
+    if (policy) _policies[operation] = policy;
+    else [_policies removeObjectForKey:operation];
+    pthread_mutex_unlock(&_lock);
+}
+
+- (FSRetryPolicy *) policyForOperation:(NSString *)operation {
+    pthread_mutex_lock(&_lock);
+    FSRetryPolicy * policy = (operation ? _policies[operation] : nil) ?: _defaultPolicy;
+    pthread_mutex_unlock(&_lock);
+    return policy;
+}
+
+#pragma mark BUDGET
+
+- (void) setBudgetCapacity:(double)budgetCapacity {
+    pthread_mutex_lock(&_lock);
+    _budgetCapacity = budgetCapacity;
+    _budgetBalance = budgetCapacity;
+    pthread_mutex_unlock(&_lock);
+}
+
+- (double) budgetBalance {
+    pthread_mutex_lock(&_lock);
+    double balance = _budgetBalance;
+    pthread_mutex_unlock(&_lock);
+    return balance;
+}
+
+- (void) depositBudget {
+    pthread_mutex_lock(&_lock);
+    _budgetBalance = MIN(_budgetBalance + _budgetRatio, _budgetCapacity);
+    pthread_mutex_unlock(&_lock);
+}
+
+- (BOOL) withdrawBudget {
+    pthread_mutex_lock(&_lock);
+    BOOL isFunded = _budgetBalance >= 1;
+    if (isFunded) _budgetBalance -= 1;
+    pthread_mutex_unlock(&_lock);
+    return isFunded;
+}
+
+#pragma mark RUN
+
+- (void) runOperation:(NSString *)operation
+              attempt:(void (^)(void (^finished)(NSError * error)))attempt
+           completion:(void (^)(NSError * error))completion {
+    [self depositBudget];
+    [self runAttempt:1 ofOperation:operation policy:[self policyForOperation:operation] block:attempt completion:completion];
+}
+
+- (void) runAttempt:(NSUInteger)number
+        ofOperation:(NSString *)operation
+             policy:(FSRetryPolicy *)policy
+              block:(void (^)(void (^finished)(NSError * error)))attempt
+         completion:(void (^)(NSError * error))completion {
+
+    attempt(^(NSError * error) {
+
+        // Done, Or Not Worth Another Try
+        if (!error || number >= policy.maxAttempts || ![policy shouldRetryError:error]) {
+            if (completion) completion(error);
+            return;
+        }
+
+        // Out Of Budget -- Give Up Rather Than Pile On
+        FSMetrics * metrics = self.metrics;
+        if (![self withdrawBudget]) {
+            [metrics recordRetryDeniedForOperation:operation];
+            if (completion) completion(error);
+            return;
+        }
+
+        [metrics recordRetryForOperation:operation];
+        NSTimeInterval delay = [policy delayBeforeRetry:number];
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            [self runAttempt:number + 1 ofOperation:operation policy:policy block:attempt completion:completion];
+        });
+    });
+}
+
+- (void) setValue:(id)value
+      andPriority:(id)priority
+            onRef:(Firebase *)ref
+        operation:(NSString *)operation
+       completion:(void (^)(NSError * error, Firebase * ref))completion {
+
+    [self runOperation:operation attempt:^(void (^finished)(NSError *)) {
+        if (priority) {
+            [ref setValue:value andPriority:priority withCompletionBlock:^(NSError *error, Firebase *ref) {
+                finished(error);
+            }];
+        }
+        else {
+            [ref setValue:value withCompletionBlock:^(NSError *error, Firebase *ref) {
+                finished(error);
+            }];
+        }
+    } completion:^(NSError *error) {
+        if (completion) completion(error, ref);
+    }];
+}
+
+- (void) updateChildValues:(NSDictionary *)values
+                     onRef:(Firebase *)ref
+                 operation:(NSString *)operation
+                completion:(void (^)(NSError * error, Firebase * ref))completion {
+
+    [self runOperation:operation attempt:^(void (^finished)(NSError *)) {
+        [ref updateChildValues:values withCompletionBlock:^(NSError *error, Firebase *ref) {
+            finished(error);
+        }];
+    } completion:^(NSError *error) {
+        if (completion) completion(error, ref);
+    }];
+}
+
+- (void) removeValueOnRef:(Firebase *)ref
+                operation:(NSString *)operation
+               completion:(void (^)(NSError * error, Firebase * ref))completion {
+
+    [self runOperation:operation attempt:^(void (^finished)(NSError *)) {
+        [ref removeValueWithCompletionBlock:^(NSError *error, Firebase *ref) {
+            finished(error);
+        }];
+    } completion:^(NSError *error) {
+        if (completion) completion(error, ref);
+    }];
+}
+
+- (void) runTransactionOnRef:(Firebase *)ref
+                   operation:(NSString *)operation
+                       block:(FTransactionResult * (^)(FMutableData * currentData))block
+                  completion:(void (^)(NSError * error, BOOL committed, FDataSnapshot * snapshot))completion {
+
+    // Last Attempt's Result
+    __block BOOL isCommitted = NO;
+    __block FDataSnapshot * result;
+
+    FSMetrics * metrics = self.metrics;
+    [self runOperation:operation attempt:^(void (^finished)(NSError *)) {
+        [metrics runTransactionOnRef:ref operation:operation block:block completion:^(NSError *error, BOOL committed, FDataSnapshot *snapshot) {
+            isCommitted = committed;
+            result = snapshot;
+            finished(error);
+        }];
+    } completion:^(NSError *error) {
+        if (completion) completion(error, isCommitted, result);
+    }];
+}
+
+@end
@@ -0,0 +1,33 @@
+//
+//  FSShardRouter.h
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/*!
+ Spreads data over several Firebase databases by consistent hashing.  Chats/{chatId} lives on the chat's shard; Users/{userId} -- chats, alerts, presence -- lives on the user's home shard.  Adding or removing a database only moves the keys that hash next to it.  Immutable -- reshard by swapping in a new router.
+ */
+@interface FSShardRouter : NSObject
+
+/*!
+ @param databaseURLs root URLs, trailing slash added if missing
+ */
++ (instancetype) routerWithDatabaseURLs:(NSArray *)databaseURLs;
+- (instancetype) initWithDatabaseURLs:(NSArray *)databaseURLs;
+
+@property (strong, nonatomic, readonly) NSArray * databaseURLs;
+
+#pragma mark ROUTE
+
+- (NSString *) databaseURLForChatId:(NSString *)chatId;
+- (NSString *) databaseURLForUserId:(NSString *)userId;
+
+#pragma mark RESHARD
+
+- (FSShardRouter *) routerByAddingDatabaseURL:(NSString *)databaseURL;
+- (FSShardRouter *) routerByRemovingDatabaseURL:(NSString *)databaseURL;
+
+@end
@@ -0,0 +1,131 @@
+//
+//  FSShardRouter.m
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import "FSShardRouter.h"
+
+// Points Per Database On The Ring -- Enough To Keep Shards Within A Few Percent
+static NSUInteger const kVirtualNodes = 160;
+
+typedef struct {
+    uint64_t hash;
+    uint32_t shard;
+} FSRingPoint;
+
+// FNV-1a Then A splitmix64 Finalizer -- Stable Across Runs And Platforms
+static uint64_t FSShardHash(NSString * prefix, NSString * key) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (NSString * part in @[prefix, key]) {
+        const char * bytes = [part UTF8String];
+        for (; *bytes; bytes++) {
+            hash ^= (uint8_t)*bytes;
+            hash *= 1099511628211ULL;
+        }
+    }
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ULL;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebULL;
+    hash ^= hash >> 31;
+    return hash;
+}
+
+static int FSCompareRingPoints(const void * a, const void * b) {
+    uint64_t hashA = ((const FSRingPoint *)a)->hash;
+    uint64_t hashB = ((const FSRingPoint *)b)->hash;
+    return hashA < hashB ? -1 : hashA > hashB ? 1 : 0;
+}
+
+@interface FSShardRouter ()
+{
+    FSRingPoint * _ring;
+    NSUInteger _ringCount;
+}
+
+@property (strong, nonatomic, readwrite) NSArray * databaseURLs;
+
+@end
+
+@implementation FSShardRouter
+
+#pragma mark INIT
+
++ (instancetype) routerWithDatabaseURLs:(NSArray *)databaseURLs {
+    return [[self alloc] initWithDatabaseURLs:databaseURLs];
+}
+
+- (instancetype) initWithDatabaseURLs:(NSArray *)databaseURLs {
+    self = [super init];
+    if (self) {
+        NSAssert(databaseURLs.count > 0, @"FSShardRouter needs at least one database URL");
+        
+        // Normalize Like FireSuite Does
+        NSMutableArray * urls = [NSMutableArray new];
+        for (NSString * url in databaseURLs) {
+            NSString * normalized = [url hasSuffix:@"/"] ? url : [NSString stringWithFormat:@"%@/", url];
+            if (![urls containsObject:normalized]) [urls addObject:normalized];
+        }
+        _databaseURLs = urls;
+        
+        // Points Depend Only On The URL -- Other Shards Coming Or Going Don't Move Them
+        _ringCount = urls.count * kVirtualNodes;
+        _ring = malloc(_ringCount * sizeof(FSRingPoint));
+        for (uint32_t shard = 0; shard < urls.count; shard++) {
+            for (NSUInteger i = 0; i < kVirtualNodes; i++) {
+                NSString * point = [NSString stringWithFormat:@"#%lu", (unsigned long)i];
+                _ring[shard * kVirtualNodes + i].hash = FSShardHash(urls[shard], point);
+                _ring[shard * kVirtualNodes + i].shard = shard;
+            }
+        }
+        qsort(_ring, _ringCount, sizeof(FSRingPoint), FSCompareRingPoints);
+    }
+    return self;
+}
+
+- (void) dealloc {
+    free(_ring);
+}
+
+#pragma mark ROUTE
+
+- (NSString *) databaseURLForKey:(NSString *)key prefix:(NSString *)prefix {
+    if (_databaseURLs.count == 1) return _databaseURLs[0];
+    
+    uint64_t hash = FSShardHash(prefix, key ?: @"");
+    
+    // First Point Clockwise, Wrapping To The Start
+    NSUInteger low = 0, high = _ringCount;
+    while (low < high) {
+        NSUInteger mid = (low + high) / 2;
+        if (_ring[mid].hash < hash) low = mid + 1;
+        else high = mid;
+    }
+    if (low == _ringCount) low = 0;
+    return _databaseURLs[_ring[low].shard];
+}
+
+- (NSString *) databaseURLForChatId:(NSString *)chatId {
+    return [self databaseURLForKey:chatId prefix:@"Chats/"];
+}
+
+- (NSString *) databaseURLForUserId:(NSString *)userId {
+    return [self databaseURLForKey:userId prefix:@"Users/"];
+}
+
+#pragma mark RESHARD
+
+- (FSShardRouter *) routerByAddingDatabaseURL:(NSString *)databaseURL {
+    return [[FSShardRouter alloc] initWithDatabaseURLs:[_databaseURLs arrayByAddingObject:databaseURL]];
+}
+
+- (FSShardRouter *) routerByRemovingDatabaseURL:(NSString *)databaseURL {
+    NSString * normalized = [databaseURL hasSuffix:@"/"] ? databaseURL : [NSString stringWithFormat:@"%@/", databaseURL];
+    NSMutableArray * urls = [_databaseURLs mutableCopy];
+    [urls removeObject:normalized];
+    return [[FSShardRouter alloc] initWithDatabaseURLs:urls];
+}
+
+@end
@@ -0,0 +1,28 @@
+//
+//  FSStateQueue.h
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/*!
+ A serial queue that owns a manager's state.  Public methods and Firebase callbacks hop onto it before touching anything, so a manager may be driven from any thread -- including a concurrent +[Firebase setDispatchQueue:].
+ */
+FOUNDATION_EXPORT dispatch_queue_t FSStateQueueCreate(const char * label);
+
+/*!
+ YES when running on @param queue
+ */
+FOUNDATION_EXPORT BOOL FSStateQueueIsCurrent(dispatch_queue_t queue);
+
+/*!
+ Run @param block on @param queue without waiting -- inline when already on it, so a manager's calls into itself keep their order
+ */
+FOUNDATION_EXPORT void FSStateQueueAsync(dispatch_queue_t queue, dispatch_block_t block);
+
+/*!
+ Run @param block on @param queue and wait -- inline when already on it, so accessors may be used from callbacks
+ */
+FOUNDATION_EXPORT void FSStateQueueSync(dispatch_queue_t queue, dispatch_block_t block);
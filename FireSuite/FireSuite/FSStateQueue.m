@@ -0,0 +1,31 @@
+//
+//  FSStateQueue.m
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import "FSStateQueue.h"
+
+// Each Queue Tags Itself Under This Key
+static char kStateQueueKey;
+
+dispatch_queue_t FSStateQueueCreate(const char * label) {
+    dispatch_queue_t queue = dispatch_queue_create(label, DISPATCH_QUEUE_SERIAL);
+    dispatch_queue_set_specific(queue, &kStateQueueKey, (__bridge void *)queue, NULL);
+    return queue;
+}
+
+BOOL FSStateQueueIsCurrent(dispatch_queue_t queue) {
+    return dispatch_get_specific(&kStateQueueKey) == (__bridge void *)queue;
+}
+
+void FSStateQueueAsync(dispatch_queue_t queue, dispatch_block_t block) {
+    if (FSStateQueueIsCurrent(queue)) block();
+    else dispatch_async(queue, block);
+}
+
+void FSStateQueueSync(dispatch_queue_t queue, dispatch_block_t block) {
+    if (FSStateQueueIsCurrent(queue)) block();
+    else dispatch_sync(queue, block);
+}
@@ -0,0 +1,65 @@
+//
+//  FSTracer.h
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#pragma mark SPAN
+
+/*!
+ One step of an operation.  Passed by value -- capture it in the completion block and end it there.  @param name must be a string literal.
+ */
+typedef struct {
+    uint64_t spanId;
+    uint64_t parentId;
+    uint64_t traceId; // Root Span's Id
+    const char * name;
+    NSTimeInterval start;
+} FSTraceSpan;
+
+/*!
+ No span -- begin with this as parent for a root span.  Ending it does nothing.
+ */
+FOUNDATION_EXPORT const FSTraceSpan FSTraceSpanNone;
+
+#pragma mark TRACER
+
+/*!
+ Records finished spans into a fixed size lock free ring buffer -- oldest spans are overwritten, and a span racing a writer a full lap away for the same slot is dropped rather than mixed with it.  Off by default; set enabled to YES, reproduce, then export as Chrome trace_event JSON and open in chrome://tracing.
+ */
+@interface FSTracer : NSObject
+
++ (FSTracer *) singleton;
+
+/*!
+ @param capacity rounded up to a power of two
+ */
+- (instancetype) initWithCapacity:(NSUInteger)capacity;
+
+@property (nonatomic) BOOL enabled;
+@property (nonatomic, readonly) NSUInteger capacity;
+
+#pragma mark RECORD
+
+- (FSTraceSpan) beginSpan:(const char *)name parent:(FSTraceSpan)parent;
+- (void) endSpan:(FSTraceSpan)span;
+
+#pragma mark EXPORT
+
+/*!
+ Spans still in the buffer, oldest first -- dictionaries with name, spanId, parentId, traceId, thread, start, duration (seconds)
+ */
+- (NSArray *) spans;
+
+/*!
+ {"traceEvents": [...]} -- nestable async ("b" / "e") events, one track per root span, parent links in args
+ */
+- (NSData *) exportChromeTrace;
+- (BOOL) writeChromeTraceToPath:(NSString *)path error:(NSError **)error;
+
+- (void) reset;
+
+@end
@@ -0,0 +1,232 @@
+//
+//  FSTracer.m
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import "FSTracer.h"
+#import <pthread.h>
+
+const FSTraceSpan FSTraceSpanNone = {0, 0, 0, NULL, 0};
+
+static NSUInteger const kDefaultCapacity = 16384;
+
+// Set In sequence While A Writer Fills The Slot
+static uint64_t const kTraceSlotBusy = 1ULL << 63;
+
+/*
+ A Slot Is Readable When sequence Is Non Zero, Not Busy And Unchanged Across The Copy -- A Writer Claims It Busy, Fills, Then Publishes
+ */
+typedef struct {
+    volatile uint64_t sequence;
+    uint64_t spanId;
+    uint64_t parentId;
+    uint64_t traceId;
+    const char * name;
+    NSTimeInterval start;
+    NSTimeInterval end;
+    uint64_t thread;
+} FSTraceRecord;
+
+static uint64_t FSTraceThreadId(void) {
+#if defined(__APPLE__)
+    uint64_t thread = 0;
+    pthread_threadid_np(NULL, &thread);
+    return thread;
+#else
+    return (uint64_t)(uintptr_t)pthread_self();
+#endif
+}
+
+@interface FSTracer ()
+{
+    FSTraceRecord * _records;
+    uint64_t _mask;
+    volatile uint64_t _writeIndex;
+    volatile uint64_t _nextSpanId;
+    NSTimeInterval _epoch;
+}
+
+@end
+
+@implementation FSTracer
+
+#pragma mark SINGLETON
+
++ (FSTracer *) singleton {
+    static dispatch_once_t pred;
+    static FSTracer *shared = nil;
+
+    dispatch_once(&pred, ^{
+        shared = [[FSTracer alloc] init];
+    });
+    return shared;
+}
+
+- (instancetype) init {
+    return [self initWithCapacity:kDefaultCapacity];
+}
+
+- (instancetype) initWithCapacity:(NSUInteger)capacity {
+    self = [super init];
+    if (self) {
+        // Power Of Two So Slots Are A Mask Away
+        NSUInteger rounded = 1;
+        while (rounded < MAX(capacity, 2)) rounded <<= 1;
+
+        _capacity = rounded;
+        _mask = rounded - 1;
+        _records = calloc(rounded, sizeof(FSTraceRecord));
+        _epoch = [NSDate timeIntervalSinceReferenceDate];
+    }
+    return self;
+}
+
+- (void) dealloc {
+    free(_records);
+}
+
+#pragma mark RECORD
+
+- (FSTraceSpan) beginSpan:(const char *)name parent:(FSTraceSpan)parent {
+    if (!_enabled) return FSTraceSpanNone;
+
+    FSTraceSpan span;
+    span.spanId = __sync_add_and_fetch(&_nextSpanId, 1);
+    span.parentId = parent.spanId;
+    span.traceId = parent.spanId ? parent.traceId : span.spanId;
+    span.name = name;
+    span.start = [NSDate timeIntervalSinceReferenceDate];
+    return span;
+}
+
+- (void) endSpan:(FSTraceSpan)span {
+    if (span.spanId == 0) return;
+
+    NSTimeInterval end = [NSDate timeIntervalSinceReferenceDate];
+
+    // Claim A Slot -- Overwrites The Oldest Once Full
+    uint64_t index = __sync_fetch_and_add(&_writeIndex, 1);
+    FSTraceRecord * record = &_records[index & _mask];
+
+    // A Writer A Lap Ahead Or Behind Shares The Slot -- Whoever Loses The Claim Drops Its Span
+    uint64_t sequence = record->sequence;
+    if ((sequence & kTraceSlotBusy) || sequence > index) return;
+    if (!__sync_bool_compare_and_swap(&record->sequence, sequence, (index + 1) | kTraceSlotBusy)) return;
+
+    record->spanId = span.spanId;
+    record->parentId = span.parentId;
+    record->traceId = span.traceId;
+    record->name = span.name;
+    record->start = span.start;
+    record->end = end;
+    record->thread = FSTraceThreadId();
+
+    __sync_synchronize();
+    record->sequence = index + 1;
+}
+
+#pragma mark EXPORT
+
+- (NSArray *) records {
+    NSMutableArray * records = [NSMutableArray new];
+
+    for (uint64_t i = 0; i < _capacity; i++) {
+        FSTraceRecord * slot = &_records[i];
+
+        uint64_t sequence = slot->sequence;
+        if (sequence == 0 || (sequence & kTraceSlotBusy)) continue;
+        __sync_synchronize();
+
+        FSTraceRecord copy = *slot;
+
+        // Skip Slots Rewritten While We Copied
+        __sync_synchronize();
+        if (slot->sequence != sequence) continue;
+
+        [records addObject:[NSValue valueWithBytes:&copy objCType:@encode(FSTraceRecord)]];
+    }
+
+    [records sortUsingComparator:^NSComparisonResult(NSValue * a, NSValue * b) {
+        FSTraceRecord recordA, recordB;
+        [a getValue:&recordA];
+        [b getValue:&recordB];
+        if (recordA.sequence == recordB.sequence) return NSOrderedSame;
+        return recordA.sequence < recordB.sequence ? NSOrderedAscending : NSOrderedDescending;
+    }];
+    return records;
+}
+
+- (NSArray *) spans {
+    NSMutableArray * spans = [NSMutableArray new];
+    for (NSValue * value in [self records]) {
+        FSTraceRecord record;
+        [value getValue:&record];
+        [spans addObject:@{
+                           @"name" : @(record.name),
+                           @"spanId" : @(record.spanId),
+                           @"parentId" : @(record.parentId),
+                           @"traceId" : @(record.traceId),
+                           @"thread" : @(record.thread),
+                           @"start" : @(record.start - _epoch),
+                           @"duration" : @(record.end - record.start),
+                           }];
+    }
+    return spans;
+}
+
+- (NSData *) exportChromeTrace {
+    NSMutableArray * events = [NSMutableArray new];
+    NSNumber * pid = @([[NSProcessInfo processInfo] processIdentifier]);
+
+    for (NSValue * value in [self records]) {
+        FSTraceRecord record;
+        [value getValue:&record];
+
+        // Same id Nests Every Span Of One Operation On One Track
+        NSString * traceId = [NSString stringWithFormat:@"0x%llx", record.traceId];
+        NSString * name = @(record.name);
+        NSDictionary * args = @{
+                                @"spanId" : @(record.spanId),
+                                @"parentId" : @(record.parentId),
+                                };
+
+        [events addObject:@{
+                            @"name" : name,
+                            @"cat" : @"FireSuite",
+                            @"ph" : @"b",
+                            @"id" : traceId,
+                            @"ts" : @((record.start - _epoch) * 1000000),
+                            @"pid" : pid,
+                            @"tid" : @(record.thread),
+                            @"args" : args,
+                            }];
+        [events addObject:@{
+                            @"name" : name,
+                            @"cat" : @"FireSuite",
+                            @"ph" : @"e",
+                            @"id" : traceId,
+                            @"ts" : @((record.end - _epoch) * 1000000),
+                            @"pid" : pid,
+                            @"tid" : @(record.thread),
+                            }];
+    }
+
+    NSDictionary * trace = @{
+                             @"traceEvents" : events,
+                             @"displayTimeUnit" : @"ms",
+                             };
+    return [NSJSONSerialization dataWithJSONObject:trace options:0 error:nil];
+}
+
+- (BOOL) writeChromeTraceToPath:(NSString *)path error:(NSError **)error {
+    return [[self exportChromeTrace] writeToFile:path options:NSDataWritingAtomic error:error];
+}
+
+- (void) reset {
+    for (uint64_t i = 0; i < _capacity; i++) _records[i].sequence = 0;
+    __sync_synchronize();
+}
+
+@end
@@ -8,16 +8,71 @@
 #import <Foundation/Foundation.h>
 
 #import "FSChatManager.h"
+#import "FSChatSchema.h"
 #import "FSPresenceManager.h"
 #import "FSChannelManager.h"
+#import "FSMetrics.h"
+#import "FSTracer.h"
+#import "FSRefCache.h"
+#import "FSRetrier.h"
+#import "FSDecodePool.h"
+#import "FSShardRouter.h"
+#import "FSContext.h"
+#import "FSPromise.h"
+#import "FSOutbox.h"
+#import "FSRateLimiter.h"
+#import "FSEventHub.h"
 
+/*!
+ Acts on [FSContext defaultContext] -- create more FSContexts to run several users in one process
+ */
 @interface FireSuite : NSObject
 
 + (void) setFirebaseURL:(NSString *)firebaseURL;
 + (void) setCurrentUserId:(NSString *)currentUserId;
 
+/*!
+ Shard chats and users across databases -- see FSShardRouter
+ */
++ (void) setShardRouter:(FSShardRouter *)shardRouter;
+
+/*!
+ Where managers call back -- defaults to the main queue.  Managers themselves may be called from any thread.
+ */
++ (void) setCallbackQueue:(dispatch_queue_t)callbackQueue;
+
+/*!
+ Journal sends and alerts so they survive failures and relaunches -- see FSOutbox
+ */
++ (void) setOutbox:(FSOutbox *)outbox;
+
 + (FSChatManager *) chatManager;
 + (FSPresenceManager *) presenceManager;
 + (FSChannelManager *) channelManager;
 
+/*!
+ Counters, gauges and latency histograms for every manager
+ */
++ (FSMetrics *) metrics;
+
+/*!
+ Spans for each step of load, send, header query, presence and alerts -- off until enabled
+ */
++ (FSTracer *) tracer;
+
+/*!
+ Backoff, budget and per-operation policies for every manager's writes and transactions
+ */
++ (FSRetrier *) retrier;
+
+/*!
+ Token buckets pacing sends, per chat and overall -- off until a rate is set
+ */
++ (FSRateLimiter *) rateLimiter;
+
+/*!
+ The listeners every manager shares -- one per path and event type
+ */
++ (FSEventHub *) eventHub;
+
 @end
@@ -12,37 +12,57 @@
 #pragma mark GET MANAGERS
 
 + (FSChatManager *) chatManager {
-    return [FSChatManager singleton];
+    return [FSContext defaultContext].chatManager;
 }
 
 + (FSChannelManager *) channelManager {
-    return [FSChannelManager singleton];
+    return [FSContext defaultContext].channelManager;
 }
 
 + (FSPresenceManager *) presenceManager {
-    return [FSPresenceManager singleton];
+    return [FSContext defaultContext].presenceManager;
+}
+
++ (FSMetrics *) metrics {
+    return [FSContext defaultContext].metrics;
+}
+
++ (FSTracer *) tracer {
+    return [FSContext defaultContext].tracer;
+}
+
++ (FSRetrier *) retrier {
+    return [FSContext defaultContext].retrier;
+}
+
++ (FSRateLimiter *) rateLimiter {
+    return [FSContext defaultContext].rateLimiter;
+}
+
++ (FSEventHub *) eventHub {
+    return [FSContext defaultContext].eventHub;
 }
 
 #pragma mark SET URL & CURRENT USER ID
 
 + (void) setFirebaseURL:(NSString *)firebaseURL {
-    
-    if (![firebaseURL hasSuffix:@"/"]) {
-        firebaseURL = [NSString stringWithFormat:@"%@/", firebaseURL];
-    }
-    
-    // Set Our Tools
-    [FSChatManager singleton].urlRefString = firebaseURL;
-    [FSPresenceManager singleton].urlRefString = firebaseURL;
-    [FSChannelManager singleton].urlRefString = firebaseURL;
+    [FSContext defaultContext].firebaseURL = firebaseURL;
 }
 
 + (void) setCurrentUserId:(NSString *)currentUserId {
-    
-    // Set Our Tools
-    [FSChatManager singleton].currentUserId = currentUserId;
-    [FSPresenceManager singleton].currentUserId = currentUserId;
-    [FSChannelManager singleton].currentUserId = currentUserId;
+    [FSContext defaultContext].currentUserId = currentUserId;
+}
+
++ (void) setShardRouter:(FSShardRouter *)shardRouter {
+    [FSContext defaultContext].shardRouter = shardRouter;
+}
+
++ (void) setCallbackQueue:(dispatch_queue_t)callbackQueue {
+    [FSContext defaultContext].callbackQueue = callbackQueue;
+}
+
++ (void) setOutbox:(FSOutbox *)outbox {
+    [FSContext defaultContext].outbox = outbox;
 }
 
 @end
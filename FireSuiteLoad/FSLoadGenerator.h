@@ -0,0 +1,120 @@
+//
+//  FSLoadGenerator.h
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "FireSuite.h"
+
+#pragma mark CONSTANTS
+
+// Action Keys
+FOUNDATION_EXPORT NSString *const kLoadActionCreateChat;
+FOUNDATION_EXPORT NSString *const kLoadActionSendMessage;
+FOUNDATION_EXPORT NSString *const kLoadActionPresenceFlap;
+FOUNDATION_EXPORT NSString *const kLoadActionSendAlert;
+
+// Report Keys
+FOUNDATION_EXPORT NSString *const kLoadReportScenario;
+FOUNDATION_EXPORT NSString *const kLoadReportParameters;
+FOUNDATION_EXPORT NSString *const kLoadReportSetupSeconds;
+FOUNDATION_EXPORT NSString *const kLoadReportElapsedSeconds;
+FOUNDATION_EXPORT NSString *const kLoadReportActions;
+FOUNDATION_EXPORT NSString *const kLoadReportAlertsReceived;
+FOUNDATION_EXPORT NSString *const kLoadReportStatusUpdatesReceived;
+FOUNDATION_EXPORT NSString *const kLoadReportClient;
+FOUNDATION_EXPORT NSString *const kLoadReportBackend;
+
+// Per Action Report Keys
+FOUNDATION_EXPORT NSString *const kLoadReportIssued;
+FOUNDATION_EXPORT NSString *const kLoadReportCompleted;
+FOUNDATION_EXPORT NSString *const kLoadReportErrors;
+FOUNDATION_EXPORT NSString *const kLoadReportSkipped;
+FOUNDATION_EXPORT NSString *const kLoadReportThroughput;
+FOUNDATION_EXPORT NSString *const kLoadReportP50Ms;
+FOUNDATION_EXPORT NSString *const kLoadReportP90Ms;
+FOUNDATION_EXPORT NSString *const kLoadReportP99Ms;
+FOUNDATION_EXPORT NSString *const kLoadReportMaxMs;
+
+#pragma mark SCENARIO
+
+/*!
+ What a crowd of simulated users does -- rates are per user, spread evenly over time
+ */
+@interface FSLoadScenario : NSObject <NSCopying>
+
+/*!
+ 100 users for 10s: a chat every 2 minutes, a message every 10s, pairs only, no flapping or alerts
+ */
++ (instancetype) scenarioWithName:(NSString *)name;
+
+/*!
+ quiet, chatty, groups, presenceStorm, alertStorm -- see the README
+ */
++ (NSArray *) standardScenarios;
++ (instancetype) standardScenarioNamed:(NSString *)name;
+
+@property (strong, nonatomic) NSString * name;
+
+@property (nonatomic) NSUInteger users;
+@property (nonatomic) NSTimeInterval duration;
+
+/*!
+ Each new chat is opened in place of the user's current one
+ */
+@property (nonatomic) double chatsPerUserPerMinute;
+@property (nonatomic) double messagesPerUserPerMinute;
+
+/*!
+ Members per chat, the creator included -- at least 2
+ */
+@property (nonatomic) NSUInteger groupSize;
+
+/*!
+ Presence stopped and started again -- a dropped and restored connection
+ */
+@property (nonatomic) double presenceFlapsPerUserPerMinute;
+@property (nonatomic) double alertsPerUserPerMinute;
+
+/*!
+ Everything above as plain values
+ */
+- (NSDictionary *) parameters;
+
+@end
+
+#pragma mark GENERATOR
+
+/*!
+ Drives one FSContext per simulated user against a database and measures what each action costs.  Users connect, open a chat and register for alerts before the clock starts; actions are then issued on a fixed tick to random users, and whatever is still in flight when the duration ends is waited for.
+ */
+@interface FSLoadGenerator : NSObject
+
+- (instancetype) initWithFirebaseURL:(NSString *)firebaseURL;
+
+@property (strong, nonatomic, readonly) NSString * firebaseURL;
+
+/*!
+ Backend counters sampled before and after each run -- the report carries the difference.  nil leaves kLoadReportBackend out.
+ */
+@property (copy, nonatomic) NSDictionary * (^backendStats)(void);
+
+/*!
+ Which users act and who they chat with -- fixed so runs repeat
+ */
+@property (nonatomic) unsigned int randomSeed;
+
+/*!
+ Gives up on in-flight actions this long after the duration ends, default 30s
+ */
+@property (nonatomic) NSTimeInterval drainTimeout;
+
+/*!
+ Runs @param scenario to completion -- blocks, so call it off the Firebase dispatch queue.  @return a report keyed by kLoadReport..., plain values only.
+ */
+- (NSDictionary *) runScenario:(FSLoadScenario *)scenario;
+
+@end
@@ -0,0 +1,664 @@
+//
+//  FSLoadGenerator.m
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import "FSLoadGenerator.h"
+
+#pragma mark KEYS
+
+// Action Keys
+NSString *const kLoadActionCreateChat = @"createChat";
+NSString *const kLoadActionSendMessage = @"sendMessage";
+NSString *const kLoadActionPresenceFlap = @"presenceFlap";
+NSString *const kLoadActionSendAlert = @"sendAlert";
+
+// Report Keys
+NSString *const kLoadReportScenario = @"scenario";
+NSString *const kLoadReportParameters = @"parameters";
+NSString *const kLoadReportSetupSeconds = @"setupSeconds";
+NSString *const kLoadReportElapsedSeconds = @"elapsedSeconds";
+NSString *const kLoadReportActions = @"actions";
+NSString *const kLoadReportAlertsReceived = @"alertsReceived";
+NSString *const kLoadReportStatusUpdatesReceived = @"statusUpdatesReceived";
+NSString *const kLoadReportClient = @"client";
+NSString *const kLoadReportBackend = @"backend";
+
+// Per Action Report Keys
+NSString *const kLoadReportIssued = @"issued";
+NSString *const kLoadReportCompleted = @"completed";
+NSString *const kLoadReportErrors = @"errors";
+NSString *const kLoadReportSkipped = @"skipped";
+NSString *const kLoadReportThroughput = @"throughputPerSecond";
+NSString *const kLoadReportP50Ms = @"p50Ms";
+NSString *const kLoadReportP90Ms = @"p90Ms";
+NSString *const kLoadReportP99Ms = @"p99Ms";
+NSString *const kLoadReportMaxMs = @"maxMs";
+
+static NSString *const kLoadAlertType = @"loadTest";
+
+// Driver Tick -- Actions Due Within One Are Issued Together
+static NSTimeInterval const kLoadTickInterval = 0.01;
+static NSTimeInterval const kLoadDefaultDrainTimeout = 30;
+static NSTimeInterval const kLoadSetupTimeout = 120;
+static int const kLoadRecentMessages = 20;
+
+#pragma mark SCENARIO
+
+@implementation FSLoadScenario
+
++ (instancetype) scenarioWithName:(NSString *)name {
+    FSLoadScenario * scenario = [self new];
+    scenario.name = name;
+    scenario.users = 100;
+    scenario.duration = 10;
+    scenario.chatsPerUserPerMinute = 0.5;
+    scenario.messagesPerUserPerMinute = 6;
+    scenario.groupSize = 2;
+    return scenario;
+}
+
++ (NSArray *) standardScenarios {
+
+    // Steady Pairs Chatting Now And Then
+    FSLoadScenario * quiet = [self scenarioWithName:@"quiet"];
+    quiet.users = 1000;
+    quiet.duration = 30;
+    quiet.messagesPerUserPerMinute = 2;
+
+    // Everyone Typing At Once
+    FSLoadScenario * chatty = [self scenarioWithName:@"chatty"];
+    chatty.users = 1000;
+    chatty.duration = 30;
+    chatty.chatsPerUserPerMinute = 1;
+    chatty.messagesPerUserPerMinute = 30;
+
+    // Group Chats -- Bigger Headers Fan Out
+    FSLoadScenario * groups = [self scenarioWithName:@"groups"];
+    groups.users = 500;
+    groups.duration = 30;
+    groups.chatsPerUserPerMinute = 2;
+    groups.messagesPerUserPerMinute = 12;
+    groups.groupSize = 8;
+
+    // Flaky Connections
+    FSLoadScenario * presenceStorm = [self scenarioWithName:@"presenceStorm"];
+    presenceStorm.users = 1000;
+    presenceStorm.duration = 30;
+    presenceStorm.messagesPerUserPerMinute = 2;
+    presenceStorm.groupSize = 4;
+    presenceStorm.presenceFlapsPerUserPerMinute = 6;
+
+    // Notifications Flood
+    FSLoadScenario * alertStorm = [self scenarioWithName:@"alertStorm"];
+    alertStorm.users = 1000;
+    alertStorm.duration = 30;
+    alertStorm.messagesPerUserPerMinute = 2;
+    alertStorm.alertsPerUserPerMinute = 30;
+
+    return @[quiet, chatty, groups, presenceStorm, alertStorm];
+}
+
++ (instancetype) standardScenarioNamed:(NSString *)name {
+    for (FSLoadScenario * scenario in [self standardScenarios]) {
+        if ([scenario.name isEqualToString:name]) return scenario;
+    }
+    return nil;
+}
+
+- (id) copyWithZone:(NSZone *)zone {
+    FSLoadScenario * scenario = [[[self class] allocWithZone:zone] init];
+    scenario.name = _name;
+    scenario.users = _users;
+    scenario.duration = _duration;
+    scenario.chatsPerUserPerMinute = _chatsPerUserPerMinute;
+    scenario.messagesPerUserPerMinute = _messagesPerUserPerMinute;
+    scenario.groupSize = _groupSize;
+    scenario.presenceFlapsPerUserPerMinute = _presenceFlapsPerUserPerMinute;
+    scenario.alertsPerUserPerMinute = _alertsPerUserPerMinute;
+    return scenario;
+}
+
+- (NSDictionary *) parameters {
+    return @{
+             @"users" : @(_users),
+             @"duration" : @(_duration),
+             @"chatsPerUserPerMinute" : @(_chatsPerUserPerMinute),
+             @"messagesPerUserPerMinute" : @(_messagesPerUserPerMinute),
+             @"groupSize" : @(_groupSize),
+             @"presenceFlapsPerUserPerMinute" : @(_presenceFlapsPerUserPerMinute),
+             @"alertsPerUserPerMinute" : @(_alertsPerUserPerMinute),
+             };
+}
+
+@end
+
+#pragma mark USER
+
+/*!
+ One simulated user -- only touched on the driver queue, which is also every context's callbackQueue
+ */
+@interface FSLoadUser : NSObject
+
+@property (strong, nonatomic) FSContext * context;
+
+/*!
+ Partners from the first chat -- their presence is watched
+ */
+@property (strong, nonatomic) NSArray * watchedUserIds;
+
+/*!
+ The open chat -- nil while switching
+ */
+@property (strong, nonatomic) NSString * chatId;
+@property (nonatomic) BOOL isSwitchingChat;
+@property (nonatomic) BOOL isFlapping;
+
+/*!
+ Run once the user's own status shows online again, then cleared
+ */
+@property (copy, nonatomic) dispatch_block_t connected;
+
+// Counters Shared By Every User
+@property (copy, nonatomic) dispatch_block_t alertReceived;
+@property (copy, nonatomic) dispatch_block_t statusReceived;
+
+- (void) receivedAlert:(NSDictionary *)alert;
+- (void) userStatusDidUpdateWithId:(NSString *)userId andStatus:(BOOL)isOnline;
+
+@end
+
+@implementation FSLoadUser
+
+- (void) receivedAlert:(NSDictionary *)alert {
+    if (_alertReceived) _alertReceived();
+}
+
+- (void) userStatusDidUpdateWithId:(NSString *)userId andStatus:(BOOL)isOnline {
+    
+    // Our Own Status -- Only Watched While Flapping, Not A Partner's Update
+    if ([userId isEqualToString:_context.currentUserId]) {
+        if (!isOnline || !_connected) return;
+        dispatch_block_t connected = _connected;
+        _connected = nil;
+        connected();
+        return;
+    }
+    if (_statusReceived) _statusReceived();
+}
+
+@end
+
+#pragma mark ACTION
+
+/*!
+ One kind of action and what it cost -- counters only touched on the driver queue
+ */
+@interface FSLoadAction : NSObject
+
+@property (strong, nonatomic) NSString * name;
+
+/*!
+ Across all users, per second
+ */
+@property (nonatomic) double rate;
+
+/*!
+ Actions owed but not yet issued -- carries fractions between ticks
+ */
+@property (nonatomic) double credit;
+
+/*!
+ Starts the action for @param user, calling @param finished once -- @return NO to skip a user that's busy
+ */
+@property (copy, nonatomic) BOOL (^perform)(FSLoadUser * user, void (^finished)(NSError * error));
+
+@property (nonatomic) NSUInteger issued;
+@property (nonatomic) NSUInteger completed;
+@property (nonatomic) NSUInteger errors;
+@property (nonatomic) NSUInteger skipped;
+@property (strong, nonatomic) FSLatencyHistogram * latency;
+
+@end
+
+@implementation FSLoadAction
+
+- (instancetype) init {
+    self = [super init];
+    if (self) {
+        _latency = [FSLatencyHistogram new];
+    }
+    return self;
+}
+
+- (NSDictionary *) reportWithElapsed:(NSTimeInterval)elapsed {
+    return @{
+             kLoadReportIssued : @(_issued),
+             kLoadReportCompleted : @(_completed),
+             kLoadReportErrors : @(_errors),
+             kLoadReportSkipped : @(_skipped),
+             kLoadReportThroughput : @(elapsed > 0 ? _completed / elapsed : 0),
+             kLoadReportP50Ms : @([_latency valueAtPercentile:50] * 1000),
+             kLoadReportP90Ms : @([_latency valueAtPercentile:90] * 1000),
+             kLoadReportP99Ms : @([_latency valueAtPercentile:99] * 1000),
+             kLoadReportMaxMs : @([_latency max] * 1000),
+             };
+}
+
+@end
+
+#pragma mark GENERATOR
+
+@interface FSLoadGenerator ()
+{
+    // Driver Queue Only
+    unsigned int _randomState;
+    NSUInteger _inFlight;
+    NSUInteger _alertsReceived;
+    NSUInteger _statusesReceived;
+}
+
+@end
+
+@implementation FSLoadGenerator
+
+- (instancetype) initWithFirebaseURL:(NSString *)firebaseURL {
+    self = [super init];
+    if (self) {
+        _firebaseURL = firebaseURL;
+        _randomSeed = 1;
+        _drainTimeout = kLoadDefaultDrainTimeout;
+    }
+    return self;
+}
+
+#pragma mark RUN
+
+- (NSDictionary *) runScenario:(FSLoadScenario *)scenario {
+
+    scenario = [scenario copy];
+    scenario.groupSize = MIN(MAX(scenario.groupSize, 2), MAX(scenario.users, 2));
+
+    dispatch_queue_t queue = dispatch_queue_create("com.firesuite.load.driver", DISPATCH_QUEUE_SERIAL);
+    _randomState = _randomSeed;
+    _inFlight = 0;
+    _alertsReceived = 0;
+    _statusesReceived = 0;
+
+    NSDictionary * backendBefore = _backendStats ? _backendStats() : nil;
+
+    // Connect Everyone Before The Clock Starts
+    NSTimeInterval setupStart = FSMetricsNow();
+    NSArray * users = [self connectUsersForScenario:scenario onQueue:queue];
+    NSTimeInterval setupSeconds = FSMetricsNow() - setupStart;
+
+    // Only Count What The Run Itself Caused
+    dispatch_sync(queue, ^{
+        _alertsReceived = 0;
+        _statusesReceived = 0;
+    });
+
+    NSArray * actions = [self actionsForScenario:scenario users:users];
+    NSTimeInterval start = FSMetricsNow();
+    [self driveActions:actions users:users forDuration:scenario.duration onQueue:queue];
+    NSTimeInterval elapsed = FSMetricsNow() - start;
+
+    [self disconnectUsers:users onQueue:queue];
+
+    // Report
+    NSMutableDictionary * actionReports = [NSMutableDictionary new];
+    for (FSLoadAction * action in actions) {
+        actionReports[action.name] = [action reportWithElapsed:elapsed];
+    }
+
+    NSMutableDictionary * report = [NSMutableDictionary new];
+    report[kLoadReportScenario] = scenario.name ?: @"custom";
+    report[kLoadReportParameters] = [scenario parameters];
+    report[kLoadReportSetupSeconds] = @(setupSeconds);
+    report[kLoadReportElapsedSeconds] = @(elapsed);
+    report[kLoadReportActions] = actionReports;
+    report[kLoadReportAlertsReceived] = @(_alertsReceived);
+    report[kLoadReportStatusUpdatesReceived] = @(_statusesReceived);
+    report[kLoadReportClient] = [self clientMetricsForUsers:users];
+    if (_backendStats) {
+        report[kLoadReportBackend] = [self deltaFrom:backendBefore to:_backendStats()];
+    }
+    return report;
+}
+
+#pragma mark USERS
+
+- (NSString *) userIdAtIndex:(NSUInteger)index {
+    return [NSString stringWithFormat:@"loadUser%lu", (unsigned long)index];
+}
+
+/*!
+ @param index plus groupSize - 1 distinct others -- driver queue or before the run
+ */
+- (NSArray *) membersForUserAtIndex:(NSUInteger)index scenario:(FSLoadScenario *)scenario {
+    NSMutableOrderedSet * members = [NSMutableOrderedSet orderedSetWithObject:@(index)];
+    while (members.count < scenario.groupSize) {
+        [members addObject:@(rand_r(&_randomState) % scenario.users)];
+    }
+    NSMutableArray * userIds = [NSMutableArray new];
+    for (NSNumber * member in members) {
+        [userIds addObject:[self userIdAtIndex:member.unsignedIntegerValue]];
+    }
+    return userIds;
+}
+
+- (NSArray *) connectUsersForScenario:(FSLoadScenario *)scenario onQueue:(dispatch_queue_t)queue {
+
+    NSMutableArray * users = [NSMutableArray arrayWithCapacity:scenario.users];
+    for (NSUInteger i = 0; i < scenario.users; i++) {
+        FSLoadUser * user = [FSLoadUser new];
+        user.context = [FSContext contextWithFirebaseURL:_firebaseURL currentUserId:[self userIdAtIndex:i]];
+        user.context.callbackQueue = queue;
+        user.alertReceived = ^{
+            _alertsReceived++;
+        };
+        user.statusReceived = ^{
+            _statusesReceived++;
+        };
+        [users addObject:user];
+    }
+
+    __block NSUInteger remaining = users.count;
+    dispatch_semaphore_t connected = dispatch_semaphore_create(0);
+    dispatch_async(queue, ^{
+        if (remaining == 0) dispatch_semaphore_signal(connected);
+
+        for (NSUInteger i = 0; i < users.count; i++) {
+            FSLoadUser * user = users[i];
+            FSContext * context = user.context;
+            NSArray * members = [self membersForUserAtIndex:i scenario:scenario];
+            user.watchedUserIds = [members subarrayWithRange:NSMakeRange(1, members.count - 1)];
+
+            // Online, Watching Partners, Listening For Alerts, With A Chat Open
+            [context.presenceManager startPresenceManager];
+            [self watchPartnersOfUser:user];
+            [context.channelManager registerUserAlertsObserver:user withSelector:@selector(receivedAlert:)];
+
+            user.isSwitchingChat = YES;
+            FSChatManager * chatManager = context.chatManager;
+            [[[chatManager createNewChatForUsers:members withCustomId:nil] then:^id(NSString * chatId) {
+                return [[chatManager openChatSessionWithChatId:chatId andNumberOfRecentMessages:kLoadRecentMessages] then:^id(id response) {
+                    return chatId;
+                }];
+            }] addCompletionBlock:^(NSString * chatId, NSError * error) {
+                if (error) NSLog(@"FSLoadGenerator: %@ failed to open a chat: %@", context.currentUserId, error);
+                user.chatId = chatId;
+                user.isSwitchingChat = NO;
+                if (--remaining == 0) dispatch_semaphore_signal(connected);
+            }];
+        }
+    });
+
+    if (dispatch_semaphore_wait(connected, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kLoadSetupTimeout * NSEC_PER_SEC)))) {
+        NSLog(@"FSLoadGenerator: Setup timed out -- some users start without a chat");
+    }
+    return users;
+}
+
+- (void) watchPartnersOfUser:(FSLoadUser *)user {
+    for (NSString * userId in user.watchedUserIds) {
+        [user.context.presenceManager registerUserStatusObserver:user withSelector:@selector(userStatusDidUpdateWithId:andStatus:) forUserId:userId];
+    }
+}
+
+- (void) disconnectUsers:(NSArray *)users onQueue:(dispatch_queue_t)queue {
+
+    __block NSUInteger remaining = users.count * 3;
+    dispatch_semaphore_t disconnected = dispatch_semaphore_create(0);
+    dispatch_block_t done = ^{
+        if (--remaining == 0) dispatch_semaphore_signal(disconnected);
+    };
+
+    dispatch_async(queue, ^{
+        if (remaining == 0) dispatch_semaphore_signal(disconnected);
+
+        for (FSLoadUser * user in users) {
+            FSContext * context = user.context;
+            [context.chatManager endChatSessionWithCompletionBlock:^(NSError *error) {
+                done();
+            }];
+            [context.presenceManager stopPresenceMonitorWithCompletion:done];
+            [context.channelManager endAlertsMonitorWithCompletionBlock:done];
+        }
+    });
+
+    if (dispatch_semaphore_wait(disconnected, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kLoadSetupTimeout * NSEC_PER_SEC)))) {
+        NSLog(@"FSLoadGenerator: Timed out disconnecting users");
+    }
+}
+
+#pragma mark ACTIONS
+
+- (NSArray *) actionsForScenario:(FSLoadScenario *)scenario users:(NSArray *)users {
+
+    NSMutableArray * actions = [NSMutableArray new];
+    double perUserToTotal = (double)scenario.users / 60;
+
+    // New Chat, Opened In Place Of The Current One
+    FSLoadAction * createChat = [FSLoadAction new];
+    createChat.name = kLoadActionCreateChat;
+    createChat.rate = scenario.chatsPerUserPerMinute * perUserToTotal;
+    createChat.perform = ^BOOL(FSLoadUser * user, void (^finished)(NSError *)) {
+        if (user.isSwitchingChat) return NO;
+
+        NSUInteger index = [users indexOfObjectIdenticalTo:user];
+        NSArray * members = [self membersForUserAtIndex:index scenario:scenario];
+        NSString * previousChatId = user.chatId;
+        user.chatId = nil;
+        user.isSwitchingChat = YES;
+
+        FSChatManager * chatManager = user.context.chatManager;
+        [[[chatManager createNewChatForUsers:members withCustomId:nil] then:^id(NSString * chatId) {
+            return [[chatManager endChatSession] then:^id(id value) {
+                return [[chatManager openChatSessionWithChatId:chatId andNumberOfRecentMessages:kLoadRecentMessages] then:^id(id response) {
+                    return chatId;
+                }];
+            }];
+        }] addCompletionBlock:^(NSString * chatId, NSError * error) {
+            finished(error);
+            if (!error) {
+                user.chatId = chatId;
+                user.isSwitchingChat = NO;
+                return;
+            }
+
+            // Back To Where We Were
+            if (!previousChatId) {
+                user.isSwitchingChat = NO;
+                return;
+            }
+            [[[chatManager endChatSession] then:^id(id value) {
+                return [chatManager openChatSessionWithChatId:previousChatId andNumberOfRecentMessages:kLoadRecentMessages];
+            }] addCompletionBlock:^(id value, NSError * error) {
+                if (!error) user.chatId = previousChatId;
+                user.isSwitchingChat = NO;
+            }];
+        }];
+        return YES;
+    };
+    [actions addObject:createChat];
+
+    FSLoadAction * sendMessage = [FSLoadAction new];
+    sendMessage.name = kLoadActionSendMessage;
+    sendMessage.rate = scenario.messagesPerUserPerMinute * perUserToTotal;
+    sendMessage.perform = ^BOOL(FSLoadUser * user, void (^finished)(NSError *)) {
+        if (!user.chatId) return NO;
+
+        NSString * content = [NSString stringWithFormat:@"load message %u", rand_r(&_randomState)];
+        [[user.context.chatManager sendMessage:content] addCompletionBlock:^(id value, NSError * error) {
+            finished(error);
+        }];
+        return YES;
+    };
+    [actions addObject:sendMessage];
+
+    // Taken Offline And Restored -- Measured Until The User's Own Connection Shows Again
+    FSLoadAction * presenceFlap = [FSLoadAction new];
+    presenceFlap.name = kLoadActionPresenceFlap;
+    presenceFlap.rate = scenario.presenceFlapsPerUserPerMinute * perUserToTotal;
+    presenceFlap.perform = ^BOOL(FSLoadUser * user, void (^finished)(NSError *)) {
+        if (user.isFlapping) return NO;
+        user.isFlapping = YES;
+
+        FSPresenceManager * presenceManager = user.context.presenceManager;
+        NSString * userId = user.context.currentUserId;
+        [presenceManager stopPresenceMonitorWithCompletion:^{
+            user.connected = ^{
+                [presenceManager removeStatusObserverForObject:user andUserId:userId];
+                user.isFlapping = NO;
+                finished(nil);
+            };
+            [presenceManager registerUserStatusObserver:user withSelector:@selector(userStatusDidUpdateWithId:andStatus:) forUserId:userId];
+            [presenceManager startPresenceManager];
+            [self watchPartnersOfUser:user];
+        }];
+        return YES;
+    };
+    [actions addObject:presenceFlap];
+
+    FSLoadAction * sendAlert = [FSLoadAction new];
+    sendAlert.name = kLoadActionSendAlert;
+    sendAlert.rate = scenario.alertsPerUserPerMinute * perUserToTotal;
+    sendAlert.perform = ^BOOL(FSLoadUser * user, void (^finished)(NSError *)) {
+        FSLoadUser * recipient = users[rand_r(&_randomState) % users.count];
+        if (recipient == user && users.count > 1) return NO;
+
+        [[user.context.channelManager sendAlertToUserId:recipient.context.currentUserId
+                                         withAlertType:kLoadAlertType
+                                               andData:@{@"from": user.context.currentUserId}] addCompletionBlock:^(id value, NSError * error) {
+            finished(error);
+        }];
+        return YES;
+    };
+    [actions addObject:sendAlert];
+
+    return actions;
+}
+
+#pragma mark DRIVER
+
+- (void) issueAction:(FSLoadAction *)action toUser:(FSLoadUser *)user {
+
+    // Counted Up Front -- finished May Run Before perform Returns
+    _inFlight++;
+    NSTimeInterval start = FSMetricsNow();
+    BOOL isIssued = action.perform(user, ^(NSError * error) {
+        [action.latency recordLatency:FSMetricsNow() - start];
+        if (error) action.errors++;
+        else action.completed++;
+        _inFlight--;
+    });
+
+    if (isIssued) {
+        action.issued++;
+    }
+    else {
+        action.skipped++;
+        _inFlight--;
+    }
+}
+
+- (void) driveActions:(NSArray *)actions users:(NSArray *)users forDuration:(NSTimeInterval)duration onQueue:(dispatch_queue_t)queue {
+
+    if (users.count == 0) return;
+
+    dispatch_semaphore_t finished = dispatch_semaphore_create(0);
+    dispatch_source_t timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, queue);
+    dispatch_source_set_timer(timer, DISPATCH_TIME_NOW, (uint64_t)(kLoadTickInterval * NSEC_PER_SEC), (uint64_t)(kLoadTickInterval * NSEC_PER_SEC / 10));
+
+    NSTimeInterval start = FSMetricsNow();
+    NSTimeInterval end = start + duration;
+    __block NSTimeInterval lastTick = start;
+
+    dispatch_source_set_event_handler(timer, ^{
+        NSTimeInterval now = MIN(FSMetricsNow(), end);
+
+        // Issue Whatever Came Due Since The Last Tick
+        for (FSLoadAction * action in actions) {
+            action.credit += action.rate * (now - lastTick);
+            while (action.credit >= 1) {
+                action.credit -= 1;
+                [self issueAction:action toUser:users[rand_r(&_randomState) % users.count]];
+            }
+        }
+        lastTick = now;
+
+        if (now >= end) {
+            dispatch_source_cancel(timer);
+            [self drainUntil:end + _drainTimeout onQueue:queue finished:finished];
+        }
+    });
+    dispatch_resume(timer);
+
+    dispatch_semaphore_wait(finished, DISPATCH_TIME_FOREVER);
+}
+
+// Wait Out Actions Still In Flight
+- (void) drainUntil:(NSTimeInterval)deadline onQueue:(dispatch_queue_t)queue finished:(dispatch_semaphore_t)finished {
+    if (_inFlight == 0 || FSMetricsNow() >= deadline) {
+        if (_inFlight > 0) NSLog(@"FSLoadGenerator: Gave up on %lu actions still in flight", (unsigned long)_inFlight);
+        dispatch_semaphore_signal(finished);
+        return;
+    }
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kLoadTickInterval * NSEC_PER_SEC)), queue, ^{
+        [self drainUntil:deadline onQueue:queue finished:finished];
+    });
+}
+
+#pragma mark METRICS
+
+/*!
+ Every user's metrics added up
+ */
+- (NSDictionary *) clientMetricsForUsers:(NSArray *)users {
+
+    int64_t roundTrips = 0, transactionAttempts = 0, transactionRetries = 0, retries = 0, retriesDenied = 0;
+    NSMutableDictionary * operations = [NSMutableDictionary new];
+
+    for (FSLoadUser * user in users) {
+        FSMetrics * metrics = user.context.metrics;
+        roundTrips += [metrics roundTrips];
+        transactionAttempts += [metrics transactionAttempts];
+        transactionRetries += [metrics transactionRetries];
+        retries += [metrics retries];
+        retriesDenied += [metrics retriesDenied];
+
+        NSDictionary * snapshot = [metrics snapshot][kMetricsOperations];
+        for (NSString * operation in snapshot) {
+            NSMutableDictionary * totals = operations[operation];
+            if (!totals) {
+                totals = [NSMutableDictionary dictionaryWithDictionary:@{@"calls": @0, @"errors": @0}];
+                operations[operation] = totals;
+            }
+            totals[@"calls"] = @([totals[@"calls"] longLongValue] + [snapshot[operation][@"calls"] longLongValue]);
+            totals[@"errors"] = @([totals[@"errors"] longLongValue] + [snapshot[operation][@"errors"] longLongValue]);
+        }
+    }
+
+    return @{
+             kMetricsRoundTrips : @(roundTrips),
+             kMetricsTransactionAttempts : @(transactionAttempts),
+             kMetricsTransactionRetries : @(transactionRetries),
+             kMetricsRetries : @(retries),
+             kMetricsRetriesDenied : @(retriesDenied),
+             kMetricsOperations : operations,
+             };
+}
+
+- (NSDictionary *) deltaFrom:(NSDictionary *)before to:(NSDictionary *)after {
+    NSMutableDictionary * delta = [NSMutableDictionary new];
+    for (NSString * key in after) {
+        if (![after[key] isKindOfClass:[NSNumber class]]) continue;
+        delta[key] = @([after[key] longLongValue] - [before[key] longLongValue]);
+    }
+    return delta;
+}
+
+@end
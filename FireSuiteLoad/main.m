@@ -0,0 +1,124 @@
+//
+//  main.m
+//  FireSuiteLoad
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "FSLoadGenerator.h"
+#import "FSLocalDatabase.h"
+
+static NSString *const kDefaultURL = @"https://firesuite-load.firebaseIO.com/";
+
+// How Long The Last Scenario's Stragglers Get To Settle Before The Next Reset
+static NSTimeInterval const kIdleTimeout = 30;
+
+static void PrintUsage(void) {
+    printf("usage: FireSuiteLoad [-scenario quiet|chatty|groups|presenceStorm|alertStorm|all]\n"
+           "                     [-users N] [-duration SECONDS] [-groupSize N]\n"
+           "                     [-chatRate PER_USER_PER_MIN] [-messageRate PER_USER_PER_MIN]\n"
+           "                     [-presenceRate PER_USER_PER_MIN] [-alertRate PER_USER_PER_MIN]\n"
+           "                     [-url FIREBASE_URL] [-latencyMs MS] [-operationsPerSecond N]\n"
+           "                     [-seed N] [-output PATH]\n");
+}
+
+/*!
+ Flags override the named scenario -- or the defaults if none was named
+ */
+static NSArray * ScenariosFromDefaults(NSUserDefaults * defaults) {
+
+    NSString * name = [defaults stringForKey:@"scenario"];
+    NSArray * scenarios;
+    if ([name isEqualToString:@"all"]) {
+        scenarios = [FSLoadScenario standardScenarios];
+    }
+    else if (name) {
+        FSLoadScenario * scenario = [FSLoadScenario standardScenarioNamed:name];
+        if (!scenario) return nil;
+        scenarios = @[scenario];
+    }
+    else {
+        scenarios = @[[FSLoadScenario scenarioWithName:@"custom"]];
+    }
+
+    for (FSLoadScenario * scenario in scenarios) {
+        if ([defaults objectForKey:@"users"]) scenario.users = [defaults integerForKey:@"users"];
+        if ([defaults objectForKey:@"duration"]) scenario.duration = [defaults doubleForKey:@"duration"];
+        if ([defaults objectForKey:@"groupSize"]) scenario.groupSize = [defaults integerForKey:@"groupSize"];
+        if ([defaults objectForKey:@"chatRate"]) scenario.chatsPerUserPerMinute = [defaults doubleForKey:@"chatRate"];
+        if ([defaults objectForKey:@"messageRate"]) scenario.messagesPerUserPerMinute = [defaults doubleForKey:@"messageRate"];
+        if ([defaults objectForKey:@"presenceRate"]) scenario.presenceFlapsPerUserPerMinute = [defaults doubleForKey:@"presenceRate"];
+        if ([defaults objectForKey:@"alertRate"]) scenario.alertsPerUserPerMinute = [defaults doubleForKey:@"alertRate"];
+    }
+    return scenarios;
+}
+
+int main(int argc, const char * argv[])
+{
+    @autoreleasepool {
+
+        // -key value Arguments Land In The Argument Domain
+        NSUserDefaults * defaults = [NSUserDefaults standardUserDefaults];
+        if ([[[NSProcessInfo processInfo] arguments] containsObject:@"-help"]) {
+            PrintUsage();
+            return 0;
+        }
+
+        NSArray * scenarios = ScenariosFromDefaults(defaults);
+        if (!scenarios) {
+            PrintUsage();
+            return 1;
+        }
+
+        // Callbacks Must Not Land On The Main Thread We Block
+        [Firebase setDispatchQueue:dispatch_queue_create("com.firesuite.load.firebase", DISPATCH_QUEUE_SERIAL)];
+
+        NSString * url = [defaults stringForKey:@"url"] ?: kDefaultURL;
+        FSLocalDatabase * database = [FSLocalDatabase databaseForURL:url];
+
+        FSLoadGenerator * generator = [[FSLoadGenerator alloc] initWithFirebaseURL:url];
+        generator.backendStats = ^NSDictionary *{
+            return [database stats];
+        };
+        if ([defaults objectForKey:@"seed"]) generator.randomSeed = (unsigned int)[defaults integerForKey:@"seed"];
+
+        NSMutableArray * reports = [NSMutableArray new];
+        for (FSLoadScenario * scenario in scenarios) {
+            fprintf(stderr, "FireSuiteLoad: %s -- %lu users for %.0fs\n", [scenario.name UTF8String], (unsigned long)scenario.users, scenario.duration);
+
+            // Each Scenario Starts From An Empty Database -- Once The Last One's Writes Have Settled
+            if (![database waitUntilIdleWithTimeout:kIdleTimeout]) {
+                fprintf(stderr, "FireSuiteLoad: Timed out after %.0fs waiting for the database to go idle before %s\n", kIdleTimeout, [scenario.name UTF8String]);
+                return 1;
+            }
+            [database reset];
+            database.latency = [defaults doubleForKey:@"latencyMs"] / 1000;
+            database.operationsPerSecond = [defaults doubleForKey:@"operationsPerSecond"];
+
+            [reports addObject:[generator runScenario:scenario]];
+        }
+
+        NSError * error;
+        NSData * json = [NSJSONSerialization dataWithJSONObject:reports options:NSJSONWritingPrettyPrinted error:&error];
+        if (!json) {
+            fprintf(stderr, "FireSuiteLoad: Failed to encode report: %s\n", [[error description] UTF8String]);
+            return 1;
+        }
+
+        NSString * output = [defaults stringForKey:@"output"];
+        if (output) {
+            if (![json writeToFile:output options:NSDataWritingAtomic error:&error]) {
+                fprintf(stderr, "FireSuiteLoad: Failed to write %s: %s\n", [output UTF8String], [[error description] UTF8String]);
+                return 1;
+            }
+        }
+        else {
+            fwrite(json.bytes, 1, json.length, stdout);
+            printf("\n");
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,67 @@
+//
+//  FSBenchmark.h
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/*!
+ Wall clock in seconds -- for measuring, not for timestamps
+ */
+FOUNDATION_EXPORT NSTimeInterval FSBenchmarkNow(void);
+
+/*!
+ Collects latency samples for one named operation and reports throughput and percentiles.  Recorded benchmarks are written together as JSON so runs can be compared across versions.
+ */
+@interface FSBenchmark : NSObject
+
++ (FSBenchmark *) benchmarkWithName:(NSString *)name;
+
+@property (strong, nonatomic, readonly) NSString * name;
+
+/*!
+ Free form parameters -- message count, chat count, latency etc.
+ */
+@property (strong, nonatomic) NSDictionary * parameters;
+
+/*!
+ Backend operation counts for the measured section -- see -[FSLocalDatabase stats]
+ */
+@property (strong, nonatomic) NSDictionary * backendStats;
+
+/*!
+ Thread safe
+ */
+- (void) addSample:(NSTimeInterval)seconds;
+
+/*!
+ Set when operations overlap -- otherwise throughput is derived from the samples
+ */
+- (void) setOperations:(NSUInteger)operations completedInDuration:(NSTimeInterval)duration;
+
+- (NSUInteger) sampleCount;
+- (NSTimeInterval) percentile:(double)percentile;
+- (double) throughput;
+
+- (NSDictionary *) report;
+
+#pragma mark RESULTS FILE
+
+/*!
+ Keep @param benchmark for the results file
+ */
++ (void) recordBenchmark:(FSBenchmark *)benchmark;
+
+/*!
+ $FIRESUITE_BENCHMARK_OUTPUT, or FireSuiteBenchmarks.json in the temporary directory
+ */
++ (NSString *) resultsPath;
+
+/*!
+ Write every recorded benchmark to @param path
+ */
++ (BOOL) writeResultsToPath:(NSString *)path error:(NSError **)error;
+
+@end
@@ -0,0 +1,138 @@
+//
+//  FSBenchmark.m
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import "FSBenchmark.h"
+
+NSTimeInterval FSBenchmarkNow(void) {
+    return [NSDate timeIntervalSinceReferenceDate];
+}
+
+static NSMutableArray * recordedBenchmarks;
+
+@interface FSBenchmark ()
+{
+    NSMutableArray * _samples;
+    NSUInteger _operations;
+    NSTimeInterval _duration;
+}
+
+@property (strong, nonatomic, readwrite) NSString * name;
+
+@end
+
+@implementation FSBenchmark
+
++ (FSBenchmark *) benchmarkWithName:(NSString *)name {
+    FSBenchmark * benchmark = [FSBenchmark new];
+    benchmark.name = name;
+    return benchmark;
+}
+
+- (instancetype) init {
+    self = [super init];
+    if (self) {
+        _samples = [NSMutableArray new];
+    }
+    return self;
+}
+
+#pragma mark SAMPLES
+
+- (void) addSample:(NSTimeInterval)seconds {
+    @synchronized (_samples) {
+        [_samples addObject:@(seconds)];
+    }
+}
+
+- (void) setOperations:(NSUInteger)operations completedInDuration:(NSTimeInterval)duration {
+    _operations = operations;
+    _duration = duration;
+}
+
+- (NSUInteger) sampleCount {
+    @synchronized (_samples) {
+        return _samples.count;
+    }
+}
+
+- (NSTimeInterval) percentile:(double)percentile {
+    NSArray * sorted;
+    @synchronized (_samples) {
+        sorted = [_samples sortedArrayUsingSelector:@selector(compare:)];
+    }
+    if (sorted.count == 0) return 0;
+
+    // Nearest Rank
+    NSUInteger rank = (NSUInteger)ceil(percentile / 100.0 * sorted.count);
+    if (rank > 0) rank--;
+    return [sorted[MIN(rank, sorted.count - 1)] doubleValue];
+}
+
+- (double) throughput {
+    if (_duration > 0) return _operations / _duration;
+
+    NSTimeInterval total = 0;
+    NSUInteger count;
+    @synchronized (_samples) {
+        for (NSNumber * sample in _samples) total += [sample doubleValue];
+        count = _samples.count;
+    }
+    return total > 0 ? count / total : 0;
+}
+
+- (NSDictionary *) report {
+    NSMutableDictionary * report = [NSMutableDictionary new];
+    report[@"name"] = _name;
+    report[@"samples"] = @([self sampleCount]);
+    report[@"throughputPerSecond"] = @([self throughput]);
+    report[@"p50Ms"] = @([self percentile:50] * 1000);
+    report[@"p99Ms"] = @([self percentile:99] * 1000);
+    report[@"maxMs"] = @([self percentile:100] * 1000);
+    if (_parameters) report[@"parameters"] = _parameters;
+    if (_backendStats) report[@"backend"] = _backendStats;
+    return report;
+}
+
+- (NSString *) description {
+    return [NSString stringWithFormat:@"%@: %.1f ops/s p50 %.3fms p99 %.3fms (%lu samples)", _name, [self throughput], [self percentile:50] * 1000, [self percentile:99] * 1000, (unsigned long)[self sampleCount]];
+}
+
+#pragma mark RESULTS FILE
+
++ (void) recordBenchmark:(FSBenchmark *)benchmark {
+    @synchronized (self) {
+        if (!recordedBenchmarks) recordedBenchmarks = [NSMutableArray new];
+        [recordedBenchmarks addObject:benchmark];
+    }
+    NSLog(@"FSBenchmark: %@", benchmark);
+}
+
++ (NSString *) resultsPath {
+    NSString * path = [[NSProcessInfo processInfo] environment][@"FIRESUITE_BENCHMARK_OUTPUT"];
+    if (path.length > 0) return path;
+    return [NSTemporaryDirectory() stringByAppendingPathComponent:@"FireSuiteBenchmarks.json"];
+}
+
++ (BOOL) writeResultsToPath:(NSString *)path error:(NSError **)error {
+
+    NSMutableArray * reports = [NSMutableArray new];
+    @synchronized (self) {
+        for (FSBenchmark * benchmark in recordedBenchmarks) [reports addObject:[benchmark report]];
+    }
+
+    NSDictionary * results = @{
+                               @"formatVersion": @1,
+                               @"date": [NSString stringWithFormat:@"%.0f", [[NSDate date] timeIntervalSince1970]],
+                               @"benchmarks": reports,
+                               };
+
+    NSData * data = [NSJSONSerialization dataWithJSONObject:results options:NSJSONWritingPrettyPrinted error:error];
+    if (!data) return NO;
+    return [data writeToFile:path options:NSDataWritingAtomic error:error];
+}
+
+@end
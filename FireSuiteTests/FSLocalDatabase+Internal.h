@@ -0,0 +1,129 @@
+//
+//  FSLocalDatabase+Internal.h
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+//  Shared between FSLocalDatabase.m and FSLocalFirebase.m -- not for use by tests.
+//
+
+#import "FSLocalDatabase.h"
+
+#pragma mark NODE
+
+/*!
+ One location in the tree -- either a leaf (NSString / NSNumber) or a branch of named children
+ */
+@interface FSLocalNode : NSObject
+
+@property (strong, nonatomic) id leaf;
+@property (strong, nonatomic, readonly) NSDictionary * children;
+@property (strong, nonatomic) id priority;
+@property (nonatomic) uint64_t version;
+
+/*!
+ Import a Foundation value -- returns nil for NSNull, nil or empty containers
+ */
++ (FSLocalNode *) nodeWithValue:(id)value;
+
+- (FSLocalNode *) childAtPath:(NSArray *)components;
+- (NSArray *) sortedChildNames;
+
+/*!
+ Replace (or remove, for nil) the node at @param components, creating and pruning branches as needed.  Returns NO if nothing changed.
+ */
+- (BOOL) setNode:(FSLocalNode *)node atPath:(NSArray *)components version:(uint64_t)version;
+- (BOOL) setPriority:(id)priority atPath:(NSArray *)components version:(uint64_t)version;
+
+- (void) stampVersion:(uint64_t)version;
+- (FSLocalNode *) deepCopy;
+- (FSLocalNode *) copyWithChildNames:(NSArray *)names;
+
+- (id) exportValue;
+- (id) exportValueWithPriority;
+- (NSUInteger) byteSize;
+- (NSUInteger) nodeCount;
+
+@end
+
+FOUNDATION_EXPORT NSComparisonResult FSLocalComparePriorities(id priority1, id priority2);
+FOUNDATION_EXPORT NSComparisonResult FSLocalCompareNames(NSString * name1, NSString * name2);
+FOUNDATION_EXPORT NSArray * FSLocalPathComponents(NSString * path);
+
+#pragma mark QUERY SPEC
+
+@interface FSLocalQuerySpec : NSObject <NSCopying>
+
+@property (strong, nonatomic) id startPriority;
+@property (strong, nonatomic) NSString * startName;
+@property (nonatomic) BOOL hasStart;
+
+@property (strong, nonatomic) id endPriority;
+@property (strong, nonatomic) NSString * endName;
+@property (nonatomic) BOOL hasEnd;
+
+@property (nonatomic) NSUInteger limit;
+
+- (NSArray *) selectedChildNamesOfNode:(FSLocalNode *)node;
+- (BOOL) includesChild:(FSLocalNode *)child named:(NSString *)name;
+
+@end
+
+#pragma mark LISTENER
+
+@interface FSLocalListener : NSObject
+
+@property (nonatomic) FirebaseHandle handle;
+@property (strong, nonatomic) NSArray * components;
+@property (strong, nonatomic) FSLocalQuerySpec * spec;
+@property (nonatomic) FEventType eventType;
+@property (nonatomic) BOOL isSingle;
+@property (nonatomic) BOOL wantsPreviousName;
+
+// Called on the callback queue with a detached copy of the data
+@property (copy, nonatomic) void (^eventBlock)(FSLocalNode * node, NSArray * components, NSString * previousName);
+@property (copy, nonatomic) void (^cancelBlock)(NSError * error);
+
+// Set by removeObserverWithHandle: -- stops queued deliveries
+@property (atomic) BOOL isCancelled;
+
+@end
+
+#pragma mark ENGINE
+
+@interface FSLocalDatabase ()
+
++ (dispatch_queue_t) callbackQueue;
++ (void) setCallbackQueue:(dispatch_queue_t)queue;
+
++ (void) disconnectAll;
++ (void) reconnectAll;
+
+/*!
+ A fresh push id -- chronologically ordered, as childByAutoId produces
+ */
++ (NSString *) nextPushId;
+
+/*!
+ Thread safe -- called from Firebase initializers
+ */
+- (void) countRefCreatedFromURL:(BOOL)fromURL;
+
+- (FirebaseHandle) addListener:(FSLocalListener *)listener;
+- (void) removeListenerWithHandle:(FirebaseHandle)handle;
+- (void) removeListenersAtPath:(NSArray *)components;
+
+/*!
+ Each write is @[components, node or NSNull] -- all applied atomically
+ */
+- (void) writeNodes:(NSArray *)writes completion:(void (^)(NSError * error))completion;
+- (void) setPriority:(id)priority atPath:(NSArray *)components completion:(void (^)(NSError * error))completion;
+
+- (void) runTransactionAtPath:(NSArray *)components
+                       update:(FSLocalNode * (^)(FSLocalNode * current, BOOL * abort))update
+                   completion:(void (^)(NSError * error, BOOL committed, FSLocalNode * node))completion;
+
+- (void) addDisconnectWrites:(NSArray *)writes completion:(void (^)(NSError * error))completion;
+- (void) cancelDisconnectWritesAtPath:(NSArray *)components completion:(void (^)(NSError * error))completion;
+
+@end
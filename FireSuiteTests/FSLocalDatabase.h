@@ -0,0 +1,152 @@
+//
+//  FSLocalDatabase.h
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <Firebase/Firebase.h>
+
+#pragma mark CONSTANTS
+
+/*!
+ Mirrors the codes the Firebase SDK reports, so FireSuite sees the same errors it would against a live database.
+ */
+typedef enum {
+    FSLocalErrorPermissionDenied = -3,
+    FSLocalErrorDisconnected = -4,
+    FSLocalErrorMaxRetries = -8,
+    FSLocalErrorWriteCanceled = -9,
+    FSLocalErrorUnavailable = -10,
+    FSLocalErrorNetworkError = -24,
+} FSLocalErrorCode;
+
+// Error Keys
+FOUNDATION_EXPORT NSString *const kFSLocalDatabaseErrorDomain;
+
+// Stats Keys
+FOUNDATION_EXPORT NSString *const kLocalStatReads;
+FOUNDATION_EXPORT NSString *const kLocalStatWrites;
+FOUNDATION_EXPORT NSString *const kLocalStatTransactions;
+FOUNDATION_EXPORT NSString *const kLocalStatTransactionRetries;
+FOUNDATION_EXPORT NSString *const kLocalStatActiveListeners;
+FOUNDATION_EXPORT NSString *const kLocalStatEventsDelivered;
+FOUNDATION_EXPORT NSString *const kLocalStatBytesSent;
+FOUNDATION_EXPORT NSString *const kLocalStatBytesReceived;
+FOUNDATION_EXPORT NSString *const kLocalStatRefsCreated;
+FOUNDATION_EXPORT NSString *const kLocalStatURLsParsed;
+
+/*!
+ In-process stand-in for a Firebase backend.  FSLocalFirebase.m implements Firebase, FQuery, FDataSnapshot, FMutableData and FTransactionResult on top of it -- link it in place of Firebase.framework and every ref whose url shares a host talks to the same FSLocalDatabase.
+
+ Latency and bandwidth are simulated on a private serial queue; callbacks arrive on the queue set by +[Firebase setDispatchQueue:] (main queue by default) in the order the "server" sent them.
+ */
+@interface FSLocalDatabase : NSObject
+
+#pragma mark DATABASES
+
+/*!
+ The database for @param url's host -- created on first use
+ */
++ (FSLocalDatabase *) databaseForURL:(NSString *)url;
+
+/*!
+ Drop all data, listeners, stats and network settings on every database
+ */
++ (void) resetAllDatabases;
+
+@property (strong, nonatomic, readonly) NSString * host;
+
+#pragma mark NETWORK SIMULATION
+
+/*!
+ Simulated round trip time in seconds -- writes land on the server after half of it, acks and events take the other half
+ */
+@property (nonatomic) NSTimeInterval latency;
+
+/*!
+ Simulated link speed in bytes per second, applies in both directions.  0 for unlimited.
+ */
+@property (nonatomic) double bandwidth;
+
+/*!
+ Server side ceiling on operations per second, like a real database's write limit -- excess operations queue.  0 for unlimited.
+ */
+@property (nonatomic) double operationsPerSecond;
+
+/*!
+ Fraction (0 - 1) of writes and transactions to fail with FSLocalErrorNetworkError.  Drawn from randomSeed so runs repeat.
+ */
+@property (nonatomic) double writeFailureRate;
+@property (nonatomic) uint64_t randomSeed;
+
+/*!
+ Connection state -- reported through .info/connected
+ */
+@property (nonatomic, readonly) BOOL isConnected;
+
+/*!
+ Drop the connection: run registered onDisconnect operations and hold new operations until reconnect.
+ */
+- (void) disconnect;
+- (void) reconnect;
+
+/*!
+ Reads and writes at or beneath @param path fail with FSLocalErrorPermissionDenied
+ */
+- (void) denyAccessToPath:(NSString *)path;
+- (void) allowAccessToPath:(NSString *)path;
+
+#pragma mark DATA
+
+/*!
+ Inspect or seed data directly, bypassing latency -- seeding still fires listeners
+ */
+- (id) valueAtPath:(NSString *)path;
+- (void) setValue:(id)value andPriority:(id)priority atPath:(NSString *)path;
+
+/*!
+ Number of stored nodes (leaves and branches) at @param path
+ */
+- (NSUInteger) nodeCountAtPath:(NSString *)path;
+
+/*!
+ Approximate JSON size of the data at @param path
+ */
+- (NSUInteger) byteSizeAtPath:(NSString *)path;
+
+/*!
+ Block until every operation and callback issued so far has run -- do not call from the Firebase dispatch queue
+ */
+- (BOOL) waitUntilIdleWithTimeout:(NSTimeInterval)timeout;
+
+/*!
+ Drop all data, stats and listeners on this database -- operations and deliveries still in flight are dropped too, never reaching the new state
+ */
+- (void) reset;
+
+#pragma mark STATS
+
+@property (nonatomic, readonly) NSUInteger reads;
+@property (nonatomic, readonly) NSUInteger writes;
+@property (nonatomic, readonly) NSUInteger transactions;
+@property (nonatomic, readonly) NSUInteger transactionRetries;
+@property (nonatomic, readonly) NSUInteger activeListeners;
+@property (nonatomic, readonly) NSUInteger eventsDelivered;
+@property (nonatomic, readonly) NSUInteger bytesSent;
+@property (nonatomic, readonly) NSUInteger bytesReceived;
+
+/*!
+ Client side -- Firebase refs allocated on this database, and how many came from parsing a URL
+ */
+@property (nonatomic, readonly) NSUInteger refsCreated;
+@property (nonatomic, readonly) NSUInteger urlsParsed;
+
+/*!
+ All counters above keyed by kLocalStat...
+ */
+- (NSDictionary *) stats;
+- (void) resetStats;
+
+@end
@@ -0,0 +1,1331 @@
+//
+//  FSLocalDatabase.m
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+
+#import "FSLocalDatabase+Internal.h"
+
+#pragma mark KEYS
+
+// Error Keys
+NSString *const kFSLocalDatabaseErrorDomain = @"FirebaseError";
+
+// Stats Keys
+NSString *const kLocalStatReads = @"reads";
+NSString *const kLocalStatWrites = @"writes";
+NSString *const kLocalStatTransactions = @"transactions";
+NSString *const kLocalStatTransactionRetries = @"transactionRetries";
+NSString *const kLocalStatActiveListeners = @"activeListeners";
+NSString *const kLocalStatEventsDelivered = @"eventsDelivered";
+NSString *const kLocalStatBytesSent = @"bytesSent";
+NSString *const kLocalStatBytesReceived = @"bytesReceived";
+NSString *const kLocalStatRefsCreated = @"refsCreated";
+NSString *const kLocalStatURLsParsed = @"urlsParsed";
+
+// Firebase gives up on a transaction after 25 conflicting attempts
+static NSUInteger const kMaxTransactionAttempts = 25;
+
+static NSString *const kPushChars = @"-0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ_abcdefghijklmnopqrstuvwxyz";
+
+#pragma mark HELPERS
+
+static NSTimeInterval FSLocalNow(void) {
+    return [NSDate timeIntervalSinceReferenceDate];
+}
+
+static dispatch_time_t FSLocalDispatchTime(NSTimeInterval delay) {
+    return dispatch_time(DISPATCH_TIME_NOW, (int64_t)(MAX(delay, 0) * NSEC_PER_SEC));
+}
+
+static BOOL FSLocalIsArrayIndex(NSString * key, NSUInteger * index) {
+    NSUInteger length = key.length;
+    if (length == 0 || length > 9) return NO;
+    if (length > 1 && [key characterAtIndex:0] == '0') return NO;
+
+    NSUInteger value = 0;
+    for (NSUInteger i = 0; i < length; i++) {
+        unichar c = [key characterAtIndex:i];
+        if (c < '0' || c > '9') return NO;
+        value = value * 10 + (c - '0');
+    }
+    *index = value;
+    return YES;
+}
+
+static BOOL FSLocalIsPrefix(NSArray * prefix, NSArray * components) {
+    if (prefix.count > components.count) return NO;
+    for (NSUInteger i = 0; i < prefix.count; i++) {
+        if (![prefix[i] isEqualToString:components[i]]) return NO;
+    }
+    return YES;
+}
+
+static id FSLocalNormalizedPriority(id priority) {
+    if ([priority isKindOfClass:[NSString class]] || [priority isKindOfClass:[NSNumber class]]) return priority;
+
+    // Server Values -- Resolved On Write, As Values Are
+    if ([priority isKindOfClass:[NSDictionary class]] && priority[@".sv"]) {
+        return [NSNumber numberWithLongLong:(long long)([[NSDate date] timeIntervalSince1970] * 1000)];
+    }
+    return nil;
+}
+
+NSArray * FSLocalPathComponents(NSString * path) {
+    NSMutableArray * components = [NSMutableArray new];
+    for (NSString * component in [path componentsSeparatedByString:@"/"]) {
+        if (component.length > 0) [components addObject:component];
+    }
+    return components;
+}
+
+// Firebase Ordering -- No Priority, Then Numbers, Then Strings
+NSComparisonResult FSLocalComparePriorities(id priority1, id priority2) {
+    int rank1 = !priority1 ? 0 : [priority1 isKindOfClass:[NSNumber class]] ? 1 : 2;
+    int rank2 = !priority2 ? 0 : [priority2 isKindOfClass:[NSNumber class]] ? 1 : 2;
+
+    if (rank1 != rank2) return rank1 < rank2 ? NSOrderedAscending : NSOrderedDescending;
+    if (rank1 == 0) return NSOrderedSame;
+    return [priority1 compare:priority2];
+}
+
+// Firebase Ordering -- Integer Names Numerically, Then Strings
+NSComparisonResult FSLocalCompareNames(NSString * name1, NSString * name2) {
+    NSUInteger index1, index2;
+    BOOL isIndex1 = FSLocalIsArrayIndex(name1, &index1);
+    BOOL isIndex2 = FSLocalIsArrayIndex(name2, &index2);
+
+    if (isIndex1 && isIndex2) {
+        if (index1 == index2) return NSOrderedSame;
+        return index1 < index2 ? NSOrderedAscending : NSOrderedDescending;
+    }
+    if (isIndex1 != isIndex2) return isIndex1 ? NSOrderedAscending : NSOrderedDescending;
+    return [name1 compare:name2];
+}
+
+#pragma mark NODE
+
+@interface FSLocalNode ()
+{
+    NSMutableDictionary * _mutableChildren;
+    NSArray * _sortedNames;
+}
+@end
+
+@implementation FSLocalNode
+
++ (FSLocalNode *) nodeWithValue:(id)value {
+
+    if (!value || value == [NSNull null]) return nil;
+
+    FSLocalNode * node = [FSLocalNode new];
+
+    if ([value isKindOfClass:[NSDictionary class]]) {
+        NSDictionary * dict = value;
+
+        // Server Values
+        if (dict[@".sv"]) {
+            node.leaf = [NSNumber numberWithLongLong:(long long)([[NSDate date] timeIntervalSince1970] * 1000)];
+            return node;
+        }
+
+        node.priority = FSLocalNormalizedPriority(dict[@".priority"]);
+
+        if (dict[@".value"]) {
+            FSLocalNode * inner = [FSLocalNode nodeWithValue:dict[@".value"]];
+            node.leaf = inner.leaf;
+            for (NSString * name in inner.children) {
+                [node setChild:inner.children[name] forName:name];
+            }
+        }
+        else {
+            for (NSString * key in dict) {
+                if ([key hasPrefix:@"."]) continue;
+                [node setChild:[FSLocalNode nodeWithValue:dict[key]] forName:key];
+            }
+        }
+    }
+    else if ([value isKindOfClass:[NSArray class]]) {
+        NSArray * array = value;
+        for (NSUInteger i = 0; i < array.count; i++) {
+            [node setChild:[FSLocalNode nodeWithValue:array[i]] forName:[NSString stringWithFormat:@"%lu", (unsigned long)i]];
+        }
+    }
+    else if ([value isKindOfClass:[NSString class]] || [value isKindOfClass:[NSNumber class]]) {
+        node.leaf = [value copy];
+    }
+    else {
+        @throw [NSException exceptionWithName:NSInvalidArgumentException
+                                       reason:[NSString stringWithFormat:@"FSLocalDatabase: Cannot store object of type %@", [value class]]
+                                     userInfo:nil];
+    }
+
+    if (!node.leaf && node.children.count == 0) return nil;
+    return node;
+}
+
+- (NSDictionary *) children {
+    return _mutableChildren;
+}
+
+- (void) setChild:(FSLocalNode *)child forName:(NSString *)name {
+    if (child) {
+        if (!_mutableChildren) _mutableChildren = [NSMutableDictionary new];
+        _mutableChildren[name] = child;
+    }
+    else {
+        [_mutableChildren removeObjectForKey:name];
+    }
+    _sortedNames = nil;
+}
+
+- (void) invalidateSortedNames {
+    _sortedNames = nil;
+}
+
+- (FSLocalNode *) childAtPath:(NSArray *)components {
+    FSLocalNode * node = self;
+    for (NSString * component in components) {
+        node = node->_mutableChildren[component];
+        if (!node) return nil;
+    }
+    return node;
+}
+
+- (NSArray *) sortedChildNames {
+    if (!_sortedNames) {
+        NSDictionary * children = _mutableChildren;
+        _sortedNames = [[children allKeys] sortedArrayUsingComparator:^NSComparisonResult(NSString * name1, NSString * name2) {
+            NSComparisonResult result = FSLocalComparePriorities([children[name1] priority], [children[name2] priority]);
+            return result != NSOrderedSame ? result : FSLocalCompareNames(name1, name2);
+        }];
+    }
+    return _sortedNames;
+}
+
+#pragma mark MUTATION
+
+- (BOOL) setNode:(FSLocalNode *)node atPath:(NSArray *)components version:(uint64_t)version {
+
+    // Root Replacement
+    if (components.count == 0) {
+        _leaf = node.leaf;
+        _priority = node.priority;
+        _mutableChildren = node ? [node->_mutableChildren mutableCopy] : nil;
+        _sortedNames = nil;
+        _version = version;
+        return YES;
+    }
+
+    NSMutableArray * trail = [NSMutableArray new];
+    FSLocalNode * current = self;
+
+    for (NSUInteger i = 0; i < components.count; i++) {
+
+        // Writing Beneath A Leaf Replaces It
+        if (current->_leaf) {
+            if (!node) return NO;
+            current->_leaf = nil;
+        }
+        [trail addObject:current];
+
+        if (i + 1 == components.count) break;
+
+        FSLocalNode * next = current->_mutableChildren[components[i]];
+        if (!next) {
+            if (!node) return NO;
+            next = [FSLocalNode new];
+            [current setChild:next forName:components[i]];
+        }
+        current = next;
+    }
+
+    NSString * name = components.lastObject;
+    if (!node && !current->_mutableChildren[name]) return NO;
+    [current setChild:node forName:name];
+
+    for (FSLocalNode * ancestor in trail) ancestor->_version = version;
+
+    // Prune Empty Branches
+    for (NSInteger i = trail.count - 1; i > 0; i--) {
+        FSLocalNode * branch = trail[i];
+        if (branch->_leaf || branch->_mutableChildren.count > 0) break;
+        [trail[i - 1] setChild:nil forName:components[i - 1]];
+    }
+
+    return YES;
+}
+
+- (BOOL) setPriority:(id)priority atPath:(NSArray *)components version:(uint64_t)version {
+
+    FSLocalNode * node = [self childAtPath:components];
+    if (!node) return NO;
+
+    node.priority = FSLocalNormalizedPriority(priority);
+
+    FSLocalNode * current = self;
+    current->_version = version;
+    for (NSString * component in components) {
+        [current invalidateSortedNames];
+        current = current->_mutableChildren[component];
+        current->_version = version;
+    }
+    return YES;
+}
+
+- (void) stampVersion:(uint64_t)version {
+    _version = version;
+    for (NSString * name in _mutableChildren) {
+        [_mutableChildren[name] stampVersion:version];
+    }
+}
+
+#pragma mark COPIES
+
+- (FSLocalNode *) deepCopy {
+    FSLocalNode * copy = [FSLocalNode new];
+    copy->_leaf = _leaf;
+    copy->_priority = _priority;
+    copy->_version = _version;
+
+    if (_mutableChildren) {
+        copy->_mutableChildren = [NSMutableDictionary dictionaryWithCapacity:_mutableChildren.count];
+        for (NSString * name in _mutableChildren) {
+            copy->_mutableChildren[name] = [_mutableChildren[name] deepCopy];
+        }
+        copy->_sortedNames = _sortedNames;
+    }
+    return copy;
+}
+
+- (FSLocalNode *) copyWithChildNames:(NSArray *)names {
+    FSLocalNode * copy = [FSLocalNode new];
+    copy->_priority = _priority;
+    copy->_version = _version;
+    for (NSString * name in names) {
+        [copy setChild:[_mutableChildren[name] deepCopy] forName:name];
+    }
+    return copy;
+}
+
+#pragma mark EXPORT
+
+- (id) exportValue {
+
+    if (_leaf) return _leaf;
+
+    // Integer Keys That Are Mostly Filled Come Back As Arrays
+    BOOL isArray = _mutableChildren.count > 0;
+    NSUInteger maxIndex = 0;
+    for (NSString * name in _mutableChildren) {
+        NSUInteger index;
+        if (!FSLocalIsArrayIndex(name, &index)) {
+            isArray = NO;
+            break;
+        }
+        maxIndex = MAX(maxIndex, index);
+    }
+
+    if (isArray && maxIndex < 2 * _mutableChildren.count) {
+        NSMutableArray * array = [NSMutableArray arrayWithCapacity:maxIndex + 1];
+        for (NSUInteger i = 0; i <= maxIndex; i++) {
+            FSLocalNode * child = _mutableChildren[[NSString stringWithFormat:@"%lu", (unsigned long)i]];
+            [array addObject:child ? [child exportValue] : [NSNull null]];
+        }
+        return array;
+    }
+
+    NSMutableDictionary * dict = [NSMutableDictionary dictionaryWithCapacity:_mutableChildren.count];
+    for (NSString * name in _mutableChildren) {
+        dict[name] = [_mutableChildren[name] exportValue];
+    }
+    return dict;
+}
+
+- (id) exportValueWithPriority {
+
+    if (_leaf) {
+        if (!_priority) return _leaf;
+        return [NSMutableDictionary dictionaryWithDictionary:@{@".value" : _leaf, @".priority" : _priority}];
+    }
+
+    NSMutableDictionary * dict = [NSMutableDictionary dictionaryWithCapacity:_mutableChildren.count + 1];
+    for (NSString * name in _mutableChildren) {
+        dict[name] = [_mutableChildren[name] exportValueWithPriority];
+    }
+    if (_priority) dict[@".priority"] = _priority;
+    return dict;
+}
+
+// Approximates JSON Wire Size Without Serializing
+- (NSUInteger) byteSize {
+
+    NSUInteger size = 0;
+
+    if (_leaf) {
+        if ([_leaf isKindOfClass:[NSString class]]) {
+            size = [_leaf lengthOfBytesUsingEncoding:NSUTF8StringEncoding] + 2;
+        }
+        else {
+            size = [[_leaf description] length];
+        }
+    }
+    else {
+        size = 2;
+        for (NSString * name in _mutableChildren) {
+            size += [name lengthOfBytesUsingEncoding:NSUTF8StringEncoding] + 4 + [_mutableChildren[name] byteSize];
+        }
+    }
+
+    if (_priority) size += 14 + [[_priority description] length];
+
+    return size;
+}
+
+- (NSUInteger) nodeCount {
+    NSUInteger count = 1;
+    for (NSString * name in _mutableChildren) {
+        count += [_mutableChildren[name] nodeCount];
+    }
+    return count;
+}
+
+@end
+
+#pragma mark QUERY SPEC
+
+@implementation FSLocalQuerySpec
+
+- (id) copyWithZone:(NSZone *)zone {
+    FSLocalQuerySpec * copy = [FSLocalQuerySpec new];
+    copy.startPriority = _startPriority;
+    copy.startName = _startName;
+    copy.hasStart = _hasStart;
+    copy.endPriority = _endPriority;
+    copy.endName = _endName;
+    copy.hasEnd = _hasEnd;
+    copy.limit = _limit;
+    return copy;
+}
+
+- (BOOL) includesChild:(FSLocalNode *)child named:(NSString *)name {
+
+    if (_hasStart) {
+        NSComparisonResult result = FSLocalComparePriorities(child.priority, _startPriority);
+        if (result == NSOrderedSame && _startName) result = FSLocalCompareNames(name, _startName);
+        if (result == NSOrderedAscending) return NO;
+    }
+
+    if (_hasEnd) {
+        NSComparisonResult result = FSLocalComparePriorities(child.priority, _endPriority);
+        if (result == NSOrderedSame && _endName) result = FSLocalCompareNames(name, _endName);
+        if (result == NSOrderedDescending) return NO;
+    }
+
+    return YES;
+}
+
+- (NSArray *) selectedChildNamesOfNode:(FSLocalNode *)node {
+
+    NSMutableArray * names = [NSMutableArray new];
+    for (NSString * name in [node sortedChildNames]) {
+        if ([self includesChild:node.children[name] named:name]) [names addObject:name];
+    }
+
+    // Limit Counts From The Start Only When Anchored At The Start
+    if (_limit > 0 && names.count > _limit) {
+        if (_hasStart && !_hasEnd) {
+            return [names subarrayWithRange:NSMakeRange(0, _limit)];
+        }
+        return [names subarrayWithRange:NSMakeRange(names.count - _limit, _limit)];
+    }
+
+    return names;
+}
+
+@end
+
+#pragma mark LISTENER
+
+@interface FSLocalListener ()
+
+// Set By addListener: -- reset Only Cancels Its Own
+@property (weak, nonatomic) FSLocalDatabase * database;
+
+// Last State Sent -- Only Touched On The Database Queue
+@property (nonatomic) BOOL hasFired;
+@property (nonatomic) BOOL isDetached;
+@property (nonatomic) uint64_t lastVersion;
+@property (strong, nonatomic) NSArray * lastNames;
+@property (strong, nonatomic) NSMutableDictionary * lastVersions;
+@property (strong, nonatomic) NSMutableDictionary * lastChildren;
+
+@end
+
+@implementation FSLocalListener
+@end
+
+#pragma mark DATABASE
+
+@interface FSLocalDatabase ()
+{
+    dispatch_queue_t _queue;
+    dispatch_group_t _group;
+
+    // Server State
+    FSLocalNode * _root;
+    uint64_t _clock;
+    NSMutableArray * _listeners;
+    NSMutableArray * _infoListeners;
+    NSMutableArray * _disconnectWrites;
+    NSMutableArray * _deniedPaths;
+
+    // Client State
+    NSMutableArray * _pendingOperations;
+    NSMutableArray * _deliveries;
+    NSTimeInterval _lastDeliveryTime;
+    NSTimeInterval _nextOperationTime;
+    uint64_t _randomState;
+
+    // Bumped By reset -- Work Scheduled Before It Is Dropped When It Fires
+    NSUInteger _generation;
+}
+
+@property (strong, nonatomic, readwrite) NSString * host;
+@property (nonatomic, readwrite) BOOL isConnected;
+
+@property (nonatomic, readwrite) NSUInteger reads;
+@property (nonatomic, readwrite) NSUInteger writes;
+@property (nonatomic, readwrite) NSUInteger transactions;
+@property (nonatomic, readwrite) NSUInteger transactionRetries;
+@property (nonatomic, readwrite) NSUInteger activeListeners;
+@property (nonatomic, readwrite) NSUInteger eventsDelivered;
+@property (nonatomic, readwrite) NSUInteger bytesSent;
+@property (nonatomic, readwrite) NSUInteger bytesReceived;
+@property (nonatomic, readwrite) NSUInteger refsCreated;
+@property (nonatomic, readwrite) NSUInteger urlsParsed;
+
+@end
+
+static NSMutableDictionary * databases;
+static NSMutableDictionary * listenersByHandle;
+static FirebaseHandle lastHandle;
+static dispatch_queue_t callbackQueue;
+
+@implementation FSLocalDatabase
+
+#pragma mark DATABASES
+
++ (FSLocalDatabase *) databaseForURL:(NSString *)url {
+
+    NSString * host = url;
+    NSRange scheme = [host rangeOfString:@"://"];
+    if (scheme.location != NSNotFound) host = [host substringFromIndex:NSMaxRange(scheme)];
+    NSRange slash = [host rangeOfString:@"/"];
+    if (slash.location != NSNotFound) host = [host substringToIndex:slash.location];
+    host = [host lowercaseString];
+
+    @synchronized (self) {
+        if (!databases) databases = [NSMutableDictionary new];
+
+        FSLocalDatabase * database = databases[host];
+        if (!database) {
+            database = [[FSLocalDatabase alloc] initWithHost:host];
+            databases[host] = database;
+        }
+        return database;
+    }
+}
+
++ (NSArray *) allDatabases {
+    @synchronized (self) {
+        return [databases allValues];
+    }
+}
+
++ (void) resetAllDatabases {
+    for (FSLocalDatabase * database in [self allDatabases]) {
+        [database reset];
+        database.latency = 0;
+        database.bandwidth = 0;
+        database.writeFailureRate = 0;
+        database.operationsPerSecond = 0;
+    }
+}
+
++ (void) disconnectAll {
+    for (FSLocalDatabase * database in [self allDatabases]) [database disconnect];
+}
+
++ (void) reconnectAll {
+    for (FSLocalDatabase * database in [self allDatabases]) [database reconnect];
+}
+
++ (dispatch_queue_t) callbackQueue {
+    @synchronized (self) {
+        return callbackQueue ? callbackQueue : dispatch_get_main_queue();
+    }
+}
+
++ (void) setCallbackQueue:(dispatch_queue_t)queue {
+    @synchronized (self) {
+        callbackQueue = queue;
+    }
+}
+
++ (NSString *) nextPushId {
+
+    static long long lastPushTime = 0;
+    static int lastRandomChars[12];
+
+    @synchronized (self) {
+        long long now = (long long)([[NSDate date] timeIntervalSince1970] * 1000);
+        BOOL duplicateTime = now == lastPushTime;
+        lastPushTime = now;
+
+        unichar chars[20];
+        for (int i = 7; i >= 0; i--) {
+            chars[i] = [kPushChars characterAtIndex:(NSUInteger)(now % 64)];
+            now /= 64;
+        }
+
+        // Same Millisecond -- Increment The Random Part So Ids Stay Ordered
+        if (!duplicateTime) {
+            for (int i = 0; i < 12; i++) lastRandomChars[i] = (int)(random() % 64);
+        }
+        else {
+            int i = 11;
+            while (i >= 0 && lastRandomChars[i] == 63) {
+                lastRandomChars[i] = 0;
+                i--;
+            }
+            if (i >= 0) lastRandomChars[i]++;
+        }
+
+        for (int i = 0; i < 12; i++) {
+            chars[8 + i] = [kPushChars characterAtIndex:lastRandomChars[i]];
+        }
+        return [NSString stringWithCharacters:chars length:20];
+    }
+}
+
+#pragma mark INIT
+
+- (instancetype) initWithHost:(NSString *)host {
+    self = [super init];
+    if (self) {
+        _host = host;
+        _queue = dispatch_queue_create("com.firesuite.localdatabase", DISPATCH_QUEUE_SERIAL);
+        _group = dispatch_group_create();
+        _randomSeed = 1;
+        [self resetState];
+    }
+    return self;
+}
+
+// Must Be Called On _queue (Or Before It Exists)
+- (void) resetState {
+    _root = [FSLocalNode new];
+    _clock = 1;
+    _listeners = [NSMutableArray new];
+    _infoListeners = [NSMutableArray new];
+    _disconnectWrites = [NSMutableArray new];
+    _deniedPaths = [NSMutableArray new];
+    _pendingOperations = [NSMutableArray new];
+    _deliveries = [NSMutableArray new];
+    _lastDeliveryTime = 0;
+    _nextOperationTime = 0;
+    _randomState = _randomSeed ? _randomSeed : 1;
+    _isConnected = YES;
+    [self resetCounters];
+}
+
+- (void) resetCounters {
+    _reads = 0;
+    _writes = 0;
+    _transactions = 0;
+    _transactionRetries = 0;
+    _eventsDelivered = 0;
+    _bytesSent = 0;
+    _bytesReceived = 0;
+    _refsCreated = 0;
+    _urlsParsed = 0;
+}
+
+- (void) reset {
+
+    @synchronized ([FSLocalDatabase class]) {
+        for (FSLocalListener * listener in [listenersByHandle allValues]) {
+            if (listener.database != self) continue;
+            listener.isCancelled = YES;
+            [listenersByHandle removeObjectForKey:@(listener.handle)];
+        }
+    }
+
+    dispatch_sync(_queue, ^{
+        // Operations Held While Offline, And Deliveries Not Yet Sent, Will Never Run
+        for (NSUInteger i = 0; i < _pendingOperations.count + _deliveries.count; i++) dispatch_group_leave(_group);
+        _generation++;
+        [self resetState];
+        _activeListeners = 0;
+    });
+}
+
+- (void) setRandomSeed:(uint64_t)randomSeed {
+    _randomSeed = randomSeed;
+    dispatch_async(_queue, ^{
+        _randomState = randomSeed ? randomSeed : 1;
+    });
+}
+
+#pragma mark SCHEDULING
+
+- (NSTimeInterval) transferTimeForBytes:(NSUInteger)bytes {
+    return _bandwidth > 0 ? bytes / _bandwidth : 0;
+}
+
+// xorshift64* -- Deterministic Per Seed
+- (double) nextRandom {
+    _randomState ^= _randomState >> 12;
+    _randomState ^= _randomState << 25;
+    _randomState ^= _randomState >> 27;
+    return (double)((_randomState * 2685821657736338717ULL) >> 11) / (double)(1ULL << 53);
+}
+
+// Client -> Server.  Held While Offline.
+- (void) performServerOperation:(dispatch_block_t)operation bytes:(NSUInteger)bytes {
+    dispatch_group_enter(_group);
+    dispatch_async(_queue, ^{
+        if (_isConnected) {
+            [self sendOperation:operation bytes:bytes];
+        }
+        else {
+            [_pendingOperations addObject:@[[operation copy], @(bytes)]];
+        }
+    });
+}
+
+// Must Be Called On _queue -- Balances The Group Enter From performServerOperation:
+- (void) sendOperation:(dispatch_block_t)operation bytes:(NSUInteger)bytes {
+    _bytesSent += bytes;
+    NSTimeInterval delay = _latency / 2 + [self transferTimeForBytes:bytes];
+
+    // Queue Behind Earlier Operations Once Over The Server's Rate
+    if (_operationsPerSecond > 0) {
+        NSTimeInterval arrival = MAX(FSLocalNow() + delay, _nextOperationTime);
+        _nextOperationTime = arrival + 1.0 / _operationsPerSecond;
+        delay = arrival - FSLocalNow();
+    }
+
+    NSUInteger generation = _generation;
+    dispatch_after(FSLocalDispatchTime(delay), _queue, ^{
+        if (generation == _generation) operation();
+        dispatch_group_leave(_group);
+    });
+}
+
+// Server -> Client.  Must Be Called On _queue.  Delivered In Order.
+- (void) deliverBytes:(NSUInteger)bytes block:(dispatch_block_t)block {
+
+    _bytesReceived += bytes;
+    NSTimeInterval delay = _latency / 2 + [self transferTimeForBytes:bytes];
+    NSTimeInterval time = MAX(FSLocalNow() + delay, _lastDeliveryTime);
+    _lastDeliveryTime = time;
+
+    dispatch_group_enter(_group);
+    [_deliveries addObject:@[@(time), [block copy]]];
+
+    dispatch_after(FSLocalDispatchTime(time - FSLocalNow()), _queue, ^{
+        [self drainDeliveries];
+    });
+}
+
+- (void) drainDeliveries {
+
+    NSTimeInterval now = FSLocalNow();
+    dispatch_queue_t queue = [FSLocalDatabase callbackQueue];
+    dispatch_group_t group = _group;
+
+    while (_deliveries.count > 0 && [_deliveries[0][0] doubleValue] <= now + 0.001) {
+        dispatch_block_t block = _deliveries[0][1];
+        [_deliveries removeObjectAtIndex:0];
+        dispatch_async(queue, ^{
+            block();
+            dispatch_group_leave(group);
+        });
+    }
+
+    // Clock Skew Between NSDate And dispatch_after -- Try Again
+    if (_deliveries.count > 0) {
+        dispatch_after(FSLocalDispatchTime([_deliveries[0][0] doubleValue] - now), _queue, ^{
+            [self drainDeliveries];
+        });
+    }
+}
+
+- (BOOL) waitUntilIdleWithTimeout:(NSTimeInterval)timeout {
+    return dispatch_group_wait(_group, FSLocalDispatchTime(timeout)) == 0;
+}
+
+#pragma mark ERRORS
+
+- (NSError *) errorWithCode:(FSLocalErrorCode)code description:(NSString *)description {
+    NSDictionary * userInfo = @{NSLocalizedDescriptionKey: description};
+    return [NSError errorWithDomain:kFSLocalDatabaseErrorDomain code:code userInfo:userInfo];
+}
+
+- (BOOL) isDeniedPath:(NSArray *)components {
+    for (NSArray * denied in _deniedPaths) {
+        if (FSLocalIsPrefix(denied, components)) return YES;
+    }
+    return NO;
+}
+
+- (NSError *) errorForWrites:(NSArray *)writes {
+    for (NSArray * write in writes) {
+        if ([self isDeniedPath:write[0]]) {
+            return [self errorWithCode:FSLocalErrorPermissionDenied description:@"Permission denied"];
+        }
+    }
+    if (_writeFailureRate > 0 && [self nextRandom] < _writeFailureRate) {
+        return [self errorWithCode:FSLocalErrorNetworkError description:@"The operation couldn't be completed due to a network error"];
+    }
+    return nil;
+}
+
+#pragma mark CONNECTION
+
+- (void) disconnect {
+    dispatch_async(_queue, ^{
+        if (!_isConnected) return;
+
+        // Server Notices First
+        NSMutableArray * writes = [NSMutableArray new];
+        for (NSArray * registered in _disconnectWrites) [writes addObjectsFromArray:registered];
+        [_disconnectWrites removeAllObjects];
+        [self applyWrites:writes];
+
+        self.isConnected = NO;
+        [self notifyInfoListeners];
+    });
+}
+
+- (void) reconnect {
+    dispatch_async(_queue, ^{
+        if (_isConnected) return;
+
+        self.isConnected = YES;
+        [self notifyInfoListeners];
+
+        NSArray * pending = [NSArray arrayWithArray:_pendingOperations];
+        [_pendingOperations removeAllObjects];
+        for (NSArray * operation in pending) {
+            [self sendOperation:operation[0] bytes:[operation[1] unsignedIntegerValue]];
+        }
+    });
+}
+
+- (void) notifyInfoListeners {
+    for (FSLocalListener * listener in [NSArray arrayWithArray:_infoListeners]) {
+        [self deliverInfoToListener:listener];
+    }
+}
+
+- (void) deliverInfoToListener:(FSLocalListener *)listener {
+    FSLocalNode * node = [FSLocalNode nodeWithValue:[NSNumber numberWithBool:_isConnected]];
+    NSArray * components = listener.components;
+
+    // Local Event -- No Network Delay
+    dispatch_group_enter(_group);
+    dispatch_group_t group = _group;
+    dispatch_async([FSLocalDatabase callbackQueue], ^{
+        if (!listener.isCancelled) listener.eventBlock(node, components, nil);
+        dispatch_group_leave(group);
+    });
+
+    if (listener.isSingle) {
+        [_infoListeners removeObject:listener];
+        [self forgetListener:listener];
+    }
+}
+
+- (void) denyAccessToPath:(NSString *)path {
+    NSArray * components = FSLocalPathComponents(path);
+    dispatch_async(_queue, ^{
+        [_deniedPaths addObject:components];
+    });
+}
+
+- (void) allowAccessToPath:(NSString *)path {
+    NSArray * components = FSLocalPathComponents(path);
+    dispatch_async(_queue, ^{
+        [_deniedPaths removeObject:components];
+    });
+}
+
+#pragma mark DATA
+
+- (id) valueAtPath:(NSString *)path {
+    __block id value;
+    dispatch_sync(_queue, ^{
+        FSLocalNode * node = [_root childAtPath:FSLocalPathComponents(path)];
+        value = node ? [node exportValue] : [NSNull null];
+    });
+    return value;
+}
+
+- (void) setValue:(id)value andPriority:(id)priority atPath:(NSString *)path {
+    FSLocalNode * node = [FSLocalNode nodeWithValue:value];
+    if (priority) node.priority = FSLocalNormalizedPriority(priority);
+    NSArray * components = FSLocalPathComponents(path);
+
+    dispatch_sync(_queue, ^{
+        [self applyWrites:@[@[components, node ? node : [NSNull null]]]];
+    });
+}
+
+- (NSUInteger) nodeCountAtPath:(NSString *)path {
+    __block NSUInteger count;
+    dispatch_sync(_queue, ^{
+        count = [[_root childAtPath:FSLocalPathComponents(path)] nodeCount];
+    });
+    return count;
+}
+
+- (NSUInteger) byteSizeAtPath:(NSString *)path {
+    __block NSUInteger size;
+    dispatch_sync(_queue, ^{
+        size = [[_root childAtPath:FSLocalPathComponents(path)] byteSize];
+    });
+    return size;
+}
+
+#pragma mark WRITES
+
+- (void) writeNodes:(NSArray *)writes completion:(void (^)(NSError * error))completion {
+
+    NSUInteger bytes = 0;
+    for (NSArray * write in writes) {
+        bytes += [write[1] isKindOfClass:[FSLocalNode class]] ? [write[1] byteSize] : 4;
+    }
+
+    [self performServerOperation:^{
+        NSError * error = [self errorForWrites:writes];
+        if (!error) [self applyWrites:writes];
+
+        if (completion) {
+            [self deliverBytes:0 block:^{
+                completion(error);
+            }];
+        }
+    } bytes:bytes];
+}
+
+- (void) setPriority:(id)priority atPath:(NSArray *)components completion:(void (^)(NSError * error))completion {
+
+    [self performServerOperation:^{
+        NSError * error = [self errorForWrites:@[@[components, [NSNull null]]]];
+        if (!error) {
+            _clock++;
+            _writes++;
+            if ([_root setPriority:priority atPath:components version:_clock]) {
+                [self refreshListenersForPaths:@[components]];
+            }
+        }
+
+        if (completion) {
+            [self deliverBytes:0 block:^{
+                completion(error);
+            }];
+        }
+    } bytes:[[priority description] length]];
+}
+
+// Must Be Called On _queue
+- (void) applyWrites:(NSArray *)writes {
+
+    if (writes.count == 0) return;
+
+    _clock++;
+    _writes++;
+
+    NSMutableArray * changedPaths = [NSMutableArray new];
+    for (NSArray * write in writes) {
+        FSLocalNode * node = write[1] == [NSNull null] ? nil : write[1];
+
+        // Nodes Are Shared With Disconnect Writes -- Store A Copy
+        node = [node deepCopy];
+        [node stampVersion:_clock];
+
+        if ([_root setNode:node atPath:write[0] version:_clock]) {
+            [changedPaths addObject:write[0]];
+        }
+    }
+
+    [self refreshListenersForPaths:changedPaths];
+}
+
+#pragma mark TRANSACTIONS
+
+- (void) runTransactionAtPath:(NSArray *)components
+                       update:(FSLocalNode * (^)(FSLocalNode * current, BOOL * abort))update
+                   completion:(void (^)(NSError * error, BOOL committed, FSLocalNode * node))completion {
+
+    dispatch_group_enter(_group);
+    [self performServerOperation:^{
+        _transactions++;
+        [self attemptTransactionAtPath:components update:update completion:completion attempt:1];
+    } bytes:0];
+}
+
+// Must Be Called On _queue -- Leaves The Group Once The Transaction Completes
+- (void) attemptTransactionAtPath:(NSArray *)components
+                           update:(FSLocalNode * (^)(FSLocalNode * current, BOOL * abort))update
+                       completion:(void (^)(NSError * error, BOOL committed, FSLocalNode * node))completion
+                          attempt:(NSUInteger)attempt {
+
+    // Client Runs The Update Against The Latest Value It Has Seen
+    FSLocalNode * current = [_root childAtPath:components];
+    uint64_t baseVersion = current ? current.version : 0;
+
+    BOOL aborted = NO;
+    FSLocalNode * proposed = update([current deepCopy], &aborted);
+
+    if (aborted) {
+        FSLocalNode * unchanged = [current deepCopy];
+        [self deliverBytes:0 block:^{
+            if (completion) completion(nil, NO, unchanged);
+        }];
+        dispatch_group_leave(_group);
+        return;
+    }
+
+    NSUInteger bytes = proposed ? [proposed byteSize] : 4;
+    _bytesSent += bytes;
+    NSTimeInterval delay = _latency / 2 + [self transferTimeForBytes:bytes];
+
+    // Server Compares Against What The Client Saw
+    NSUInteger generation = _generation;
+    dispatch_after(FSLocalDispatchTime(delay), _queue, ^{
+
+        // Reset Meanwhile -- Never Completes, Like An Operation Held Offline
+        if (generation != _generation) {
+            dispatch_group_leave(_group);
+            return;
+        }
+
+        FSLocalNode * server = [_root childAtPath:components];
+        uint64_t serverVersion = server ? server.version : 0;
+
+        if (serverVersion != baseVersion) {
+            _transactionRetries++;
+
+            if (attempt >= kMaxTransactionAttempts) {
+                NSError * error = [self errorWithCode:FSLocalErrorMaxRetries description:@"The transaction had too many retries"];
+                [self deliverBytes:0 block:^{
+                    if (completion) completion(error, NO, nil);
+                }];
+                dispatch_group_leave(_group);
+                return;
+            }
+
+            // Rejected -- Client Gets The Server Value And Tries Again
+            NSUInteger returnBytes = server ? [server byteSize] : 4;
+            _bytesReceived += returnBytes;
+            dispatch_after(FSLocalDispatchTime(_latency / 2 + [self transferTimeForBytes:returnBytes]), _queue, ^{
+                if (generation != _generation) {
+                    dispatch_group_leave(_group);
+                    return;
+                }
+                [self attemptTransactionAtPath:components update:update completion:completion attempt:attempt + 1];
+            });
+            return;
+        }
+
+        NSError * error = [self errorForWrites:@[@[components, [NSNull null]]]];
+        if (!error) [self applyWrites:@[@[components, proposed ? proposed : [NSNull null]]]];
+
+        FSLocalNode * committed = error ? nil : [[_root childAtPath:components] deepCopy];
+        [self deliverBytes:0 block:^{
+            if (completion) completion(error, !error, committed);
+        }];
+        dispatch_group_leave(_group);
+    });
+}
+
+#pragma mark ON DISCONNECT
+
+- (void) addDisconnectWrites:(NSArray *)writes completion:(void (^)(NSError * error))completion {
+    [self performServerOperation:^{
+        [_disconnectWrites addObject:writes];
+        if (completion) {
+            [self deliverBytes:0 block:^{
+                completion(nil);
+            }];
+        }
+    } bytes:0];
+}
+
+- (void) cancelDisconnectWritesAtPath:(NSArray *)components completion:(void (^)(NSError * error))completion {
+    [self performServerOperation:^{
+        NSMutableArray * keepers = [NSMutableArray new];
+        for (NSArray * writes in _disconnectWrites) {
+            if (!FSLocalIsPrefix(components, [writes firstObject][0])) [keepers addObject:writes];
+        }
+        _disconnectWrites = keepers;
+
+        if (completion) {
+            [self deliverBytes:0 block:^{
+                completion(nil);
+            }];
+        }
+    } bytes:0];
+}
+
+#pragma mark LISTENERS
+
+- (FirebaseHandle) addListener:(FSLocalListener *)listener {
+
+    @synchronized ([FSLocalDatabase class]) {
+        if (!listenersByHandle) listenersByHandle = [NSMutableDictionary new];
+        listener.handle = ++lastHandle;
+        listener.database = self;
+        listenersByHandle[@(listener.handle)] = listener;
+    }
+
+    // .info/ Is Answered Locally
+    if ([[listener.components firstObject] isEqualToString:@".info"]) {
+        dispatch_async(_queue, ^{
+            if (listener.isCancelled) return;
+            [_infoListeners addObject:listener];
+            [self deliverInfoToListener:listener];
+        });
+        return listener.handle;
+    }
+
+    [self performServerOperation:^{
+        if (listener.isCancelled) return;
+        _reads++;
+
+        if ([self isDeniedPath:listener.components]) {
+            NSError * error = [self errorWithCode:FSLocalErrorPermissionDenied description:@"Permission denied"];
+            [self deliverBytes:0 block:^{
+                if (listener.cancelBlock) listener.cancelBlock(error);
+            }];
+            [self forgetListener:listener];
+            return;
+        }
+
+        [_listeners addObject:listener];
+        _activeListeners++;
+        [self refreshListener:listener changedPath:nil];
+    } bytes:0];
+
+    return listener.handle;
+}
+
+- (void) removeListenerWithHandle:(FirebaseHandle)handle {
+    FSLocalListener * listener;
+    @synchronized ([FSLocalDatabase class]) {
+        listener = listenersByHandle[@(handle)];
+        listener.isCancelled = YES;
+        [listenersByHandle removeObjectForKey:@(handle)];
+    }
+
+    if (listener) {
+        dispatch_async(_queue, ^{
+            [self detachListener:listener];
+        });
+    }
+}
+
+- (void) removeListenersAtPath:(NSArray *)components {
+    NSMutableArray * removed = [NSMutableArray new];
+    @synchronized ([FSLocalDatabase class]) {
+        for (FSLocalListener * listener in [listenersByHandle allValues]) {
+            if (listener.database == self && [listener.components isEqualToArray:components]) {
+                listener.isCancelled = YES;
+                [removed addObject:listener];
+                [listenersByHandle removeObjectForKey:@(listener.handle)];
+            }
+        }
+    }
+
+    dispatch_async(_queue, ^{
+        for (FSLocalListener * listener in removed) [self detachListener:listener];
+    });
+}
+
+// Must Be Called On _queue
+- (void) detachListener:(FSLocalListener *)listener {
+    listener.isDetached = YES;
+    if ([_listeners containsObject:listener]) {
+        [_listeners removeObject:listener];
+        _activeListeners--;
+    }
+    [_infoListeners removeObject:listener];
+}
+
+- (void) forgetListener:(FSLocalListener *)listener {
+    @synchronized ([FSLocalDatabase class]) {
+        [listenersByHandle removeObjectForKey:@(listener.handle)];
+    }
+}
+
+#pragma mark EVENTS
+
+// Must Be Called On _queue
+- (void) refreshListenersForPaths:(NSArray *)paths {
+
+    if (paths.count == 0) return;
+
+    for (FSLocalListener * listener in [NSArray arrayWithArray:_listeners]) {
+        for (NSArray * path in paths) {
+            if (FSLocalIsPrefix(listener.components, path) || FSLocalIsPrefix(path, listener.components)) {
+                // One Write Beneath A Plain Listener Touches A Single Child
+                NSArray * changedPath = paths.count == 1 ? path : nil;
+                [self refreshListener:listener changedPath:changedPath];
+                break;
+            }
+        }
+    }
+}
+
+// Must Be Called On _queue -- Diffs Against The Last State Sent And Delivers Events
+- (void) refreshListener:(FSLocalListener *)listener changedPath:(NSArray *)changedPath {
+
+    FSLocalNode * node = [_root childAtPath:listener.components];
+
+    if (listener.eventType == FEventTypeValue) {
+
+        NSArray * names = listener.spec ? [listener.spec selectedChildNamesOfNode:node] : nil;
+        uint64_t version = node ? node.version : 0;
+
+        if (listener.hasFired && version == listener.lastVersion && (!names || [names isEqualToArray:listener.lastNames])) return;
+
+        listener.hasFired = YES;
+        listener.lastVersion = version;
+        listener.lastNames = names;
+
+        FSLocalNode * copy = names ? [node copyWithChildNames:names] : [node deepCopy];
+        [self deliverNode:copy components:listener.components previousName:nil toListener:listener];
+        return;
+    }
+
+    if (!listener.lastVersions) {
+        listener.lastVersions = [NSMutableDictionary new];
+        listener.lastChildren = [NSMutableDictionary new];
+    }
+
+    // Fast Path -- One Child Changed Beneath A Listener That Doesn't Need Ordering
+    BOOL canDiffOneChild = listener.hasFired && changedPath.count > listener.components.count && !listener.wantsPreviousName && listener.spec.limit == 0;
+
+    if (canDiffOneChild) {
+        NSString * name = changedPath[listener.components.count];
+        FSLocalNode * child = node.children[name];
+        if (child && listener.spec && ![listener.spec includesChild:child named:name]) child = nil;
+        [self diffChild:child named:name previousName:nil forListener:listener];
+        return;
+    }
+
+    NSArray * names = listener.spec ? [listener.spec selectedChildNamesOfNode:node] : [node sortedChildNames];
+    NSSet * current = [NSSet setWithArray:names];
+
+    // Removed
+    for (NSString * name in [listener.lastVersions allKeys]) {
+        if (![current containsObject:name]) {
+            [self diffChild:nil named:name previousName:nil forListener:listener];
+        }
+    }
+
+    // Added & Changed
+    NSString * previousName;
+    for (NSString * name in names) {
+        [self diffChild:node.children[name] named:name previousName:previousName forListener:listener];
+        previousName = name;
+    }
+
+    listener.hasFired = YES;
+}
+
+- (void) diffChild:(FSLocalNode *)child named:(NSString *)name previousName:(NSString *)previousName forListener:(FSLocalListener *)listener {
+
+    // Single Events Stop After The First Delivery
+    if (listener.isDetached) return;
+
+    NSNumber * lastVersion = listener.lastVersions[name];
+    FEventType eventType;
+    FSLocalNode * payload;
+
+    if (child && !lastVersion) {
+        eventType = FEventTypeChildAdded;
+        payload = child;
+        listener.lastVersions[name] = @(child.version);
+        listener.lastChildren[name] = child;
+    }
+    else if (!child && lastVersion) {
+        eventType = FEventTypeChildRemoved;
+        payload = listener.lastChildren[name];
+        [listener.lastVersions removeObjectForKey:name];
+        [listener.lastChildren removeObjectForKey:name];
+    }
+    else if (child && [lastVersion unsignedLongLongValue] != child.version) {
+        eventType = FEventTypeChildChanged;
+        payload = child;
+        listener.lastVersions[name] = @(child.version);
+        listener.lastChildren[name] = child;
+    }
+    else {
+        return;
+    }
+
+    if (eventType != listener.eventType) return;
+
+    NSArray * components = [listener.components arrayByAddingObject:name];
+    [self deliverNode:[payload deepCopy] components:components previousName:previousName toListener:listener];
+}
+
+- (void) deliverNode:(FSLocalNode *)node components:(NSArray *)components previousName:(NSString *)previousName toListener:(FSLocalListener *)listener {
+
+    _eventsDelivered++;
+
+    [self deliverBytes:node ? [node byteSize] : 4 block:^{
+        if (!listener.isCancelled) listener.eventBlock(node, components, previousName);
+    }];
+
+    if (listener.isSingle) {
+        [self detachListener:listener];
+        [self forgetListener:listener];
+    }
+}
+
+#pragma mark STATS
+
+- (NSDictionary *) stats {
+    return @{
+             kLocalStatReads: @(_reads),
+             kLocalStatWrites: @(_writes),
+             kLocalStatTransactions: @(_transactions),
+             kLocalStatTransactionRetries: @(_transactionRetries),
+             kLocalStatActiveListeners: @(_activeListeners),
+             kLocalStatEventsDelivered: @(_eventsDelivered),
+             kLocalStatBytesSent: @(_bytesSent),
+             kLocalStatBytesReceived: @(_bytesReceived),
+             kLocalStatRefsCreated: @(_refsCreated),
+             kLocalStatURLsParsed: @(_urlsParsed),
+             };
+}
+
+- (void) countRefCreatedFromURL:(BOOL)fromURL {
+    __sync_fetch_and_add(&_refsCreated, 1);
+    if (fromURL) __sync_fetch_and_add(&_urlsParsed, 1);
+}
+
+- (void) resetStats {
+    dispatch_sync(_queue, ^{
+        [self resetCounters];
+    });
+}
+
+@end
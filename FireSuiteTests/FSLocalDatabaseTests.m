@@ -0,0 +1,216 @@
+//
+//  FSLocalDatabaseTests.m
+//  FireSuiteTests
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+//  The stand-in every other test runs against -- checked on its own, so a bug here can't quietly pass them.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "FSLocalDatabase.h"
+
+static NSString *const kLocalURL = @"https://firesuite-local.firebaseIO.com/";
+
+static NSTimeInterval const kLocalTimeout = 10;
+static NSUInteger const kConflictingTransactions = 20;
+
+@interface FSLocalDatabaseTests : XCTestCase
+
+@property (strong, nonatomic) FSLocalDatabase * database;
+@property (strong, nonatomic) Firebase * root;
+
+@end
+
+@implementation FSLocalDatabaseTests
+
+- (void)setUp
+{
+    [super setUp];
+
+    [FSLocalDatabase resetAllDatabases];
+    _database = [FSLocalDatabase databaseForURL:kLocalURL];
+    _root = [[Firebase alloc] initWithUrl:kLocalURL];
+
+    // Callbacks Must Not Land On The Thread We Block
+    [Firebase setDispatchQueue:dispatch_queue_create("com.firesuite.tests.local", DISPATCH_QUEUE_SERIAL)];
+}
+
+#pragma mark HELPERS
+
+- (void) waitForSemaphore:(dispatch_semaphore_t)semaphore {
+    long result = dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kLocalTimeout * NSEC_PER_SEC)));
+    XCTAssertEqual(result, 0L, @"Timed out waiting for the local database");
+}
+
+/*!
+ Child names of @param query's first value event, in the order the snapshot enumerates them
+ */
+- (NSArray *) childNamesOfQuery:(FQuery *)query {
+    NSMutableArray * names = [NSMutableArray new];
+    dispatch_semaphore_t received = dispatch_semaphore_create(0);
+    [query observeSingleEventOfType:FEventTypeValue withBlock:^(FDataSnapshot *snapshot) {
+        for (FDataSnapshot * child in snapshot.children) [names addObject:child.name];
+        dispatch_semaphore_signal(received);
+    }];
+    [self waitForSemaphore:received];
+    return names;
+}
+
+#pragma mark TRANSACTIONS
+
+- (void) testTransactionsRetryOnConflictingWrites
+{
+    // Every Transaction Starts From The Same Version -- All But One Must Be Rejected And Rerun
+    _database.latency = 0.02;
+    Firebase * counter = [_root childByAppendingPath:@"counter"];
+
+    __block NSUInteger committed = 0;
+    dispatch_semaphore_t finished = dispatch_semaphore_create(0);
+    for (NSUInteger i = 0; i < kConflictingTransactions; i++) {
+        [counter runTransactionBlock:^FTransactionResult *(FMutableData *currentData) {
+            NSInteger count = currentData.value == [NSNull null] ? 0 : [currentData.value integerValue];
+            [currentData setValue:@(count + 1)];
+            return [FTransactionResult successWithValue:currentData];
+        } andCompletionBlock:^(NSError *error, BOOL isCommitted, FDataSnapshot *snapshot) {
+            XCTAssertNil(error);
+            if (isCommitted) committed++;
+            dispatch_semaphore_signal(finished);
+        }];
+    }
+    for (NSUInteger i = 0; i < kConflictingTransactions; i++) [self waitForSemaphore:finished];
+
+    // No Increment Lost, And The Reruns Were Counted
+    XCTAssertTrue([_database waitUntilIdleWithTimeout:kLocalTimeout]);
+    XCTAssertEqual(committed, kConflictingTransactions);
+    XCTAssertEqualObjects([_database valueAtPath:@"counter"], @(kConflictingTransactions));
+    XCTAssertEqual(_database.transactions, kConflictingTransactions);
+    XCTAssertTrue(_database.transactionRetries > 0);
+}
+
+- (void) testTransactionAbortLeavesValue
+{
+    [_database setValue:@5 andPriority:nil atPath:@"counter"];
+    NSUInteger writes = _database.writes;
+
+    dispatch_semaphore_t finished = dispatch_semaphore_create(0);
+    [[_root childByAppendingPath:@"counter"] runTransactionBlock:^FTransactionResult *(FMutableData *currentData) {
+        return [FTransactionResult abort];
+    } andCompletionBlock:^(NSError *error, BOOL committed, FDataSnapshot *snapshot) {
+        XCTAssertNil(error);
+        XCTAssertFalse(committed);
+        XCTAssertEqualObjects(snapshot.value, @5);
+        dispatch_semaphore_signal(finished);
+    }];
+    [self waitForSemaphore:finished];
+
+    XCTAssertTrue([_database waitUntilIdleWithTimeout:kLocalTimeout]);
+    XCTAssertEqualObjects([_database valueAtPath:@"counter"], @5);
+    XCTAssertEqual(_database.writes, writes);
+}
+
+- (void) testResetDropsOperationsInFlight
+{
+    // Still Travelling When The Reset Lands
+    _database.latency = 0.2;
+    [[_root childByAppendingPath:@"pending"] setValue:@"written"];
+    [[_root childByAppendingPath:@"counter"] runTransactionBlock:^FTransactionResult *(FMutableData *currentData) {
+        [currentData setValue:@1];
+        return [FTransactionResult successWithValue:currentData];
+    }];
+    [_database reset];
+
+    // Idle Again Without Either Reaching The New Tree
+    XCTAssertTrue([_database waitUntilIdleWithTimeout:kLocalTimeout]);
+    XCTAssertEqualObjects([_database valueAtPath:@"pending"], [NSNull null]);
+    XCTAssertEqualObjects([_database valueAtPath:@"counter"], [NSNull null]);
+}
+
+#pragma mark ON DISCONNECT
+
+- (void) testOnDisconnectRunsOnceWhenConnectionDrops
+{
+    for (NSString * name in @[@"set", @"removed", @"cancelled"]) {
+        [_database setValue:@"online" andPriority:nil atPath:[NSString stringWithFormat:@"devices/%@", name]];
+    }
+
+    [[_root childByAppendingPath:@"devices/set"] onDisconnectSetValue:@"offline"];
+    [[_root childByAppendingPath:@"devices/removed"] onDisconnectRemoveValue];
+    Firebase * cancelled = [_root childByAppendingPath:@"devices/cancelled"];
+    [cancelled onDisconnectSetValue:@"offline"];
+    [cancelled cancelDisconnectOperations];
+    XCTAssertTrue([_database waitUntilIdleWithTimeout:kLocalTimeout]);
+
+    // Registered Writes Wait For The Drop
+    XCTAssertEqualObjects([_database valueAtPath:@"devices/set"], @"online");
+
+    [_database disconnect];
+    XCTAssertTrue([_database waitUntilIdleWithTimeout:kLocalTimeout]);
+    XCTAssertFalse(_database.isConnected);
+    XCTAssertEqualObjects([_database valueAtPath:@"devices/set"], @"offline");
+    XCTAssertEqualObjects([_database valueAtPath:@"devices/removed"], [NSNull null]);
+    XCTAssertEqualObjects([_database valueAtPath:@"devices/cancelled"], @"online");
+
+    // Spent -- A Second Drop Runs Nothing
+    [_database reconnect];
+    [_database setValue:@"online" andPriority:nil atPath:@"devices/set"];
+    [_database disconnect];
+    XCTAssertTrue([_database waitUntilIdleWithTimeout:kLocalTimeout]);
+    XCTAssertEqualObjects([_database valueAtPath:@"devices/set"], @"online");
+    [_database reconnect];
+}
+
+- (void) testConnectedReportsEachChange
+{
+    NSMutableArray * states = [NSMutableArray new];
+    dispatch_semaphore_t changed = dispatch_semaphore_create(0);
+    Firebase * connected = [_root childByAppendingPath:@".info/connected"];
+    FirebaseHandle handle = [connected observeEventType:FEventTypeValue withBlock:^(FDataSnapshot *snapshot) {
+        [states addObject:snapshot.value];
+        dispatch_semaphore_signal(changed);
+    }];
+    [self waitForSemaphore:changed];
+
+    [_database disconnect];
+    [self waitForSemaphore:changed];
+    [_database reconnect];
+    [self waitForSemaphore:changed];
+
+    XCTAssertEqualObjects(states, (@[@YES, @NO, @YES]));
+    [connected removeObserverWithHandle:handle];
+}
+
+#pragma mark QUERIES
+
+- (void) testChildrenOrderedByPriorityThenName
+{
+    // No Priority First, Then Numbers, Then Strings -- Ties Broken By Name, Integer Names Numerically
+    [_database setValue:@{
+                          @"10" : @{@".value" : @"a", @".priority" : @1},
+                          @"9" : @{@".value" : @"b", @".priority" : @1},
+                          @"string" : @{@".value" : @"c", @".priority" : @"x"},
+                          @"high" : @{@".value" : @"d", @".priority" : @3},
+                          @"low" : @{@".value" : @"e", @".priority" : @0},
+                          @"unset" : @"f",
+                          @"alsoUnset" : @"g",
+                          }
+            andPriority:nil
+                 atPath:@"items"];
+    Firebase * items = [_root childByAppendingPath:@"items"];
+
+    XCTAssertEqualObjects([self childNamesOfQuery:items], (@[@"alsoUnset", @"unset", @"low", @"9", @"10", @"high", @"string"]));
+
+    // Bounds Are Inclusive, A Child Name Narrows A Tie
+    XCTAssertEqualObjects([self childNamesOfQuery:[items queryStartingAtPriority:@1]], (@[@"9", @"10", @"high", @"string"]));
+    XCTAssertEqualObjects([self childNamesOfQuery:[items queryStartingAtPriority:@1 andChildName:@"10"]], (@[@"10", @"high", @"string"]));
+    XCTAssertEqualObjects([self childNamesOfQuery:[items queryEndingAtPriority:@1]], (@[@"alsoUnset", @"unset", @"low", @"9", @"10"]));
+
+    // A Limit Keeps The Last Children -- Or The First, When Only The Start Is Anchored
+    XCTAssertEqualObjects([self childNamesOfQuery:[items queryLimitedToNumberOfChildren:2]], (@[@"high", @"string"]));
+    XCTAssertEqualObjects([self childNamesOfQuery:[[items queryStartingAtPriority:@0] queryLimitedToNumberOfChildren:2]], (@[@"low", @"9"]));
+    XCTAssertEqualObjects([self childNamesOfQuery:[[items queryEndingAtPriority:@1] queryLimitedToNumberOfChildren:2]], (@[@"9", @"10"]));
+}
+
+@end
@@ -0,0 +1,591 @@
+//
+//  FSLocalFirebase.m
+//
+//  Created by Logan Wright on 10/19/26.
+//  Copyright (c) 2026 Logan Wright. All rights reserved.
+//
+//  The subset of the Firebase SDK that FireSuite uses, backed by FSLocalDatabase.  Compiled in place of Firebase.framework.
+//
+
+#import "FSLocalDatabase+Internal.h"
+
+static NSString *const kMutableDataRoot = @"root";
+
+#pragma mark PRIVATE INTERFACES
+
+@interface FQuery ()
+
+@property (strong, nonatomic) FSLocalDatabase * database;
+@property (strong, nonatomic) NSArray * components;
+@property (strong, nonatomic) FSLocalQuerySpec * spec;
+
+- (instancetype) initWithDatabase:(FSLocalDatabase *)database components:(NSArray *)components spec:(FSLocalQuerySpec *)spec;
+
+@end
+
+@interface Firebase ()
+
+- (instancetype) initWithDatabase:(FSLocalDatabase *)database components:(NSArray *)components;
+
+@end
+
+@interface FDataSnapshot ()
+{
+    FSLocalNode * _node;
+    Firebase * _ref;
+}
+
+- (instancetype) initWithNode:(FSLocalNode *)node ref:(Firebase *)ref;
+
+@end
+
+@interface FMutableData ()
+{
+    // Holds The Transaction Value Under kMutableDataRoot
+    FSLocalNode * _holder;
+    NSArray * _path;
+    NSString * _rootName;
+}
+
+- (instancetype) initWithHolder:(FSLocalNode *)holder path:(NSArray *)path rootName:(NSString *)rootName;
+- (FSLocalNode *) transactionNode;
+
+@end
+
+@interface FTransactionResult ()
+
+@property (nonatomic) BOOL isAborted;
+@property (strong, nonatomic) FMutableData * data;
+
+@end
+
+#pragma mark SNAPSHOT
+
+@implementation FDataSnapshot
+
+- (instancetype) initWithNode:(FSLocalNode *)node ref:(Firebase *)ref {
+    self = [super init];
+    if (self) {
+        _node = node;
+        _ref = ref;
+    }
+    return self;
+}
+
+- (id) value {
+    return _node ? [_node exportValue] : [NSNull null];
+}
+
+- (id) valueInExportFormat {
+    return _node ? [_node exportValueWithPriority] : [NSNull null];
+}
+
+- (id) priority {
+    return _node.priority ? _node.priority : [NSNull null];
+}
+
+- (Firebase *) ref {
+    return _ref;
+}
+
+- (NSString *) name {
+    return _ref.name;
+}
+
+- (FDataSnapshot *) childSnapshotForPath:(NSString *)childPathString {
+    NSArray * components = FSLocalPathComponents(childPathString);
+    return [[FDataSnapshot alloc] initWithNode:[_node childAtPath:components]
+                                           ref:[_ref childByAppendingPath:childPathString]];
+}
+
+- (BOOL) hasChild:(NSString *)childPathString {
+    return [_node childAtPath:FSLocalPathComponents(childPathString)] != nil;
+}
+
+- (BOOL) hasChildren {
+    return _node.children.count > 0;
+}
+
+- (NSUInteger) childrenCount {
+    return _node.children.count;
+}
+
+- (NSEnumerator *) children {
+    NSMutableArray * children = [NSMutableArray new];
+    for (NSString * name in [_node sortedChildNames]) {
+        [children addObject:[[FDataSnapshot alloc] initWithNode:_node.children[name]
+                                                            ref:[_ref childByAppendingPath:name]]];
+    }
+    return [children objectEnumerator];
+}
+
+- (NSString *) description {
+    return [NSString stringWithFormat:@"Snap (%@) %@", self.name, self.value];
+}
+
+@end
+
+#pragma mark MUTABLE DATA
+
+@implementation FMutableData
+
+- (instancetype) initWithHolder:(FSLocalNode *)holder path:(NSArray *)path rootName:(NSString *)rootName {
+    self = [super init];
+    if (self) {
+        _holder = holder;
+        _path = path;
+        _rootName = rootName;
+    }
+    return self;
+}
+
+- (FSLocalNode *) node {
+    return [_holder childAtPath:_path];
+}
+
+- (FSLocalNode *) transactionNode {
+    return [_holder childAtPath:@[kMutableDataRoot]];
+}
+
+- (id) value {
+    FSLocalNode * node = [self node];
+    return node ? [node exportValue] : [NSNull null];
+}
+
+- (void) setValue:(id)value {
+    [_holder setNode:[FSLocalNode nodeWithValue:value] atPath:_path version:0];
+}
+
+- (id) priority {
+    FSLocalNode * node = [self node];
+    return node.priority ? node.priority : [NSNull null];
+}
+
+- (void) setPriority:(id)priority {
+    [_holder setPriority:priority atPath:_path version:0];
+}
+
+- (BOOL) hasChildren {
+    return [self node].children.count > 0;
+}
+
+- (BOOL) hasChildAtPath:(NSString *)path {
+    return [[self node] childAtPath:FSLocalPathComponents(path)] != nil;
+}
+
+- (FMutableData *) childDataByAppendingPath:(NSString *)path {
+    NSArray * childPath = [_path arrayByAddingObjectsFromArray:FSLocalPathComponents(path)];
+    return [[FMutableData alloc] initWithHolder:_holder path:childPath rootName:_rootName];
+}
+
+- (FMutableData *) parent {
+    if (_path.count <= 1) return nil;
+    NSArray * parentPath = [_path subarrayWithRange:NSMakeRange(0, _path.count - 1)];
+    return [[FMutableData alloc] initWithHolder:_holder path:parentPath rootName:_rootName];
+}
+
+- (NSUInteger) childrenCount {
+    return [self node].children.count;
+}
+
+- (NSEnumerator *) children {
+    NSMutableArray * children = [NSMutableArray new];
+    for (NSString * name in [[self node] sortedChildNames]) {
+        [children addObject:[[FMutableData alloc] initWithHolder:_holder
+                                                            path:[_path arrayByAddingObject:name]
+                                                        rootName:_rootName]];
+    }
+    return [children objectEnumerator];
+}
+
+- (NSString *) name {
+    return _path.count <= 1 ? _rootName : [_path lastObject];
+}
+
+@end
+
+#pragma mark TRANSACTION RESULT
+
+@implementation FTransactionResult
+
++ (FTransactionResult *) successWithValue:(FMutableData *)value {
+    FTransactionResult * result = [FTransactionResult new];
+    result.data = value;
+    return result;
+}
+
++ (FTransactionResult *) abort {
+    FTransactionResult * result = [FTransactionResult new];
+    result.isAborted = YES;
+    return result;
+}
+
+@end
+
+#pragma mark QUERY
+
+@implementation FQuery
+
+- (instancetype) initWithDatabase:(FSLocalDatabase *)database components:(NSArray *)components spec:(FSLocalQuerySpec *)spec {
+    self = [super init];
+    if (self) {
+        _database = database;
+        _components = components;
+        _spec = spec;
+    }
+    return self;
+}
+
+- (Firebase *) refForComponents:(NSArray *)components {
+    return [[Firebase alloc] initWithDatabase:_database components:components];
+}
+
+#pragma mark OBSERVE
+
+- (FirebaseHandle) observeEventType:(FEventType)eventType
+                          withBlock:(void (^)(FDataSnapshot * snapshot))block
+                    withCancelBlock:(void (^)(NSError * error))cancelBlock
+                   previousNameBlock:(void (^)(FDataSnapshot * snapshot, NSString * prevName))previousNameBlock
+                             single:(BOOL)single {
+
+    FSLocalListener * listener = [FSLocalListener new];
+    listener.components = _components;
+    listener.spec = [_spec copy];
+    listener.eventType = eventType;
+    listener.isSingle = single;
+    listener.wantsPreviousName = previousNameBlock != nil;
+    listener.cancelBlock = cancelBlock;
+
+    FSLocalDatabase * database = _database;
+    listener.eventBlock = ^(FSLocalNode * node, NSArray * components, NSString * previousName) {
+        Firebase * ref = [[Firebase alloc] initWithDatabase:database components:components];
+        FDataSnapshot * snapshot = [[FDataSnapshot alloc] initWithNode:node ref:ref];
+        if (previousNameBlock) {
+            previousNameBlock(snapshot, previousName);
+        }
+        else if (block) {
+            block(snapshot);
+        }
+    };
+
+    return [_database addListener:listener];
+}
+
+- (FirebaseHandle) observeEventType:(FEventType)eventType withBlock:(void (^)(FDataSnapshot * snapshot))block {
+    return [self observeEventType:eventType withBlock:block withCancelBlock:nil previousNameBlock:nil single:NO];
+}
+
+- (FirebaseHandle) observeEventType:(FEventType)eventType andPreviousSiblingNameWithBlock:(void (^)(FDataSnapshot * snapshot, NSString * prevName))block {
+    return [self observeEventType:eventType withBlock:nil withCancelBlock:nil previousNameBlock:block single:NO];
+}
+
+- (FirebaseHandle) observeEventType:(FEventType)eventType withBlock:(void (^)(FDataSnapshot * snapshot))block withCancelBlock:(void (^)(NSError * error))cancelBlock {
+    return [self observeEventType:eventType withBlock:block withCancelBlock:cancelBlock previousNameBlock:nil single:NO];
+}
+
+- (FirebaseHandle) observeEventType:(FEventType)eventType andPreviousSiblingNameWithBlock:(void (^)(FDataSnapshot * snapshot, NSString * prevName))block withCancelBlock:(void (^)(NSError * error))cancelBlock {
+    return [self observeEventType:eventType withBlock:nil withCancelBlock:cancelBlock previousNameBlock:block single:NO];
+}
+
+- (void) observeSingleEventOfType:(FEventType)eventType withBlock:(void (^)(FDataSnapshot * snapshot))block {
+    [self observeEventType:eventType withBlock:block withCancelBlock:nil previousNameBlock:nil single:YES];
+}
+
+- (void) observeSingleEventOfType:(FEventType)eventType andPreviousSiblingNameWithBlock:(void (^)(FDataSnapshot * snapshot, NSString * prevName))block {
+    [self observeEventType:eventType withBlock:nil withCancelBlock:nil previousNameBlock:block single:YES];
+}
+
+- (void) observeSingleEventOfType:(FEventType)eventType withBlock:(void (^)(FDataSnapshot * snapshot))block withCancelBlock:(void (^)(NSError * error))cancelBlock {
+    [self observeEventType:eventType withBlock:block withCancelBlock:cancelBlock previousNameBlock:nil single:YES];
+}
+
+- (void) observeSingleEventOfType:(FEventType)eventType andPreviousSiblingNameWithBlock:(void (^)(FDataSnapshot * snapshot, NSString * prevName))block withCancelBlock:(void (^)(NSError * error))cancelBlock {
+    [self observeEventType:eventType withBlock:nil withCancelBlock:cancelBlock previousNameBlock:block single:YES];
+}
+
+- (void) removeObserverWithHandle:(FirebaseHandle)handle {
+    [_database removeListenerWithHandle:handle];
+}
+
+- (void) removeAllObservers {
+    [_database removeListenersAtPath:_components];
+}
+
+#pragma mark QUERIES
+
+- (FQuery *) queryWithSpecChanges:(void (^)(FSLocalQuerySpec * spec))changes {
+    FSLocalQuerySpec * spec = _spec ? [_spec copy] : [FSLocalQuerySpec new];
+    changes(spec);
+    return [[FQuery alloc] initWithDatabase:_database components:_components spec:spec];
+}
+
+- (FQuery *) queryStartingAtPriority:(id)startPriority {
+    return [self queryStartingAtPriority:startPriority andChildName:nil];
+}
+
+- (FQuery *) queryStartingAtPriority:(id)startPriority andChildName:(NSString *)childName {
+    return [self queryWithSpecChanges:^(FSLocalQuerySpec * spec) {
+        spec.hasStart = YES;
+        spec.startPriority = startPriority == [NSNull null] ? nil : startPriority;
+        spec.startName = childName;
+    }];
+}
+
+- (FQuery *) queryEndingAtPriority:(id)endPriority {
+    return [self queryEndingAtPriority:endPriority andChildName:nil];
+}
+
+- (FQuery *) queryEndingAtPriority:(id)endPriority andChildName:(NSString *)childName {
+    return [self queryWithSpecChanges:^(FSLocalQuerySpec * spec) {
+        spec.hasEnd = YES;
+        spec.endPriority = endPriority == [NSNull null] ? nil : endPriority;
+        spec.endName = childName;
+    }];
+}
+
+- (FQuery *) queryLimitedToNumberOfChildren:(NSUInteger)limit {
+    return [self queryWithSpecChanges:^(FSLocalQuerySpec * spec) {
+        spec.limit = limit;
+    }];
+}
+
+@end
+
+#pragma mark FIREBASE
+
+@implementation Firebase
+
+- (id) initWithUrl:(NSString *)url {
+
+    NSString * path = url;
+    NSRange scheme = [path rangeOfString:@"://"];
+    if (scheme.location != NSNotFound) path = [path substringFromIndex:NSMaxRange(scheme)];
+    NSRange slash = [path rangeOfString:@"/"];
+    path = slash.location != NSNotFound ? [path substringFromIndex:slash.location] : @"";
+
+    FSLocalDatabase * database = [FSLocalDatabase databaseForURL:url];
+    [database countRefCreatedFromURL:YES];
+    return [super initWithDatabase:database components:FSLocalPathComponents(path) spec:nil];
+}
+
+- (instancetype) initWithDatabase:(FSLocalDatabase *)database components:(NSArray *)components {
+    [database countRefCreatedFromURL:NO];
+    return [super initWithDatabase:database components:components spec:nil];
+}
+
+#pragma mark NAVIGATION
+
+- (Firebase *) childByAppendingPath:(NSString *)pathString {
+    return [self refForComponents:[self.components arrayByAddingObjectsFromArray:FSLocalPathComponents(pathString)]];
+}
+
+- (Firebase *) childByAutoId {
+    return [self refForComponents:[self.components arrayByAddingObject:[FSLocalDatabase nextPushId]]];
+}
+
+- (Firebase *) parent {
+    if (self.components.count == 0) return nil;
+    return [self refForComponents:[self.components subarrayWithRange:NSMakeRange(0, self.components.count - 1)]];
+}
+
+- (Firebase *) root {
+    return [self refForComponents:@[]];
+}
+
+- (NSString *) name {
+    return [self.components lastObject];
+}
+
+- (NSString *) description {
+    return [NSString stringWithFormat:@"https://%@/%@", self.database.host, [self.components componentsJoinedByString:@"/"]];
+}
+
+#pragma mark WRITE
+
+- (NSArray *) writesWithValue:(id)value andPriority:(id)priority {
+    FSLocalNode * node = [FSLocalNode nodeWithValue:value];
+    if (priority && priority != [NSNull null]) node.priority = priority;
+    return @[@[self.components, node ? node : [NSNull null]]];
+}
+
+- (void (^)(NSError *)) completionForBlock:(void (^)(NSError * error, Firebase * ref))block {
+    if (!block) return nil;
+    return ^(NSError * error) {
+        block(error, self);
+    };
+}
+
+- (void) setValue:(id)value {
+    [self setValue:value andPriority:nil withCompletionBlock:nil];
+}
+
+- (void) setValue:(id)value withCompletionBlock:(void (^)(NSError * error, Firebase * ref))block {
+    [self setValue:value andPriority:nil withCompletionBlock:block];
+}
+
+- (void) setValue:(id)value andPriority:(id)priority {
+    [self setValue:value andPriority:priority withCompletionBlock:nil];
+}
+
+- (void) setValue:(id)value andPriority:(id)priority withCompletionBlock:(void (^)(NSError * error, Firebase * ref))block {
+    [self.database writeNodes:[self writesWithValue:value andPriority:priority] completion:[self completionForBlock:block]];
+}
+
+- (void) removeValue {
+    [self setValue:nil andPriority:nil withCompletionBlock:nil];
+}
+
+- (void) removeValueWithCompletionBlock:(void (^)(NSError * error, Firebase * ref))block {
+    [self setValue:nil andPriority:nil withCompletionBlock:block];
+}
+
+- (void) setPriority:(id)priority {
+    [self setPriority:priority withCompletionBlock:nil];
+}
+
+- (void) setPriority:(id)priority withCompletionBlock:(void (^)(NSError * error, Firebase * ref))block {
+    [self.database setPriority:priority atPath:self.components completion:[self completionForBlock:block]];
+}
+
+- (NSArray *) writesWithChildValues:(NSDictionary *)values {
+    NSMutableArray * writes = [NSMutableArray new];
+    for (NSString * key in values) {
+        FSLocalNode * node = [FSLocalNode nodeWithValue:values[key]];
+        NSArray * components = [self.components arrayByAddingObjectsFromArray:FSLocalPathComponents(key)];
+        [writes addObject:@[components, node ? node : [NSNull null]]];
+    }
+    return writes;
+}
+
+- (void) updateChildValues:(NSDictionary *)values {
+    [self updateChildValues:values withCompletionBlock:nil];
+}
+
+- (void) updateChildValues:(NSDictionary *)values withCompletionBlock:(void (^)(NSError * error, Firebase * ref))block {
+    [self.database writeNodes:[self writesWithChildValues:values] completion:[self completionForBlock:block]];
+}
+
+#pragma mark ON DISCONNECT
+
+- (void) onDisconnectSetValue:(id)value {
+    [self onDisconnectSetValue:value andPriority:nil withCompletionBlock:nil];
+}
+
+- (void) onDisconnectSetValue:(id)value withCompletionBlock:(void (^)(NSError * error, Firebase * ref))block {
+    [self onDisconnectSetValue:value andPriority:nil withCompletionBlock:block];
+}
+
+- (void) onDisconnectSetValue:(id)value andPriority:(id)priority {
+    [self onDisconnectSetValue:value andPriority:priority withCompletionBlock:nil];
+}
+
+- (void) onDisconnectSetValue:(id)value andPriority:(id)priority withCompletionBlock:(void (^)(NSError * error, Firebase * ref))block {
+    [self.database addDisconnectWrites:[self writesWithValue:value andPriority:priority] completion:[self completionForBlock:block]];
+}
+
+- (void) onDisconnectRemoveValue {
+    [self onDisconnectSetValue:nil andPriority:nil withCompletionBlock:nil];
+}
+
+- (void) onDisconnectRemoveValueWithCompletionBlock:(void (^)(NSError * error, Firebase * ref))block {
+    [self onDisconnectSetValue:nil andPriority:nil withCompletionBlock:block];
+}
+
+- (void) onDisconnectUpdateChildValues:(NSDictionary *)values {
+    [self onDisconnectUpdateChildValues:values withCompletionBlock:nil];
+}
+
+- (void) onDisconnectUpdateChildValues:(NSDictionary *)values withCompletionBlock:(void (^)(NSError * error, Firebase * ref))block {
+    [self.database addDisconnectWrites:[self writesWithChildValues:values] completion:[self completionForBlock:block]];
+}
+
+- (void) cancelDisconnectOperations {
+    [self cancelDisconnectOperationsWithCompletionBlock:nil];
+}
+
+- (void) cancelDisconnectOperationsWithCompletionBlock:(void (^)(NSError * error, Firebase * ref))block {
+    [self.database cancelDisconnectWritesAtPath:self.components completion:[self completionForBlock:block]];
+}
+
+#pragma mark TRANSACTIONS
+
+- (void) runTransactionBlock:(FTransactionResult * (^)(FMutableData * currentData))block {
+    [self runTransactionBlock:block andCompletionBlock:nil withLocalEvents:YES];
+}
+
+- (void) runTransactionBlock:(FTransactionResult * (^)(FMutableData * currentData))block
+          andCompletionBlock:(void (^)(NSError * error, BOOL committed, FDataSnapshot * snapshot))completionBlock {
+    [self runTransactionBlock:block andCompletionBlock:completionBlock withLocalEvents:YES];
+}
+
+- (void) runTransactionBlock:(FTransactionResult * (^)(FMutableData * currentData))block
+          andCompletionBlock:(void (^)(NSError * error, BOOL committed, FDataSnapshot * snapshot))completionBlock
+             withLocalEvents:(BOOL)localEvents {
+
+    NSString * name = self.name;
+
+    [self.database runTransactionAtPath:self.components update:^FSLocalNode *(FSLocalNode * current, BOOL * abort) {
+
+        FSLocalNode * holder = [FSLocalNode new];
+        [holder setNode:current atPath:@[kMutableDataRoot] version:0];
+        FMutableData * currentData = [[FMutableData alloc] initWithHolder:holder path:@[kMutableDataRoot] rootName:name];
+
+        FTransactionResult * result = block(currentData);
+        if (!result || result.isAborted) {
+            *abort = YES;
+            return nil;
+        }
+        return [result.data transactionNode];
+
+    } completion:^(NSError * error, BOOL committed, FSLocalNode * node) {
+        if (completionBlock) completionBlock(error, committed, [[FDataSnapshot alloc] initWithNode:node ref:self]);
+    }];
+}
+
+#pragma mark AUTH
+
+- (void) authWithCredential:(NSString *)credential withCompletionBlock:(void (^)(NSError * error, id data))block withCancelBlock:(void (^)(NSError * error))cancelBlock {
+    if (block) {
+        dispatch_async([FSLocalDatabase callbackQueue], ^{
+            block(nil, @{@"auth": @{}});
+        });
+    }
+}
+
+- (void) unauth {
+    [self unauthWithCompletionBlock:nil];
+}
+
+- (void) unauthWithCompletionBlock:(void (^)(NSError * error))block {
+    if (block) {
+        dispatch_async([FSLocalDatabase callbackQueue], ^{
+            block(nil);
+        });
+    }
+}
+
+#pragma mark CLASS METHODS
+
++ (void) goOffline {
+    [FSLocalDatabase disconnectAll];
+}
+
++ (void) goOnline {
+    [FSLocalDatabase reconnectAll];
+}
+
++ (void) setDispatchQueue:(dispatch_queue_t)queue {
+    [FSLocalDatabase setCallbackQueue:queue];
+}
+
++ (NSString *) sdkVersion {
+    return @"local";
+}
+
++ (void) setLoggingEnabled:(BOOL)enabled {
+}
+
++ (void) setOption:(NSString *)option to:(id)value {
+}
+
+@end
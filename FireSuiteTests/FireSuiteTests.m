@@ -8,27 +8,2840 @@
 
 #import <XCTest/XCTest.h>
 
-@interface FireSuiteTests : XCTestCase
+#import "FireSuite.h"
+#import "FSLocalDatabase.h"
+#import "FSBenchmark.h"
+#import "FSLoadGenerator.h"
+
+static NSString *const kBenchmarkURL = @"https://firesuite-benchmark.firebaseIO.com/";
+static NSString *const kCurrentUserId = @"currentUserId";
+static NSString *const kOtherUserId = @"anotherUserId";
+
+// Iterations
+static NSUInteger const kSendIterations = 200;
+static NSUInteger const kAlertIterations = 200;
+static NSUInteger const kPresenceFlaps = 50;
+static NSUInteger const kPresenceUsers = 10;
+static NSUInteger const kPresenceObserversPerUser = 20;
+static NSUInteger const kMetricsIterations = 1000000;
+static NSUInteger const kRefIterations = 100000;
+static NSUInteger const kContextUsers = 1000;
+static NSUInteger const kRefCacheChats = 100;
+static NSUInteger const kShardKeys = 100000;
+static NSUInteger const kShardChats = 400;
+static NSUInteger const kStressWorkers = 8;
+static NSUInteger const kStressIterations = 100;
+static NSUInteger const kPromiseSends = 50;
+static NSUInteger const kOutboxMessages = 200;
+static NSUInteger const kRetryMessages = 200;
+static NSUInteger const kRetryAlerts = 20;
+static NSUInteger const kDecodeMessages = 10000;
+static NSUInteger const kDecodeChats = 5000;
+static NSUInteger const kLoadUsers = 50;
+static NSUInteger const kFanOutMembers = 250;
+static NSUInteger const kFanOutChunkSize = 100;
+static NSUInteger const kFanOutIterations = 10;
+static NSUInteger const kArchiveDays = 30;
+static NSUInteger const kArchiveMessagesPerDay = 100;
+static NSUInteger const kArchivePageSize = 50;
+static NSUInteger const kFeedChats = 1000;
+static NSUInteger const kFeedChangedChats = 5;
+static NSUInteger const kPreviewChats = 20;
+static NSUInteger const kPreviewContentLength = 10000;
+static NSUInteger const kSchemaMessages = 500;
+static NSUInteger const kSchemaChats = 25;
+static NSUInteger const kSchemaChatMessages = 20;
+static NSUInteger const kSchemaBatchSize = 4;
+static NSUInteger const kResumeLiveMessages = 200;
+static NSUInteger const kResumeGapMessages = 5;
+static NSUInteger const kPrefetchChats = 10;
+static NSUInteger const kPrefetchTopChats = 3;
+static NSUInteger const kPrefetchChatMessages = 50;
+static NSUInteger const kRateLimitSends = 60;
+static NSUInteger const kRateLimitBurst = 10;
+static NSUInteger const kRateLimitQueueDepth = 5;
+static NSUInteger const kHubObservers = 20;
+static NSUInteger const kHubFlaps = 10;
+static NSUInteger const kImportChats = 200;
+static NSUInteger const kImportChatMessages = 10;
+static NSUInteger const kImportBatchSize = 100;
+static NSUInteger const kImportMaxInFlight = 4;
+static NSUInteger const kImportFailingChat = 120;
+static NSUInteger const kAdaptiveMessages = 200;
+static NSUInteger const kAdaptiveMinimumWindow = 5;
+
+// Per Database Write Ceiling For The Sharding Benchmark
+static double const kShardOperationsPerSecond = 2000;
+
+static NSTimeInterval const kTimeout = 120;
+static NSTimeInterval const kPrefetchLatency = 0.1;
+static double const kRateLimitPerSecond = 50;
+
+// Slow Link For The Adaptive Load -- 200 Seeded Messages Take Well Over kAdaptiveTarget
+static NSTimeInterval const kAdaptiveLatency = 0.05;
+static double const kAdaptiveBandwidth = 20000;
+static NSTimeInterval const kAdaptiveTarget = 0.4;
+
+#pragma mark OBSERVER
+
+/*!
+ Stands in for a view controller registered with the presence and channel managers
+ */
+@interface FSBenchmarkObserver : NSObject
+
+@property (copy, nonatomic) void (^callback)(id info);
+
+- (void) userStatusDidUpdateWithId:(NSString *)userId andStatus:(BOOL)isOnline;
+- (void) receivedAlert:(NSDictionary *)alert;
+
+@end
+
+@implementation FSBenchmarkObserver
+
+- (void) userStatusDidUpdateWithId:(NSString *)userId andStatus:(BOOL)isOnline {
+    if (_callback) _callback(userId);
+}
+
+- (void) receivedAlert:(NSDictionary *)alert {
+    if (_callback) _callback(alert);
+}
+
+@end
+
+#pragma mark TESTS
+
+@interface FireSuiteTests : XCTestCase <FSChatManagerDelegate>
+
+@property (strong, nonatomic) FSLocalDatabase * database;
+@property (strong, nonatomic) dispatch_queue_t firebaseQueue;
+
+// Delegate Hooks -- Called On firebaseQueue, The Callback Queue
+@property (copy, nonatomic) void (^loadFinished)(NSDictionary * response);
+@property (copy, nonatomic) void (^messageReceived)(NSDictionary * message);
+@property (copy, nonatomic) void (^messageSent)(NSDictionary * message);
+@property (copy, nonatomic) void (^sendFailed)(NSDictionary * message, NSError * error);
+@property (copy, nonatomic) void (^earlierLoaded)(NSArray * messages);
 
 @end
 
 @implementation FireSuiteTests
 
++ (void) tearDown {
+    NSError * error;
+    NSString * path = [FSBenchmark resultsPath];
+    if ([FSBenchmark writeResultsToPath:path error:&error]) {
+        NSLog(@"FSBenchmark: Wrote results to %@", path);
+    }
+    else {
+        NSLog(@"FSBenchmark: Failed to write results: %@", error);
+    }
+    [super tearDown];
+}
+
 - (void)setUp
 {
     [super setUp];
-    // Put setup code here. This method is called before the invocation of each test method in the class.
+
+    [FSLocalDatabase resetAllDatabases];
+    _database = [FSLocalDatabase databaseForURL:kBenchmarkURL];
+
+    // Simulated Round Trip -- Defaults To 0 To Isolate FireSuite's Own Overhead
+    NSString * latency = [[NSProcessInfo processInfo] environment][@"FIRESUITE_BENCHMARK_LATENCY_MS"];
+    _database.latency = [latency doubleValue] / 1000;
+
+    // Callbacks Must Not Land On The Thread We Block
+    _firebaseQueue = dispatch_queue_create("com.firesuite.tests.firebase", DISPATCH_QUEUE_SERIAL);
+    [Firebase setDispatchQueue:_firebaseQueue];
+
+    [FireSuite setFirebaseURL:kBenchmarkURL];
+    [FireSuite setCurrentUserId:kCurrentUserId];
+    [FireSuite setCallbackQueue:_firebaseQueue];
+    [FireSuite chatManager].delegate = self;
+    [[FireSuite metrics] reset];
+    [[FSRefCache singleton] removeAllRefs];
 }
 
 - (void)tearDown
 {
-    // Put teardown code here. This method is called after the invocation of each test method in the class.
+    _loadFinished = nil;
+    _messageReceived = nil;
+    _messageSent = nil;
+    _sendFailed = nil;
+    _earlierLoaded = nil;
+    [FireSuite chatManager].decodePool = [FSDecodePool singleton];
+    [FireSuite chatManager].schemaVersion = FSChatSchemaVersion1;
+    [FireSuite chatManager].migrationBatchSize = 50;
+    [FireSuite chatManager].cursorPath = nil;
+    [FireSuite chatManager].prefetchChatCount = 5;
+    [FireSuite chatManager].prefetchByteBudget = 256 * 1024;
+    [FireSuite chatManager].importBatchSize = 500;
+    [FireSuite chatManager].importMaxInFlight = 4;
+    [FireSuite chatManager].initialLoadTargetLatency = 0;
+    [FireSuite chatManager].minimumInitialMessageCount = 10;
+
+    [self onFirebaseQueue:^(dispatch_block_t done) {
+        [[FireSuite chatManager] endChatSessionWithCompletionBlock:^(NSError *error) {
+            done();
+        }];
+    }];
+
     [super tearDown];
 }
 
-- (void)testExample
+#pragma mark HELPERS
+
+/*!
+ Run @param block on the Firebase queue, as FireSuite expects, and wait for it to call done
+ */
+- (void) onFirebaseQueue:(void (^)(dispatch_block_t done))block {
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    dispatch_async(_firebaseQueue, ^{
+        block(^{
+            dispatch_semaphore_signal(semaphore);
+        });
+    });
+    [self waitForSemaphore:semaphore];
+}
+
+- (void) waitForSemaphore:(dispatch_semaphore_t)semaphore {
+    long result = dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kTimeout * NSEC_PER_SEC)));
+    XCTAssertEqual(result, 0L, @"Timed out waiting for FireSuite");
+}
+
+- (NSDictionary *) statsDeltaFrom:(NSDictionary *)before {
+    [_database waitUntilIdleWithTimeout:kTimeout];
+    NSDictionary * after = [_database stats];
+    NSMutableDictionary * delta = [NSMutableDictionary new];
+    for (NSString * key in after) {
+        delta[key] = @([after[key] longLongValue] - [before[key] longLongValue]);
+    }
+    return delta;
+}
+
+- (NSString *) timestampWithOffset:(double)milliseconds {
+    return [NSString stringWithFormat:@"%f", [[NSDate date] timeIntervalSince1970] * 1000 + milliseconds];
+}
+
+- (NSString *) seedChatWithId:(NSString *)chatId messageCount:(NSUInteger)count {
+
+    NSString * lastTimestamp = [self timestampWithOffset:-1];
+    NSMutableDictionary * messages = [NSMutableDictionary dictionaryWithCapacity:count];
+
+    for (NSUInteger i = 0; i < count; i++) {
+        lastTimestamp = [self timestampWithOffset:-(double)(count - i)];
+        messages[[NSString stringWithFormat:@"m%06lu", (unsigned long)i]] = @{
+                                                                              kMessageTimestamp: lastTimestamp,
+                                                                              kMessageContent: [NSString stringWithFormat:@"Seeded message %lu", (unsigned long)i],
+                                                                              kMessageSentBy: i % 2 ? kCurrentUserId : kOtherUserId,
+                                                                              kMessageSentTo: i % 2 ? kOtherUserId : kCurrentUserId,
+                                                                              kMessageChatId: chatId,
+                                                                              @".priority": lastTimestamp,
+                                                                              };
+    }
+
+    NSMutableDictionary * chat = [NSMutableDictionary new];
+    chat[kChatHeader] = [self headerWithTimestamp:lastTimestamp messageCount:count];
+    if (count > 0) chat[kChatMessages] = messages;
+
+    [_database setValue:chat andPriority:lastTimestamp atPath:[NSString stringWithFormat:@"Chats/%@", chatId]];
+    return chatId;
+}
+
+- (NSDictionary *) headerWithTimestamp:(NSString *)timestamp messageCount:(NSUInteger)count {
+    return @{
+             kHeaderUsers: @[kCurrentUserId, kOtherUserId],
+             kHeaderTimeStamp: timestamp,
+             kHeaderCreatedAt: timestamp,
+             kHeaderLastMessage: @"",
+             kHeaderMessageCount: @(count),
+             kCurrentUserId: timestamp,
+             kOtherUserId: timestamp,
+             };
+}
+
+- (void) loadChatWithId:(NSString *)chatId numberOfMessages:(int)numberOfMessages {
+    dispatch_semaphore_t loaded = dispatch_semaphore_create(0);
+    _loadFinished = ^(NSDictionary * response) {
+        dispatch_semaphore_signal(loaded);
+    };
+    dispatch_async(_firebaseQueue, ^{
+        [[FireSuite chatManager] loadChatSessionWithChatId:chatId andNumberOfRecentMessages:numberOfMessages];
+    });
+    [self waitForSemaphore:loaded];
+    _loadFinished = nil;
+}
+
+- (id) waitForPromise:(FSPromise *)promise {
+    dispatch_semaphore_t settled = dispatch_semaphore_create(0);
+    [promise addCompletionBlock:^(id value, NSError * error) {
+        dispatch_semaphore_signal(settled);
+    }];
+    [self waitForSemaphore:settled];
+    return promise.value;
+}
+
+- (void) endChat {
+    [self onFirebaseQueue:^(dispatch_block_t done) {
+        [[FireSuite chatManager] endChatSessionWithCompletionBlock:^(NSError *error) {
+            done();
+        }];
+    }];
+}
+
+#pragma mark CHAT MANAGER DELEGATE
+
+- (void) chatSessionLoadDidFinishWithResponse:(NSDictionary *)response {
+    if (_loadFinished) _loadFinished(response);
+}
+
+- (void) chatSessionLoadDidFailWithError:(NSError *)error {
+    XCTFail(@"Chat load failed: %@", error);
+}
+
+- (void) sendMessage:(NSDictionary *)message didFailWithError:(NSError *)error {
+    if (_sendFailed) _sendFailed(message, error);
+    else XCTFail(@"Send failed: %@", error);
+}
+
+- (void) newMessageReceived:(NSMutableDictionary *)newMessage {
+    if (_messageReceived) _messageReceived(newMessage);
+}
+
+- (void) messageSendStateDidChange:(NSMutableDictionary *)message {
+    if (_messageSent && [message[kMessageSendState] isEqualToString:kMessageSendStateSent]) _messageSent(message);
+}
+
+- (void) chatSessionDidLoadEarlierMessages:(NSArray *)messages {
+    if (_earlierLoaded) _earlierLoaded(messages);
+}
+
+#pragma mark SEND MESSAGE
+
+- (void) testSendNewMessage
+{
+    [self seedChatWithId:@"sendChat" messageCount:0];
+    [self loadChatWithId:@"sendChat" numberOfMessages:50];
+
+    FSBenchmark * latency = [FSBenchmark benchmarkWithName:@"sendNewMessage.latency"];
+    FSBenchmark * throughput = [FSBenchmark benchmarkWithName:@"sendNewMessage.throughput"];
+    FSBenchmark * localEcho = [FSBenchmark benchmarkWithName:@"sendNewMessage.localEcho"];
+    NSMutableDictionary * sentAt = [NSMutableDictionary new];
+
+    // Shown At Once -- What The User Perceives
+    __block NSUInteger deliveries = 0;
+    _messageReceived = ^(NSDictionary * message) {
+        NSNumber * start = sentAt[message[kMessageContent]];
+        if (!start) return;
+        deliveries++;
+        [localEcho addSample:FSBenchmarkNow() - [start doubleValue]];
+    };
+
+    // Each Phase Feeds Only Its Own Benchmark -- Flipped On The Firebase Queue
+    __block NSUInteger remaining = 0;
+    __block BOOL isBursting = NO;
+    __block dispatch_semaphore_t received;
+    _messageSent = ^(NSDictionary * message) {
+        NSNumber * start = sentAt[message[kMessageContent]];
+        if (!start) return;
+        [isBursting ? throughput : latency addSample:FSBenchmarkNow() - [start doubleValue]];
+        if (--remaining == 0) dispatch_semaphore_signal(received);
+    };
+
+    // Latency -- One At A Time, Send Until Acknowledged
+    NSDictionary * before = [_database stats];
+    for (NSUInteger i = 0; i < kSendIterations; i++) {
+        NSString * content = [NSString stringWithFormat:@"Sequential %lu", (unsigned long)i];
+        received = dispatch_semaphore_create(0);
+        dispatch_async(_firebaseQueue, ^{
+            remaining = 1;
+            sentAt[content] = @(FSBenchmarkNow());
+            [[FireSuite chatManager] sendNewMessage:content];
+        });
+        [self waitForSemaphore:received];
+    }
+    latency.backendStats = [self statsDeltaFrom:before];
+    latency.parameters = @{@"messages": @(kSendIterations), @"latencyMs": @(_database.latency * 1000)};
+
+    // Throughput -- All At Once, Header Transactions Contend
+    before = [_database stats];
+    received = dispatch_semaphore_create(0);
+    NSTimeInterval start = FSBenchmarkNow();
+    dispatch_async(_firebaseQueue, ^{
+        remaining = kSendIterations;
+        isBursting = YES;
+        for (NSUInteger i = 0; i < kSendIterations; i++) {
+            NSString * content = [NSString stringWithFormat:@"Burst %lu", (unsigned long)i];
+            sentAt[content] = @(FSBenchmarkNow());
+            [[FireSuite chatManager] sendNewMessage:content];
+        }
+    });
+    [self waitForSemaphore:received];
+    [throughput setOperations:kSendIterations completedInDuration:FSBenchmarkNow() - start];
+    throughput.backendStats = [self statsDeltaFrom:before];
+    throughput.parameters = latency.parameters;
+    localEcho.parameters = latency.parameters;
+
+    // Let Every Server Copy Arrive -- None Should Be Delivered Again
+    [_database waitUntilIdleWithTimeout:kTimeout];
+    [self endChat];
+
+    [FSBenchmark recordBenchmark:latency];
+    [FSBenchmark recordBenchmark:throughput];
+    [FSBenchmark recordBenchmark:localEcho];
+    XCTAssertEqual([latency sampleCount], kSendIterations);
+    XCTAssertEqual([throughput sampleCount], kSendIterations);
+    XCTAssertEqual(deliveries, kSendIterations * 2);
+}
+
+- (void) testLocalEchoFailedSend
+{
+    [self seedChatWithId:@"echoChat" messageCount:0];
+    [self loadChatWithId:@"echoChat" numberOfMessages:50];
+    _database.writeFailureRate = 1;
+
+    __block NSDictionary * echo;
+    _messageReceived = ^(NSDictionary * message) {
+        echo = message;
+        XCTAssertEqualObjects(message[kMessageSendState], kMessageSendStatePending);
+        XCTAssertNotNil(message[kMessageId]);
+    };
+    dispatch_semaphore_t failed = dispatch_semaphore_create(0);
+    _sendFailed = ^(NSDictionary * message, NSError * error) {
+        dispatch_semaphore_signal(failed);
+    };
+    dispatch_async(_firebaseQueue, ^{
+        [[FireSuite chatManager] sendNewMessage:@"Doomed"];
+    });
+    [self waitForSemaphore:failed];
+
+    // The Shown Message Is Marked, Not Withdrawn
+    XCTAssertEqualObjects(echo[kMessageSendState], kMessageSendStateFailed);
+    _database.writeFailureRate = 0;
+}
+
+#pragma mark LOAD CHAT SESSION
+
+- (void) benchmarkLoadWithMessageCount:(NSUInteger)count iterations:(NSUInteger)iterations {
+
+    NSString * chatId = [self seedChatWithId:[NSString stringWithFormat:@"loadChat%lu", (unsigned long)count] messageCount:count];
+
+    FSBenchmark * benchmark = [FSBenchmark benchmarkWithName:[NSString stringWithFormat:@"loadChatSession.%lu", (unsigned long)count]];
+    NSDictionary * before = [_database stats];
+
+    for (NSUInteger i = 0; i < iterations; i++) {
+        NSTimeInterval start = FSBenchmarkNow();
+        [self loadChatWithId:chatId numberOfMessages:(int)count];
+        [benchmark addSample:FSBenchmarkNow() - start];
+        [self endChat];
+    }
+
+    benchmark.backendStats = [self statsDeltaFrom:before];
+    benchmark.parameters = @{@"messages": @(count), @"iterations": @(iterations), @"latencyMs": @(_database.latency * 1000)};
+    [FSBenchmark recordBenchmark:benchmark];
+    XCTAssertEqual([benchmark sampleCount], iterations);
+}
+
+- (void) testLoadChatSession50
+{
+    [self benchmarkLoadWithMessageCount:50 iterations:50];
+}
+
+- (void) testLoadChatSession1k
+{
+    [self benchmarkLoadWithMessageCount:1000 iterations:20];
+}
+
+- (void) testLoadChatSession10k
+{
+    [self benchmarkLoadWithMessageCount:10000 iterations:5];
+}
+
+#pragma mark CHAT HEADERS
+
+- (void) seedHeadersWithChatCount:(NSUInteger)count {
+    NSMutableArray * chatIds = [NSMutableArray arrayWithCapacity:count];
+    NSMutableDictionary * chats = [NSMutableDictionary dictionaryWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        NSString * chatId = [NSString stringWithFormat:@"headerChat%lu", (unsigned long)i];
+        NSString * timestamp = [self timestampWithOffset:-(double)(count - i)];
+        [chatIds addObject:chatId];
+        chats[chatId] = @{kChatHeader: [self headerWithTimestamp:timestamp messageCount:0]};
+    }
+    [_database setValue:chats andPriority:nil atPath:@"Chats"];
+    [_database setValue:chatIds andPriority:nil atPath:[NSString stringWithFormat:@"Users/%@/chats", kCurrentUserId]];
+}
+
+- (void) benchmarkHeadersWithChatCount:(NSUInteger)count iterations:(NSUInteger)iterations {
+
+    [self seedHeadersWithChatCount:count];
+
+    FSBenchmark * benchmark = [FSBenchmark benchmarkWithName:[NSString stringWithFormat:@"getChatHeaders.%lu", (unsigned long)count]];
+    NSDictionary * before = [_database stats];
+
+    for (NSUInteger i = 0; i < iterations; i++) {
+        __block NSUInteger headerCount = 0;
+        NSTimeInterval start = FSBenchmarkNow();
+        [self onFirebaseQueue:^(dispatch_block_t done) {
+            [[FireSuite chatManager] getChatHeadersForUserId:kCurrentUserId WithCompletionBlock:^(NSArray *headers, NSError *error) {
+                headerCount = headers.count;
+                done();
+            }];
+        }];
+        [benchmark addSample:FSBenchmarkNow() - start];
+        XCTAssertEqual(headerCount, count);
+    }
+
+    benchmark.backendStats = [self statsDeltaFrom:before];
+    benchmark.parameters = @{@"chats": @(count), @"iterations": @(iterations), @"latencyMs": @(_database.latency * 1000)};
+    [FSBenchmark recordBenchmark:benchmark];
+}
+
+- (void) testGetChatHeaders10
+{
+    [self benchmarkHeadersWithChatCount:10 iterations:50];
+}
+
+- (void) testGetChatHeaders1k
+{
+    [self benchmarkHeadersWithChatCount:1000 iterations:10];
+}
+
+- (void) testGetChatHeaders10k
+{
+    [self benchmarkHeadersWithChatCount:10000 iterations:3];
+}
+
+#pragma mark PRESENCE
+
+- (void) testPresenceObserverFanOut
+{
+    FSPresenceManager * presenceManager = [FireSuite presenceManager];
+    NSMutableArray * observers = [NSMutableArray new];
+
+    __block NSUInteger remaining = kPresenceUsers * kPresenceObserversPerUser;
+    __block dispatch_semaphore_t notified = dispatch_semaphore_create(0);
+    void (^callback)(id) = ^(id userId) {
+        if (--remaining == 0) dispatch_semaphore_signal(notified);
+    };
+
+    // Register -- Each Fires Once With The Initial Status
+    dispatch_async(_firebaseQueue, ^{
+        for (NSUInteger user = 0; user < kPresenceUsers; user++) {
+            for (NSUInteger i = 0; i < kPresenceObserversPerUser; i++) {
+                FSBenchmarkObserver * observer = [FSBenchmarkObserver new];
+                observer.callback = callback;
+                [observers addObject:observer];
+                [presenceManager registerUserStatusObserver:observer
+                                               withSelector:@selector(userStatusDidUpdateWithId:andStatus:)
+                                                  forUserId:[NSString stringWithFormat:@"presenceUser%lu", (unsigned long)user]];
+            }
+        }
+    });
+    [self waitForSemaphore:notified];
+
+    // Flap -- Time Until Every Observer Of That User Hears About It
+    FSBenchmark * benchmark = [FSBenchmark benchmarkWithName:@"presence.fanOut"];
+    NSDictionary * before = [_database stats];
+
+    for (NSUInteger flap = 0; flap < kPresenceFlaps; flap++) {
+        NSString * path = [NSString stringWithFormat:@"Users/presenceUser%lu/connections", (unsigned long)(flap % kPresenceUsers)];
+        id value = (flap / kPresenceUsers) % 2 ? [NSNull null] : @{@"device": [self timestampWithOffset:0]};
+
+        notified = dispatch_semaphore_create(0);
+        dispatch_sync(_firebaseQueue, ^{
+            remaining = kPresenceObserversPerUser;
+        });
+
+        NSTimeInterval start = FSBenchmarkNow();
+        [_database setValue:value andPriority:nil atPath:path];
+        [self waitForSemaphore:notified];
+        [benchmark addSample:FSBenchmarkNow() - start];
+    }
+
+    benchmark.backendStats = [self statsDeltaFrom:before];
+    benchmark.parameters = @{@"users": @(kPresenceUsers), @"observersPerUser": @(kPresenceObserversPerUser), @"flaps": @(kPresenceFlaps), @"latencyMs": @(_database.latency * 1000)};
+    [FSBenchmark recordBenchmark:benchmark];
+
+    [self onFirebaseQueue:^(dispatch_block_t done) {
+        [presenceManager removeAllUserStatusObservers];
+        done();
+    }];
+}
+
+- (void) testPresenceStopTakesConnectionDown
+{
+    FSPresenceManager * presenceManager = [FireSuite presenceManager];
+    NSString * connectionsPath = [NSString stringWithFormat:@"Users/%@/connections", kCurrentUserId];
+
+    // Online, Then Stopped -- The Device's Connection Is Gone Without The Socket Dropping
+    for (NSUInteger flap = 0; flap < 2; flap++) {
+        [self onFirebaseQueue:^(dispatch_block_t done) {
+            [presenceManager startPresenceManager];
+            done();
+        }];
+        NSTimeInterval deadline = FSBenchmarkNow() + kTimeout;
+        while (![_database valueAtPath:connectionsPath] && FSBenchmarkNow() < deadline) {
+            [NSThread sleepForTimeInterval:0.01];
+        }
+        XCTAssertEqual([[_database valueAtPath:connectionsPath] count], (NSUInteger)1);
+
+        [self onFirebaseQueue:^(dispatch_block_t done) {
+            [presenceManager stopPresenceMonitorWithCompletion:done];
+        }];
+        [_database waitUntilIdleWithTimeout:kTimeout];
+        XCTAssertNil([_database valueAtPath:connectionsPath]);
+    }
+    XCTAssertNotNil([_database valueAtPath:[NSString stringWithFormat:@"Users/%@/lastOnline", kCurrentUserId]]);
+}
+
+#pragma mark ALERTS
+
+- (void) testAlertDelivery
+{
+    FSChannelManager * channelManager = [FireSuite channelManager];
+    FSBenchmark * benchmark = [FSBenchmark benchmarkWithName:@"alerts.delivery"];
+    NSMutableDictionary * sentAt = [NSMutableDictionary new];
+
+    __block NSUInteger remaining = kAlertIterations;
+    dispatch_semaphore_t received = dispatch_semaphore_create(0);
+
+    FSBenchmarkObserver * observer = [FSBenchmarkObserver new];
+    observer.callback = ^(NSDictionary * alert) {
+        NSNumber * start = sentAt[alert[kAlertData][@"sequence"]];
+        if (!start) return;
+        [benchmark addSample:FSBenchmarkNow() - [start doubleValue]];
+        if (--remaining == 0) dispatch_semaphore_signal(received);
+    };
+
+    NSDictionary * before = [_database stats];
+    NSTimeInterval start = FSBenchmarkNow();
+    dispatch_async(_firebaseQueue, ^{
+        [channelManager registerUserAlertsObserver:observer withSelector:@selector(receivedAlert:)];
+        for (NSUInteger i = 0; i < kAlertIterations; i++) {
+            NSNumber * sequence = @(i);
+            sentAt[sequence] = @(FSBenchmarkNow());
+            [channelManager sendAlertToUserId:kCurrentUserId
+                                withAlertType:kAlertTypeNewMessage
+                                      andData:@{@"sequence": sequence}
+                               withCompletion:nil];
+        }
+    });
+    [self waitForSemaphore:received];
+    [benchmark setOperations:kAlertIterations completedInDuration:FSBenchmarkNow() - start];
+
+    benchmark.backendStats = [self statsDeltaFrom:before];
+    benchmark.parameters = @{@"alerts": @(kAlertIterations), @"latencyMs": @(_database.latency * 1000)};
+    [FSBenchmark recordBenchmark:benchmark];
+
+    [self onFirebaseQueue:^(dispatch_block_t done) {
+        [channelManager endAlertsMonitorWithCompletionBlock:done];
+    }];
+}
+
+#pragma mark METRICS
+
+- (void) testMetricsForSendNewMessage
+{
+    [self seedChatWithId:@"metricsChat" messageCount:0];
+    [self loadChatWithId:@"metricsChat" numberOfMessages:50];
+
+    FSMetrics * metrics = [FireSuite metrics];
+    [metrics reset];
+
+    dispatch_semaphore_t received = dispatch_semaphore_create(0);
+    _messageReceived = ^(NSDictionary * message) {
+        dispatch_semaphore_signal(received);
+    };
+    dispatch_async(_firebaseQueue, ^{
+        [[FireSuite chatManager] sendNewMessage:@"Counted"];
+    });
+    [self waitForSemaphore:received];
+
+    // Header Transaction Finishes After The Echo -- Drain Backend, Then Callbacks
+    [_database waitUntilIdleWithTimeout:kTimeout];
+    [self onFirebaseQueue:^(dispatch_block_t done) {
+        done();
+    }];
+
+    FSOperationMetrics * send = [metrics metricsForOperation:kFSOperationSendMessage];
+    XCTAssertEqual([send calls], 1LL);
+    XCTAssertEqual([send errors], 0LL);
+    XCTAssertTrue([send bytesEncoded] > 0);
+    XCTAssertEqual([[send latency] count], 1ULL);
+
+    XCTAssertEqual([[metrics metricsForOperation:kFSOperationUpdateHeader] calls], 1LL);
+    XCTAssertTrue([metrics transactionAttempts] >= 1);
+    XCTAssertEqual([metrics transactionRetries], [metrics transactionAttempts] - 1);
+    XCTAssertTrue([metrics roundTrips] >= 2);
+    XCTAssertTrue([metrics listenerCount] >= 1, @"Incoming message monitor should be counted");
+
+    NSDictionary * exported = [NSJSONSerialization JSONObjectWithData:[metrics exportJSON] options:0 error:nil];
+    XCTAssertNotNil(exported[kMetricsOperations][kFSOperationSendMessage]);
+}
+
+- (void) testLatencyHistogramPercentiles
+{
+    FSLatencyHistogram * histogram = [FSLatencyHistogram new];
+    for (int i = 1; i <= 1000; i++) [histogram recordLatency:i / 1000.0];
+
+    XCTAssertEqual([histogram count], 1000ULL);
+    XCTAssertEqualWithAccuracy([histogram valueAtPercentile:50], 0.5, 0.5 * 0.05);
+    XCTAssertEqualWithAccuracy([histogram valueAtPercentile:99], 0.99, 0.99 * 0.05);
+    XCTAssertEqualWithAccuracy([histogram max], 1.0, 0.001);
+    XCTAssertEqualWithAccuracy([histogram mean], 0.5005, 0.001);
+}
+
+- (void) testMetricsRecordingOverhead
+{
+    FSMetrics * metrics = [FSMetrics new];
+    FSBenchmark * benchmark = [FSBenchmark benchmarkWithName:@"metrics.recordOperation"];
+
+    // Concurrent Writers -- Same Operation, Worst Case For Contention
+    NSTimeInterval start = FSBenchmarkNow();
+    dispatch_apply(4, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t worker) {
+        for (NSUInteger i = 0; i < kMetricsIterations / 4; i++) {
+            [metrics recordOperation:kFSOperationSendMessage latency:i * 0.000001 error:nil];
+        }
+    });
+    [benchmark setOperations:kMetricsIterations completedInDuration:FSBenchmarkNow() - start];
+    benchmark.parameters = @{@"operations": @(kMetricsIterations), @"threads": @4};
+
+    [FSBenchmark recordBenchmark:benchmark];
+    XCTAssertEqual([[metrics metricsForOperation:kFSOperationSendMessage] calls], (int64_t)kMetricsIterations);
+}
+
+#pragma mark TRACING
+
+- (void) testTraceLoadChatSession
+{
+    FSTracer * tracer = [FireSuite tracer];
+    [tracer reset];
+    tracer.enabled = YES;
+
+    [self seedChatWithId:@"traceChat" messageCount:50];
+    [self loadChatWithId:@"traceChat" numberOfMessages:50];
+    tracer.enabled = NO;
+
+    // Load Span Closes After The Delegate Returns -- Ending Queues Behind It
+    [self endChat];
+
+    // Root And Each Step, Linked By Parent
+    NSMutableDictionary * spansByName = [NSMutableDictionary new];
+    for (NSDictionary * span in [tracer spans]) spansByName[span[@"name"]] = span;
+
+    NSDictionary * load = spansByName[@"chat.loadChatSession"];
+    XCTAssertNotNil(load);
+    for (NSString * step in @[@"chat.loadChatSession.getHeader", @"chat.loadChatSession.getMessages", @"chat.loadChatSession.delegate"]) {
+        XCTAssertEqualObjects(spansByName[step][@"parentId"], load[@"spanId"], @"%@ should be a child of the load", step);
+        XCTAssertEqualObjects(spansByName[step][@"traceId"], load[@"spanId"]);
+    }
+
+    NSDictionary * trace = [NSJSONSerialization JSONObjectWithData:[tracer exportChromeTrace] options:0 error:nil];
+    XCTAssertEqual([trace[@"traceEvents"] count], [[tracer spans] count] * 2);
+}
+
+- (void) testTracerRingBufferOverwritesOldest
+{
+    FSTracer * tracer = [[FSTracer alloc] initWithCapacity:100];
+    tracer.enabled = YES;
+    XCTAssertEqual(tracer.capacity, (NSUInteger)128);
+
+    dispatch_apply(4, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t worker) {
+        for (int i = 0; i < 1000; i++) {
+            FSTraceSpan root = [tracer beginSpan:"root" parent:FSTraceSpanNone];
+            [tracer endSpan:[tracer beginSpan:"child" parent:root]];
+            [tracer endSpan:root];
+        }
+    });
+
+    NSArray * spans = [tracer spans];
+    XCTAssertEqual(spans.count, (NSUInteger)128);
+    XCTAssertTrue([[spans lastObject][@"spanId"] unsignedLongLongValue] > 7000);
+}
+
+- (void) testTraceRingKeepsRecordsWhole
+{
+    // Two Slots, Many Writers -- Every Lap Fights Over The Same Slots
+    FSTracer * tracer = [[FSTracer alloc] initWithCapacity:2];
+    tracer.enabled = YES;
+
+    static const char * names[] = {"trace.race.0", "trace.race.1", "trace.race.2", "trace.race.3"};
+    dispatch_apply(4, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t worker) {
+        for (NSUInteger i = 0; i < 10000; i++) {
+            [tracer endSpan:[tracer beginSpan:names[worker] parent:FSTraceSpanNone]];
+        }
+    });
+
+    // Whatever Survived Came From One Writer -- A Root's Trace Is Itself
+    NSArray * spans = [tracer spans];
+    XCTAssertTrue(spans.count > 0 && spans.count <= 2);
+    for (NSDictionary * span in spans) {
+        XCTAssertEqualObjects(span[@"traceId"], span[@"spanId"]);
+        XCTAssertEqualObjects(span[@"parentId"], @0);
+        XCTAssertTrue([span[@"duration"] doubleValue] >= 0);
+        XCTAssertTrue([span[@"name"] hasPrefix:@"trace.race."]);
+    }
+}
+
+#pragma mark REF CACHE
+
+/*!
+ Firebase refs allocated and URLs parsed per operation, cache emptied before each (cold) or left warm
+ */
+- (NSDictionary *) refCountsForOperations:(NSUInteger)count cold:(BOOL)cold operation:(void (^)(NSUInteger i, dispatch_block_t done))operation {
+    NSDictionary * before = [_database stats];
+    for (NSUInteger i = 0; i < count; i++) {
+        if (cold) [[FSRefCache singleton] removeAllRefs];
+        [self onFirebaseQueue:^(dispatch_block_t done) {
+            operation(i, done);
+        }];
+    }
+    NSDictionary * delta = [self statsDeltaFrom:before];
+    return @{
+             @"refsPerOperation": @([delta[kLocalStatRefsCreated] doubleValue] / count),
+             @"urlsParsedPerOperation": @([delta[kLocalStatURLsParsed] doubleValue] / count),
+             };
+}
+
+- (void) testRefAllocationsPerSend
+{
+    [self seedChatWithId:@"refChat" messageCount:0];
+    [self loadChatWithId:@"refChat" numberOfMessages:50];
+
+    __block dispatch_block_t echoed;
+    _messageSent = ^(NSDictionary * message) {
+        if (echoed) echoed();
+        echoed = nil;
+    };
+    void (^send)(NSUInteger, dispatch_block_t) = ^(NSUInteger i, dispatch_block_t done) {
+        echoed = done;
+        [[FireSuite chatManager] sendNewMessage:[NSString stringWithFormat:@"Ref %lu", (unsigned long)i]];
+    };
+
+    NSDictionary * cold = [self refCountsForOperations:kSendIterations cold:YES operation:send];
+    NSDictionary * warm = [self refCountsForOperations:kSendIterations cold:NO operation:send];
+
+    FSBenchmark * benchmark = [FSBenchmark benchmarkWithName:@"refCache.sendNewMessage"];
+    benchmark.parameters = @{@"messages": @(kSendIterations), @"cold": cold, @"warm": warm};
+    [FSBenchmark recordBenchmark:benchmark];
+
+    XCTAssertEqual([warm[@"urlsParsedPerOperation"] doubleValue], 0.0, @"A warm send should not parse any URL");
+    XCTAssertTrue([warm[@"refsPerOperation"] doubleValue] < [cold[@"refsPerOperation"] doubleValue]);
+}
+
+- (void) testRefAllocationsPerHeaderFetch
+{
+    NSMutableArray * chatIds = [NSMutableArray new];
+    NSMutableDictionary * chats = [NSMutableDictionary new];
+    for (NSUInteger i = 0; i < kRefCacheChats; i++) {
+        NSString * chatId = [NSString stringWithFormat:@"refChat%lu", (unsigned long)i];
+        [chatIds addObject:chatId];
+        chats[chatId] = @{kChatHeader: [self headerWithTimestamp:[self timestampWithOffset:-(double)i] messageCount:0]};
+    }
+    [_database setValue:chats andPriority:nil atPath:@"Chats"];
+    [_database setValue:chatIds andPriority:nil atPath:[NSString stringWithFormat:@"Users/%@/chats", kCurrentUserId]];
+
+    void (^fetch)(NSUInteger, dispatch_block_t) = ^(NSUInteger i, dispatch_block_t done) {
+        [[FireSuite chatManager] getChatHeadersForUserId:kCurrentUserId WithCompletionBlock:^(NSArray *headers, NSError *error) {
+            done();
+        }];
+    };
+
+    NSDictionary * cold = [self refCountsForOperations:10 cold:YES operation:fetch];
+    NSDictionary * warm = [self refCountsForOperations:10 cold:NO operation:fetch];
+
+    FSBenchmark * benchmark = [FSBenchmark benchmarkWithName:@"refCache.getChatHeaders"];
+    benchmark.parameters = @{@"chats": @(kRefCacheChats), @"cold": cold, @"warm": warm};
+    [FSBenchmark recordBenchmark:benchmark];
+
+    // Cold Parses The Root Once Instead Of Once Per Header
+    XCTAssertEqual([cold[@"urlsParsedPerOperation"] doubleValue], 1.0);
+    XCTAssertEqual([warm[@"urlsParsedPerOperation"] doubleValue], 0.0);
+}
+
+- (void) testRefCacheLookup
+{
+    FSRefCache * cache = [[FSRefCache alloc] initWithCapacity:kRefCacheChats];
+    NSMutableArray * chatIds = [NSMutableArray new];
+    for (NSUInteger i = 0; i < kRefCacheChats; i++) [chatIds addObject:[NSString stringWithFormat:@"chat%lu", (unsigned long)i]];
+
+    // Before -- Format And Parse Every Time
+    FSBenchmark * uncached = [FSBenchmark benchmarkWithName:@"refCache.initWithUrl"];
+    NSTimeInterval start = FSBenchmarkNow();
+    for (NSUInteger i = 0; i < kRefIterations; i++) {
+        @autoreleasepool {
+            NSString * url = [NSString stringWithFormat:@"%@Chats/%@/header/", kBenchmarkURL, chatIds[i % kRefCacheChats]];
+            XCTAssertNotNil([[Firebase alloc] initWithUrl:url]);
+        }
+    }
+    [uncached setOperations:kRefIterations completedInDuration:FSBenchmarkNow() - start];
+
+    // After -- Warm Cache
+    FSBenchmark * cached = [FSBenchmark benchmarkWithName:@"refCache.refWithRoot"];
+    start = FSBenchmarkNow();
+    for (NSUInteger i = 0; i < kRefIterations; i++) {
+        @autoreleasepool {
+            XCTAssertNotNil([cache refWithRoot:kBenchmarkURL collection:@"Chats" id:chatIds[i % kRefCacheChats] leaf:kChatHeader]);
+        }
+    }
+    [cached setOperations:kRefIterations completedInDuration:FSBenchmarkNow() - start];
+
+    [FSBenchmark recordBenchmark:uncached];
+    [FSBenchmark recordBenchmark:cached];
+    XCTAssertEqual([cache misses], kRefCacheChats);
+    XCTAssertEqual([cache count], kRefCacheChats);
+
+    // LRU -- One More Evicts The Oldest
+    [cache refWithRoot:kBenchmarkURL collection:@"Chats" id:@"overflow" leaf:kChatHeader];
+    XCTAssertEqual([cache count], kRefCacheChats);
+    [cache refWithRoot:kBenchmarkURL collection:@"Chats" id:chatIds[kRefCacheChats - 1] leaf:kChatHeader];
+    XCTAssertEqual([cache misses], kRefCacheChats + 1, @"Most recent entry should survive eviction");
+}
+
+#pragma mark CONTEXTS
+
+- (void) testManyContextsInOneProcess
+{
+    // One Context Per Simulated User, Each Alerting The Next
+    NSMutableArray * contexts = [NSMutableArray arrayWithCapacity:kContextUsers];
+    NSMutableArray * observers = [NSMutableArray arrayWithCapacity:kContextUsers];
+    NSMutableArray * receivedCounts = [NSMutableArray arrayWithCapacity:kContextUsers];
+
+    __block NSUInteger remaining = kContextUsers;
+    dispatch_semaphore_t received = dispatch_semaphore_create(0);
+
+    for (NSUInteger i = 0; i < kContextUsers; i++) {
+        NSString * userId = [NSString stringWithFormat:@"contextUser%lu", (unsigned long)i];
+        FSContext * context = [FSContext contextWithFirebaseURL:kBenchmarkURL currentUserId:userId];
+        context.callbackQueue = _firebaseQueue;
+        [contexts addObject:context];
+        [receivedCounts addObject:@0];
+
+        FSBenchmarkObserver * observer = [FSBenchmarkObserver new];
+        observer.callback = ^(NSDictionary * alert) {
+            receivedCounts[i] = @([receivedCounts[i] integerValue] + 1);
+            if (--remaining == 0) dispatch_semaphore_signal(received);
+        };
+        [observers addObject:observer];
+    }
+
+    FSBenchmark * benchmark = [FSBenchmark benchmarkWithName:@"contexts.alertRing"];
+    NSDictionary * before = [_database stats];
+    NSTimeInterval start = FSBenchmarkNow();
+    dispatch_async(_firebaseQueue, ^{
+        for (NSUInteger i = 0; i < kContextUsers; i++) {
+            [[contexts[i] channelManager] registerUserAlertsObserver:observers[i] withSelector:@selector(receivedAlert:)];
+        }
+        for (NSUInteger i = 0; i < kContextUsers; i++) {
+            FSContext * next = contexts[(i + 1) % kContextUsers];
+            [[contexts[i] channelManager] sendAlertToUserId:next.currentUserId
+                                              withAlertType:kAlertTypeNewMessage
+                                                    andData:@{@"from": [contexts[i] currentUserId]}
+                                             withCompletion:nil];
+        }
+    });
+    [self waitForSemaphore:received];
+    [benchmark setOperations:kContextUsers completedInDuration:FSBenchmarkNow() - start];
+
+    benchmark.backendStats = [self statsDeltaFrom:before];
+    benchmark.parameters = @{@"contexts": @(kContextUsers), @"latencyMs": @(_database.latency * 1000)};
+    [FSBenchmark recordBenchmark:benchmark];
+
+    // Each User Heard Exactly Once, Each Context Counted Only Its Own Send
+    for (NSUInteger i = 0; i < kContextUsers; i++) {
+        XCTAssertEqual([receivedCounts[i] integerValue], 1);
+        XCTAssertEqual([[[contexts[i] metrics] metricsForOperation:kFSOperationSendAlert] calls], 1LL);
+    }
+    XCTAssertEqual([[[FireSuite metrics] metricsForOperation:kFSOperationSendAlert] calls], 0LL);
+
+    [self onFirebaseQueue:^(dispatch_block_t done) {
+        for (FSContext * context in contexts) {
+            [context.channelManager endAlertsMonitorWithCompletionBlock:^{}];
+        }
+        done();
+    }];
+}
+
+#pragma mark SHARDING
+
+- (NSArray *) shardURLsWithCount:(NSUInteger)count {
+    NSMutableArray * urls = [NSMutableArray new];
+    for (NSUInteger i = 0; i < count; i++) {
+        [urls addObject:[NSString stringWithFormat:@"https://firesuite-shard%lu.firebaseIO.com/", (unsigned long)i]];
+    }
+    return urls;
+}
+
+- (void) testShardDistributionAndResharding
+{
+    NSArray * urls = [self shardURLsWithCount:4];
+    FSShardRouter * router = [FSShardRouter routerWithDatabaseURLs:urls];
+    FSShardRouter * grown = [router routerByAddingDatabaseURL:@"https://firesuite-shard4.firebaseIO.com"];
+
+    NSCountedSet * counts = [NSCountedSet new];
+    NSUInteger moved = 0;
+    for (NSUInteger i = 0; i < kShardKeys; i++) {
+        NSString * chatId = [NSString stringWithFormat:@"chat%lu", (unsigned long)i];
+        NSString * before = [router databaseURLForChatId:chatId];
+        NSString * after = [grown databaseURLForChatId:chatId];
+        [counts addObject:before];
+
+        // Keys Only Ever Move Onto The New Database
+        if (![before isEqualToString:after]) {
+            moved++;
+            XCTAssertEqualObjects(after, @"https://firesuite-shard4.firebaseIO.com/");
+        }
+    }
+
+    // Each Shard Within 15% Of An Even Share
+    double even = (double)kShardKeys / urls.count;
+    for (NSString * url in urls) {
+        XCTAssertEqualWithAccuracy((double)[counts countForObject:url], even, even * 0.15, @"%@ is unbalanced", url);
+    }
+
+    // About 1/5 Of Keys Move, Not Everything
+    XCTAssertEqualWithAccuracy((double)moved / kShardKeys, 0.2, 0.05);
+
+    // Removing It Again Restores The Original Placement
+    FSShardRouter * shrunk = [grown routerByRemovingDatabaseURL:@"https://firesuite-shard4.firebaseIO.com/"];
+    XCTAssertEqualObjects([shrunk databaseURLForChatId:@"chat42"], [router databaseURLForChatId:@"chat42"]);
+}
+
+- (void) testShardedChatPlacement
+{
+    NSArray * urls = [self shardURLsWithCount:4];
+    FSContext * context = [FSContext contextWithFirebaseURL:nil currentUserId:kCurrentUserId];
+    context.callbackQueue = _firebaseQueue;
+    context.shardRouter = [FSShardRouter routerWithDatabaseURLs:urls];
+    XCTAssertEqualObjects(context.firebaseURL, urls[0]);
+
+    __block NSString * chatId;
+    [self onFirebaseQueue:^(dispatch_block_t done) {
+        [context.chatManager createNewChatForUsers:@[kCurrentUserId, kOtherUserId] withCustomId:nil andCompletionBlock:^(NSString *newChatId, NSError *error) {
+            XCTAssertNil(error);
+            chatId = newChatId;
+            done();
+        }];
+    }];
+
+    // Chat On Its Own Shard, Each User's Index On Their Home Shard
+    FSShardRouter * router = context.shardRouter;
+    NSString * chatShard = [router databaseURLForChatId:chatId];
+    for (NSString * url in urls) {
+        id header = [[FSLocalDatabase databaseForURL:url] valueAtPath:[NSString stringWithFormat:@"Chats/%@/%@", chatId, kChatHeader]];
+        if ([url isEqualToString:chatShard]) XCTAssertNotNil(header);
+        else XCTAssertNil(header);
+    }
+    for (NSString * userId in @[kCurrentUserId, kOtherUserId]) {
+        FSLocalDatabase * home = [FSLocalDatabase databaseForURL:[router databaseURLForUserId:userId]];
+        XCTAssertEqualObjects([home valueAtPath:[NSString stringWithFormat:@"Users/%@/chats", userId]], @[chatId]);
+    }
+
+    // Headers Are Fetched Across Shards
+    __block NSArray * headers;
+    [self onFirebaseQueue:^(dispatch_block_t done) {
+        [context.chatManager getChatHeadersForUserId:kOtherUserId WithCompletionBlock:^(NSArray *fetched, NSError *error) {
+            headers = fetched;
+            done();
+        }];
+    }];
+    XCTAssertEqual(headers.count, (NSUInteger)1);
+}
+
+- (double) createChatsPerSecondWithShardCount:(NSUInteger)shardCount {
+    NSArray * urls = [self shardURLsWithCount:shardCount];
+    for (NSString * url in urls) {
+        FSLocalDatabase * database = [FSLocalDatabase databaseForURL:url];
+        database.latency = _database.latency;
+        database.operationsPerSecond = kShardOperationsPerSecond;
+    }
+
+    FSContext * context = [FSContext contextWithFirebaseURL:nil currentUserId:kCurrentUserId];
+    context.callbackQueue = _firebaseQueue;
+    context.shardRouter = [FSShardRouter routerWithDatabaseURLs:urls];
+
+    __block NSUInteger remaining = kShardChats;
+    dispatch_semaphore_t created = dispatch_semaphore_create(0);
+    NSTimeInterval start = FSBenchmarkNow();
+    dispatch_async(_firebaseQueue, ^{
+        for (NSUInteger i = 0; i < kShardChats; i++) {
+            NSArray * users = @[[NSString stringWithFormat:@"shardUser%lu", (unsigned long)i], [NSString stringWithFormat:@"shardUser%lu", (unsigned long)i + 1]];
+            [context.chatManager createNewChatForUsers:users withCustomId:nil andCompletionBlock:^(NSString *newChatId, NSError *error) {
+                if (--remaining == 0) dispatch_semaphore_signal(created);
+            }];
+        }
+    });
+    [self waitForSemaphore:created];
+    NSTimeInterval duration = FSBenchmarkNow() - start;
+
+    FSBenchmark * benchmark = [FSBenchmark benchmarkWithName:[NSString stringWithFormat:@"sharding.createNewChat.%luShards", (unsigned long)shardCount]];
+    [benchmark setOperations:kShardChats completedInDuration:duration];
+    benchmark.parameters = @{@"shards": @(shardCount), @"operationsPerSecondPerShard": @(kShardOperationsPerSecond)};
+    [FSBenchmark recordBenchmark:benchmark];
+    return kShardChats / duration;
+}
+
+- (void) testShardedWriteThroughput
+{
+    double single = [self createChatsPerSecondWithShardCount:1];
+    double sharded = [self createChatsPerSecondWithShardCount:4];
+
+    // Bounded By Each Database's Ceiling, So More Shards Means More Writes
+    XCTAssertTrue(sharded > single * 2, @"4 shards: %.0f/s, 1 shard: %.0f/s", sharded, single);
+}
+
+#pragma mark THREAD SAFETY
+
+/*!
+ Drive every manager from a worker pool with Firebase and the managers calling back on concurrent queues -- run under Thread Sanitizer to catch races
+ */
+- (void) testConcurrentManagerStress
 {
-    XCTFail(@"No implementation for \"%s\"", __PRETTY_FUNCTION__);
+    [self seedChatWithId:@"stressChat" messageCount:0];
+    [self loadChatWithId:@"stressChat" numberOfMessages:50];
+
+    dispatch_queue_t concurrentQueue = dispatch_queue_create("com.firesuite.tests.concurrent", DISPATCH_QUEUE_CONCURRENT);
+    [Firebase setDispatchQueue:concurrentQueue];
+    [FireSuite setCallbackQueue:concurrentQueue];
+
+    // Echoed Messages, Header Queries And Sent Alerts
+    NSUInteger total = kStressWorkers * kStressIterations;
+    __block int64_t remaining = total * 3;
+    dispatch_semaphore_t finished = dispatch_semaphore_create(0);
+    dispatch_block_t countDown = ^{
+        if (__sync_sub_and_fetch(&remaining, 1) == 0) dispatch_semaphore_signal(finished);
+    };
+
+    _messageReceived = ^(NSDictionary * message) {
+        countDown();
+    };
+
+    FSChatManager * chatManager = [FireSuite chatManager];
+    FSPresenceManager * presenceManager = [FireSuite presenceManager];
+    FSChannelManager * channelManager = [FireSuite channelManager];
+
+    FSBenchmark * benchmark = [FSBenchmark benchmarkWithName:@"threadSafety.stress"];
+    NSTimeInterval start = FSBenchmarkNow();
+    dispatch_apply(kStressWorkers, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t worker) {
+        for (NSUInteger i = 0; i < kStressIterations; i++) {
+            FSBenchmarkObserver * observer = [FSBenchmarkObserver new];
+
+            // Chat -- Sends Contend On The Header Transaction
+            [chatManager sendNewMessage:[NSString stringWithFormat:@"Stress %lu.%lu", (unsigned long)worker, (unsigned long)i]];
+            [chatManager getChatHeadersForUserId:kCurrentUserId WithCompletionBlock:^(NSArray *headers, NSError *error) {
+                countDown();
+            }];
+
+            // Presence -- Register And Remove While Statuses Arrive
+            [presenceManager registerUserStatusObserver:observer
+                                           withSelector:@selector(userStatusDidUpdateWithId:andStatus:)
+                                              forUserId:[NSString stringWithFormat:@"stressUser%lu", (unsigned long)(i % 10)]];
+            [presenceManager removeUserStatusObserversForObject:observer];
+
+            // Alerts -- Register And Remove While Alerts Are Delivered
+            [channelManager registerUserAlertsObserver:observer withSelector:@selector(receivedAlert:)];
+            [channelManager sendAlertToUserId:kCurrentUserId withAlertType:kAlertTypeNewMessage andData:@{@"worker": @(worker)} withCompletion:^(NSError *error) {
+                countDown();
+            }];
+            [channelManager removeAlertStatusObserver:observer];
+
+            // Accessors From Any Thread
+            XCTAssertEqualObjects(chatManager.chatId, @"stressChat");
+        }
+    });
+    [self waitForSemaphore:finished];
+    [benchmark setOperations:total completedInDuration:FSBenchmarkNow() - start];
+    benchmark.parameters = @{@"workers": @(kStressWorkers), @"iterations": @(kStressIterations)};
+    [FSBenchmark recordBenchmark:benchmark];
+
+    // Ending Queues Behind Every Registration And Removal
+    dispatch_semaphore_t ended = dispatch_semaphore_create(0);
+    [presenceManager stopPresenceMonitorWithCompletion:^{
+        dispatch_semaphore_signal(ended);
+    }];
+    [channelManager endAlertsMonitorWithCompletionBlock:^{
+        dispatch_semaphore_signal(ended);
+    }];
+    [self waitForSemaphore:ended];
+    [self waitForSemaphore:ended];
+
+    // Every Send Counted Exactly Once, No Observer Leaked
+    [_database waitUntilIdleWithTimeout:kTimeout];
+    XCTAssertEqualObjects([_database valueAtPath:@"Chats/stressChat/header/messageCount"], @(total));
+    XCTAssertEqual([[FireSuite metrics] observerCount], 0LL);
+
+    [Firebase setDispatchQueue:_firebaseQueue];
+    [FireSuite setCallbackQueue:_firebaseQueue];
+}
+
+#pragma mark PROMISES
+
+- (void) testPromiseCombinators
+{
+    NSError * error = [NSError errorWithDomain:@"FireSuiteTests" code:7 userInfo:nil];
+
+    // all -- Values In Order, nil As NSNull
+    FSPromise * all = [FSPromise all:@[[FSPromise promiseWithValue:@1], [FSPromise promiseWithValue:nil], [FSPromise promiseWithValue:@3]]];
+    XCTAssertEqualObjects(all.value, (@[@1, [NSNull null], @3]));
+
+    // all -- First Error Rejects And Cancels The Rest
+    FSPromise * pending = [FSPromise promise];
+    FSPromise * failed = [FSPromise all:@[pending, [FSPromise promiseWithError:error]]];
+    XCTAssertEqual(failed.error.code, (NSInteger)7);
+    XCTAssertTrue(pending.isCancelled);
+
+    // any -- First Value Wins
+    FSPromise * slow = [FSPromise promise];
+    FSPromise * fast = [FSPromise promise];
+    FSPromise * any = [FSPromise any:@[[FSPromise promiseWithError:error], slow, fast]];
+    [fast fulfillWithValue:@"fast"];
+    XCTAssertEqualObjects(any.value, @"fast");
+    XCTAssertTrue(slow.isCancelled);
+
+    // any -- Every Rejection, Or Nothing To Wait On
+    XCTAssertEqual([FSPromise any:@[[FSPromise promiseWithError:error]]].error.code, (NSInteger)7);
+    XCTAssertEqual([FSPromise any:@[]].error.code, (NSInteger)FSPromiseErrorNoneFulfilled);
+
+    // then -- Values, Promises And Errors
+    FSPromise * chained = [[[FSPromise promiseWithValue:@2] then:^id(NSNumber * value) {
+        return @(value.intValue * 2);
+    }] then:^id(NSNumber * value) {
+        return [FSPromise promiseWithValue:@(value.intValue + 1)];
+    }];
+    XCTAssertEqualObjects(chained.value, @5);
+
+    __block BOOL ranAfterError = NO;
+    FSPromise * rejected = [[[FSPromise promiseWithValue:@2] then:^id(id value) {
+        return error;
+    }] then:^id(id value) {
+        ranAfterError = YES;
+        return value;
+    }];
+    XCTAssertEqual(rejected.error.code, (NSInteger)7);
+    XCTAssertFalse(ranAfterError);
+
+    // Cancelling A Step Cancels What It Waits On
+    FSPromise * root = [FSPromise promise];
+    [[root then:^id(id value) {
+        return value;
+    }] cancel];
+    XCTAssertTrue(root.isCancelled);
+    XCTAssertFalse([root fulfillWithValue:@1]);
+}
+
+- (void) testPromiseCreateLoadSend
+{
+    FSChatManager * chatManager = [FireSuite chatManager];
+    __block NSString * chatId;
+
+    FSBenchmark * benchmark = [FSBenchmark benchmarkWithName:@"promises.createLoadSend"];
+    NSDictionary * before = [_database stats];
+    NSTimeInterval start = FSBenchmarkNow();
+    FSPromise * chain = [[[[chatManager createNewChatForUsers:@[kCurrentUserId, kOtherUserId] withCustomId:nil] then:^id(NSString * newChatId) {
+        chatId = newChatId;
+        return [chatManager openChatSessionWithChatId:newChatId andNumberOfRecentMessages:50];
+    }] then:^id(NSDictionary * response) {
+        NSMutableArray * sends = [NSMutableArray arrayWithCapacity:kPromiseSends];
+        for (NSUInteger i = 0; i < kPromiseSends; i++) {
+            [sends addObject:[chatManager sendMessage:[NSString stringWithFormat:@"Promise %lu", (unsigned long)i]]];
+        }
+        return [FSPromise all:sends];
+    }] withDeadline:kTimeout];
+
+    dispatch_semaphore_t finished = dispatch_semaphore_create(0);
+    [chain addCompletionBlock:^(id value, NSError * error) {
+        dispatch_semaphore_signal(finished);
+    }];
+    [self waitForSemaphore:finished];
+    [benchmark setOperations:kPromiseSends completedInDuration:FSBenchmarkNow() - start];
+
+    benchmark.backendStats = [self statsDeltaFrom:before];
+    benchmark.parameters = @{@"sends": @(kPromiseSends), @"latencyMs": @(_database.latency * 1000)};
+    [FSBenchmark recordBenchmark:benchmark];
+
+    // Every Send Acknowledged And Counted
+    XCTAssertNil(chain.error);
+    XCTAssertEqual([chain.value count], kPromiseSends);
+    XCTAssertEqualObjects([_database valueAtPath:[NSString stringWithFormat:@"Chats/%@/header/messageCount", chatId]], @(kPromiseSends));
+}
+
+- (void) testPromiseCancellationRemovesObservers
+{
+    [self seedChatWithId:@"promiseChat" messageCount:100];
+    _database.latency = MAX(_database.latency, 0.05);
+    [_database waitUntilIdleWithTimeout:kTimeout];
+    NSUInteger listeners = _database.activeListeners;
+
+    // Cancel Both Before Either Can Settle
+    FSPromise * load = [[FireSuite chatManager] openChatSessionWithChatId:@"promiseChat" andNumberOfRecentMessages:50];
+    FSPromise * status = [[FireSuite presenceManager] userStatusForUserId:kOtherUserId];
+    [[FSPromise all:@[load, status]] cancel];
+    XCTAssertEqual(load.error.code, (NSInteger)FSPromiseErrorCancelled);
+    XCTAssertEqual(status.error.code, (NSInteger)FSPromiseErrorCancelled);
+
+    // The Session Behind The Load Ends, Its Queries With It
+    [_database waitUntilIdleWithTimeout:kTimeout];
+    XCTAssertNil([FireSuite chatManager].chatId);
+    [_database waitUntilIdleWithTimeout:kTimeout];
+    XCTAssertEqual(_database.activeListeners, listeners);
+}
+
+- (void) testPromiseDeadline
+{
+    // Statuses Can't Arrive In Time
+    _database.latency = 1;
+    [_database waitUntilIdleWithTimeout:kTimeout];
+    NSUInteger listeners = _database.activeListeners;
+
+    FSPromise * status = [[[FireSuite presenceManager] userStatusForUserId:kOtherUserId] withDeadline:0.05];
+    dispatch_semaphore_t finished = dispatch_semaphore_create(0);
+    [status addCompletionBlock:^(id value, NSError * error) {
+        dispatch_semaphore_signal(finished);
+    }];
+    [self waitForSemaphore:finished];
+    XCTAssertEqual(status.error.code, (NSInteger)FSPromiseErrorTimedOut);
+
+    // The Observer Is Gone Once The Manager Catches Up
+    dispatch_semaphore_t stopped = dispatch_semaphore_create(0);
+    [[FireSuite presenceManager] stopPresenceMonitorWithCompletion:^{
+        dispatch_semaphore_signal(stopped);
+    }];
+    [self waitForSemaphore:stopped];
+    [_database waitUntilIdleWithTimeout:kTimeout];
+    XCTAssertEqual(_database.activeListeners, listeners);
+}
+
+#pragma mark OUTBOX
+
+- (NSString *) outboxPathWithName:(NSString *)name {
+    NSString * path = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"FireSuiteTests-%@.outbox", name]];
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+    return path;
+}
+
+- (FSContext *) contextWithOutboxAtPath:(NSString *)path {
+    FSContext * context = [FSContext contextWithFirebaseURL:kBenchmarkURL currentUserId:kCurrentUserId];
+    context.callbackQueue = _firebaseQueue;
+    context.outbox = [FSOutbox outboxWithPath:path];
+    return context;
+}
+
+/*!
+ Keep resuming @param outbox, as reconnects would, until @param count entries are left
+ */
+- (void) waitForOutbox:(FSOutbox *)outbox pendingCount:(NSUInteger)count {
+    NSTimeInterval deadline = FSBenchmarkNow() + kTimeout;
+    while (outbox.pendingCount != count && FSBenchmarkNow() < deadline) {
+        [outbox drain];
+        [NSThread sleepForTimeInterval:0.01];
+    }
+    XCTAssertEqual(outbox.pendingCount, count, @"Timed out waiting for the outbox");
+}
+
+- (void) assertChat:(NSString *)chatId hasMessageCount:(NSUInteger)count {
+    [_database waitUntilIdleWithTimeout:kTimeout];
+    XCTAssertEqual([[_database valueAtPath:[NSString stringWithFormat:@"Chats/%@/messages", chatId]] count], count);
+    XCTAssertEqualObjects([_database valueAtPath:[NSString stringWithFormat:@"Chats/%@/header/messageCount", chatId]], @(count));
+    XCTAssertEqual([[_database valueAtPath:[NSString stringWithFormat:@"Users/%@/alerts", kOtherUserId]] count], count);
+}
+
+- (void) testOutboxSurvivesWriteFailures
+{
+    [self seedChatWithId:@"outboxChat" messageCount:0];
+    NSString * path = [self outboxPathWithName:@"failures"];
+    FSContext * context = [self contextWithOutboxAtPath:path];
+    [self waitForPromise:[context.chatManager openChatSessionWithChatId:@"outboxChat" andNumberOfRecentMessages:50]];
+
+    // Half Of All Writes And Transactions Fail
+    _database.randomSeed = 42;
+    _database.writeFailureRate = 0.5;
+
+    NSMutableArray * sends = [NSMutableArray arrayWithCapacity:kOutboxMessages];
+    for (NSUInteger i = 0; i < kOutboxMessages; i++) {
+        [sends addObject:[context.chatManager sendMessage:[NSString stringWithFormat:@"Outbox %lu", (unsigned long)i]]];
+    }
+    FSPromise * sent = [FSPromise all:sends];
+    [self waitForOutbox:context.outbox pendingCount:0];
+    _database.writeFailureRate = 0;
+
+    // Every Message, Count And Alert Exactly Once
+    XCTAssertTrue(sent.isSettled);
+    XCTAssertNil(sent.error);
+    [self assertChat:@"outboxChat" hasMessageCount:kOutboxMessages];
+
+    // Empty Journal Is Compacted To Its First Line
+    NSString * journal = [NSString stringWithContentsOfFile:path encoding:NSUTF8StringEncoding error:nil];
+    XCTAssertEqual([journal componentsSeparatedByString:@"\n"].count, (NSUInteger)2);
+
+    [self waitForPromise:[context.chatManager endChatSession]];
+}
+
+- (void) testOutboxReplayAfterCrash
+{
+    [self seedChatWithId:@"outboxChat" messageCount:0];
+    NSString * path = [self outboxPathWithName:@"crash"];
+    FSContext * context = [self contextWithOutboxAtPath:path];
+    [self waitForPromise:[context.chatManager openChatSessionWithChatId:@"outboxChat" andNumberOfRecentMessages:50]];
+
+    // Offline -- Every Message Is Journaled, Nothing Acknowledged, No Alert Queued Ahead Of Its Message
+    [_database disconnect];
+    for (NSUInteger i = 0; i < kOutboxMessages; i++) {
+        [context.chatManager sendNewMessage:[NSString stringWithFormat:@"Outbox %lu", (unsigned long)i]];
+    }
+    [self waitForOutbox:context.outbox pendingCount:kOutboxMessages];
+
+    // The Journal As A Crash Would Leave It -- Sent, But Not Yet Marked Done
+    NSString * crashedPath = [self outboxPathWithName:@"crashed"];
+    XCTAssertTrue([[NSFileManager defaultManager] copyItemAtPath:path toPath:crashedPath error:nil]);
+
+    [_database reconnect];
+    [self waitForOutbox:context.outbox pendingCount:0];
+    [self assertChat:@"outboxChat" hasMessageCount:kOutboxMessages];
+    [self waitForPromise:[context.chatManager endChatSession]];
+
+    // The Replayed Messages Still Owe Their Alerts
+    [_database setValue:nil andPriority:nil atPath:[NSString stringWithFormat:@"Users/%@/alerts", kOtherUserId]];
+
+    // Relaunch -- Replays Every Entry In Batches
+    FSBenchmark * benchmark = [FSBenchmark benchmarkWithName:@"outbox.replay"];
+    NSDictionary * before = [_database stats];
+    NSTimeInterval start = FSBenchmarkNow();
+    FSContext * relaunched = [self contextWithOutboxAtPath:crashedPath];
+    XCTAssertEqual(relaunched.outbox.pendingCount, kOutboxMessages);
+    XCTAssertEqualObjects(relaunched.outbox.outboxId, context.outbox.outboxId);
+    [self waitForOutbox:relaunched.outbox pendingCount:0];
+    [benchmark setOperations:kOutboxMessages completedInDuration:FSBenchmarkNow() - start];
+
+    NSDictionary * stats = [self statsDeltaFrom:before];
+    benchmark.backendStats = stats;
+    benchmark.parameters = @{@"entries": @(kOutboxMessages), @"batchSize": @(relaunched.outbox.batchSize), @"latencyMs": @(_database.latency * 1000)};
+    [FSBenchmark recordBenchmark:benchmark];
+
+    // Nothing Doubled, And Batched Rather Than One Write Per Entry
+    [self assertChat:@"outboxChat" hasMessageCount:kOutboxMessages];
+    XCTAssertTrue([stats[kLocalStatWrites] unsignedIntegerValue] < kOutboxMessages / 10, @"%@ writes", stats[kLocalStatWrites]);
+}
+
+- (void) testOutboxFailedLaneDoesNotStallOthers
+{
+    FSOutbox * outbox = [FSOutbox outboxWithPath:[self outboxPathWithName:@"lanes"]];
+    outbox.retryPolicy = [FSRetryPolicy policyWithMaxAttempts:0 baseDelay:0.01 maxDelay:0.05];
+
+    // "flaky" Fails Twice, "denied" Always -- Nothing Calls drain
+    NSError * transient = [NSError errorWithDomain:kFSLocalDatabaseErrorDomain code:FSLocalErrorNetworkError userInfo:nil];
+    NSError * denied = [NSError errorWithDomain:kFSLocalDatabaseErrorDomain code:FSLocalErrorPermissionDenied userInfo:nil];
+    __block NSUInteger flakyAttempts = 0;
+    [outbox setSender:^(NSArray *entries, void (^done)(NSError *)) {
+        NSString * lane = entries[0][kOutboxEntryLane];
+        if ([lane isEqualToString:@"denied"]) done(denied);
+        else if ([lane isEqualToString:@"flaky"] && ++flakyAttempts <= 2) done(transient);
+        else done(nil);
+    } forKind:@"test"];
+
+    __block NSUInteger deadLetters = 0;
+    [outbox setDeadLetterHandler:^(NSArray *entries, NSError *error) {
+        XCTAssertEqualObjects(error, denied);
+        deadLetters += entries.count;
+    } forKind:@"test"];
+
+    NSMutableDictionary * errors = [NSMutableDictionary new];
+    dispatch_semaphore_t finished = dispatch_semaphore_create(0);
+    for (NSString * lane in @[@"denied", @"flaky", @"healthy"]) {
+        NSDictionary * entry = [FSOutbox entryWithKind:@"test" lane:lane key:lane payload:@{}];
+        XCTAssertTrue([outbox enqueueEntry:entry completion:^(NSError *error) {
+            @synchronized (errors) {
+                errors[lane] = error ?: [NSNull null];
+            }
+            dispatch_semaphore_signal(finished);
+        } error:nil]);
+    }
+    for (NSUInteger i = 0; i < 3; i++) [self waitForSemaphore:finished];
+
+    // Dropped, Retried On Its Own Timer, And Untouched
+    XCTAssertEqualObjects(errors[@"denied"], denied);
+    XCTAssertEqualObjects(errors[@"flaky"], [NSNull null]);
+    XCTAssertEqualObjects(errors[@"healthy"], [NSNull null]);
+    XCTAssertEqual(flakyAttempts, (NSUInteger)3);
+    XCTAssertEqual(deadLetters, (NSUInteger)1);
+    XCTAssertEqual(outbox.pendingCount, (NSUInteger)0);
+    XCTAssertNil(outbox.lastError);
+}
+
+#pragma mark RETRIES
+
+- (void) testRetryPolicyBackoffAndClassification
+{
+    FSRetryPolicy * policy = [FSRetryPolicy policyWithMaxAttempts:6 baseDelay:0.1 maxDelay:1];
+    policy.jitter = 0;
+    XCTAssertEqualWithAccuracy([policy delayBeforeRetry:1], 0.1, 1e-9);
+    XCTAssertEqualWithAccuracy([policy delayBeforeRetry:3], 0.4, 1e-9);
+    XCTAssertEqualWithAccuracy([policy delayBeforeRetry:5], 1.0, 1e-9);
+
+    // Jitter Only Ever Shortens A Delay
+    policy.jitter = 0.5;
+    for (NSUInteger i = 0; i < 100; i++) {
+        NSTimeInterval delay = [policy delayBeforeRetry:2];
+        XCTAssertTrue(delay >= 0.1 && delay <= 0.2, @"%f", delay);
+    }
+
+    XCTAssertTrue(FSRetryIsTransientError([NSError errorWithDomain:kFSLocalDatabaseErrorDomain code:FSLocalErrorNetworkError userInfo:nil]));
+    XCTAssertTrue(FSRetryIsTransientError([NSError errorWithDomain:kFSLocalDatabaseErrorDomain code:FSLocalErrorMaxRetries userInfo:nil]));
+    XCTAssertFalse(FSRetryIsTransientError([NSError errorWithDomain:kFSLocalDatabaseErrorDomain code:FSLocalErrorPermissionDenied userInfo:nil]));
+    XCTAssertFalse(FSRetryIsTransientError(nil));
+
+    // Overrides Win, Copied So Later Edits Don't Leak In
+    FSRetrier * retrier = [FSRetrier new];
+    [retrier setPolicy:[FSRetryPolicy noRetryPolicy] forOperation:kFSOperationSendAlert];
+    XCTAssertEqual([retrier policyForOperation:kFSOperationSendAlert].maxAttempts, (NSUInteger)1);
+    XCTAssertEqual([retrier policyForOperation:kFSOperationSendMessage].maxAttempts, retrier.defaultPolicy.maxAttempts);
+    policy.maxAttempts = 2;
+    [retrier setPolicy:policy forOperation:kFSOperationSendMessage];
+    policy.maxAttempts = 3;
+    XCTAssertEqual([retrier policyForOperation:kFSOperationSendMessage].maxAttempts, (NSUInteger)2);
+}
+
+- (void) testRetriesAbsorbTransientFailures
+{
+    [self seedChatWithId:@"retryChat" messageCount:0];
+    FSContext * context = [FSContext contextWithFirebaseURL:kBenchmarkURL currentUserId:kCurrentUserId];
+    context.callbackQueue = _firebaseQueue;
+    context.retrier.defaultPolicy = [FSRetryPolicy policyWithMaxAttempts:8 baseDelay:0.01 maxDelay:0.2];
+    [self waitForPromise:[context.chatManager openChatSessionWithChatId:@"retryChat" andNumberOfRecentMessages:50]];
+
+    // One In Ten Writes And Transactions Fail
+    _database.randomSeed = 7;
+    _database.writeFailureRate = 0.1;
+
+    FSBenchmark * benchmark = [FSBenchmark benchmarkWithName:@"retries.transientFailures"];
+    NSDictionary * before = [_database stats];
+    NSTimeInterval start = FSBenchmarkNow();
+    NSMutableArray * sends = [NSMutableArray arrayWithCapacity:kRetryMessages];
+    for (NSUInteger i = 0; i < kRetryMessages; i++) {
+        [sends addObject:[context.chatManager sendMessage:[NSString stringWithFormat:@"Retry %lu", (unsigned long)i]]];
+    }
+    FSPromise * sent = [FSPromise all:sends];
+    [self waitForPromise:sent];
+    [benchmark setOperations:kRetryMessages completedInDuration:FSBenchmarkNow() - start];
+
+    // Header And Alert Retries Wait On Timers The Database Can't See
+    NSString * countPath = @"Chats/retryChat/header/messageCount";
+    NSString * alertsPath = [NSString stringWithFormat:@"Users/%@/alerts", kOtherUserId];
+    NSTimeInterval deadline = FSBenchmarkNow() + kTimeout;
+    while ((![[_database valueAtPath:countPath] isEqual:@(kRetryMessages)] || [[_database valueAtPath:alertsPath] count] < kRetryMessages) && FSBenchmarkNow() < deadline) {
+        [NSThread sleepForTimeInterval:0.01];
+    }
+    _database.writeFailureRate = 0;
+
+    FSMetrics * metrics = context.metrics;
+    benchmark.backendStats = [self statsDeltaFrom:before];
+    benchmark.parameters = @{@"messages": @(kRetryMessages), @"writeFailureRate": @0.1, @"retries": @([metrics retries]), @"latencyMs": @(_database.latency * 1000)};
+    [FSBenchmark recordBenchmark:benchmark];
+
+    // Every Failure Recovered -- Nothing Lost, Nothing Doubled
+    XCTAssertNil(sent.error);
+    XCTAssertTrue([metrics retries] > 0);
+    XCTAssertEqual([metrics retriesDenied], 0LL);
+    XCTAssertTrue([[metrics metricsForOperation:kFSOperationSendMessage] retries] > 0);
+    [self assertChat:@"retryChat" hasMessageCount:kRetryMessages];
+
+    [self waitForPromise:[context.chatManager endChatSession]];
+}
+
+- (void) testRetryBudgetCapsExtraLoad
+{
+    FSContext * context = [FSContext contextWithFirebaseURL:kBenchmarkURL currentUserId:kCurrentUserId];
+    context.callbackQueue = _firebaseQueue;
+    context.retrier.defaultPolicy = [FSRetryPolicy policyWithMaxAttempts:4 baseDelay:0.001 maxDelay:0.01];
+    context.retrier.budgetCapacity = 5;
+
+    // Hard Down -- Every Write Fails
+    _database.writeFailureRate = 1;
+
+    __block int64_t remaining = kRetryAlerts;
+    dispatch_semaphore_t finished = dispatch_semaphore_create(0);
+    for (NSUInteger i = 0; i < kRetryAlerts; i++) {
+        [context.channelManager sendAlertToUserId:kOtherUserId withAlertType:kAlertTypeNewMessage andData:@{@"i": @(i)} withCompletion:^(NSError *error) {
+            XCTAssertNotNil(error);
+            if (__sync_sub_and_fetch(&remaining, 1) == 0) dispatch_semaphore_signal(finished);
+        }];
+    }
+    [self waitForSemaphore:finished];
+    _database.writeFailureRate = 0;
+
+    // Unbudgeted, Each Alert Would Be Tried 4 Times -- The Budget Allows Its Capacity Plus A Fifth Per Call
+    FSMetrics * metrics = context.metrics;
+    int64_t retries = [metrics retries];
+    XCTAssertTrue(retries <= 5 + kRetryAlerts / 5, @"%lld retries", retries);
+    XCTAssertTrue([metrics retriesDenied] > 0);
+    XCTAssertEqual([[metrics metricsForOperation:kFSOperationSendAlert] retries], retries);
+
+    // Permission Failures Are Never Retried
+    context.retrier.budgetCapacity = 5;
+    [_database denyAccessToPath:@"Users/deniedUser"];
+    dispatch_semaphore_t denied = dispatch_semaphore_create(0);
+    [context.channelManager sendAlertToUserId:@"deniedUser" withAlertType:kAlertTypeNewMessage andData:@{} withCompletion:^(NSError *error) {
+        XCTAssertEqual(error.code, (NSInteger)FSLocalErrorPermissionDenied);
+        dispatch_semaphore_signal(denied);
+    }];
+    [self waitForSemaphore:denied];
+    XCTAssertEqual([metrics retries], retries);
+}
+
+#pragma mark DECODE POOL
+
+/*!
+ How long getting onto the chat manager's state queue takes while @param work runs -- each probe waits behind whatever is queued there
+ */
+- (FSBenchmark *) stateQueueStallsNamed:(NSString *)name during:(void (^)(dispatch_block_t done))work {
+    FSBenchmark * stalls = [FSBenchmark benchmarkWithName:name];
+    FSChatManager * chatManager = [FireSuite chatManager];
+    dispatch_semaphore_t finished = dispatch_semaphore_create(0);
+
+    NSTimeInterval start = FSBenchmarkNow();
+    dispatch_async(_firebaseQueue, ^{
+        work(^{
+            dispatch_semaphore_signal(finished);
+        });
+    });
+    while (dispatch_semaphore_wait(finished, DISPATCH_TIME_NOW) != 0) {
+        NSTimeInterval probe = FSBenchmarkNow();
+        [chatManager chatId];
+        [stalls addSample:FSBenchmarkNow() - probe];
+        if (FSBenchmarkNow() - start > kTimeout) {
+            XCTFail(@"Timed out waiting for FireSuite");
+            break;
+        }
+        [NSThread sleepForTimeInterval:0.001];
+    }
+    [stalls setOperations:1 completedInDuration:FSBenchmarkNow() - start];
+    return stalls;
+}
+
+- (void) testDecodePoolLoadStateQueueOccupancy
+{
+    NSString * chatId = [self seedChatWithId:@"decodeChat" messageCount:kDecodeMessages];
+
+    __block NSArray * messages;
+    void (^load)(dispatch_block_t) = ^(dispatch_block_t done) {
+        _loadFinished = ^(NSDictionary * response) {
+            messages = response[kResponseMessages];
+            done();
+        };
+        [[FireSuite chatManager] loadChatSessionWithChatId:chatId andNumberOfRecentMessages:(int)kDecodeMessages];
+    };
+
+    // Before -- Every Message Built On The State Queue
+    [FireSuite chatManager].decodePool = nil;
+    FSBenchmark * inlined = [self stateQueueStallsNamed:@"decodePool.load10k.inline" during:load];
+    NSArray * inlinedMessages = messages;
+    [self endChat];
+
+    // After -- Built On The Pool, Handed Back In Order
+    [FireSuite chatManager].decodePool = [FSDecodePool singleton];
+    FSBenchmark * pooled = [self stateQueueStallsNamed:@"decodePool.load10k.pooled" during:load];
+    [self endChat];
+
+    NSDictionary * parameters = @{@"messages": @(kDecodeMessages), @"poolWidth": @([FSDecodePool singleton].width), @"latencyMs": @(_database.latency * 1000)};
+    inlined.parameters = parameters;
+    pooled.parameters = parameters;
+    [FSBenchmark recordBenchmark:inlined];
+    [FSBenchmark recordBenchmark:pooled];
+
+    // Same Messages, Same Order
+    XCTAssertEqual(messages.count, kDecodeMessages);
+    XCTAssertEqualObjects(messages, inlinedMessages);
+    XCTAssertTrue([pooled percentile:99] <= [inlined percentile:99], @"pooled p99 %f, inline p99 %f", [pooled percentile:99], [inlined percentile:99]);
+}
+
+- (void) testDecodePoolHeadersStateQueueOccupancy
+{
+    [self seedHeadersWithChatCount:kDecodeChats];
+
+    __block NSUInteger headerCount = 0;
+    void (^fetch)(dispatch_block_t) = ^(dispatch_block_t done) {
+        [[FireSuite chatManager] getChatHeadersForUserId:kCurrentUserId WithCompletionBlock:^(NSArray *headers, NSError *error) {
+            headerCount = headers.count;
+            done();
+        }];
+    };
+
+    [FireSuite chatManager].decodePool = nil;
+    FSBenchmark * inlined = [self stateQueueStallsNamed:@"decodePool.headers5k.inline" during:fetch];
+    XCTAssertEqual(headerCount, kDecodeChats);
+
+    [FireSuite chatManager].decodePool = [FSDecodePool singleton];
+    FSBenchmark * pooled = [self stateQueueStallsNamed:@"decodePool.headers5k.pooled" during:fetch];
+    XCTAssertEqual(headerCount, kDecodeChats);
+
+    NSDictionary * parameters = @{@"chats": @(kDecodeChats), @"poolWidth": @([FSDecodePool singleton].width), @"latencyMs": @(_database.latency * 1000)};
+    inlined.parameters = parameters;
+    pooled.parameters = parameters;
+    [FSBenchmark recordBenchmark:inlined];
+    [FSBenchmark recordBenchmark:pooled];
+}
+
+- (void) testDecodeStreamPreservesOrder
+{
+    FSDecodePool * pool = [[FSDecodePool alloc] initWithWidth:4];
+    FSDecodeStream * stream = [pool streamWithTargetQueue:_firebaseQueue];
+
+    NSMutableArray * results = [NSMutableArray new];
+    dispatch_semaphore_t finished = dispatch_semaphore_create(0);
+    for (NSUInteger i = 0; i < 1000; i++) {
+        [stream decode:^id{
+            // Later Ones Often Finish First
+            if (i % 7 == 0) [NSThread sleepForTimeInterval:0.0005];
+            return @(i);
+        } completion:^(id value) {
+            [results addObject:value];
+            if (results.count == 1000) dispatch_semaphore_signal(finished);
+        }];
+    }
+    [self waitForSemaphore:finished];
+
+    for (NSUInteger i = 0; i < results.count; i++) XCTAssertEqualObjects(results[i], @(i));
+    XCTAssertTrue([pool runningCount] <= pool.width);
+}
+
+#pragma mark LOAD GENERATOR
+
+- (void) testLoadGeneratorRunsEveryAction
+{
+    // Short And Busy -- Every Action Fires Many Times
+    FSLoadScenario * scenario = [FSLoadScenario scenarioWithName:@"smoke"];
+    scenario.users = kLoadUsers;
+    scenario.duration = 2;
+    scenario.groupSize = 3;
+    scenario.chatsPerUserPerMinute = 30;
+    scenario.messagesPerUserPerMinute = 120;
+    scenario.presenceFlapsPerUserPerMinute = 30;
+    scenario.alertsPerUserPerMinute = 60;
+
+    FSLoadGenerator * generator = [[FSLoadGenerator alloc] initWithFirebaseURL:kBenchmarkURL];
+    FSLocalDatabase * database = _database;
+    generator.backendStats = ^NSDictionary *{
+        return [database stats];
+    };
+
+    NSDictionary * report = [generator runScenario:scenario];
+
+    for (NSString * action in @[kLoadActionCreateChat, kLoadActionSendMessage, kLoadActionPresenceFlap, kLoadActionSendAlert]) {
+        NSDictionary * actionReport = report[kLoadReportActions][action];
+        XCTAssertTrue([actionReport[kLoadReportCompleted] integerValue] > 0, @"%@ never completed", action);
+        XCTAssertEqual([actionReport[kLoadReportErrors] integerValue], 0, @"%@ failed", action);
+        XCTAssertEqual([actionReport[kLoadReportIssued] integerValue], [actionReport[kLoadReportCompleted] integerValue], @"%@ left in flight", action);
+    }
+    XCTAssertTrue([report[kLoadReportAlertsReceived] integerValue] > 0);
+    XCTAssertTrue([report[kLoadReportBackend][kLocalStatWrites] integerValue] > 0);
+    XCTAssertTrue([report[kLoadReportClient][kMetricsRoundTrips] integerValue] > 0);
+
+    // Plain Values Only -- The Tool Writes It Straight Out
+    XCTAssertTrue([NSJSONSerialization isValidJSONObject:report]);
+
+    // The Default Context Sat It Out
+    XCTAssertEqual([[[FireSuite metrics] metricsForOperation:kFSOperationSendMessage] calls], 0LL);
+}
+
+#pragma mark GROUP FAN OUT
+
+/*!
+ A header-only chat -- kCurrentUserId first, then groupUser1...
+ */
+- (NSArray *) seedGroupChatWithId:(NSString *)chatId memberCount:(NSUInteger)count {
+    NSMutableArray * members = [NSMutableArray arrayWithObject:kCurrentUserId];
+    for (NSUInteger i = 1; i < count; i++) {
+        [members addObject:[NSString stringWithFormat:@"groupUser%lu", (unsigned long)i]];
+    }
+
+    NSString * timestamp = [self timestampWithOffset:-1];
+    NSMutableDictionary * header = [[self headerWithTimestamp:timestamp messageCount:0] mutableCopy];
+    header[kHeaderUsers] = members;
+    [_database setValue:@{kChatHeader: header} andPriority:timestamp atPath:[NSString stringWithFormat:@"Chats/%@", chatId]];
+    return members;
+}
+
+- (NSDictionary *) alertsForUserId:(NSString *)userId {
+    id alerts = [_database valueAtPath:[NSString stringWithFormat:@"Users/%@/alerts", userId]];
+    return [alerts isKindOfClass:[NSDictionary class]] ? alerts : @{};
+}
+
+- (void) testGroupSendFansOutInChunks
+{
+    NSArray * members = [self seedGroupChatWithId:@"groupChat" memberCount:kFanOutMembers + 1];
+    [self loadChatWithId:@"groupChat" numberOfMessages:10];
+    [FireSuite channelManager].fanOutChunkSize = kFanOutChunkSize;
+
+    NSDictionary * before = [_database stats];
+    NSDictionary * message = [self waitForPromise:[[FireSuite chatManager] sendMessage:@"Hello, group"]];
+    NSDictionary * backend = [self statsDeltaFrom:before];
+    XCTAssertNotNil(message);
+
+    // Every Other Member Holds One Compact Alert -- Not The Message Itself
+    for (NSString * member in [members subarrayWithRange:NSMakeRange(1, kFanOutMembers)]) {
+        NSDictionary * alerts = [self alertsForUserId:member];
+        XCTAssertEqual(alerts.count, 1U, @"%@", member);
+
+        NSDictionary * alert = [[alerts allValues] firstObject];
+        XCTAssertEqualObjects(alert[kAlertType], kAlertTypeNewGroupMessage);
+        XCTAssertEqualObjects(alert[kAlertData][kMessageChatId], @"groupChat");
+        XCTAssertEqualObjects(alert[kAlertData][kMessageSentBy], kCurrentUserId);
+        XCTAssertNotNil(alert[kAlertData][kMessageId]);
+        XCTAssertNil(alert[kAlertData][kMessageContent]);
+    }
+    XCTAssertEqual([self alertsForUserId:kCurrentUserId].count, 0U);
+
+    // 250 Members, 100 Per Write
+    XCTAssertEqual([[[FireSuite metrics] metricsForOperation:kFSOperationFanOutAlert] calls], 3LL);
+    XCTAssertTrue([backend[kLocalStatWrites] integerValue] < 10, @"%@", backend);
+
+    [FireSuite channelManager].fanOutChunkSize = 100;
+}
+
+- (void) testGroupFanOutThresholdSwitchesToPull
+{
+    NSArray * members = [self seedGroupChatWithId:@"bigGroupChat" memberCount:21];
+    [self loadChatWithId:@"bigGroupChat" numberOfMessages:10];
+    [FireSuite chatManager].fanOutThreshold = 10;
+
+    XCTAssertNotNil([self waitForPromise:[[FireSuite chatManager] sendMessage:@"Hello, everyone"]]);
+    [_database waitUntilIdleWithTimeout:kTimeout];
+
+    // No Alerts -- Members Find The Message Through The Header
+    for (NSString * member in members) {
+        XCTAssertEqual([self alertsForUserId:member].count, 0U, @"%@", member);
+    }
+    XCTAssertEqual([[[FireSuite metrics] metricsForOperation:kFSOperationFanOutAlert] calls], 0LL);
+    XCTAssertEqualObjects([_database valueAtPath:[NSString stringWithFormat:@"Chats/bigGroupChat/%@/%@", kChatHeader, kHeaderLastMessage]][kMessageContent], @"Hello, everyone");
+
+    [FireSuite chatManager].fanOutThreshold = 100;
+}
+
+- (void) testGroupFanOutVersusPerMemberAlerts
+{
+    NSMutableArray * recipients = [NSMutableArray arrayWithCapacity:kFanOutMembers];
+    for (NSUInteger i = 0; i < kFanOutMembers; i++) {
+        [recipients addObject:[NSString stringWithFormat:@"groupUser%lu", (unsigned long)i]];
+    }
+    FSChannelManager * channelManager = [FireSuite channelManager];
+    NSDictionary * parameters = @{@"members": @(kFanOutMembers), @"chunkSize": @(channelManager.fanOutChunkSize), @"iterations": @(kFanOutIterations), @"latencyMs": @(_database.latency * 1000)};
+
+    // One Alert Per Member, As Groups Had To Before
+    FSBenchmark * perMember = [FSBenchmark benchmarkWithName:@"groupFanOut.perMemberAlerts"];
+    NSDictionary * before = [_database stats];
+    for (NSUInteger i = 0; i < kFanOutIterations; i++) {
+        NSMutableArray * sends = [NSMutableArray arrayWithCapacity:kFanOutMembers];
+        NSTimeInterval start = FSBenchmarkNow();
+        for (NSString * userId in recipients) {
+            [sends addObject:[channelManager sendAlertToUserId:userId withAlertType:kAlertTypeNewGroupMessage andData:@{kMessageChatId: @"groupChat"}]];
+        }
+        [self waitForPromise:[FSPromise all:sends]];
+        [perMember addSample:FSBenchmarkNow() - start];
+    }
+    perMember.backendStats = [self statsDeltaFrom:before];
+    perMember.parameters = parameters;
+    [FSBenchmark recordBenchmark:perMember];
+
+    // One Chunked Multi-Location Write
+    FSBenchmark * chunked = [FSBenchmark benchmarkWithName:@"groupFanOut.chunked"];
+    before = [_database stats];
+    for (NSUInteger i = 0; i < kFanOutIterations; i++) {
+        NSTimeInterval start = FSBenchmarkNow();
+        [self waitForPromise:[channelManager sendAlertToUserIds:recipients withAlertType:kAlertTypeNewGroupMessage andData:@{kMessageChatId: @"groupChat"}]];
+        [chunked addSample:FSBenchmarkNow() - start];
+    }
+    chunked.backendStats = [self statsDeltaFrom:before];
+    chunked.parameters = parameters;
+    [FSBenchmark recordBenchmark:chunked];
+
+    // Same Alerts Landed, In A Fraction Of The Writes
+    for (NSString * userId in recipients) {
+        XCTAssertEqual([self alertsForUserId:userId].count, kFanOutIterations * 2, @"%@", userId);
+    }
+    XCTAssertTrue([chunked.backendStats[kLocalStatWrites] integerValue] * 10 <= [perMember.backendStats[kLocalStatWrites] integerValue], @"chunked %@, per member %@", chunked.backendStats, perMember.backendStats);
+}
+
+#pragma mark ARCHIVE
+
+/*!
+ kArchiveDays of history, kArchiveMessagesPerDay a day from 01:00 UTC, then a day's worth sent just now -- @return every message id, oldest first
+ */
+- (NSArray *) seedHistoryWithChatId:(NSString *)chatId {
+    double day = 24 * 60 * 60 * 1000;
+    double now = [[NSDate date] timeIntervalSince1970] * 1000;
+    double midnight = floor(now / day) * day;
+
+    NSUInteger count = (kArchiveDays + 1) * kArchiveMessagesPerDay;
+    NSMutableDictionary * messages = [NSMutableDictionary dictionaryWithCapacity:count];
+    NSMutableArray * messageIds = [NSMutableArray arrayWithCapacity:count];
+    NSString * lastTimestamp;
+
+    for (NSUInteger i = 0; i < count; i++) {
+        NSUInteger daysAgo = kArchiveDays - i / kArchiveMessagesPerDay;
+        NSUInteger n = i % kArchiveMessagesPerDay;
+        double time = daysAgo > 0 ? midnight - daysAgo * day + 60 * 60 * 1000 + n * 1000 : now - (kArchiveMessagesPerDay - n);
+        lastTimestamp = [NSString stringWithFormat:@"%f", time];
+
+        NSString * messageId = [NSString stringWithFormat:@"m%06lu", (unsigned long)i];
+        [messageIds addObject:messageId];
+        messages[messageId] = @{
+                                kMessageTimestamp: lastTimestamp,
+                                kMessageContent: [NSString stringWithFormat:@"Seeded message %lu, sent %lu days ago", (unsigned long)i, (unsigned long)daysAgo],
+                                kMessageSentBy: i % 2 ? kCurrentUserId : kOtherUserId,
+                                kMessageSentTo: i % 2 ? kOtherUserId : kCurrentUserId,
+                                kMessageChatId: chatId,
+                                @".priority": lastTimestamp,
+                                };
+    }
+
+    NSDictionary * chat = @{kChatHeader: [self headerWithTimestamp:lastTimestamp messageCount:count], kChatMessages: messages};
+    [_database setValue:chat andPriority:lastTimestamp atPath:[NSString stringWithFormat:@"Chats/%@", chatId]];
+    return messageIds;
+}
+
+/*!
+ Every message of @param chatId, oldest first, a page at a time -- each page a sample in @param benchmark
+ */
+- (NSArray *) historyOfChatId:(NSString *)chatId pageSize:(NSUInteger)pageSize benchmark:(FSBenchmark *)benchmark {
+    NSMutableArray * history = [NSMutableArray new];
+    NSString * timestamp;
+
+    while (YES) {
+        NSTimeInterval start = FSBenchmarkNow();
+        NSArray * page = [self waitForPromise:[[FireSuite chatManager] messagesForChatId:chatId beforeTimestamp:timestamp count:pageSize]];
+        [benchmark addSample:FSBenchmarkNow() - start];
+        XCTAssertNotNil(page);
+
+        [history insertObjects:page atIndexes:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, page.count)]];
+        if (page.count < pageSize) break;
+        timestamp = [page firstObject][kMessageTimestamp];
+    }
+    return history;
+}
+
+- (void) testArchiveCompactionPacksOldDays
+{
+    [self seedHistoryWithChatId:@"historyChat"];
+    NSUInteger bytesBefore = FSMetricsEstimatedBytes([_database valueAtPath:@"Chats/historyChat"]);
+
+    // Everything Before Today, One Bucket A Day
+    NSNumber * archived = [self waitForPromise:[[FireSuite chatManager] compactChatWithId:@"historyChat" olderThan:12 * 60 * 60]];
+    XCTAssertEqualObjects(archived, @(kArchiveDays * kArchiveMessagesPerDay));
+    [_database waitUntilIdleWithTimeout:kTimeout];
+
+    XCTAssertEqual([[_database valueAtPath:@"Chats/historyChat/messages"] count], kArchiveMessagesPerDay);
+    XCTAssertEqual([[_database valueAtPath:@"Chats/historyChat/archive"] count], kArchiveDays);
+    XCTAssertEqualObjects([_database valueAtPath:@"Chats/historyChat/header/archivedCount"], archived);
+
+    NSUInteger bytesAfter = FSMetricsEstimatedBytes([_database valueAtPath:@"Chats/historyChat"]);
+    XCTAssertTrue(bytesAfter * 2 < bytesBefore, @"before %lu, after %lu", (unsigned long)bytesBefore, (unsigned long)bytesAfter);
+
+    // A Second Pass Finds Nothing -- And Rewrites Nothing
+    XCTAssertEqualObjects([self waitForPromise:[[FireSuite chatManager] compactChatWithId:@"historyChat" olderThan:12 * 60 * 60]], @0);
+    XCTAssertEqual([[_database valueAtPath:@"Chats/historyChat/archive"] count], kArchiveDays);
+
+    // Sessions Only Wait On Live Messages
+    NSDictionary * response = [self waitForPromise:[[FireSuite chatManager] openChatSessionWithChatId:@"historyChat" andNumberOfRecentMessages:500]];
+    XCTAssertEqual([response[kResponseMessages] count], kArchiveMessagesPerDay);
+    [self endChat];
+}
+
+- (void) testHistoryPagingAcrossArchive
+{
+    NSArray * messageIds = [self seedHistoryWithChatId:@"historyChat"];
+    NSDictionary * parameters = @{@"days": @(kArchiveDays), @"messagesPerDay": @(kArchiveMessagesPerDay), @"pageSize": @(kArchivePageSize), @"latencyMs": @(_database.latency * 1000)};
+
+    // Every Message Still Live
+    FSBenchmark * live = [FSBenchmark benchmarkWithName:@"history.live"];
+    NSDictionary * before = [_database stats];
+    NSArray * liveHistory = [self historyOfChatId:@"historyChat" pageSize:kArchivePageSize benchmark:live];
+    live.backendStats = [self statsDeltaFrom:before];
+    live.parameters = parameters;
+    [FSBenchmark recordBenchmark:live];
+
+    XCTAssertEqualObjects([liveHistory valueForKey:kMessageId], messageIds);
+
+    XCTAssertNotNil([self waitForPromise:[[FireSuite chatManager] compactChatWithId:@"historyChat" olderThan:12 * 60 * 60]]);
+
+    // Same Pages, Mostly From Buckets
+    FSBenchmark * archived = [FSBenchmark benchmarkWithName:@"history.archived"];
+    before = [_database stats];
+    NSArray * archivedHistory = [self historyOfChatId:@"historyChat" pageSize:kArchivePageSize benchmark:archived];
+    archived.backendStats = [self statsDeltaFrom:before];
+    archived.parameters = parameters;
+    [FSBenchmark recordBenchmark:archived];
+
+    XCTAssertEqualObjects(archivedHistory, liveHistory);
+    XCTAssertTrue([archived.backendStats[kLocalStatBytesReceived] longLongValue] * 2 < [live.backendStats[kLocalStatBytesReceived] longLongValue], @"archived %@, live %@", archived.backendStats, live.backendStats);
+}
+
+#pragma mark CHANGE FEED
+
+- (NSDictionary *) headerChangesSinceWatermark:(NSNumber *)watermark forUserId:(NSString *)userId benchmark:(FSBenchmark *)benchmark {
+    NSDictionary * before = [_database stats];
+    NSTimeInterval start = FSBenchmarkNow();
+    NSDictionary * response = [self waitForPromise:[[FireSuite chatManager] chatHeaderChangesForUserId:userId sinceWatermark:watermark]];
+    [benchmark addSample:FSBenchmarkNow() - start];
+    benchmark.backendStats = [self statsDeltaFrom:before];
+    benchmark.parameters = @{@"chats": @(kFeedChats), @"changed": @(kFeedChangedChats), @"latencyMs": @(_database.latency * 1000)};
+    [FSBenchmark recordBenchmark:benchmark];
+    XCTAssertNotNil(response);
+    return response;
+}
+
+- (void) testChatHeaderChangesSinceWatermark
+{
+    [self seedHeadersWithChatCount:kFeedChats];
+
+    // Full Sync -- Nothing Recorded Yet, So The Watermark Starts At 0
+    FSBenchmark * full = [FSBenchmark benchmarkWithName:@"headerSync.full"];
+    NSDictionary * response = [self headerChangesSinceWatermark:nil forUserId:kCurrentUserId benchmark:full];
+    XCTAssertEqual([response[kResponseHeaders] count], kFeedChats);
+    XCTAssertEqualObjects(response[kResponseWatermark], @0);
+    NSNumber * watermark = response[kResponseWatermark];
+
+    // A Few Chats Change
+    NSMutableSet * changedChatIds = [NSMutableSet new];
+    for (NSUInteger i = 0; i < kFeedChangedChats; i++) {
+        NSString * chatId = [NSString stringWithFormat:@"headerChat%lu", (unsigned long)(i * 97)];
+        [changedChatIds addObject:chatId];
+        [self loadChatWithId:chatId numberOfMessages:10];
+        XCTAssertNotNil([self waitForPromise:[[FireSuite chatManager] sendMessage:[NSString stringWithFormat:@"Change %lu", (unsigned long)i]]]);
+        [self endChat];
+    }
+    [_database waitUntilIdleWithTimeout:kTimeout];
+
+    // Only Those Come Back -- Newest Header Included
+    FSBenchmark * delta = [FSBenchmark benchmarkWithName:@"headerSync.delta"];
+    response = [self headerChangesSinceWatermark:watermark forUserId:kCurrentUserId benchmark:delta];
+    XCTAssertEqualObjects([NSSet setWithArray:[response[kResponseHeaders] allKeys]], changedChatIds);
+    XCTAssertEqualObjects(response[kResponseHeaders][@"headerChat0"][kHeaderLastMessage][kMessageContent], @"Change 0");
+    XCTAssertTrue([response[kResponseWatermark] compare:watermark] == NSOrderedDescending);
+    XCTAssertTrue([delta.backendStats[kLocalStatBytesReceived] longLongValue] * 10 < [full.backendStats[kLocalStatBytesReceived] longLongValue], @"delta %@, full %@", delta.backendStats, full.backendStats);
+
+    // Caught Up -- At Most The Changes At The Watermark Itself Repeat
+    response = [self waitForPromise:[[FireSuite chatManager] chatHeaderChangesForUserId:kCurrentUserId sinceWatermark:response[kResponseWatermark]]];
+    XCTAssertTrue([response[kResponseHeaders] count] < kFeedChangedChats, @"%@", response);
+
+    // New Chats Reach Every Member's Feed
+    NSString * newChatId = [self waitForPromise:[[FireSuite chatManager] createNewChatForUsers:@[kCurrentUserId, kOtherUserId] withCustomId:@"feedChat"]];
+    response = [self waitForPromise:[[FireSuite chatManager] chatHeaderChangesForUserId:kOtherUserId sinceWatermark:@0]];
+    XCTAssertEqualObjects([response[kResponseHeaders] allKeys], @[newChatId]);
+}
+
+#pragma mark HEADER PREVIEW
+
+- (void) testHeaderPreviewBoundsInboxBytes
+{
+    [self seedHeadersWithChatCount:kPreviewChats];
+
+    // A Long Paste Into Every Chat -- Ending In An Emoji Right On The Limit
+    NSUInteger previewLength = [FireSuite chatManager].headerPreviewLength;
+    NSString * content = [[@"" stringByPaddingToLength:previewLength - 1 withString:@"a" startingAtIndex:0] stringByAppendingString:@"\U0001F600"];
+    content = [content stringByPaddingToLength:kPreviewContentLength withString:@"b" startingAtIndex:0];
+
+    for (NSUInteger i = 0; i < kPreviewChats; i++) {
+        [self loadChatWithId:[NSString stringWithFormat:@"headerChat%lu", (unsigned long)i] numberOfMessages:10];
+        NSDictionary * message = [self waitForPromise:[[FireSuite chatManager] sendMessage:content]];
+        XCTAssertNotNil(message);
+        [self endChat];
+    }
+    [_database waitUntilIdleWithTimeout:kTimeout];
+
+    // The Preview Points At The Full Message
+    NSDictionary * preview = [_database valueAtPath:[NSString stringWithFormat:@"Chats/headerChat0/%@/%@", kChatHeader, kHeaderLastMessage]];
+    NSString * messageId = preview[kMessageId];
+    XCTAssertEqualObjects([_database valueAtPath:[NSString stringWithFormat:@"Chats/headerChat0/%@/%@/%@", kChatMessages, messageId, kMessageContent]], content);
+    XCTAssertEqualObjects(preview[kMessageContent], [content substringToIndex:previewLength - 1]);
+    XCTAssertEqualObjects(preview[kPreviewTruncated], @YES);
+    XCTAssertEqualObjects(preview[kMessageSentBy], kCurrentUserId);
+    XCTAssertNotNil(preview[kMessageTimestamp]);
+
+    // Inbox Bytes Don't Grow With The Messages
+    FSBenchmark * benchmark = [FSBenchmark benchmarkWithName:@"headerPreview.inbox"];
+    NSDictionary * before = [_database stats];
+    NSTimeInterval start = FSBenchmarkNow();
+    NSArray * headers = [self waitForPromise:[[FireSuite chatManager] chatHeadersForUserId:kCurrentUserId]];
+    [benchmark addSample:FSBenchmarkNow() - start];
+    benchmark.backendStats = [self statsDeltaFrom:before];
+    benchmark.parameters = @{@"chats": @(kPreviewChats), @"contentLength": @(kPreviewContentLength), @"previewLength": @(previewLength), @"latencyMs": @(_database.latency * 1000)};
+    [FSBenchmark recordBenchmark:benchmark];
+
+    XCTAssertEqual(headers.count, kPreviewChats);
+    XCTAssertTrue([benchmark.backendStats[kLocalStatBytesReceived] longLongValue] < (long long)(kPreviewChats * kPreviewContentLength / 10), @"%@", benchmark.backendStats);
+}
+
+#pragma mark SCHEMA
+
+- (NSDictionary *) openSchemaChatWithId:(NSString *)chatId benchmarkName:(NSString *)name storedBytes:(NSUInteger)storedBytes {
+    FSBenchmark * benchmark = [FSBenchmark benchmarkWithName:name];
+    NSDictionary * before = [_database stats];
+    NSTimeInterval start = FSBenchmarkNow();
+    NSDictionary * response = [self waitForPromise:[[FireSuite chatManager] openChatSessionWithChatId:chatId andNumberOfRecentMessages:(int)kSchemaMessages]];
+    [benchmark addSample:FSBenchmarkNow() - start];
+    [self endChat];
+    benchmark.backendStats = [self statsDeltaFrom:before];
+    benchmark.parameters = @{@"messages": @(kSchemaMessages), @"storedBytes": @(storedBytes), @"latencyMs": @(_database.latency * 1000)};
+    [FSBenchmark recordBenchmark:benchmark];
+    XCTAssertEqual([response[kResponseMessages] count], kSchemaMessages);
+    return @{kResponseMessages: response[kResponseMessages], @"bytesReceived": benchmark.backendStats[kLocalStatBytesReceived]};
+}
+
+- (void) testSchemaV2ShrinksStoredAndLoadedBytes
+{
+    [self seedChatWithId:@"schemaChat" messageCount:kSchemaMessages];
+    [_database setValue:@[@"schemaChat"] andPriority:nil atPath:[NSString stringWithFormat:@"Users/%@/chats", kCurrentUserId]];
+    NSUInteger v1Bytes = FSMetricsEstimatedBytes([_database valueAtPath:@"Chats/schemaChat"]);
+    NSDictionary * v1 = [self openSchemaChatWithId:@"schemaChat" benchmarkName:@"schema.v1.load" storedBytes:v1Bytes];
+
+    // Rewritten In Place -- Nothing Left To Do The Second Time
+    XCTAssertEqualObjects([self waitForPromise:[[FireSuite chatManager] migrateChatsToSchemaVersion:FSChatSchemaVersion2]], @1);
+    XCTAssertEqualObjects([self waitForPromise:[[FireSuite chatManager] migrateChatsToSchemaVersion:FSChatSchemaVersion2]], @0);
+    [_database waitUntilIdleWithTimeout:kTimeout];
+
+    NSDictionary * header = [_database valueAtPath:@"Chats/schemaChat/header"];
+    XCTAssertEqualObjects(header[kHeaderSchemaVersion], @(FSChatSchemaVersion2));
+    XCTAssertNil(header[kCurrentUserId]);
+    NSDictionary * stored = [_database valueAtPath:@"Chats/schemaChat/messages/m000000"];
+    XCTAssertNil(stored[kMessageChatId]);
+    XCTAssertNil(stored[kMessageTimestamp]);
+
+    // Same Messages Come Back, For Fewer Bytes -- Every Client Writes Version 2 By Now
+    [FireSuite chatManager].schemaVersion = FSChatSchemaVersion2;
+    NSUInteger v2Bytes = FSMetricsEstimatedBytes([_database valueAtPath:@"Chats/schemaChat"]);
+    NSDictionary * v2 = [self openSchemaChatWithId:@"schemaChat" benchmarkName:@"schema.v2.load" storedBytes:v2Bytes];
+    XCTAssertEqualObjects(v2[kResponseMessages], v1[kResponseMessages]);
+    XCTAssertTrue(v2Bytes < v1Bytes, @"v1 %lu, v2 %lu", (unsigned long)v1Bytes, (unsigned long)v2Bytes);
+    XCTAssertTrue([v2[@"bytesReceived"] longLongValue] < [v1[@"bytesReceived"] longLongValue], @"v1 %@, v2 %@", v1[@"bytesReceived"], v2[@"bytesReceived"]);
+
+    // New Sends Are Stored In Version 2 And Read Back In Version 1 Keys
+    [self loadChatWithId:@"schemaChat" numberOfMessages:10];
+    NSDictionary * message = [self waitForPromise:[[FireSuite chatManager] sendMessage:@"Short keys"]];
+    [self endChat];
+    [_database waitUntilIdleWithTimeout:kTimeout];
+
+    NSDictionary * messages = [_database valueAtPath:@"Chats/schemaChat/messages"];
+    NSString * sentKey = [[messages allKeys] filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"NOT (SELF BEGINSWITH 'm')"]].firstObject;
+    NSDictionary * sent = FSChatSchemaDecodeMessage(messages[sentKey], @"schemaChat");
+    XCTAssertEqualObjects(sent, message);
+    header = FSChatSchemaDecodeHeader([_database valueAtPath:@"Chats/schemaChat/header"]);
+    XCTAssertEqualObjects(header[kHeaderMessageCount], @(kSchemaMessages + 1));
+    XCTAssertEqualObjects(header[kHeaderLastMessage][kMessageContent], @"Short keys");
+}
+
+- (void) testSchemaUserIdsNeverReadAsFields
+{
+    // A Version 1 Member Named Like The Marker
+    NSDictionary * v1 = @{kHeaderUsers: @[@"v", @"n"], @"v": @"1476000000000.000000", @"n": @"1476000000001.000000", kHeaderMessageCount: @3};
+    XCTAssertEqual(FSChatSchemaVersionOfHeader(v1), FSChatSchemaVersion1);
+    XCTAssertEqualObjects(FSChatSchemaDecodeHeader(v1), v1);
+
+    // Members Named Like Short Keys Round Trip Through Version 2
+    NSDictionary * v2 = FSChatSchemaEncodeHeader(v1, FSChatSchemaVersion2);
+    XCTAssertEqual(FSChatSchemaVersionOfHeader(v2), FSChatSchemaVersion2);
+    XCTAssertEqualObjects(FSChatSchemaDecodeHeader(v2), v1);
+
+    // One User's Timestamp Written Directly Lands In Their Map
+    XCTAssertEqualObjects(FSChatSchemaHeaderKey(@"n", FSChatSchemaVersion2), @"s/n");
+    XCTAssertEqualObjects(FSChatSchemaHeaderKey(kHeaderMessageCount, FSChatSchemaVersion2), @"n");
+}
+
+- (void) testSchemaMigrationPagesThroughChats
+{
+    NSMutableArray * chatIds = [NSMutableArray arrayWithCapacity:kSchemaChats];
+    for (NSUInteger i = 0; i < kSchemaChats; i++) {
+        [chatIds addObject:[self seedChatWithId:[NSString stringWithFormat:@"schemaChat%lu", (unsigned long)i] messageCount:kSchemaChatMessages]];
+    }
+    [_database setValue:chatIds andPriority:nil atPath:[NSString stringWithFormat:@"Users/%@/chats", kCurrentUserId]];
+    NSArray * v1Headers = [self waitForPromise:[[FireSuite chatManager] chatHeadersForUserId:kCurrentUserId]];
+
+    // Several Pages -- Every Chat Exactly Once
+    [FireSuite chatManager].migrationBatchSize = kSchemaBatchSize;
+    FSBenchmark * benchmark = [FSBenchmark benchmarkWithName:@"schema.migrate"];
+    NSDictionary * before = [_database stats];
+    NSTimeInterval start = FSBenchmarkNow();
+    NSNumber * migrated = [self waitForPromise:[[FireSuite chatManager] migrateChatsToSchemaVersion:FSChatSchemaVersion2]];
+    [benchmark addSample:FSBenchmarkNow() - start];
+    benchmark.backendStats = [self statsDeltaFrom:before];
+    benchmark.parameters = @{@"chats": @(kSchemaChats), @"messagesPerChat": @(kSchemaChatMessages), @"batchSize": @(kSchemaBatchSize), @"latencyMs": @(_database.latency * 1000)};
+    [FSBenchmark recordBenchmark:benchmark];
+
+    XCTAssertEqualObjects(migrated, @(kSchemaChats));
+    for (NSString * chatId in chatIds) {
+        XCTAssertEqualObjects([_database valueAtPath:[NSString stringWithFormat:@"Chats/%@/header/%@", chatId, kHeaderSchemaVersion]], @(FSChatSchemaVersion2));
+    }
+
+    // Readers See The Same Headers
+    NSArray * v2Headers = [self waitForPromise:[[FireSuite chatManager] chatHeadersForUserId:kCurrentUserId]];
+    XCTAssertEqualObjects([NSSet setWithArray:v2Headers], [NSSet setWithArray:v1Headers]);
+
+    // And Back Again
+    XCTAssertEqualObjects([self waitForPromise:[[FireSuite chatManager] migrateChatsToSchemaVersion:FSChatSchemaVersion1]], @(kSchemaChats));
+    [_database waitUntilIdleWithTimeout:kTimeout];
+    XCTAssertEqualObjects([_database valueAtPath:@"Chats/schemaChat0/messages/m000000"][kMessageChatId], @"schemaChat0");
+    XCTAssertNil([_database valueAtPath:[NSString stringWithFormat:@"Chats/schemaChat0/header/%@", kHeaderSchemaVersion]]);
+}
+
+#pragma mark RESUME
+
+/*!
+ Messages @param range of @param chatId, as another client would send them -- names and priorities both ascend
+ */
+- (void) seedLiveMessagesInRange:(NSRange)range ofChatId:(NSString *)chatId {
+    for (NSUInteger i = range.location; i < NSMaxRange(range); i++) {
+        NSString * timestamp = [self timestampWithOffset:0];
+        NSDictionary * message = @{
+                                   kMessageTimestamp: timestamp,
+                                   kMessageContent: [NSString stringWithFormat:@"Live message %lu", (unsigned long)i],
+                                   kMessageSentBy: kOtherUserId,
+                                   kMessageSentTo: kCurrentUserId,
+                                   kMessageChatId: chatId,
+                                   };
+        [_database setValue:message andPriority:timestamp atPath:[NSString stringWithFormat:@"Chats/%@/messages/n%06lu", chatId, (unsigned long)i]];
+    }
+}
+
+/*!
+ Contents handed to newMessageReceived: -- @param semaphore is signalled once @param count have arrived
+ */
+- (NSMutableArray *) collectReceivedMessagesUntilCount:(NSUInteger)count signalling:(dispatch_semaphore_t)semaphore {
+    NSMutableArray * received = [NSMutableArray new];
+    _messageReceived = ^(NSDictionary * message) {
+        [received addObject:message[kMessageContent]];
+        if (received.count == count) dispatch_semaphore_signal(semaphore);
+    };
+    return received;
+}
+
+- (NSArray *) liveContentsInRange:(NSRange)range {
+    NSMutableArray * contents = [NSMutableArray arrayWithCapacity:range.length];
+    for (NSUInteger i = range.location; i < NSMaxRange(range); i++) {
+        [contents addObject:[NSString stringWithFormat:@"Live message %lu", (unsigned long)i]];
+    }
+    return contents;
+}
+
+- (void) waitForActiveListeners:(NSUInteger)count {
+    NSTimeInterval deadline = FSBenchmarkNow() + kTimeout;
+    while (_database.activeListeners != count && FSBenchmarkNow() < deadline) {
+        [NSThread sleepForTimeInterval:0.01];
+    }
+    XCTAssertEqual(_database.activeListeners, count, @"Timed out waiting for listeners");
+}
+
+- (void) testMonitorResumesFromCursorAfterReconnect
+{
+    [self seedChatWithId:@"resumeChat" messageCount:50];
+    [self loadChatWithId:@"resumeChat" numberOfMessages:50];
+
+    dispatch_semaphore_t live = dispatch_semaphore_create(0);
+    NSMutableArray * received = [self collectReceivedMessagesUntilCount:kResumeLiveMessages signalling:live];
+    [self seedLiveMessagesInRange:NSMakeRange(0, kResumeLiveMessages) ofChatId:@"resumeChat"];
+    [self waitForSemaphore:live];
+
+    // Offline -- The Monitor Is Dropped Rather Than Left To Re-Sync Everything Since The Load
+    [_database waitUntilIdleWithTimeout:kTimeout];
+    NSUInteger listeners = _database.activeListeners;
+    [_database disconnect];
+    [self waitForActiveListeners:listeners - 1];
+
+    NSRange gap = NSMakeRange(kResumeLiveMessages, kResumeGapMessages);
+    [self seedLiveMessagesInRange:gap ofChatId:@"resumeChat"];
+
+    dispatch_semaphore_t resumed = dispatch_semaphore_create(0);
+    received = [self collectReceivedMessagesUntilCount:kResumeGapMessages signalling:resumed];
+    FSBenchmark * benchmark = [FSBenchmark benchmarkWithName:@"chat.resume.reconnect"];
+    NSDictionary * before = [_database stats];
+    NSTimeInterval start = FSBenchmarkNow();
+    [_database reconnect];
+    [self waitForSemaphore:resumed];
+    [benchmark addSample:FSBenchmarkNow() - start];
+
+    NSDictionary * stats = [self statsDeltaFrom:before];
+    benchmark.backendStats = stats;
+    benchmark.parameters = @{@"delivered": @(kResumeLiveMessages), @"gap": @(kResumeGapMessages), @"latencyMs": @(_database.latency * 1000)};
+    [FSBenchmark recordBenchmark:benchmark];
+
+    // Only The Gap, Once Each, In Order
+    [self onFirebaseQueue:^(dispatch_block_t done) {
+        done();
+    }];
+    XCTAssertEqualObjects(received, [self liveContentsInRange:gap]);
+    XCTAssertEqual(_database.activeListeners, listeners);
+
+    NSUInteger liveBytes = [_database byteSizeAtPath:@"Chats/resumeChat/messages"];
+    XCTAssertTrue([stats[kLocalStatBytesReceived] unsignedIntegerValue] * 10 < liveBytes, @"%@ of %lu bytes", stats[kLocalStatBytesReceived], (unsigned long)liveBytes);
+}
+
+- (void) testResumeAfterRestartFetchesOnlyTheGap
+{
+    NSString * path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"FireSuiteTests-restart.cursors"];
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+    [FireSuite chatManager].cursorPath = path;
+
+    [self seedChatWithId:@"resumeChat" messageCount:50];
+    [self loadChatWithId:@"resumeChat" numberOfMessages:50];
+
+    dispatch_semaphore_t live = dispatch_semaphore_create(0);
+    [self collectReceivedMessagesUntilCount:kResumeLiveMessages signalling:live];
+    [self seedLiveMessagesInRange:NSMakeRange(0, kResumeLiveMessages) ofChatId:@"resumeChat"];
+    [self waitForSemaphore:live];
+
+    // Ending Saves The Cursor -- Then Messages Arrive While The App Is Gone
+    [self endChat];
+    XCTAssertTrue([[NSFileManager defaultManager] fileExistsAtPath:path]);
+    NSRange gap = NSMakeRange(kResumeLiveMessages, kResumeGapMessages);
+    [self seedLiveMessagesInRange:gap ofChatId:@"resumeChat"];
+
+    // Relaunch -- A Fresh Manager Knows Only The File
+    FSContext * relaunched = [FSContext contextWithFirebaseURL:kBenchmarkURL currentUserId:kCurrentUserId];
+    relaunched.callbackQueue = _firebaseQueue;
+    relaunched.chatManager.delegate = self;
+    relaunched.chatManager.cursorPath = path;
+
+    dispatch_semaphore_t resumed = dispatch_semaphore_create(0);
+    NSMutableArray * received = [self collectReceivedMessagesUntilCount:kResumeGapMessages signalling:resumed];
+    FSBenchmark * benchmark = [FSBenchmark benchmarkWithName:@"chat.resume.restart"];
+    NSDictionary * before = [_database stats];
+    NSTimeInterval start = FSBenchmarkNow();
+    NSDictionary * response = [self waitForPromise:[relaunched.chatManager reopenChatSessionWithChatId:@"resumeChat" andNumberOfRecentMessages:50]];
+    [self waitForSemaphore:resumed];
+    [benchmark addSample:FSBenchmarkNow() - start];
+
+    NSDictionary * stats = [self statsDeltaFrom:before];
+    benchmark.backendStats = stats;
+    benchmark.parameters = @{@"delivered": @(kResumeLiveMessages), @"gap": @(kResumeGapMessages), @"latencyMs": @(_database.latency * 1000)};
+    [FSBenchmark recordBenchmark:benchmark];
+
+    // No Initial Window -- Just The Gap
+    XCTAssertEqualObjects(response[kResponseResumed], @YES);
+    XCTAssertEqualObjects(response[kResponseMessages], [NSNull null]);
+    [self onFirebaseQueue:^(dispatch_block_t done) {
+        done();
+    }];
+    XCTAssertEqualObjects(received, [self liveContentsInRange:gap]);
+
+    NSUInteger liveBytes = [_database byteSizeAtPath:@"Chats/resumeChat/messages"];
+    XCTAssertTrue([stats[kLocalStatBytesReceived] unsignedIntegerValue] * 10 < liveBytes, @"%@ of %lu bytes", stats[kLocalStatBytesReceived], (unsigned long)liveBytes);
+
+    [self waitForPromise:[relaunched.chatManager endChatSession]];
+}
+
+#pragma mark PREFETCH
+
+/*!
+ Seeds @param count chats, each more recently active than the last, and returns their stored headers keyed by chat id
+ */
+- (NSDictionary *) prefetchHeadersForChatCount:(NSUInteger)count {
+    NSMutableDictionary * headers = [NSMutableDictionary dictionaryWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        NSString * chatId = [self seedChatWithId:[NSString stringWithFormat:@"prefetchChat%lu", (unsigned long)i] messageCount:kPrefetchChatMessages];
+        headers[chatId] = [_database valueAtPath:[NSString stringWithFormat:@"Chats/%@/header", chatId]];
+        [NSThread sleepForTimeInterval:0.002];
+    }
+    return headers;
+}
+
+- (void) testPrefetchedChatOpensWithoutRoundTrip
+{
+    NSDictionary * headers = [self prefetchHeadersForChatCount:kPrefetchChats];
+    FSChatManager * chatManager = [FireSuite chatManager];
+    chatManager.prefetchChatCount = kPrefetchTopChats;
+
+    // Opened Most -- Ranks First, Though It's The Least Recently Active
+    for (int i = 0; i < 2; i++) {
+        [self loadChatWithId:@"prefetchChat0" numberOfMessages:20];
+        [self endChat];
+    }
+    XCTAssertEqualObjects([self waitForPromise:[chatManager prefetchChatsWithHeaders:headers]], @(kPrefetchTopChats));
+    [_database waitUntilIdleWithTimeout:kTimeout];
+    _database.latency = kPrefetchLatency;
+
+    // Cold -- Header, Then Messages
+    FSBenchmark * cold = [FSBenchmark benchmarkWithName:@"chat.prefetch.cold"];
+    NSTimeInterval start = FSBenchmarkNow();
+    NSDictionary * coldResponse = [self waitForPromise:[chatManager openChatSessionWithChatId:@"prefetchChat1" andNumberOfRecentMessages:20]];
+    NSTimeInterval coldDuration = FSBenchmarkNow() - start;
+    [cold addSample:coldDuration];
+    [self endChat];
+
+    // Warm -- Nothing To Wait For
+    FSBenchmark * warm = [FSBenchmark benchmarkWithName:@"chat.prefetch.warm"];
+    start = FSBenchmarkNow();
+    NSDictionary * warmResponse = [self waitForPromise:[chatManager openChatSessionWithChatId:@"prefetchChat0" andNumberOfRecentMessages:20]];
+    NSTimeInterval warmDuration = FSBenchmarkNow() - start;
+    [warm addSample:warmDuration];
+
+    for (FSBenchmark * benchmark in @[cold, warm]) {
+        benchmark.parameters = @{@"chats": @(kPrefetchChats), @"prefetched": @(kPrefetchTopChats), @"messages": @20, @"latencyMs": @(kPrefetchLatency * 1000)};
+        [FSBenchmark recordBenchmark:benchmark];
+    }
+
+    XCTAssertEqual([coldResponse[kResponseMessages] count], (NSUInteger)20);
+    XCTAssertEqual([warmResponse[kResponseMessages] count], (NSUInteger)20);
+    XCTAssertEqualObjects([warmResponse[kResponseMessages] lastObject][kMessageContent], ([NSString stringWithFormat:@"Seeded message %lu", (unsigned long)kPrefetchChatMessages - 1]));
+    XCTAssertTrue(coldDuration >= 2 * kPrefetchLatency, @"Cold open took %f", coldDuration);
+    XCTAssertTrue(warmDuration < kPrefetchLatency, @"Warm open took %f", warmDuration);
+
+    // Anything Since The Prefetch Follows Live
+    dispatch_semaphore_t received = dispatch_semaphore_create(0);
+    NSMutableArray * messages = [self collectReceivedMessagesUntilCount:1 signalling:received];
+    [self seedLiveMessagesInRange:NSMakeRange(0, 1) ofChatId:@"prefetchChat0"];
+    [self waitForSemaphore:received];
+    XCTAssertEqualObjects(messages, [self liveContentsInRange:NSMakeRange(0, 1)]);
+}
+
+- (void) testPrefetchRespectsByteBudget
+{
+    NSDictionary * headers = [self prefetchHeadersForChatCount:kPrefetchChats];
+    FSChatManager * chatManager = [FireSuite chatManager];
+    chatManager.prefetchChatCount = kPrefetchTopChats;
+    XCTAssertEqualObjects([self waitForPromise:[chatManager prefetchChatsWithHeaders:headers]], @(kPrefetchTopChats));
+
+    // Nothing Moved -- Nothing Read Again
+    NSDictionary * before = [_database stats];
+    XCTAssertEqualObjects([self waitForPromise:[chatManager prefetchChatsWithHeaders:headers]], @(kPrefetchTopChats));
+    NSDictionary * stats = [self statsDeltaFrom:before];
+    XCTAssertEqual([stats[kLocalStatReads] longLongValue], 0LL);
+    XCTAssertEqual([stats[kLocalStatBytesReceived] longLongValue], 0LL);
+
+    // Room For One And A Half Chats
+    NSString * chatId = [NSString stringWithFormat:@"prefetchChat%lu", (unsigned long)kPrefetchChats - 1];
+    NSDictionary * stored = [_database valueAtPath:[NSString stringWithFormat:@"Chats/%@/messages", chatId]];
+    NSArray * newest = [[[stored allKeys] sortedArrayUsingSelector:@selector(compare:)] subarrayWithRange:NSMakeRange(kPrefetchChatMessages - chatManager.prefetchMessageCount, chatManager.prefetchMessageCount)];
+    NSUInteger chatBytes = FSMetricsEstimatedBytes(headers[chatId]) + FSMetricsEstimatedBytes([stored dictionaryWithValuesForKeys:newest]);
+    chatManager.prefetchByteBudget = chatBytes * 3 / 2;
+    XCTAssertEqualObjects([self waitForPromise:[chatManager prefetchChatsWithHeaders:headers]], @1);
+
+    chatManager.prefetchByteBudget = 0;
+    XCTAssertEqualObjects([self waitForPromise:[chatManager prefetchChatsWithHeaders:headers]], @0);
+}
+
+#pragma mark RATE LIMIT
+
+- (FSContext *) rateLimitedContextForChatId:(NSString *)chatId {
+    [self seedChatWithId:chatId messageCount:0];
+    FSContext * context = [FSContext contextWithFirebaseURL:kBenchmarkURL currentUserId:kCurrentUserId];
+    context.callbackQueue = _firebaseQueue;
+    context.rateLimiter.keyRatePerSecond = kRateLimitPerSecond;
+    context.rateLimiter.keyBurst = kRateLimitBurst;
+    [self waitForPromise:[context.chatManager openChatSessionWithChatId:chatId andNumberOfRecentMessages:50]];
+    return context;
+}
+
+- (void) testRateLimiterPacesSendsPerChat
+{
+    FSContext * context = [self rateLimitedContextForChatId:@"limitChat"];
+    __block NSUInteger maxDepth = 0;
+    context.rateLimiter.queueDepthHandler = ^(NSUInteger queueDepth) {
+        maxDepth = MAX(maxDepth, queueDepth);
+    };
+
+    // A Script Flooding One Chat
+    FSBenchmark * benchmark = [FSBenchmark benchmarkWithName:@"chat.rateLimit.send"];
+    NSDictionary * before = [_database stats];
+    NSTimeInterval start = FSBenchmarkNow();
+    NSMutableArray * sends = [NSMutableArray arrayWithCapacity:kRateLimitSends];
+    for (NSUInteger i = 0; i < kRateLimitSends; i++) {
+        [sends addObject:[context.chatManager sendMessage:[NSString stringWithFormat:@"Limited %lu", (unsigned long)i]]];
+    }
+    FSPromise * sent = [FSPromise all:sends];
+    [self waitForPromise:sent];
+    NSTimeInterval duration = FSBenchmarkNow() - start;
+    [benchmark setOperations:kRateLimitSends completedInDuration:duration];
+    benchmark.backendStats = [self statsDeltaFrom:before];
+    benchmark.parameters = @{@"sends": @(kRateLimitSends), @"ratePerSecond": @(kRateLimitPerSecond), @"burst": @(kRateLimitBurst), @"latencyMs": @(_database.latency * 1000)};
+    [FSBenchmark recordBenchmark:benchmark];
+
+    // Burst At Once, The Rest At The Rate -- Nothing Dropped
+    XCTAssertNil(sent.error);
+    XCTAssertTrue(duration >= (kRateLimitSends - kRateLimitBurst) / kRateLimitPerSecond * 0.9, @"%lu sends took %f", (unsigned long)kRateLimitSends, duration);
+    XCTAssertEqual([[_database valueAtPath:@"Chats/limitChat/messages"] count], kRateLimitSends);
+    XCTAssertEqual([[context.metrics metricsForOperation:kFSOperationRateLimit] calls], (int64_t)kRateLimitSends);
+
+    // Back-Pressure Was Signalled, And Released
+    [self onFirebaseQueue:^(dispatch_block_t done) {
+        done();
+    }];
+    XCTAssertTrue(maxDepth > 0);
+    XCTAssertEqual(context.rateLimiter.queueDepth, (NSUInteger)0);
+
+    [self waitForPromise:[context.chatManager endChatSession]];
+}
+
+- (void) testRateLimiterRejectsPastQueueDepth
+{
+    FSContext * context = [self rateLimitedContextForChatId:@"limitChat"];
+    context.rateLimiter.keyBurst = 1;
+    context.rateLimiter.maxQueueDepth = kRateLimitQueueDepth;
+
+    // One Goes, kRateLimitQueueDepth Wait, The Rest Are Refused
+    NSMutableArray * sends = [NSMutableArray new];
+    for (NSUInteger i = 0; i < kRateLimitQueueDepth * 2; i++) {
+        [sends addObject:[context.chatManager sendMessage:[NSString stringWithFormat:@"Limited %lu", (unsigned long)i]]];
+    }
+    NSUInteger refused = 0;
+    for (FSPromise * send in sends) {
+        [self waitForPromise:send];
+        if (!send.error) continue;
+        XCTAssertEqualObjects(send.error.domain, kFSRateLimiterErrorDomain);
+        XCTAssertEqual(send.error.code, (NSInteger)FSRateLimitErrorQueueFull);
+        refused++;
+    }
+    XCTAssertEqual(refused, kRateLimitQueueDepth - 1);
+    [_database waitUntilIdleWithTimeout:kTimeout];
+    XCTAssertEqual([[_database valueAtPath:@"Chats/limitChat/messages"] count], kRateLimitQueueDepth + 1);
+
+    [self waitForPromise:[context.chatManager endChatSession]];
+}
+
+- (void) testRateLimiterCoalescesWaitingSends
+{
+    FSContext * context = [self rateLimitedContextForChatId:@"limitChat"];
+    context.rateLimiter.keyBurst = 1;
+    context.chatManager.coalescesLimitedSends = YES;
+
+    // The First Goes At Once -- Everything Behind It Folds Into One Write
+    NSMutableArray * sends = [NSMutableArray new];
+    NSMutableArray * lines = [NSMutableArray new];
+    for (NSUInteger i = 0; i < kRateLimitBurst * 2; i++) {
+        NSString * content = [NSString stringWithFormat:@"Coalesced %lu", (unsigned long)i];
+        [sends addObject:[context.chatManager sendMessage:content]];
+        if (i > 0) [lines addObject:content];
+    }
+    NSArray * messages = [self waitForPromise:[FSPromise all:sends]];
+
+    XCTAssertEqualObjects(messages[0][kMessageContent], @"Coalesced 0");
+    for (NSUInteger i = 1; i < messages.count; i++) {
+        XCTAssertEqualObjects(messages[i][kMessageContent], [lines componentsJoinedByString:@"\n"]);
+        XCTAssertEqualObjects(messages[i][kMessageTimestamp], messages[1][kMessageTimestamp]);
+    }
+    [_database waitUntilIdleWithTimeout:kTimeout];
+    XCTAssertEqual([[_database valueAtPath:@"Chats/limitChat/messages"] count], (NSUInteger)2);
+
+    [self waitForPromise:[context.chatManager endChatSession]];
+}
+
+#pragma mark EVENT HUB
+
+- (void) waitForEventHubObservers:(NSUInteger)count {
+    FSEventHub * eventHub = [FireSuite eventHub];
+    NSTimeInterval deadline = FSBenchmarkNow() + kTimeout;
+    while ([eventHub observerCount] != count && FSBenchmarkNow() < deadline) {
+        [NSThread sleepForTimeInterval:0.01];
+    }
+    XCTAssertEqual([eventHub observerCount], count, @"Timed out waiting for hub observers");
+}
+
+- (void) testUserStatusObserversShareOneListener
+{
+    FSPresenceManager * presenceManager = [FireSuite presenceManager];
+    FSEventHub * eventHub = [FireSuite eventHub];
+    [_database waitUntilIdleWithTimeout:kTimeout];
+    NSUInteger listeners = _database.activeListeners;
+    NSUInteger hubListeners = [eventHub listenerCount];
+    NSMutableArray * observers = [NSMutableArray new];
+
+    __block NSUInteger remaining = kHubObservers;
+    __block dispatch_semaphore_t notified = dispatch_semaphore_create(0);
+    void (^callback)(id) = ^(id userId) {
+        if (--remaining == 0) dispatch_semaphore_signal(notified);
+    };
+
+    // Register -- Only The First Opens A Listener, The Rest Hear Its Last Snapshot
+    NSDictionary * before = [_database stats];
+    dispatch_async(_firebaseQueue, ^{
+        for (NSUInteger i = 0; i < kHubObservers; i++) {
+            FSBenchmarkObserver * observer = [FSBenchmarkObserver new];
+            observer.callback = callback;
+            [observers addObject:observer];
+            [presenceManager registerUserStatusObserver:observer
+                                           withSelector:@selector(userStatusDidUpdateWithId:andStatus:)
+                                              forUserId:kOtherUserId];
+        }
+    });
+    [self waitForSemaphore:notified];
+
+    NSDictionary * delta = [self statsDeltaFrom:before];
+    XCTAssertEqual([delta[kLocalStatReads] longLongValue], 1LL);
+    XCTAssertEqual(_database.activeListeners, listeners + 1);
+    XCTAssertEqual([eventHub listenerCount], hubListeners + 1);
+
+    // Flap -- One Event Downloaded, Every Observer Told
+    FSBenchmark * benchmark = [FSBenchmark benchmarkWithName:@"eventHub.userStatusFanOut"];
+    before = [_database stats];
+    for (NSUInteger flap = 0; flap < kHubFlaps; flap++) {
+        notified = dispatch_semaphore_create(0);
+        dispatch_sync(_firebaseQueue, ^{
+            remaining = kHubObservers;
+        });
+
+        NSTimeInterval start = FSBenchmarkNow();
+        id value = flap % 2 ? [NSNull null] : @{@"device": [self timestampWithOffset:0]};
+        [_database setValue:value andPriority:nil atPath:[NSString stringWithFormat:@"Users/%@/connections", kOtherUserId]];
+        [self waitForSemaphore:notified];
+        [benchmark addSample:FSBenchmarkNow() - start];
+    }
+
+    delta = [self statsDeltaFrom:before];
+    XCTAssertEqual([delta[kLocalStatEventsDelivered] longLongValue], (long long)kHubFlaps);
+    benchmark.backendStats = delta;
+    benchmark.parameters = @{@"observers": @(kHubObservers), @"flaps": @(kHubFlaps), @"latencyMs": @(_database.latency * 1000)};
+    [FSBenchmark recordBenchmark:benchmark];
+
+    // The Listener Outlives All But The Last Observer
+    [self onFirebaseQueue:^(dispatch_block_t done) {
+        [presenceManager removeUserStatusObserversForObject:observers[0]];
+        done();
+    }];
+    [self waitForEventHubObservers:kHubObservers - 1];
+    XCTAssertEqual([eventHub listenerCount], hubListeners + 1);
+
+    [self onFirebaseQueue:^(dispatch_block_t done) {
+        [presenceManager removeAllUserStatusObservers];
+        done();
+    }];
+    [self waitForActiveListeners:listeners];
+    XCTAssertEqual([eventHub listenerCount], hubListeners);
+}
+
+- (void) testConnectionListenerSharedAcrossManagers
+{
+    FSEventHub * eventHub = [FireSuite eventHub];
+    [self onFirebaseQueue:^(dispatch_block_t done) {
+        [[FireSuite presenceManager] stopPresenceMonitorWithCompletion:done];
+    }];
+    NSUInteger hubListeners = [eventHub listenerCount];
+    NSUInteger hubObservers = [eventHub observerCount];
+
+    // The Chat Monitor Opens .info/connected -- Presence Joins It, Alerts Add Their Own
+    [self seedChatWithId:@"hubChat" messageCount:10];
+    [self loadChatWithId:@"hubChat" numberOfMessages:10];
+    FSBenchmarkObserver * observer = [FSBenchmarkObserver new];
+    [self onFirebaseQueue:^(dispatch_block_t done) {
+        [[FireSuite presenceManager] startPresenceManager];
+        [[FireSuite channelManager] registerUserAlertsObserver:observer withSelector:@selector(receivedAlert:)];
+        done();
+    }];
+    [self waitForEventHubObservers:hubObservers + 3];
+    XCTAssertEqual([eventHub listenerCount], hubListeners + 2);
+
+    // Presence Still Hears The Connection -- It Marks Us Online
+    NSString * connectionsPath = [NSString stringWithFormat:@"Users/%@/connections", kCurrentUserId];
+    NSTimeInterval deadline = FSBenchmarkNow() + kTimeout;
+    while (![_database valueAtPath:connectionsPath] && FSBenchmarkNow() < deadline) {
+        [NSThread sleepForTimeInterval:0.01];
+    }
+    XCTAssertNotNil([_database valueAtPath:connectionsPath]);
+
+    // Each Leaves On Its Own Schedule -- The Last Out Closes The Listener
+    [self onFirebaseQueue:^(dispatch_block_t done) {
+        [[FireSuite presenceManager] stopPresenceMonitorWithCompletion:done];
+    }];
+    [self onFirebaseQueue:^(dispatch_block_t done) {
+        [[FireSuite channelManager] endAlertsMonitorWithCompletionBlock:done];
+    }];
+    XCTAssertEqual([eventHub listenerCount], hubListeners + 1);
+    [self endChat];
+    XCTAssertEqual([eventHub listenerCount], hubListeners);
+    XCTAssertEqual([eventHub observerCount], hubObservers);
+}
+
+#pragma mark IMPORT
+
+/*!
+ @param count chats between the current and other user, oldest message last in each so the importer has to sort
+ */
+- (NSArray *) importChatsWithCount:(NSUInteger)count {
+    NSMutableArray * chats = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        NSMutableArray * messages = [NSMutableArray arrayWithCapacity:kImportChatMessages];
+        for (NSUInteger m = kImportChatMessages; m > 0; m--) {
+            [messages addObject:@{
+                                  kMessageTimestamp: [self timestampWithOffset:-(double)(m * 1000)],
+                                  kMessageContent: [NSString stringWithFormat:@"Imported message %lu", (unsigned long)(kImportChatMessages - m)],
+                                  kMessageSentBy: m % 2 ? kCurrentUserId : kOtherUserId,
+                                  kMessageSentTo: m % 2 ? kOtherUserId : kCurrentUserId,
+                                  }];
+        }
+        [chats addObject:@{
+                           kImportChatId: [NSString stringWithFormat:@"importChat%lu", (unsigned long)i],
+                           kImportUsers: @[kCurrentUserId, kOtherUserId],
+                           kImportMessages: [[messages reverseObjectEnumerator] allObjects],
+                           }];
+    }
+    return chats;
+}
+
+- (NSString *) importCheckpointPath {
+    NSString * path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"FireSuiteImportCheckpoint.json"];
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+    return path;
+}
+
+- (void) testImportPipelinesChunks
+{
+    FSChatManager * chatManager = [FireSuite chatManager];
+    chatManager.importBatchSize = kImportBatchSize;
+    chatManager.importMaxInFlight = kImportMaxInFlight;
+    NSArray * chats = [self importChatsWithCount:kImportChats];
+
+    FSBenchmark * benchmark = [FSBenchmark benchmarkWithName:@"import.chats"];
+    NSMutableArray * progress = [NSMutableArray new];
+    __block NSUInteger imported = 0;
+    dispatch_semaphore_t finished = dispatch_semaphore_create(0);
+    NSDictionary * before = [_database stats];
+    NSTimeInterval start = FSBenchmarkNow();
+    [chatManager importChats:[chats objectEnumerator] checkpointPath:[self importCheckpointPath] withProgressBlock:^(NSUInteger importedCount) {
+        [progress addObject:@(importedCount)];
+    } andCompletionBlock:^(NSUInteger importedCount, NSError *error) {
+        XCTAssertNil(error);
+        imported = importedCount;
+        dispatch_semaphore_signal(finished);
+    }];
+    [self waitForSemaphore:finished];
+    NSTimeInterval duration = FSBenchmarkNow() - start;
+    [benchmark addSample:duration];
+    [benchmark setOperations:kImportChats * kImportChatMessages completedInDuration:duration];
+
+    NSDictionary * delta = [self statsDeltaFrom:before];
+    benchmark.backendStats = delta;
+    benchmark.parameters = @{@"chats": @(kImportChats), @"messagesPerChat": @(kImportChatMessages), @"batchSize": @(kImportBatchSize), @"maxInFlight": @(kImportMaxInFlight), @"latencyMs": @(_database.latency * 1000)};
+    [FSBenchmark recordBenchmark:benchmark];
+
+    // Progress Only Moves Forward, And Ends With Every Chat
+    XCTAssertEqual(imported, kImportChats);
+    XCTAssertEqualObjects(progress.lastObject, @(kImportChats));
+    XCTAssertEqualObjects(progress, [progress sortedArrayUsingSelector:@selector(compare:)]);
+
+    // A Chat List Transaction Per Member Per Chunk, Not Per Chat
+    XCTAssertTrue([delta[kLocalStatTransactions] longLongValue] < (long long)kImportChats, @"%@ transactions", delta[kLocalStatTransactions]);
+    XCTAssertEqual([[_database valueAtPath:[NSString stringWithFormat:@"Users/%@/chats", kCurrentUserId]] count], kImportChats);
+    XCTAssertEqual([[_database valueAtPath:[NSString stringWithFormat:@"Users/%@/chatChanges", kOtherUserId]] count], kImportChats);
+
+    // Headers Match The Newest Message, Keys Sort Oldest First
+    NSDictionary * header = FSChatSchemaDecodeHeader([_database valueAtPath:@"Chats/importChat0/header"]);
+    XCTAssertEqualObjects(header[kHeaderMessageCount], @(kImportChatMessages));
+    XCTAssertEqualObjects(header[kHeaderLastMessage][kMessageContent], ([NSString stringWithFormat:@"Imported message %lu", (unsigned long)(kImportChatMessages - 1)]));
+    XCTAssertEqualObjects(header[kCurrentUserId], header[kHeaderTimeStamp]);
+
+    NSDictionary * messages = [_database valueAtPath:@"Chats/importChat0/messages"];
+    NSArray * keys = [[messages allKeys] sortedArrayUsingSelector:@selector(compare:)];
+    for (NSUInteger i = 0; i < keys.count; i++) {
+        XCTAssertEqualObjects(messages[keys[i]][kMessageContent], ([NSString stringWithFormat:@"Imported message %lu", (unsigned long)i]));
+    }
+}
+
+- (void) testImportResumesFromCheckpoint
+{
+    FSChatManager * chatManager = [FireSuite chatManager];
+    chatManager.importBatchSize = kImportBatchSize;
+    chatManager.importMaxInFlight = kImportMaxInFlight;
+    NSArray * chats = [self importChatsWithCount:kImportChats];
+    NSString * checkpointPath = [self importCheckpointPath];
+
+    // Fails Partway -- Chunks Before The Failure Are Counted, Nothing Past It
+    NSString * deniedPath = [NSString stringWithFormat:@"Chats/importChat%lu", (unsigned long)kImportFailingChat];
+    [_database denyAccessToPath:deniedPath];
+    __block NSUInteger imported = 0;
+    dispatch_semaphore_t failed = dispatch_semaphore_create(0);
+    [chatManager importChats:[chats objectEnumerator] checkpointPath:checkpointPath withProgressBlock:nil andCompletionBlock:^(NSUInteger importedCount, NSError *error) {
+        XCTAssertEqual(error.code, (NSInteger)FSLocalErrorPermissionDenied);
+        imported = importedCount;
+        dispatch_semaphore_signal(failed);
+    }];
+    [self waitForSemaphore:failed];
+
+    XCTAssertTrue(imported > 0 && imported <= kImportFailingChat, @"%lu imported", (unsigned long)imported);
+    NSDictionary * checkpoint = [NSJSONSerialization JSONObjectWithData:[NSData dataWithContentsOfFile:checkpointPath] options:0 error:nil];
+    XCTAssertEqualObjects(checkpoint.allValues.firstObject, @(imported));
+    XCTAssertNil([_database valueAtPath:[deniedPath stringByAppendingString:@"/header"]]);
+
+    // Same Stream, Same Path -- Picks Up From The Checkpoint
+    [_database allowAccessToPath:deniedPath];
+    XCTAssertEqualObjects([self waitForPromise:[chatManager importChats:[chats objectEnumerator] checkpointPath:checkpointPath]], @(kImportChats));
+    [_database waitUntilIdleWithTimeout:kTimeout];
+
+    NSArray * chatIds = [_database valueAtPath:[NSString stringWithFormat:@"Users/%@/chats", kCurrentUserId]];
+    XCTAssertEqual(chatIds.count, kImportChats);
+    XCTAssertEqual([NSSet setWithArray:chatIds].count, kImportChats);
+    XCTAssertEqualObjects(FSChatSchemaDecodeHeader([_database valueAtPath:[deniedPath stringByAppendingString:@"/header"]])[kHeaderMessageCount], @(kImportChatMessages));
+}
+
+#pragma mark ADAPTIVE LOAD
+
+/*!
+ Load @param chatId asking for @param numberOfMessages -- the response, and seconds until it arrived
+ */
+- (NSDictionary *) loadResponseForChatId:(NSString *)chatId numberOfMessages:(int)numberOfMessages duration:(NSTimeInterval *)duration {
+    __block NSDictionary * loadResponse;
+    dispatch_semaphore_t loaded = dispatch_semaphore_create(0);
+    _loadFinished = ^(NSDictionary * response) {
+        loadResponse = response;
+        dispatch_semaphore_signal(loaded);
+    };
+    NSTimeInterval start = FSBenchmarkNow();
+    dispatch_async(_firebaseQueue, ^{
+        [[FireSuite chatManager] loadChatSessionWithChatId:chatId andNumberOfRecentMessages:numberOfMessages];
+    });
+    [self waitForSemaphore:loaded];
+    if (duration) *duration = FSBenchmarkNow() - start;
+    _loadFinished = nil;
+    return loadResponse;
+}
+
+- (void) testAdaptiveLoadPagesInBehindFirstWindow
+{
+    FSChatManager * chatManager = [FireSuite chatManager];
+    [self seedChatWithId:@"adaptiveChat" messageCount:kAdaptiveMessages];
+    _database.latency = kAdaptiveLatency;
+    _database.bandwidth = kAdaptiveBandwidth;
+
+    // Everything Up Front -- The Baseline, And Throughput To Go On
+    NSTimeInterval fixedDuration;
+    NSDictionary * response = [self loadResponseForChatId:@"adaptiveChat" numberOfMessages:(int)kAdaptiveMessages duration:&fixedDuration];
+    [self endChat];
+    XCTAssertEqual([response[kResponseMessages] count], kAdaptiveMessages);
+    XCTAssertTrue([chatManager estimatedRoundTrip] >= kAdaptiveLatency, @"Round trip %f", [chatManager estimatedRoundTrip]);
+    XCTAssertTrue([chatManager estimatedBytesPerSecond] > 0);
+
+    // Adaptive -- A Small First Window, The Rest In Pages Behind It
+    chatManager.initialLoadTargetLatency = kAdaptiveTarget;
+    chatManager.minimumInitialMessageCount = kAdaptiveMinimumWindow;
+    NSMutableArray * earlier = [NSMutableArray new];
+    __block NSUInteger expected = NSUIntegerMax;
+    dispatch_semaphore_t paged = dispatch_semaphore_create(0);
+    _earlierLoaded = ^(NSArray * messages) {
+        [earlier insertObjects:messages atIndexes:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, messages.count)]];
+        if (earlier.count == expected) dispatch_semaphore_signal(paged);
+    };
+
+    NSTimeInterval adaptiveDuration;
+    response = [self loadResponseForChatId:@"adaptiveChat" numberOfMessages:(int)kAdaptiveMessages duration:&adaptiveDuration];
+    NSArray * window = response[kResponseMessages];
+    XCTAssertTrue(window.count >= kAdaptiveMinimumWindow && window.count < kAdaptiveMessages, @"First window of %lu", (unsigned long)window.count);
+    XCTAssertEqualObjects(response[kResponseEarlierCount], @(kAdaptiveMessages - window.count));
+    XCTAssertTrue(adaptiveDuration < fixedDuration, @"Adaptive %f, fixed %f", adaptiveDuration, fixedDuration);
+
+    dispatch_sync(_firebaseQueue, ^{
+        expected = kAdaptiveMessages - window.count;
+        if (earlier.count == expected) dispatch_semaphore_signal(paged);
+    });
+    [self waitForSemaphore:paged];
+
+    FSBenchmark * benchmark = [FSBenchmark benchmarkWithName:@"load.adaptiveFirstRender"];
+    [benchmark addSample:adaptiveDuration];
+    benchmark.parameters = @{@"messages": @(kAdaptiveMessages), @"firstWindow": @(window.count), @"fixedSeconds": @(fixedDuration), @"targetSeconds": @(kAdaptiveTarget), @"latencyMs": @(kAdaptiveLatency * 1000), @"bandwidth": @(kAdaptiveBandwidth)};
+    [FSBenchmark recordBenchmark:benchmark];
+
+    // Pages And Window Together Are The Newest Messages, In Order, Once Each
+    __block NSArray * all;
+    dispatch_sync(_firebaseQueue, ^{
+        all = [earlier arrayByAddingObjectsFromArray:window];
+    });
+    XCTAssertEqual(all.count, kAdaptiveMessages);
+    for (NSUInteger i = 0; i < all.count; i++) {
+        XCTAssertEqualObjects(all[i][kMessageContent], ([NSString stringWithFormat:@"Seeded message %lu", (unsigned long)i]));
+    }
 }
 
 @end